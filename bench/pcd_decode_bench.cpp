@@ -0,0 +1,174 @@
+#include "pcd_decode.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t POINTS = 1 << 20;
+
+struct Layout {
+    const char* name;
+    char type;
+    int size;
+    std::size_t step;
+    int offsets[3];
+};
+
+// 各布局对应的常见录制输出：紧密 xyz、xyz+intensity、双精度、量化整型、混合类型。
+const Layout LAYOUTS[] = {
+    {"packed_xyz_f32", 'F', 4, 12, {0, 4, 8}},
+    {"xyz_intensity_f32", 'F', 4, 16, {0, 4, 8}},
+    {"xyz_normal_f32", 'F', 4, 32, {0, 4, 8}},
+    {"xyz_f64", 'F', 8, 24, {0, 8, 16}},
+    {"xyz_i16", 'I', 2, 6, {0, 2, 4}},
+    {"xyz_u8", 'U', 1, 3, {0, 1, 2}},
+    {"intensity_first_f32", 'F', 4, 16, {4, 8, 12}},
+};
+
+template <typename T>
+void fillReal(char* dst, std::mt19937& rng) {
+    std::uniform_real_distribution<T> dist(-100.0, 100.0);
+    const T v = dist(rng);
+    std::memcpy(dst, &v, sizeof(T));
+}
+
+// 整型取该类型的全部取值范围（U 类型无负值）；uniform_int_distribution 不接受 8 位类型，经 int64 抽样再收窄。
+template <typename T>
+void fillInteger(char* dst, std::mt19937& rng) {
+    std::uniform_int_distribution<std::int64_t> dist(std::numeric_limits<T>::min(), std::numeric_limits<T>::max());
+    const T v = static_cast<T>(dist(rng));
+    std::memcpy(dst, &v, sizeof(T));
+}
+
+// 按字段的 type/size 写满 size 字节。
+void fillScalar(char* dst, char type, int size, std::mt19937& rng) {
+    if (type == 'F' && size == 4) {
+        fillReal<float>(dst, rng);
+    } else if (type == 'F' && size == 8) {
+        fillReal<double>(dst, rng);
+    } else if (type == 'I' && size == 1) {
+        fillInteger<std::int8_t>(dst, rng);
+    } else if (type == 'I' && size == 2) {
+        fillInteger<std::int16_t>(dst, rng);
+    } else if (type == 'I' && size == 4) {
+        fillInteger<std::int32_t>(dst, rng);
+    } else if (type == 'U' && size == 1) {
+        fillInteger<std::uint8_t>(dst, rng);
+    } else if (type == 'U' && size == 2) {
+        fillInteger<std::uint16_t>(dst, rng);
+    } else if (type == 'U' && size == 4) {
+        fillInteger<std::uint32_t>(dst, rng);
+    } else {
+        throw std::runtime_error("不支持的字段类型");
+    }
+}
+
+tsdf::PcdHeader makeHeader(const Layout& layout) {
+    tsdf::PcdHeader header;
+    header.pointCount = POINTS;
+    header.pointStep = layout.step;
+    tsdf::FieldAttr* attrs[3] = {&header.x, &header.y, &header.z};
+    for (int k = 0; k < 3; ++k) {
+        attrs[k]->offset = layout.offsets[k];
+        attrs[k]->size = layout.size;
+        attrs[k]->type = layout.type;
+    }
+    return header;
+}
+
+std::vector<char> makeRecords(const Layout& layout) {
+    std::vector<char> records(POINTS * layout.step, 0);
+    std::mt19937 rng(42);
+    for (std::size_t i = 0; i < POINTS; ++i) {
+        for (const int offset : layout.offsets) {
+            fillScalar(records.data() + i * layout.step + offset, layout.type, layout.size, rng);
+        }
+    }
+    return records;
+}
+
+// 旧实现：每点每轴按 type/size 分支并经 double 中转，作为对照基线。
+double legacyReadScalar(const char* ptr, char type, int size) {
+    if (type == 'F') {
+        if (size == 4) {
+            float v;
+            std::memcpy(&v, ptr, sizeof(v));
+            return v;
+        }
+        if (size == 8) {
+            double v;
+            std::memcpy(&v, ptr, sizeof(v));
+            return v;
+        }
+    } else if (type == 'I') {
+        if (size == 4) {
+            std::int32_t v;
+            std::memcpy(&v, ptr, sizeof(v));
+            return static_cast<double>(v);
+        }
+    } else if (type == 'U') {
+        if (size == 4) {
+            std::uint32_t v;
+            std::memcpy(&v, ptr, sizeof(v));
+            return static_cast<double>(v);
+        }
+    }
+    throw std::runtime_error("不支持的字段类型");
+}
+
+void BM_DecodeKernel(benchmark::State& state, const Layout& layout) {
+    const tsdf::PcdHeader header = makeHeader(layout);
+    const std::vector<char> records = makeRecords(layout);
+    const tsdf::XyzDecoder decoder = tsdf::selectXyzDecoder(header);
+    std::vector<CCVector3> out(POINTS);
+    for (auto _ : state) {
+        decoder.decode(records.data(), POINTS, header, out.data());
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetLabel(decoder.name);
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * POINTS));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * records.size()));
+}
+
+void BM_DecodeLegacySwitch(benchmark::State& state, const Layout& layout) {
+    const tsdf::PcdHeader header = makeHeader(layout);
+    const std::vector<char> records = makeRecords(layout);
+    std::vector<CCVector3> out(POINTS);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < POINTS; ++i) {
+            const char* rec = records.data() + i * header.pointStep;
+            out[i] = CCVector3(
+                static_cast<PointCoordinateType>(legacyReadScalar(rec + header.x.offset, header.x.type, header.x.size)),
+                static_cast<PointCoordinateType>(legacyReadScalar(rec + header.y.offset, header.y.type, header.y.size)),
+                static_cast<PointCoordinateType>(legacyReadScalar(rec + header.z.offset, header.z.type, header.z.size)));
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * POINTS));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * records.size()));
+}
+
+const int REGISTERED = [] {
+    for (const Layout& layout : LAYOUTS) {
+        benchmark::RegisterBenchmark((std::string("BM_DecodeKernel/") + layout.name).c_str(), BM_DecodeKernel, layout);
+    }
+    // 旧实现只支持 F4/F8/I4/U4，仅对其能处理的布局做对照。
+    for (const Layout& layout : LAYOUTS) {
+        if (layout.type == 'F') {
+            benchmark::RegisterBenchmark((std::string("BM_DecodeLegacySwitch/") + layout.name).c_str(), BM_DecodeLegacySwitch, layout);
+        }
+    }
+    return 0;
+}();
+
+}  // namespace
@@ -0,0 +1,188 @@
+#include "synthetic_cloud.h"
+
+#include "mapped_file.h"
+#include "noise_filter.h"
+#include "parallel_octree.h"
+#include "params.h"
+#include "pcd_io.h"
+
+#include <PointCloud.h>
+#include <ReferenceCloud.h>
+
+#include <benchmark/benchmark.h>
+#include <tbb/global_control.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 载入 / 索引 / 滤波 / 写出各阶段在合成点云上的基准，参数为 {点数, 线程数}。
+// 线程数通过 tbb::global_control 限制，覆盖 LivoMesh 自身与 CCCoreLib 的 TBB 并行段（如 DgmOctree::build 的排序）。
+// CCCoreLib 的噪声滤波按八叉树单元经 QtConcurrent 在 QThreadPool 上并行，noiseFilter 不接受线程数参数，
+// 不受 global_control 限制，因此 BM_RunFilter/cccorelib 只在硬件线程数下运行。
+// 默认跑 1M / 10M 点，设置环境变量 LIVOMESH_BENCH_LARGE=1 追加 100M 点。
+
+namespace {
+
+namespace fs = std::filesystem;
+
+std::vector<std::int64_t> pointCounts() {
+    std::vector<std::int64_t> counts = {1000000, 10000000};
+    const char* large = std::getenv("LIVOMESH_BENCH_LARGE");
+    if (large && std::string(large) != "0") {
+        counts.push_back(100000000);
+    }
+    return counts;
+}
+
+std::vector<std::int64_t> threadCounts() {
+    const std::int64_t hardware = std::max<std::int64_t>(1, static_cast<std::int64_t>(std::thread::hardware_concurrency()));
+    std::vector<std::int64_t> counts;
+    for (std::int64_t t = 1; t < hardware; t *= 2) {
+        counts.push_back(t);
+    }
+    counts.push_back(hardware);
+    return counts;
+}
+
+// threadAxis 为 false 时只取硬件线程数，用于线程数无法从外部限制的基准。
+void applyArgs(benchmark::internal::Benchmark* bench, bool threadAxis = true) {
+    const std::vector<std::int64_t> threads = threadCounts();
+    for (const std::int64_t points : pointCounts()) {
+        if (!threadAxis) {
+            bench->Args({points, threads.back()});
+            continue;
+        }
+        for (const std::int64_t t : threads) {
+            bench->Args({points, t});
+        }
+    }
+    bench->ArgNames({"points", "threads"})->Unit(benchmark::kMillisecond)->UseRealTime();
+}
+
+// 同一点数的合成点云只载入一次，供索引、滤波、写出基准共享。
+CCCoreLib::PointCloud& sharedCloud(std::size_t count) {
+    static std::mutex mutex;
+    static std::map<std::size_t, std::unique_ptr<CCCoreLib::PointCloud>> clouds;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& slot = clouds[count];
+    if (!slot) {
+        slot = std::make_unique<CCCoreLib::PointCloud>(tsdf::loadBinaryCloud(tsdf::syntheticPcdPath(count)));
+    }
+    return *slot;
+}
+
+tsdf::FilterConfig benchFilterConfig(tsdf::FilterEngine engine) {
+    tsdf::FilterConfig cfg;
+    cfg.radius = 0.1;
+    cfg.n_sigma = 1.0;
+    cfg.remove_isolated = true;
+    cfg.engine = engine;
+    return cfg;
+}
+
+void BM_ParseHeader(benchmark::State& state) {
+    const tsdf::MappedFile mapped(tsdf::syntheticPcdPath(static_cast<std::size_t>(state.range(0))));
+    if (!mapped.valid()) {
+        state.SkipWithError("无法映射合成点云");
+        return;
+    }
+    for (auto _ : state) {
+        std::size_t dataOffset = 0;
+        const tsdf::PcdHeader header = tsdf::parseBinaryHeader(mapped.data(), mapped.size(), &dataOffset);
+        benchmark::DoNotOptimize(header.pointCount);
+        benchmark::DoNotOptimize(dataOffset);
+    }
+}
+
+void BM_LoadBinaryCloud(benchmark::State& state) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    const fs::path path = tsdf::syntheticPcdPath(count);
+    const tbb::global_control threads(tbb::global_control::max_allowed_parallelism, static_cast<std::size_t>(state.range(1)));
+    tsdf::PcdLoadInfo info;
+    for (auto _ : state) {
+        CCCoreLib::PointCloud cloud = tsdf::loadBinaryCloud(path, &info);
+        benchmark::DoNotOptimize(cloud.size());
+    }
+    state.SetLabel(info.decoder);
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * count));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * info.dataBytes));
+}
+
+// parallel 为 true 时走 ParallelOctree::buildParallel()，否则为 CCCoreLib 的 build()。
+void BM_OctreeBuild(benchmark::State& state, bool parallel) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    CCCoreLib::PointCloud& cloud = sharedCloud(count);
+    const tbb::global_control threads(tbb::global_control::max_allowed_parallelism, static_cast<std::size_t>(state.range(1)));
+    for (auto _ : state) {
+        tsdf::ParallelOctree octree(&cloud);
+        if ((parallel ? octree.buildParallel() : octree.build()) <= 0) {
+            state.SkipWithError("构建八叉树失败");
+            return;
+        }
+        benchmark::DoNotOptimize(octree.getNumberOfProjectedPoints());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * count));
+}
+
+void BM_RunFilter(benchmark::State& state, tsdf::FilterEngine engine) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    CCCoreLib::PointCloud& cloud = sharedCloud(count);
+    const tbb::global_control threads(tbb::global_control::max_allowed_parallelism, static_cast<std::size_t>(state.range(1)));
+    const tsdf::FilterConfig cfg = benchFilterConfig(engine);
+    double indexMs = 0.0;
+    double filterMs = 0.0;
+    std::size_t kept = 0;
+    for (auto _ : state) {
+        const std::unique_ptr<CCCoreLib::ReferenceCloud> filtered = tsdf::runFilter(cloud, cfg, &indexMs, &filterMs);
+        kept = filtered->size();
+    }
+    state.counters["kept"] = static_cast<double>(kept);
+    state.counters["index_ms"] = indexMs;
+    state.counters["filter_ms"] = filterMs;
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * count));
+}
+
+// fields 为 true 时保留合成点云的 intensity 字段，按下标 gather 原始记录写出。
+void BM_WriteBinaryCloud(benchmark::State& state, bool fields) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    CCCoreLib::PointCloud& cloud = sharedCloud(count);
+    const tbb::global_control threads(tbb::global_control::max_allowed_parallelism, static_cast<std::size_t>(state.range(1)));
+    const tsdf::PcdRecords records = fields ? tsdf::loadPcdRecords(tsdf::syntheticPcdPath(count)) : tsdf::PcdRecords();
+    // 隔点保留，接近滤波后的随机下标访问。
+    CCCoreLib::ReferenceCloud kept(&cloud);
+    kept.reserve(static_cast<unsigned>(count / 2));
+    for (std::size_t i = 0; i < count; i += 2) {
+        kept.addPointIndex(static_cast<unsigned>(i));
+    }
+    const fs::path output = fs::temp_directory_path() / ("livomesh_bench_write_" + std::to_string(count) + ".pcd");
+    for (auto _ : state) {
+        tsdf::writeBinaryCloud(output, kept, &records);
+    }
+    std::error_code ec;
+    fs::remove(output, ec);
+    const std::size_t step = records.valid() ? records.header().pointStep : sizeof(CCVector3);
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * kept.size()));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * kept.size() * step));
+}
+
+const int REGISTERED = [] {
+    benchmark::RegisterBenchmark("BM_ParseHeader", BM_ParseHeader)->Arg(1000000)->ArgName("points");
+    applyArgs(benchmark::RegisterBenchmark("BM_LoadBinaryCloud", BM_LoadBinaryCloud));
+    applyArgs(benchmark::RegisterBenchmark("BM_OctreeBuild/cccorelib", BM_OctreeBuild, false));
+    applyArgs(benchmark::RegisterBenchmark("BM_OctreeBuild/parallel", BM_OctreeBuild, true));
+    applyArgs(benchmark::RegisterBenchmark("BM_RunFilter/cccorelib", BM_RunFilter, tsdf::FilterEngine::kCCCoreLib), false);
+    applyArgs(benchmark::RegisterBenchmark("BM_RunFilter/native", BM_RunFilter, tsdf::FilterEngine::kNative));
+    applyArgs(benchmark::RegisterBenchmark("BM_WriteBinaryCloud/xyz", BM_WriteBinaryCloud, false));
+    applyArgs(benchmark::RegisterBenchmark("BM_WriteBinaryCloud/fields", BM_WriteBinaryCloud, true));
+    return 0;
+}();
+
+}  // namespace
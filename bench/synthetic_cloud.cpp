@@ -0,0 +1,188 @@
+#include "synthetic_cloud.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double SURFACE_DENSITY = 400.0;  // 点/m^2
+constexpr double WALL_HEIGHT = 6.0;
+constexpr double SENSOR_HEIGHT = 1.8;
+constexpr int RINGS = 32;
+
+// splitmix64：状态推进与输出都是固定整数运算，保证跨平台确定性。
+class SplitMix {
+public:
+    explicit SplitMix(std::uint64_t seed) : state_(seed) {}
+
+    std::uint64_t next() {
+        std::uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    double uniform() { return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0); }
+    double uniform(double lo, double hi) { return lo + (hi - lo) * uniform(); }
+
+    double normal() {
+        const double u1 = std::max(uniform(), 1e-300);
+        const double u2 = uniform();
+        return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * PI * u2);
+    }
+
+private:
+    std::uint64_t state_;
+};
+
+struct Scene {
+    double half = 0.0;  // 场景为 [-half, half]^2 的方形区域，四周与中线有墙
+};
+
+// 墙面：x = ±half、y = ±half 四面外墙加 x = 0 的中隔墙。
+CCVector3 wallPoint(const Scene& scene, SplitMix& rng) {
+    const int wall = static_cast<int>(rng.next() % 5);
+    const double t = rng.uniform(-scene.half, scene.half);
+    const double z = rng.uniform(0.0, WALL_HEIGHT);
+    const double n = rng.normal() * 0.005;
+    switch (wall) {
+        case 0:
+            return CCVector3(static_cast<float>(-scene.half + n), static_cast<float>(t), static_cast<float>(z));
+        case 1:
+            return CCVector3(static_cast<float>(scene.half + n), static_cast<float>(t), static_cast<float>(z));
+        case 2:
+            return CCVector3(static_cast<float>(t), static_cast<float>(-scene.half + n), static_cast<float>(z));
+        case 3:
+            return CCVector3(static_cast<float>(t), static_cast<float>(scene.half + n), static_cast<float>(z));
+        default:
+            return CCVector3(static_cast<float>(n), static_cast<float>(t * 0.5), static_cast<float>(z));
+    }
+}
+
+// 地面 LiDAR 线束：传感器沿 y = 0 的轨迹前进，每根向下的线束与地面交成一圈，
+// 圈半径随仰角变大，同样角分辨率下远处圈上点更稀。
+CCVector3 ringPoint(const Scene& scene, SplitMix& rng) {
+    // 落在场景外的回波重新采样，避免在边界处堆积。
+    for (;;) {
+        const double sensorX = rng.uniform(-scene.half * 0.9, scene.half * 0.9);
+        const int ring = static_cast<int>(rng.next() % RINGS);
+        const double elevation = (2.0 + 28.0 * static_cast<double>(ring) / (RINGS - 1)) * PI / 180.0;
+        const double range = SENSOR_HEIGHT / std::tan(elevation);
+        const double azimuth = rng.uniform(0.0, 2.0 * PI);
+        const double x = sensorX + range * std::cos(azimuth);
+        const double y = range * std::sin(azimuth);
+        if (std::abs(x) <= scene.half && std::abs(y) <= scene.half) {
+            return CCVector3(static_cast<float>(x), static_cast<float>(y), static_cast<float>(rng.normal() * 0.005));
+        }
+    }
+}
+
+// 噪声壳：地面或墙面上方/前方 0.05~0.3 m 的离散点，模拟运动物体拖影与多路径反射。
+CCVector3 shellPoint(const Scene& scene, SplitMix& rng) {
+    const double offset = rng.uniform(0.05, 0.3) * (rng.next() & 1 ? 1.0 : -1.0);
+    if (rng.next() & 1) {
+        CCVector3 p = wallPoint(scene, rng);
+        if (std::abs(std::abs(p.x) - scene.half) < 0.05 || std::abs(p.x) < 0.05) {
+            p.x += static_cast<float>(offset);
+        } else {
+            p.y += static_cast<float>(offset);
+        }
+        return p;
+    }
+    return CCVector3(static_cast<float>(rng.uniform(-scene.half, scene.half)),
+                     static_cast<float>(rng.uniform(-scene.half, scene.half)),
+                     static_cast<float>(std::abs(offset)));
+}
+
+CCVector3 outlierPoint(const Scene& scene, SplitMix& rng) {
+    return CCVector3(static_cast<float>(rng.uniform(-scene.half, scene.half)),
+                     static_cast<float>(rng.uniform(-scene.half, scene.half)),
+                     static_cast<float>(rng.uniform(-1.0, WALL_HEIGHT + 2.0)));
+}
+
+}  // namespace
+
+namespace tsdf {
+
+std::vector<CCVector3> generateSyntheticCloud(std::size_t count, std::uint64_t seed, const SyntheticSceneMix& mix) {
+    Scene scene;
+    scene.half = std::max(2.0, 0.5 * std::sqrt(static_cast<double>(count) / SURFACE_DENSITY));
+
+    const double total = mix.rings + mix.walls + mix.shells + mix.outliers;
+    if (!(total > 0.0)) {
+        throw std::runtime_error("合成场景占比之和必须大于 0");
+    }
+    const double ringEnd = mix.rings / total;
+    const double wallEnd = ringEnd + mix.walls / total;
+    const double shellEnd = wallEnd + mix.shells / total;
+
+    std::vector<CCVector3> points(count);
+    SplitMix rng(seed);
+    for (std::size_t i = 0; i < count; ++i) {
+        const double pick = rng.uniform();
+        if (pick < ringEnd) {
+            points[i] = ringPoint(scene, rng);
+        } else if (pick < wallEnd) {
+            points[i] = wallPoint(scene, rng);
+        } else if (pick < shellEnd) {
+            points[i] = shellPoint(scene, rng);
+        } else {
+            points[i] = outlierPoint(scene, rng);
+        }
+    }
+    return points;
+}
+
+void writeSyntheticPcd(const fs::path& path, const std::vector<CCVector3>& points) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("无法写入合成点云: " + path.string());
+    }
+    out << "# .PCD v0.7 - Point Cloud Data file format\n"
+        << "VERSION 0.7\n"
+        << "FIELDS x y z intensity\n"
+        << "SIZE 4 4 4 4\n"
+        << "TYPE F F F F\n"
+        << "COUNT 1 1 1 1\n"
+        << "WIDTH " << points.size() << '\n'
+        << "HEIGHT 1\n"
+        << "VIEWPOINT 0 0 0 1 0 0 0\n"
+        << "POINTS " << points.size() << '\n'
+        << "DATA binary\n";
+
+    constexpr std::size_t BATCH = 1 << 16;
+    std::vector<char> buffer(BATCH * 16);
+    for (std::size_t first = 0; first < points.size(); first += BATCH) {
+        const std::size_t n = std::min(BATCH, points.size() - first);
+        for (std::size_t i = 0; i < n; ++i) {
+            const CCVector3& p = points[first + i];
+            const float record[4] = {p.x, p.y, p.z, static_cast<float>((first + i) % 256)};
+            std::memcpy(buffer.data() + i * 16, record, sizeof(record));
+        }
+        out.write(buffer.data(), static_cast<std::streamsize>(n * 16));
+    }
+    if (!out) {
+        throw std::runtime_error("写入合成点云失败: " + path.string());
+    }
+}
+
+fs::path syntheticPcdPath(std::size_t count) {
+    const fs::path path = fs::temp_directory_path() / ("livomesh_bench_" + std::to_string(count) + ".pcd");
+    std::error_code ec;
+    if (!fs::exists(path, ec)) {
+        fs::path temp = path;
+        temp += ".tmp";
+        writeSyntheticPcd(temp, generateSyntheticCloud(count));
+        fs::rename(temp, path);
+    }
+    return path;
+}
+
+}  // namespace tsdf
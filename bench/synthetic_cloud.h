@@ -0,0 +1,31 @@
+#pragma once
+
+#include <CCGeom.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace tsdf {
+
+// 合成场景的点类别占比：地面与墙面按 LiDAR 线束采样（近密远疏），
+// 噪声壳为贴着表面、偏离 0.05~0.3 m 的离群层，outlier 在包围盒内均匀分布。
+struct SyntheticSceneMix {
+    double rings = 0.55;
+    double walls = 0.30;
+    double shells = 0.12;
+    double outliers = 0.03;
+};
+
+// 确定性合成点云：只依赖 count 与 seed，跨平台、跨标准库结果一致（不使用 <random> 分布）。
+// 场景边长随点数按 sqrt 增长，使表面点密度与实际建图相近（约 400 点/m^2）。
+std::vector<CCVector3> generateSyntheticCloud(std::size_t count, std::uint64_t seed = 20240601, const SyntheticSceneMix& mix = {});
+
+// 写出 xyz + intensity 的 DATA binary PCD，与 FAST-LIVO2 的地图输出布局相同。
+void writeSyntheticPcd(const std::filesystem::path& path, const std::vector<CCVector3>& points);
+
+// 返回临时目录下 count 点合成 PCD 的路径，不存在时生成，多个基准共享同一文件。
+std::filesystem::path syntheticPcdPath(std::size_t count);
+
+}  // namespace tsdf
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "parallel_octree.h"
+
+#include <PointCloud.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+
+namespace tsdf {
+
+// 可由序列化的单元编码表直接恢复的 DgmOctree，恢复时跳过逐点编码与排序；未命中时用 buildParallel() 构建。
+class CachedOctree : public ParallelOctree {
+public:
+    struct Bounds {
+        CCVector3 dimMin;
+        CCVector3 dimMax;
+        CCVector3 pointsMin;
+        CCVector3 pointsMax;
+    };
+
+    explicit CachedOctree(CCCoreLib::PointCloud* cloud) : ParallelOctree(cloud) {}
+
+    Bounds bounds() const;
+    const cellsContainer& codes() const { return m_thePointsAndTheirCellCodes; }
+    void restore(const Bounds& bounds, const IndexAndCode* codes, std::size_t count);
+};
+
+struct CloudCacheEntry {
+    std::unique_ptr<CCCoreLib::PointCloud> cloud;
+    std::unique_ptr<CachedOctree> octree;  // 缓存里没有八叉树时为空
+    std::size_t bytes = 0;                 // 缓存文件大小
+};
+
+// 缓存文件与输入同目录，文件名为 <输入文件名>.lmcache。
+std::filesystem::path cloudCachePath(const std::filesystem::path& input);
+
+// 缓存键为输入文件大小、mtime 与抽样内容哈希，三者都一致才算命中；未命中、缓存损坏或内容校验和不符返回 false。
+bool loadCloudCache(const std::filesystem::path& input, CloudCacheEntry* entry);
+
+// 写出解码后的点云与可选的八叉树编码表及其校验和：先写同目录下唯一命名的临时文件再原子替换，
+// 同一输入的并发写入互不干扰；目录不可写等失败返回 false。
+bool saveCloudCache(const std::filesystem::path& input, const CCCoreLib::PointCloud& cloud, const CachedOctree* octree);
+
+}  // namespace tsdf
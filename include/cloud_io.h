@@ -0,0 +1,71 @@
+#pragma once
+
+#include "params.h"
+#include "pcd_io.h"
+
+#include <CCGeom.h>
+#include <PointCloud.h>
+#include <ReferenceCloud.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace tsdf {
+
+// 点云读写的格式分派：按扩展名（.ply / 其余按 .pcd）选择后端，调用方不关心具体格式。
+// 两种后端共用 PcdHeader 描述的记录布局，因此 PcdRecords 可跨格式写出（PCD 读入、PLY 写出或反之）。
+
+PointCloudFormat cloudFormatOf(const std::filesystem::path& path);
+
+// 格式对应的扩展名（含点）。
+const char* cloudExtension(PointCloudFormat format);
+
+PcdHeader readCloudHeader(const std::filesystem::path& path);
+
+CCCoreLib::PointCloud loadCloud(const std::filesystem::path& path, PcdLoadInfo* info = nullptr);
+
+std::size_t loadCloudPoints(const std::filesystem::path& path,
+                            CCVector3* dst,
+                            std::size_t capacity,
+                            PcdLoadInfo* info = nullptr,
+                            PcdRecords* records = nullptr);
+
+PcdRecords loadCloudRecords(const std::filesystem::path& path);
+
+void writeCloud(const std::filesystem::path& output,
+                const CCCoreLib::ReferenceCloud& filtered,
+                const PcdRecords* records = nullptr,
+                const PointColumns* columns = nullptr);
+
+// 点数事先未知时的流式写出器（PCD 或 binary PLY）：点数字段定宽预留，close() 时回填。
+// 默认布局为 xyz float32；给出 fields 时按其记录布局写出，由 appendRecords 追加整条记录。
+class CloudStreamWriter {
+public:
+    explicit CloudStreamWriter(const std::filesystem::path& output);
+    CloudStreamWriter(const std::filesystem::path& output, const std::vector<PcdField>& fields);
+    ~CloudStreamWriter();
+
+    CloudStreamWriter(const CloudStreamWriter&) = delete;
+    CloudStreamWriter& operator=(const CloudStreamWriter&) = delete;
+
+    void append(const CCVector3* points, std::size_t count);
+    // 追加 count 条按构造时 fields 布局连续存放的记录。
+    void appendRecords(const char* records, std::size_t count);
+    std::size_t size() const { return count_; }
+    // 回填当前点数并刷盘，此后文件即为完整可读的点云，供下游边写边读。
+    void flush();
+    void close();
+
+private:
+    void writeCount();
+
+    std::filesystem::path path_;
+    std::ofstream out_;
+    std::vector<std::streampos> countPos_;
+    std::size_t recordSize_ = 0;
+    std::size_t count_ = 0;
+};
+
+}  // namespace tsdf
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "params.h"
+#include "pcd_io.h"
+
+#include <PointCloud.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+namespace tsdf {
+
+struct SweepResult {
+    double radius = 0.0;
+    bool absolute = false;  // true: value 为绝对误差；false: value 为 n_sigma
+    double value = 0.0;
+    std::size_t kept = 0;
+    double evalMs = 0.0;   // 由共享统计量判定本组合取舍的耗时
+    double writeMs = 0.0;  // 写出本组合结果的耗时（未写出为 0）
+    std::filesystem::path cloudPath;
+};
+
+struct SweepReport {
+    std::size_t inputPoints = 0;
+    double indexMs = 0.0;  // 按最大半径建体素索引
+    double statsMs = 0.0;  // 收集邻域并为每个半径拟合平面（所有组合共享）
+    std::vector<SweepResult> results;
+};
+
+// 在同一点云上评估 sweep.radii x (sweep.n_sigmas + sweep.absolute_errors) 的全部组合：
+// 每点只按最大半径收集一次邻域并按距离分桶，逐半径增量累加矩得到平面距离与标准差，
+// 各阈值只在这些统计量上判定。cloudBase（如 out/scan.pcd）非空且 sweep.write_clouds 时按组合写出
+// out/scan_r<radius>_s<n_sigma>.pcd / _a<absolute_error>.pcd，格式随扩展名，records 有效时保留原始字段。
+SweepReport runFilterSweep(CCCoreLib::PointCloud& cloud,
+                           const FilterConfig& filter,
+                           const SweepConfig& sweep,
+                           const std::filesystem::path& cloudBase,
+                           const PcdRecords* records = nullptr);
+
+// 汇总表（CSV）：每个组合一行，含保留点数、比例与各段耗时。
+void writeSweepSummary(const std::filesystem::path& csv, const SweepReport& report);
+
+}  // namespace tsdf
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "params.h"
+
+#include <CCGeom.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace tsdf {
+
+// 在线增量噪声滤波：以 radius 为边长的持久体素哈希，点按体素分桶以 SoA 存放，插入只追加所在体素。
+// 每批新点插入后只复评新点所在体素及其 26 邻域内的点（半径邻域受新点影响的点都在其中），
+// 判据与 native 引擎相同，单批耗时只与新点附近的点密度有关，与地图总点数无关。
+// 保留点按首次保留的先后编为输出行号；之后被判为噪声的点撤销其行号，重新保留时再分配新行号。
+class IncrementalFilter {
+public:
+    struct Update {
+        std::size_t inserted = 0;             // 本批插入点数
+        std::size_t evaluated = 0;            // 本批复评点数（含新点）
+        std::size_t cells = 0;                // 本批复评体素数
+        std::vector<CCVector3> added;         // 新分配行号的点，按行号升序
+        std::vector<std::uint64_t> revoked;   // 本批撤销的行号
+    };
+
+    explicit IncrementalFilter(const FilterConfig& cfg);
+
+    Update insert(const CCVector3* points, std::size_t count);
+
+    std::size_t size() const { return size_; }
+    std::size_t keptCount() const { return kept_; }
+    std::size_t cellCount() const { return cells_.size(); }
+    std::uint64_t rows() const { return nextRow_; }
+
+private:
+    struct Cell {
+        std::int32_t coord[3] = {0, 0, 0};
+        std::vector<float> xs, ys, zs;
+        std::vector<std::uint8_t> keep;
+        std::vector<std::int64_t> row;  // 当前输出行号，未输出为 -1
+        std::uint64_t stamp = 0;        // 最近一次被列入复评的批次
+    };
+
+    std::uint64_t keyOf(const std::int32_t coord[3]) const;
+    Cell* find(const std::int32_t coord[3]);
+
+    FilterConfig cfg_;
+    double inv_ = 0.0;
+    bool hasOrigin_ = false;
+    double origin_[3] = {0.0, 0.0, 0.0};  // 首个点，体素坐标相对它计算
+    std::unordered_map<std::uint64_t, Cell> cells_;
+    std::size_t size_ = 0;
+    std::size_t kept_ = 0;
+    std::uint64_t nextRow_ = 0;
+    std::uint64_t epoch_ = 0;
+};
+
+}  // namespace tsdf
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "params.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace tsdf {
+
+struct JobResult {
+    std::size_t inputPoints = 0;
+    std::size_t keptPoints = 0;
+    std::filesystem::path output;  // 主输出（点云或扫描汇总），未写出时为空
+};
+
+// 一次完整的处理作业：载入、降采样、滤波 / 参数扫描 / 分块 / 在线模式、压薄、写出与 TSDF，进度与各阶段耗时写到 log。
+// 单次运行的 main 与守护进程共用，失败时抛出。
+JobResult runJob(const AppConfig& cfg, std::ostream& log);
+
+const char* engineName(FilterEngine engine);
+
+// Filter.mode 的规范写法，如 "radius+plane"。
+std::string filterModeName(const std::vector<FilterMode>& modes);
+
+// 未指定输出文件时按 Base.pcl_type 选择扩展名写到输出目录 <输入名>_denoised.pcd/.ply，并创建所需目录。
+std::filesystem::path resolveOutputPath(const AppConfig& cfg);
+
+}  // namespace tsdf
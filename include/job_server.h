@@ -0,0 +1,25 @@
+#pragma once
+
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace tsdf {
+
+// 常驻守护进程：在 Unix 域套接字上接收作业，每个连接一个作业，由固定 maxJobs 个工作线程执行，其余连接排队；
+// 排队连接超过上限时直接回复 status=error 并关闭。
+// 作业在同一进程内执行 runJob，复用已热身的 TBB / QtConcurrent 线程池、分配器与页缓存，省去进程启动与线程池创建。
+// 请求为文本行：首行配置文件绝对路径，其后每行一个 "Section.key=value" 覆盖项，空行结束。
+// 作业日志实时回传，最后一行为 "@result status=ok|error queue_ms=.. run_ms=.. input=.. kept=.. output=.. message=.."。
+// SIGINT / SIGTERM 时停止接收新连接，等待在途作业结束后删除套接字文件返回。
+// Watch 与 Telemetry.enable 的作业直接返回错误：前者不会结束，后者的度量单例是进程级的，并发作业会相互混入。
+void runJobServer(const std::filesystem::path& socketPath, int maxJobs);
+
+// 命令行客户端：提交一个作业，把回传日志原样写到 out，末尾输出作业统计；返回作业是否成功。
+bool submitJob(const std::filesystem::path& socketPath,
+               const std::filesystem::path& config,
+               const std::vector<std::string>& overrides,
+               std::ostream& out);
+
+}  // namespace tsdf
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "params.h"
+
+#include <cstddef>
+#include <filesystem>
+
+namespace tsdf {
+
+struct LeanFilterStats {
+    std::size_t inputPoints = 0;
+    std::size_t keptPoints = 0;
+    std::size_t cells = 0;
+    double origin[3] = {0.0, 0.0, 0.0};  // 局部原点（首点坐标按 1024 m 取整）
+    const char* decoder = "";
+    std::size_t dataBytes = 0;
+    std::size_t scratchBytes = 0;  // 各线程邻域缓冲所在 arena 的总字节数
+    double loadMs = 0.0;
+    double indexMs = 0.0;
+    double filterMs = 0.0;
+    double writeMs = 0.0;
+};
+
+// Filter.lean 时的省内存整图滤波，面向上亿点的地图：
+//   载入  坐标减去局部原点后以 float32 SoA 存放（每点 12 字节），F8 输入在 double 下相减，UTM 等大坐标不丢精度；
+//         DATA binary PCD 按块解码，解码过的文件页随即释放；
+//   索引  VoxelIndex::adopt 在这份 SoA 上原地排序，只在需要按原始次序取记录时另存 4 字节/点的原始索引；
+//   滤波  判据同 native 引擎，结果为每点 1 bit 的位图；邻域缓冲按最大 27 邻域点数从同一 arena 为每个线程切出，运行中不再分配；
+//   写出  keepFields 时按原始次序流式写出保留点的原始记录，否则按体素序写 xyz（原点加回后转 float32）。
+// output 为空时只滤波不写出。
+LeanFilterStats runLeanFilter(const std::filesystem::path& input,
+                              const std::filesystem::path& output,
+                              const FilterConfig& cfg,
+                              bool keepFields);
+
+}  // namespace tsdf
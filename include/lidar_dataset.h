@@ -0,0 +1,63 @@
+#pragma once
+
+#include "params.h"
+#include "pcd_io.h"
+#include "telemetry.h"
+
+#include <CCGeom.h>
+#include <PointCloud.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tsdf {
+
+// 帧坐标到世界坐标的刚体变换，rotation 为行主序 3x3。
+struct FramePose {
+    double rotation[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    double translation[3] = {0, 0, 0};
+};
+
+struct LidarFrame {
+    std::filesystem::path path;
+    std::size_t pointOffset = 0;  // 在合并点云中的起始下标
+    std::size_t pointCount = 0;
+    FramePose pose;
+};
+
+struct LidarDataset {
+    std::unique_ptr<CCCoreLib::PointCloud> cloud;  // 合并后的世界坐标点云
+    std::vector<LidarFrame> frames;                // 按 pointOffset 升序，整图模式下只有一帧
+    PcdLoadInfo loadInfo;                          // 各帧统计汇总
+    PcdRecords records;                            // 整图模式下保留的原始记录，供带属性写出
+    std::vector<PipelineStageStats> pipeline;      // 多帧模式 Pipeline.enable 时载入流水线各级统计
+
+    // 返回合并点云中第 index 个点所属的帧号。
+    std::size_t frameOf(std::size_t index) const;
+};
+
+// 读取位姿文件，每行一帧，支持：
+//   7 列  tx ty tz qx qy qz qw
+//   8 列  timestamp tx ty tz qx qy qz qw（TUM 格式）
+//   12/16 列  行主序 3x4 / 4x4 变换矩阵
+// 空行与 # 开头的注释行被忽略。
+std::vector<FramePose> loadPoses(const std::filesystem::path& file);
+
+// 解析位姿文件的一行（格式同上）：空行与注释行返回 false，列数不支持或解析失败时抛出；lineNo / file 只用于报错。
+bool parsePoseLine(const std::string& line, std::size_t lineNo, const std::filesystem::path& file, FramePose* pose);
+
+// 列出 dir 下扩展名为 extension 的帧文件；文件名若全是数字则按数值排序（0.pcd, 1.pcd, ..., 10.pcd），否则按字典序。
+std::vector<std::filesystem::path> listFrameFiles(const std::filesystem::path& dir, const std::string& extension);
+
+// 原地对 count 个点施加位姿变换，SSE 下每 4 点一组向量化。
+void transformPoints(const FramePose& pose, CCVector3* points, std::size_t count);
+
+// 整图模式直接载入 depth_path（按扩展名识别 PCD / PLY）；多帧模式载入 depth_path 目录下全部
+// Base.pcl_type 扩展名（.pcd / .ply）的帧，按 depth_pose 逐帧变换后并行写入一块预分配的合并点云；
+// Pipeline.enable 时读盘与解码分为两级流水线，线程数分别由 Pipeline.readers / decoders 指定。
+LidarDataset loadLidarDataset(const AppConfig& config);
+
+}  // namespace tsdf
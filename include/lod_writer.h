@@ -0,0 +1,63 @@
+#pragma once
+
+#include "params.h"
+#include "pcd_io.h"
+
+#include <ReferenceCloud.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace tsdf {
+
+// LOD 目录的索引文件 index.bin（小端）：LodIndexHeader，随后 levels 个 LodLevelEntry，再 nodes 个 LodNodeEntry。
+// 第 d 层的点在 level_<d>.<扩展名>（与常规输出同格式、同字段）中，节点按 (层, 节点编码) 排列，节点内按 Morton 序。
+// 读取某节点：打开其层文件，跳到 dataOffset + first * pointStep 连续读 count 条记录。
+struct LodIndexHeader {
+    char magic[8];               // "LMLOD\0\0\0"
+    std::uint32_t version;
+    std::uint32_t levels;
+    std::uint32_t grid;          // 节点每轴采样格数
+    std::uint32_t pointStep;     // 每条记录字节数
+    std::uint64_t points;
+    std::uint64_t nodes;
+    double origin[3];            // 根节点立方体的最小角
+    double size;                 // 根节点立方体边长，第 d 层节点边长为 size / 2^d
+};
+
+struct LodLevelEntry {
+    std::uint64_t dataOffset;    // 层文件中数据段的起始字节
+    std::uint64_t points;
+    std::uint64_t firstNode;     // 该层第一个节点在节点表中的序号
+    std::uint64_t nodeCount;
+};
+
+struct LodNodeEntry {
+    std::uint64_t key;           // 节点在其层内的 Morton 编码（x 在最低位，每轴 level 位）
+    std::uint32_t level;
+    std::uint32_t reserved;
+    std::uint64_t first;         // 节点在层文件中的起始点号
+    std::uint64_t count;
+};
+
+struct LodStats {
+    std::size_t levels = 0;
+    std::size_t nodes = 0;
+    std::size_t points = 0;
+    std::size_t maxNodePoints = 0;
+    double sortMs = 0.0;         // 编码、排序与分层
+    double writeMs = 0.0;
+};
+
+// 把 kept 写成 LOD 金字塔到 dir：每点按根立方体内的 63 位 Morton 编码（每轴 21 位）经 radixSortByKey 排序，
+// 相邻两点编码的最高不同位给出其所在的最粗层（该层采样格中的首点），同一层的点再按层号稳定分组，各层文件并行写出。
+// recordsCover 时按全局下标写出原始记录，否则只写 xyz；extension 决定层文件格式（.pcd / .ply）。
+LodStats writeLodPyramid(const std::filesystem::path& dir,
+                         const CCCoreLib::ReferenceCloud& kept,
+                         const PcdRecords* records,
+                         const LodConfig& cfg,
+                         const std::string& extension);
+
+}  // namespace tsdf
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstddef>
+
+namespace tsdf {
+
+// 解压 LZF 数据块（PCD binary_compressed 使用的格式），返回写出字节数；数据损坏或输出越界时抛出异常。
+std::size_t lzfDecompress(const char* input, std::size_t inputSize, char* output, std::size_t outputSize);
+
+}  // namespace tsdf
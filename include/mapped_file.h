@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+
+namespace tsdf {
+
+// 只读内存映射文件。映射失败（平台不支持、空文件、权限等）时 valid() 为 false，
+// 调用方需自行走流式读取的回退路径。
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool valid() const { return data_ != nullptr; }
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+    // 顺序扫描大文件时丢弃 [offset, offset + length) 内整页的驻留映射以限制 RSS；
+    // 文件页仍在页缓存中，再次访问时重新映射。
+    void evict(std::size_t offset, std::size_t length) const;
+
+private:
+    void release();
+
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+// 可写内存映射输出文件：构造时截断并预分配为 size 字节后整段映射，供多线程直接写入。
+// 映射失败时 valid() 为 false，调用方需改走流式写出。
+class MappedOutputFile {
+public:
+    MappedOutputFile(const std::filesystem::path& path, std::size_t size);
+    ~MappedOutputFile();
+
+    MappedOutputFile(const MappedOutputFile&) = delete;
+    MappedOutputFile& operator=(const MappedOutputFile&) = delete;
+
+    bool valid() const { return data_ != nullptr; }
+    char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+    // 解除映射并关闭文件，失败时抛出异常。
+    void close();
+
+private:
+    std::string path_;
+    char* data_ = nullptr;
+    std::size_t size_ = 0;
+    int fd_ = -1;
+};
+
+}  // namespace tsdf
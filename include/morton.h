@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+namespace tsdf {
+
+// 每轴 21 位，三轴交织成 63 位 Morton 编码（x 在最低位）。ParallelOctree、VoxelIndex 与 LOD 金字塔共用。
+constexpr unsigned MORTON_AXIS_BITS = 21;
+constexpr std::uint64_t MORTON_AXIS_MAX = (std::uint64_t(1) << MORTON_AXIS_BITS) - 1;
+
+// 低 21 位的每一位间隔两位展开。
+inline std::uint64_t spreadBits(std::uint64_t v) {
+    v &= MORTON_AXIS_MAX;
+    v = (v | (v << 32)) & 0x1f00000000ffffULL;
+    v = (v | (v << 16)) & 0x1f0000ff0000ffULL;
+    v = (v | (v << 8)) & 0x100f00f00f00f00fULL;
+    v = (v | (v << 4)) & 0x10c30c30c30c30c3ULL;
+    v = (v | (v << 2)) & 0x1249249249249249ULL;
+    return v;
+}
+
+// spreadBits 的逆：取出间隔两位的各位压回低 21 位。
+inline std::uint64_t compactBits(std::uint64_t v) {
+    v &= 0x1249249249249249ULL;
+    v = (v ^ (v >> 2)) & 0x10c30c30c30c30c3ULL;
+    v = (v ^ (v >> 4)) & 0x100f00f00f00f00fULL;
+    v = (v ^ (v >> 8)) & 0x1f0000ff0000ffULL;
+    v = (v ^ (v >> 16)) & 0x1f00000000ffffULL;
+    v = (v ^ (v >> 32)) & MORTON_AXIS_MAX;
+    return v;
+}
+
+inline std::uint64_t mortonEncode(std::uint64_t x, std::uint64_t y, std::uint64_t z) {
+    return spreadBits(x) | (spreadBits(y) << 1) | (spreadBits(z) << 2);
+}
+
+}  // namespace tsdf
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "noise_criterion.h"
+#include "params.h"
+
+#include <DgmOctree.h>
+#include <PointCloud.h>
+#include <ReferenceCloud.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace tsdf {
+
+// LivoMesh 自带的噪声滤波引擎：以 radius 为边长建体素哈希索引，按体素并行收集邻域并拟合平面，
+// 判据与 CCCoreLib noiseFilter 相同。返回的引用云按原始索引升序；indexMs/filterMs/scores 可为空，
+// scores 非空时按原始索引写出每点的评估结果。projected 非空且 Filter.thin 不为 none 时，
+// 用同一邻域与同一拟合平面按原始索引写出保留点的压薄投影（未保留点保持原坐标）。
+// statistical 判据的 kNN 计数：27 邻域装不下 k 个近邻的点先逐层外扩体素壳层，外扩超过上限时改查体素 kd 树；
+// candidates 为 27 邻域之外计算过距离的点数，与全图点数无关，只随这类点的数目增长。
+struct NativeKnnStats {
+    std::uint64_t shellQueries = 0;
+    std::uint64_t shellCandidates = 0;
+    std::uint64_t treeQueries = 0;
+    std::uint64_t treeCandidates = 0;
+};
+
+// Filter.mode 含 radius / statistical 时在同一趟邻域遍历中一并判定，逐点取交集：radius 要求 Radius 内邻点数不少于
+// min_neighbors（不与平面判据组合时数够即停）；statistical 求平均 kNN 距离，阈值为全图均值 + std_ratio * 样本标准差。
+// kNN 也由同一个 Radius 体素索引回答（27 邻域、壳层外扩、索引非空体素上的 kd 树），knn 非空时写出其计数。
+std::unique_ptr<CCCoreLib::ReferenceCloud> runNativeFilter(CCCoreLib::PointCloud& cloud,
+                                                           const FilterConfig& cfg,
+                                                           double* indexMs,
+                                                           double* filterMs,
+                                                           std::vector<NoiseScore>* scores = nullptr,
+                                                           std::vector<CCVector3>* projected = nullptr,
+                                                           NativeKnnStats* knn = nullptr);
+
+struct FilterParityReport {
+    std::size_t cccorelibKept = 0;
+    std::size_t nativeKept = 0;
+    std::size_t mismatches = 0;  // 两引擎取舍不同的点数
+    std::size_t borderline = 0;  // 其中平面距离与阈值之差在浮点误差内的点数
+    double cccorelibMs = 0.0;    // 八叉树 + 滤波
+    double nativeMs = 0.0;       // 体素索引 + 滤波
+    std::unique_ptr<CCCoreLib::ReferenceCloud> kept;  // CCCoreLib 引擎的结果
+
+    bool consistent() const { return mismatches == borderline; }
+};
+
+// 在同一点云上分别运行 CCCoreLib 与原生引擎并逐点比对保留结果；octree 同 runFilter。
+FilterParityReport compareFilterEngines(CCCoreLib::PointCloud& cloud, const FilterConfig& cfg, CCCoreLib::DgmOctree* octree = nullptr);
+
+}  // namespace tsdf
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "params.h"
+
+#include <CCGeom.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tsdf {
+
+struct PlaneFit {
+    bool valid = false;
+    double normal[3] = {0.0, 0.0, 1.0};  // 单位法向
+    double offset = 0.0;                 // 平面方程 normal . p = offset
+};
+
+// 最小二乘平面拟合，与 CCCoreLib Neighbourhood::getLSPlane 相同：
+// 恰好 3 点时用叉积（共线则无效），多于 3 点取协方差矩阵最小特征值对应的特征向量。
+// 坐标以 SoA 传入，累加在 double 下进行。
+PlaneFit fitPlane(const float* xs, const float* ys, const float* zs, std::size_t count);
+
+// 邻域坐标的一阶、二阶矩，可逐点累加；坐标宜相对查询点给出以减小抵消误差。
+struct PlaneMoments {
+    std::size_t count = 0;
+    double sx = 0.0, sy = 0.0, sz = 0.0;
+    double sxx = 0.0, sxy = 0.0, sxz = 0.0, syy = 0.0, syz = 0.0, szz = 0.0;
+
+    void add(double x, double y, double z);
+    void merge(const PlaneMoments& other);
+};
+
+// 由矩拟合平面（要求多于 3 点，否则返回无效），sigma 可选返回邻点到平面有符号距离的标准差。
+// 矩可加，同一邻域按半径分段累加后前缀合并即得各半径的拟合结果，供参数扫描复用。
+PlaneFit fitPlane(const PlaneMoments& moments, double* sigma);
+
+// 单点噪声判据的中间量，同时用于统计输出与参数扫描。
+struct NoiseScore {
+    std::uint32_t neighbors = 0;  // 不含自身的 radius 邻点数
+    float distance = 0.0f;        // 查询点到邻域拟合平面的距离
+    float threshold = -1.0f;      // 保留阈值（n_sigma * 标准差或绝对误差）；< 0 表示邻点不足或平面无效
+    float sigma = -1.0f;          // 邻点到拟合平面有符号距离的标准差（绝对误差模式下也给出）；< 0 同上
+};
+
+// 按 CCCoreLib CloudSamplingTools::noiseFilter 的语义评估一个点：
+// 邻点（不含自身）不足 3 个时视为孤立点，否则拟合平面并比较查询点距离与阈值。plane 可选返回拟合平面供压薄复用。
+NoiseScore scoreNoise(const CCVector3& query,
+                      const float* xs,
+                      const float* ys,
+                      const float* zs,
+                      std::size_t count,
+                      const FilterConfig& cfg,
+                      PlaneFit* plane = nullptr);
+
+// 把查询点投影到邻域曲面上。kPlane 取拟合平面上的垂足；kMls 在平面局部坐标系内以 radius 为高斯宽度
+// 加权拟合二次高度场，取垂足处的曲面点，邻点不足 6 个或方程病态时退回平面。平面无效时原样返回。
+CCVector3 projectToSurface(const CCVector3& query,
+                           const PlaneFit& plane,
+                           const float* xs,
+                           const float* ys,
+                           const float* zs,
+                           std::size_t count,
+                           ThinMethod method,
+                           double radius);
+
+// 根据评估结果决定是否保留：孤立点由 remove_isolated 决定，平面无效的点丢弃。
+inline bool keepPoint(const NoiseScore& score, const FilterConfig& cfg) {
+    if (score.neighbors < 3) {
+        return !cfg.remove_isolated;
+    }
+    return score.threshold >= 0.0f && score.distance <= score.threshold;
+}
+
+}  // namespace tsdf
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "noise_criterion.h"
+#include "params.h"
+
+#include <DgmOctree.h>
+#include <PointCloud.h>
+#include <ReferenceCloud.h>
+
+#include <memory>
+#include <vector>
+
+namespace tsdf {
+
+// 在整块点云上执行噪声滤波，返回保留点的引用云；octreeMs/filterMs 可为空。
+// Filter.engine 选择 CCCoreLib 八叉树实现或原生体素哈希实现（此时 octreeMs 为建索引耗时）；
+// parity 模式两者都跑，取舍不一致时抛出异常，返回 CCCoreLib 的结果。
+// octree 非空时 CCCoreLib 引擎直接使用这棵已建好的八叉树（须关联 cloud）。
+// projected / scores 仅在 native 引擎下由滤波同一趟邻域写出压薄投影与逐点评估结果（见 runNativeFilter），其余引擎保持为空。
+std::unique_ptr<CCCoreLib::ReferenceCloud> runFilter(CCCoreLib::PointCloud& cloud,
+                                                     const FilterConfig& cfg,
+                                                     double* octreeMs,
+                                                     double* filterMs,
+                                                     CCCoreLib::DgmOctree* octree = nullptr,
+                                                     std::vector<CCVector3>* projected = nullptr,
+                                                     std::vector<NoiseScore>* scores = nullptr);
+
+}  // namespace tsdf
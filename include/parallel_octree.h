@@ -0,0 +1,22 @@
+#pragma once
+
+#include <DgmOctree.h>
+#include <PointCloud.h>
+
+namespace tsdf {
+
+// 并行构建的 DgmOctree：包围盒与立方化同 DgmOctree::build()，逐点单元编码（最大层级，与 GenerateTruncatedCellCode 相同的
+// x/y/z 位交织）按块并行计算、SSE2 下 4 点一组量化，再用 radixSortByKey 并行排序后直接填入单元编码表，替代 build() 的单线程编码与排序。
+// 编码表与 build() 的结果逐项相同，仅同一单元内的点按原始下标排列（build() 的排序不稳定，次序未定义）。
+class ParallelOctree : public CCCoreLib::DgmOctree {
+public:
+    explicit ParallelOctree(CCCoreLib::PointCloud* cloud) : CCCoreLib::DgmOctree(cloud), cloud_(cloud) {}
+
+    // 返回落入八叉树的点数，空点云返回 -1（同 build()）。
+    int buildParallel();
+
+private:
+    CCCoreLib::PointCloud* cloud_;
+};
+
+}  // namespace tsdf
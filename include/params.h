@@ -1,6 +1,9 @@
 #pragma once
 
+#include <algorithm>
 #include <filesystem>
+#include <string>
+#include <vector>
 
 namespace tsdf {
 
@@ -14,6 +17,34 @@ enum class PointCloudLoadMode {
     kFrameSequence = 1,
 };
 
+// 噪声滤波引擎：CCCoreLib 八叉树实现、LivoMesh 体素哈希实现，或同时运行两者校验保留点集一致。
+enum class FilterEngine {
+    kCCCoreLib = 0,
+    kNative = 1,
+    kParity = 2,
+};
+
+// 噪声判据：邻域平面拟合（CCCoreLib noiseFilter 语义）、半径离群（Radius 内邻点数）、统计离群（平均 kNN 距离）。
+// 可组合，逐点取交集。
+enum class FilterMode {
+    kPlane = 0,
+    kRadius = 1,
+    kStatistical = 2,
+};
+
+// 滤波后的压薄方式：不处理、投影到邻域拟合平面，或投影到邻域移动最小二乘（二次）曲面。
+enum class ThinMethod {
+    kNone = 0,
+    kPlane = 1,
+    kMls = 2,
+};
+
+// 降采样代表点：体素内均值，或体素内原始下标最小的点（保留原始记录，可带属性写出）。
+enum class DownsampleMode {
+    kCentroid = 0,
+    kFirst = 1,
+};
+
 struct BaseConfig {
     bool cuda_enabled = false;
     PointCloudFormat pointcloud_format = PointCloudFormat::kPcd;
@@ -23,6 +54,8 @@ struct BaseConfig {
     std::filesystem::path depth_path;
     std::filesystem::path output_dir = "output";
     bool save_pcd = true;
+    bool keep_fields = true;     // 整图模式写出时保留输入的全部字段（intensity、rgb、时间戳等），否则只写 xyz
+    bool cache_enabled = false;  // 整图模式下在输入旁缓存解码点云与八叉树（<输入>.lmcache）
     std::filesystem::path output_pcd_path;
     std::filesystem::path rgb_pose = "color_poses.txt";
     std::filesystem::path depth_pose = "depth_poses.txt";
@@ -35,13 +68,124 @@ struct FilterConfig {
     bool remove_isolated = false;
     bool use_absolute_error = false;
     double absolute_error = 0.5;
+    // 分块（out-of-core）模式：两者任一大于 0 即按 XY 平面分块、带 radius 宽的重叠边逐块滤波并流式写出。
+    double tile_size = 0.0;      // 分块边长（米），0 表示按 max_memory_mb 自动选择
+    double max_memory_mb = 0.0;  // 单块滤波的内存上限（MB）
+    FilterEngine engine = FilterEngine::kCCCoreLib;
+    // 判据组合（Filter.mode，如 plane / radius / radius+plane）：radius 与 statistical 需 native 引擎，与 plane 共用同一趟体素邻域搜索。
+    std::vector<FilterMode> modes{FilterMode::kPlane};
+    int min_neighbors = 6;   // radius：Radius 内（不含自身）至少有这么多邻点才保留，同 Open3D remove_radius_outlier 的 nb_points
+    int sor_neighbors = 20;  // statistical：近邻数（含查询点自身），同 Open3D remove_statistical_outlier 的 nb_neighbors
+    double std_ratio = 2.0;  // statistical：平均近邻距离不小于全图均值 + std_ratio * 标准差的点剔除
+    // 压薄：把保留点投影到 radius 邻域拟合的曲面上，merge_voxel > 0 时再把同一体素内的点合并为均值点。
+    ThinMethod thin = ThinMethod::kNone;
+    double merge_voxel = 0.0;  // 合并体素边长（米），0 表示不合并
+    // 省内存整图路径：float32 SoA（相对局部原点）原地建体素索引，结果存为位图，判据同 native 引擎。
+    bool lean = false;
+    // 质检输出：export_rejected 另写被剔除的点到 <输出名>_rejected；export_scores 在保留与剔除点云中追加
+    // neighbors / plane_distance / threshold / sigma 字段（需 native 引擎，取自同一趟滤波）。
+    bool export_rejected = false;
+    bool export_scores = false;
+};
+
+// 滤波前的体素网格降采样：载入后、建八叉树 / 体素索引之前把每个体素内的点合并为一点。
+struct DownsampleConfig {
+    bool enable = false;
+    double voxel_size = 0.02;  // 体素边长（米），宜明显小于 Filter.radius
+    DownsampleMode mode = DownsampleMode::kCentroid;
+};
+
+// 参数扫描：一次载入、按最大半径收集一次邻域，评估 radii x (n_sigmas + absolute_errors) 的全部组合。
+// remove_isolated 沿用 Filter 段。
+struct SweepConfig {
+    bool enable = false;
+    std::vector<double> radii;
+    std::vector<double> n_sigmas;
+    std::vector<double> absolute_errors;
+    bool write_clouds = false;  // 是否为每个组合写出滤波结果
+};
+
+// 结构化度量：每次运行写 JSON 阶段报告，可选写 Chrome trace-event 文件。
+// 路径为空时写到输出目录 <输入名>_telemetry.json / <输入名>_trace.json。
+struct TelemetryConfig {
+    bool enable = false;
+    std::filesystem::path report_path;
+    bool trace = false;
+    std::filesystem::path trace_path;
+};
+
+// TSDF 积分（多帧模式）：以帧位姿平移为传感器原点，沿射线把滤波后的点积分进块稀疏体素哈希。
+struct TsdfConfig {
+    bool enable = false;
+    double voxel_size = 0.05;  // 体素边长（米）
+    double truncation = 0.15;  // 截断距离（米），不小于 voxel_size
+    double max_weight = 64.0;  // 体素权重上限，越小越偏向新观测
+    bool mesh = true;          // 积分后用 Marching Cubes 提取网格并写出 binary PLY
+    double min_weight = 1.0;   // 提取网格时权重低于该值的体素视为未观测
+    std::filesystem::path mesh_path;  // 为空时写到输出目录 <输入名>_mesh.ply
+};
+
+// 在线增量模式：轮询 depth_path 目录与位姿文件，新帧就绪后插入持久体素索引，只复评其 radius 邻域内的点，
+// 新保留点追加写出，被撤销的输出行号追加到 <输出名>_revoked.txt。
+struct WatchConfig {
+    bool enable = false;
+    int poll_ms = 500;         // 轮询间隔（毫秒）；帧文件大小保持一个轮询间隔不变才视为写完
+    double idle_exit_s = 0.0;  // 连续无新帧超过该时长（秒）后退出，0 表示直到 Ctrl-C
+};
+
+// 分阶段流水线（分块滤波与多帧载入）：读盘、解码、滤波、写出各级由有界队列相连，各级线程数独立配置，
+// 写出级固定单线程并按原次序输出；在途数据项（分块 / 帧）不超过 max_inflight，下游跟不上时上游阻塞。
+struct PipelineConfig {
+    bool enable = false;
+    int readers = 1;       // 读盘线程数（分块临时文件 / 帧文件）
+    int decoders = 1;      // 解码线程数（组装分块点云 / 解码并变换帧）
+    int filters = 1;       // 同时滤波的分块数，每块内部仍由 TBB 并行
+    int max_inflight = 3;  // 在途数据项上限，分块模式下 Filter.max_memory_mb 按该数目均分
 };
 
+// 分层细节（LOD）输出：在常规输出之外把保留点按立方八叉树写成由粗到细的分层金字塔（每层一个点云文件 + 二进制索引），
+// 第 d 层每个节点内按 grid^3 采样格各取一点，前 d 层累计即每个深度 d 节点 grid^3 格各一点的均匀抽稀；最深一层收下其余全部点，
+// 层数取最深层单节点点数不超过 max_node_points 的最小值。查看器按索引只读可见节点、所需层级的点区间。
+struct LodConfig {
+    bool enable = false;
+    int grid = 128;                     // 每个节点每轴的采样格数（2 的幂），层间点密度约按 4 倍（表面）递增
+    int max_node_points = 200000;       // 最深一层单节点点数上限
+    std::filesystem::path output_dir;   // 为空时为输出目录下 <输出名>_lod
+};
+
+// 多进程分片滤波（整图分块模式）：协调进程按分块模式切出带 radius 重叠边的分块文件，由至多 workers 个 worker
+// 进程各滤一块，结果按原始点号合并写出。launcher 为空时在本机直接启动 worker，否则经 /bin/sh 执行该命令模板，
+// {cmd} 替换为 worker 命令行（不含 {cmd} 时追加在末尾），{tile} / {slot} 替换为分块号 / 并发槽位号，
+// 如 "ssh node{slot} {cmd}"、"srun -N1 -n1 {cmd}"（work_dir 须为各节点共享的路径）。
+// work_dir 中已完成的分块在输入与参数不变时重新运行直接复用。
+struct ShardConfig {
+    bool enable = false;
+    int workers = 2;                 // 同时运行的 worker 进程数
+    std::string launcher;            // worker 启动命令模板
+    std::filesystem::path work_dir;  // 分块与中间结果目录，为空时为输出目录下 .livomesh_shards_<输入名>，成功后删除
+};
+
+inline bool hasFilterMode(const FilterConfig& cfg, FilterMode mode) {
+    return std::find(cfg.modes.begin(), cfg.modes.end(), mode) != cfg.modes.end();
+}
+
 struct AppConfig {
     BaseConfig base;
+    DownsampleConfig downsample;
     FilterConfig filter;
+    LodConfig lod;
+    PipelineConfig pipeline;
+    ShardConfig shard;
+    SweepConfig sweep;
+    TelemetryConfig telemetry;
+    TsdfConfig tsdf;
+    WatchConfig watch;
 };
 
 AppConfig loadAppConfig(const std::filesystem::path& file);
 
+// overrides 为 "Section.key=value" 形式的覆盖项，解析前写入对应段（键名规则同 YAML，大小写与空格/连字符不敏感），
+// 守护进程作业用它在共享配置文件上改参数。
+AppConfig loadAppConfig(const std::filesystem::path& file, const std::vector<std::string>& overrides);
+
 }  // namespace tsdf
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "pcd_io.h"
+
+#include <CCGeom.h>
+
+#include <cstddef>
+
+namespace tsdf {
+
+struct XyzDecoder {
+    XyzDecodeFn decode = nullptr;
+    const char* name = "";
+};
+
+// 按 Header 中 x/y/z 的类型、字节数与偏移布局挑选一次解码核，之后整文件复用：
+//   packed-xyz-f32   x y z 紧密排列的 float32，整块拷贝；
+//   prefix-xyz-f32   x y z 位于记录开头、步长 >= 16（如 x y z intensity），SIMD 跨步拷贝；
+//   uniform-<type>   三轴同类型的任意偏移，按类型模板特化；
+//   mixed            三轴类型不同，每块选择一次标量读取函数。
+// 支持 F4/F8、I1/I2/I4/I8、U1/U2/U4/U8，不支持的组合在此处即抛出异常。
+XyzDecoder selectXyzDecoder(const PcdHeader& header);
+
+// 按字段连续存放（binary_compressed 解压后）的数据块：字段值数组起始于 block + pointCount * 记录内偏移，
+// 解码第 [first, first + count) 个点写入 dst。
+using FieldMajorDecodeFn = void (*)(const char* block, std::size_t first, std::size_t count, const PcdHeader& header, CCVector3* dst);
+
+struct FieldMajorDecoder {
+    FieldMajorDecodeFn decode = nullptr;
+    const char* name = "";
+};
+
+FieldMajorDecoder selectFieldMajorDecoder(const PcdHeader& header);
+
+}  // namespace tsdf
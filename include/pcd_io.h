@@ -0,0 +1,170 @@
+#pragma once
+
+#include "mapped_file.h"
+
+#include <CCGeom.h>
+#include <CCTypes.h>
+#include <PointCloud.h>
+#include <ReferenceCloud.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace tsdf {
+
+struct FieldAttr {
+    int offset = -1;
+    int size = 4;
+    char type = 'F';
+};
+
+enum class PcdDataFormat {
+    kBinary,
+    kBinaryCompressed,  // LZF 压缩、按字段连续存放（field-major）
+    kAscii,
+};
+
+struct PcdField {
+    std::string name;
+    int size = 4;
+    char type = 'F';
+    int count = 1;
+    std::size_t offset = 0;  // 在单条记录内的字节偏移
+};
+
+struct PcdHeader {
+    std::size_t pointCount = 0;
+    std::size_t pointStep = 0;
+    PcdDataFormat data = PcdDataFormat::kBinary;
+    std::vector<PcdField> fields;
+    FieldAttr x;
+    FieldAttr y;
+    FieldAttr z;
+};
+
+// 把 records 起始的 count 条记录（步长 header.pointStep）解码为 xyz，具体实现见 pcd_decode.h。
+using XyzDecodeFn = void (*)(const char* records, std::size_t count, const PcdHeader& header, CCVector3* dst);
+
+// 载入过程的统计信息，供 main 打印吞吐。
+struct PcdLoadInfo {
+    bool mapped = false;        // true: 走内存映射路径；false: 走 ifstream 回退路径
+    std::size_t dataBytes = 0;  // DATA 段字节数
+    const char* decoder = "";   // 选用的 xyz 解码核
+};
+
+// 载入时保留的原始记录（point-major，步长 header().pointStep），供写出时按下标 gather 保留全部字段。
+// DATA binary 直接持有文件映射；binary_compressed 解压转置后、ascii 解析后的记录持有在内存中。
+class PcdRecords {
+public:
+    PcdRecords() = default;
+    PcdRecords(MappedFile file, std::size_t dataOffset, const PcdHeader& header);
+    PcdRecords(std::vector<char> buffer, const PcdHeader& header);
+
+    bool valid() const { return file_.valid() || !buffer_.empty(); }
+    const PcdHeader& header() const { return header_; }
+    std::size_t size() const { return valid() ? header_.pointCount : 0; }
+    const char* data() const { return file_.valid() ? file_.data() + dataOffset_ : buffer_.data(); }
+
+private:
+    MappedFile file_;
+    std::size_t dataOffset_ = 0;
+    std::vector<char> buffer_;
+    PcdHeader header_;
+};
+
+// 写出时接在每条记录之后的逐点附加字段（如噪声评估统计）：data 按关联点云的全局下标、每点 step 字节连续存放，
+// fields 的 offset 相对附加段起始。
+struct PointColumns {
+    std::vector<PcdField> fields;
+    const char* data = nullptr;
+    std::size_t step = 0;
+};
+
+// 从流中解析 PCD Header（binary / binary_compressed / ascii），读取位置停在 DATA 行之后。
+PcdHeader parseBinaryHeader(std::istream& in);
+
+// 直接在映射内存上解析 PCD Header，dataOffset 返回 DATA 段起始偏移。
+PcdHeader parseBinaryHeader(const char* data, std::size_t size, std::size_t* dataOffset);
+
+// 只读取 Header（不触碰 DATA 段），用于多帧载入前统计点数。
+PcdHeader readPcdHeader(const std::filesystem::path& path);
+
+CCCoreLib::PointCloud loadBinaryCloud(const std::filesystem::path& path, PcdLoadInfo* info = nullptr);
+
+// 把点云直接解码进调用方预留的 dst（容量 capacity 个点），返回实际点数；点数超出容量时抛出异常。
+// records 非空时同时保留原始记录（不再重复读盘）。
+std::size_t loadBinaryPoints(const std::filesystem::path& path,
+                             CCVector3* dst,
+                             std::size_t capacity,
+                             PcdLoadInfo* info = nullptr,
+                             PcdRecords* records = nullptr);
+
+// 只取原始记录、不解码 xyz，用于缓存命中等已有点云但仍需带属性写出的场景。
+PcdRecords loadPcdRecords(const std::filesystem::path& path);
+
+// 预分配输出文件后按大块并行 gather 写出。records 有效且与 filtered 关联点云等长时，
+// 按下标拷贝原始记录并沿用原 FIELDS/SIZE/TYPE/COUNT；否则只写 xyz float32。columns 非空时每条记录后追加其字段。
+void writeBinaryCloud(const std::filesystem::path& output,
+                      const CCCoreLib::ReferenceCloud& filtered,
+                      const PcdRecords* records = nullptr,
+                      const PointColumns* columns = nullptr);
+
+// 以下供与 PCD 共享记录布局的其他格式（PLY）复用。
+
+// 把整段 DATA 解码进 dst（已按 pointCount 预分配），data 指向 DATA 段起始，bytes 为其可用长度；
+// keep 非空时对 binary_compressed / ascii 额外保留 point-major 记录（binary 由调用方直接持有映射）。
+void decodeDataBlock(const char* data,
+                     std::size_t bytes,
+                     const PcdHeader& header,
+                     CCVector3* dst,
+                     const char** decoderName,
+                     std::vector<char>* keep = nullptr);
+
+// 不解码 xyz，只把 DATA 段整理成 point-major 记录。
+std::vector<char> recordsFromBlock(const char* data, std::size_t bytes, const PcdHeader& header);
+
+// records 有效且与 filtered 关联点云等长，即可按下标 gather 原始记录。
+bool recordsCover(const CCCoreLib::ReferenceCloud& filtered, const PcdRecords* records);
+
+// 写出的字段：recordsCover 时为原始字段，否则为 x y z float32；其后接 columns 的字段（offset 已换算到整条记录）。
+std::vector<PcdField> gatherFields(const CCCoreLib::ReferenceCloud& filtered, const PcdRecords* records, const PointColumns* columns = nullptr);
+
+// 写 DATA binary 的 PCD Header；widthPos/pointsPos 非空时返回两处点数字段在文件中的位置。
+void writePcdHeader(std::ostream& out,
+                    const std::vector<PcdField>& fields,
+                    const std::string& count,
+                    std::streampos* widthPos,
+                    std::streampos* pointsPos);
+
+// 以 header 文本开头、按 gatherFields 的布局写出 filtered：预分配并映射输出文件后按大块并行 gather。
+void writeGatheredCloud(const std::filesystem::path& output,
+                        const std::string& header,
+                        const CCCoreLib::ReferenceCloud& filtered,
+                        const PcdRecords* records,
+                        const PointColumns* columns = nullptr);
+
+// DATA binary 文件的只读随机访问视图（基于内存映射），供分块/流式处理按区间解码；
+// 文件无法映射或不是 DATA binary 时构造抛出异常。
+class PcdBinaryView {
+public:
+    explicit PcdBinaryView(const std::filesystem::path& path);
+
+    const PcdHeader& header() const { return header_; }
+    std::size_t size() const { return header_.pointCount; }
+    const char* record(std::size_t index) const { return records_ + index * header_.pointStep; }
+    void decode(std::size_t first, std::size_t count, CCVector3* dst) const;
+    // 已处理完的记录区间不再驻留内存，见 MappedFile::evict。
+    void evict(std::size_t first, std::size_t count) const;
+
+private:
+    MappedFile file_;
+    PcdHeader header_;
+    const char* records_ = nullptr;
+    XyzDecodeFn decode_ = nullptr;
+};
+
+}  // namespace tsdf
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "pcd_io.h"
+
+#include <CCGeom.h>
+#include <PointCloud.h>
+#include <ReferenceCloud.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace tsdf {
+
+// 解析 PLY Header，vertex 元素的标量属性按声明顺序映射为与 PCD 相同的记录布局（PcdHeader），
+// 之后的解码、记录保留与 gather 写出全部复用 PCD 路径。支持 binary_little_endian 与 ascii；
+// vertex 含 list 属性或 binary_big_endian 时抛出异常。vertex 之前的元素会被跳过
+// （binary 下要求其只含标量属性）。dataOffset 非空时返回 vertex 数据起始偏移，此时 data 须覆盖该位置。
+PcdHeader parsePlyHeader(const char* data, std::size_t size, std::size_t* dataOffset);
+
+// 只读取 Header（不触碰数据段），用于多帧载入前统计点数。
+PcdHeader readPlyHeader(const std::filesystem::path& path);
+
+CCCoreLib::PointCloud loadPlyCloud(const std::filesystem::path& path, PcdLoadInfo* info = nullptr);
+
+// 与 loadBinaryPoints 相同的约定：解码进 dst（容量 capacity），records 非空时保留原始 vertex 记录。
+std::size_t loadPlyPoints(const std::filesystem::path& path,
+                          CCVector3* dst,
+                          std::size_t capacity,
+                          PcdLoadInfo* info = nullptr,
+                          PcdRecords* records = nullptr);
+
+PcdRecords loadPlyRecords(const std::filesystem::path& path);
+
+// 写 binary_little_endian 的 PLY Header；COUNT > 1 的字段展开为 name_0 ... name_{n-1}。
+// countPos 非空时返回 vertex 点数字段在文件中的位置。
+void writePlyHeader(std::ostream& out, const std::vector<PcdField>& fields, const std::string& count, std::streampos* countPos);
+
+// 写出 binary_little_endian PLY，字段保留规则与 writeBinaryCloud 相同。
+void writePlyCloud(const std::filesystem::path& output,
+                   const CCCoreLib::ReferenceCloud& filtered,
+                   const PcdRecords* records = nullptr,
+                   const PointColumns* columns = nullptr);
+
+}  // namespace tsdf
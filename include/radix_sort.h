@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tsdf {
+
+// 64 位键 + 32 位下标，体素索引、降采样、压薄合并共用的排序单元。
+struct KeyIndex {
+    std::uint64_t key;
+    std::uint32_t index;
+};
+
+// 按 key 稳定升序排序：LSD 基数排序，每趟 8 位，分块并行统计直方图后按块并行散射。
+// 只处理 keyBits 覆盖的趟数，全部落在同一桶的趟直接跳过。输入按 index 升序时结果等价于按 (key, index) 排序。
+void radixSortByKey(std::vector<KeyIndex>& items, unsigned keyBits = 64);
+
+}  // namespace tsdf
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "params.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <ostream>
+
+namespace tsdf {
+
+struct ShardStats {
+    std::size_t tiles = 0;     // 含点的分块数
+    std::size_t reused = 0;    // 沿用上次运行结果的分块数
+    std::size_t launched = 0;  // 本次启动的 worker 进程数
+    std::size_t inputPoints = 0;
+    std::size_t keptPoints = 0;
+    double tileSize = 0.0;
+    double partitionMs = 0.0;  // 统计范围与分块落盘耗时
+    double workMs = 0.0;       // 从启动第一个 worker 到全部退出的墙钟时间
+    double mergeMs = 0.0;
+};
+
+// 多进程分片滤波的协调进程：分块同 runTiledFilter，分块文件与渲染出的滤波参数 filter.yaml 写到 Shard.work_dir，
+// 每块由一个 worker 进程（livomesh_app --shard-worker）滤波，结果为该块保留的核心点原始点号。全部分块完成后
+// 按原始点号排序合并写出（keep_fields 时带全部字段），输出与整图滤波的点集和次序一致，与 worker 数、完成先后无关。
+// work_dir 里的 plan.txt 记录输入文件与分块划分，二者不变时已有结果的分块直接复用；任一 worker 失败时
+// 等其余 worker 退出后抛出，已完成的分块保留供下次运行。运行期间持有 <work_dir>.lock 上的 flock，使用同一分片目录的并发作业依次执行。
+ShardStats runShardedFilter(const AppConfig& cfg, const std::filesystem::path& output, std::ostream& log);
+
+// worker 进程入口：按 filterConfig 的 Filter 段对分块文件 tile 滤波，保留点号（升序 uint64）先写临时文件，
+// 完成后原子改名为 kept，kept 存在即表示该块已完成。
+void runShardWorker(const std::filesystem::path& filterConfig, const std::filesystem::path& tile, const std::filesystem::path& kept);
+
+}  // namespace tsdf
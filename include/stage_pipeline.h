@@ -0,0 +1,290 @@
+#pragma once
+
+#include "telemetry.h"
+
+#include <tbb/concurrent_queue.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace tsdf {
+
+// 每级一行打印 PipelineStageStats（线程数、数据项数、占用率与两类等待时间）。
+void printPipelineStats(std::ostream& out, const std::vector<PipelineStageStats>& stats);
+
+// 有界队列相连的多级流水线，每级有自己的工作线程：
+//   首级    workers 个线程按序号 0..count-1 产生数据项（序号按取得在途名额的先后分配）；
+//   中间级  workers 个线程并行处理，输出次序不保证；
+//   末级    单线程，按序号重排后依次消费，结果与串行执行同序。
+// 数据项从首级产生到末级消费完占用一个在途名额，总数不超过 maxInflight；各级队列容量同为 maxInflight，
+// 下游跟不上时上游阻塞（反压），驻留的数据项因此有上限。级间为 tbb::concurrent_bounded_queue。
+// 任一级抛出异常时置中止标志并中止全部队列；tbb 的 abort() 只唤醒当时已阻塞的操作，因此 run() 在等待线程退出期间
+// 反复中止队列，直到所有线程退出，再重新抛出第一个异常。
+template <typename Item>
+class StagePipeline {
+public:
+    using SourceFn = std::function<void(std::size_t seq, Item& item)>;
+    using StageFn = std::function<void(Item& item)>;
+
+    StagePipeline(std::string name, std::size_t maxInflight) : name_(std::move(name)), maxInflight_(std::max<std::size_t>(1, maxInflight)) {}
+
+    void source(std::string name, int workers, std::size_t count, SourceFn fn) {
+        source_ = Level{std::move(name), std::max(1, workers), nullptr};
+        count_ = count;
+        sourceFn_ = std::move(fn);
+    }
+
+    void stage(std::string name, int workers, StageFn fn) { stages_.push_back(Level{std::move(name), std::max(1, workers), std::move(fn)}); }
+
+    void sink(std::string name, StageFn fn) { sink_ = Level{std::move(name), 1, std::move(fn)}; }
+
+    // 阻塞到全部数据项被末级消费；返回各级统计（首级、中间级、末级依次排列），Telemetry 启用时同时写入报告。
+    std::vector<PipelineStageStats> run() {
+        std::vector<const Level*> levels{&source_};
+        for (const Level& level : stages_) {
+            levels.push_back(&level);
+        }
+        levels.push_back(&sink_);
+
+        // queues[i] 连接第 i 级与第 i + 1 级；tokens 中每个元素代表一个被占用的在途名额。
+        std::vector<std::unique_ptr<Queue>> queues;
+        for (std::size_t i = 0; i + 1 < levels.size(); ++i) {
+            queues.push_back(std::make_unique<Queue>());
+            queues.back()->set_capacity(static_cast<std::ptrdiff_t>(maxInflight_));
+        }
+        tbb::concurrent_bounded_queue<char> tokens;
+        tokens.set_capacity(static_cast<std::ptrdiff_t>(maxInflight_));
+
+        std::vector<PipelineStageStats> stats(levels.size());
+        std::vector<std::atomic<int>> running(levels.size());
+        for (std::size_t i = 0; i < levels.size(); ++i) {
+            stats[i].pipeline = name_;
+            stats[i].name = levels[i]->name;
+            stats[i].workers = levels[i]->workers;
+            running[i] = levels[i]->workers;
+        }
+
+        std::mutex mutex;  // 保护 stats 汇总、error 与 alive
+        std::condition_variable changed;
+        std::exception_ptr error;
+        std::atomic<bool> aborted{false};
+        std::size_t alive = 0;
+        auto abortQueues = [&] {
+            tokens.abort();
+            for (const std::unique_ptr<Queue>& queue : queues) {
+                queue->abort();
+            }
+        };
+        auto fail = [&] {
+            {
+                const std::lock_guard<std::mutex> lock(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                aborted = true;
+            }
+            changed.notify_all();
+            abortQueues();
+        };
+        // 每级最后一个退出的线程向下游每个线程各发一个结束标记。
+        auto finishLevel = [&](std::size_t level) {
+            if (--running[level] == 0 && level + 1 < levels.size()) {
+                for (int i = 0; i < levels[level + 1]->workers; ++i) {
+                    Slot end;
+                    end.end = true;
+                    queues[level]->push(std::move(end));
+                }
+            }
+        };
+        auto merge = [&](std::size_t level, const PipelineStageStats& local) {
+            const std::lock_guard<std::mutex> lock(mutex);
+            stats[level].items += local.items;
+            stats[level].busyMs += local.busyMs;
+            stats[level].waitInMs += local.waitInMs;
+            stats[level].waitOutMs += local.waitOutMs;
+            --alive;
+            changed.notify_all();
+        };
+
+        std::atomic<std::size_t> next{0};
+        auto sourceWorker = [&] {
+            PipelineStageStats local;
+            try {
+                while (!aborted) {
+                    auto start = Clock::now();
+                    tokens.push(0);
+                    local.waitOutMs += since(start);
+                    Slot slot;
+                    slot.seq = next++;
+                    if (slot.seq >= count_) {
+                        char token;
+                        tokens.try_pop(token);
+                        break;
+                    }
+                    start = Clock::now();
+                    sourceFn_(slot.seq, slot.item);
+                    local.busyMs += since(start);
+                    ++local.items;
+                    start = Clock::now();
+                    queues.front()->push(std::move(slot));
+                    local.waitOutMs += since(start);
+                }
+                finishLevel(0);
+            } catch (const tbb::user_abort&) {
+            } catch (...) {
+                fail();
+            }
+            merge(0, local);
+        };
+        auto stageWorker = [&](std::size_t level) {
+            PipelineStageStats local;
+            try {
+                while (!aborted) {
+                    Slot slot;
+                    auto start = Clock::now();
+                    queues[level - 1]->pop(slot);
+                    local.waitInMs += since(start);
+                    if (slot.end) {
+                        break;
+                    }
+                    start = Clock::now();
+                    levels[level]->fn(slot.item);
+                    local.busyMs += since(start);
+                    ++local.items;
+                    start = Clock::now();
+                    queues[level]->push(std::move(slot));
+                    local.waitOutMs += since(start);
+                }
+                finishLevel(level);
+            } catch (const tbb::user_abort&) {
+            } catch (...) {
+                fail();
+            }
+            merge(level, local);
+        };
+        auto sinkWorker = [&] {
+            const std::size_t level = levels.size() - 1;
+            PipelineStageStats local;
+            try {
+                std::map<std::size_t, Slot> pending;
+                std::size_t expected = 0;
+                while (!aborted) {
+                    Slot slot;
+                    auto start = Clock::now();
+                    queues.back()->pop(slot);
+                    local.waitInMs += since(start);
+                    if (slot.end) {
+                        break;
+                    }
+                    pending.emplace(slot.seq, std::move(slot));
+                    while (!pending.empty() && pending.begin()->first == expected) {
+                        start = Clock::now();
+                        sink_.fn(pending.begin()->second.item);
+                        local.busyMs += since(start);
+                        ++local.items;
+                        pending.erase(pending.begin());
+                        ++expected;
+                        char token;
+                        tokens.try_pop(token);
+                    }
+                }
+            } catch (const tbb::user_abort&) {
+            } catch (...) {
+                fail();
+            }
+            merge(level, local);
+        };
+
+        const double startUs = Telemetry::instance().nowUs();
+        const auto start = Clock::now();
+        std::vector<std::thread> threads;
+        alive = static_cast<std::size_t>(source_.workers) + 1;
+        for (std::size_t level = 1; level + 1 < levels.size(); ++level) {
+            alive += static_cast<std::size_t>(levels[level]->workers);
+        }
+        for (int i = 0; i < source_.workers; ++i) {
+            threads.emplace_back(sourceWorker);
+        }
+        for (std::size_t level = 1; level + 1 < levels.size(); ++level) {
+            for (int i = 0; i < levels[level]->workers; ++i) {
+                threads.emplace_back(stageWorker, level);
+            }
+        }
+        threads.emplace_back(sinkWorker);
+        {
+            // 中止后开始的阻塞操作不会被此前的 abort() 唤醒，持续中止直到全部线程退出。
+            std::unique_lock<std::mutex> lock(mutex);
+            while (alive > 0) {
+                if (aborted) {
+                    lock.unlock();
+                    abortQueues();
+                    lock.lock();
+                    changed.wait_for(lock, std::chrono::milliseconds(1));
+                } else {
+                    changed.wait(lock);
+                }
+            }
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+
+        const double wallMs = since(start);
+        for (PipelineStageStats& s : stats) {
+            s.wallMs = wallMs;
+            s.occupancy = wallMs > 0.0 ? s.busyMs / (wallMs * s.workers) : 0.0;
+            if (Telemetry::enabled()) {
+                Telemetry::instance().addPipelineStage(s);
+            }
+        }
+        if (Telemetry::tracing()) {
+            Telemetry::instance().addTraceEvent("pipeline", startUs, Telemetry::instance().nowUs() - startUs);
+        }
+        return stats;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Level {
+        std::string name;
+        int workers = 1;
+        StageFn fn;
+    };
+
+    struct Slot {
+        std::size_t seq = 0;
+        bool end = false;
+        Item item;
+    };
+
+    using Queue = tbb::concurrent_bounded_queue<Slot>;
+
+    static double since(Clock::time_point start) { return std::chrono::duration<double, std::milli>(Clock::now() - start).count(); }
+
+    std::string name_;
+    std::size_t maxInflight_;
+    Level source_{"source", 1, nullptr};
+    std::size_t count_ = 0;
+    SourceFn sourceFn_;
+    std::vector<Level> stages_;
+    Level sink_{"sink", 1, nullptr};
+};
+
+}  // namespace tsdf
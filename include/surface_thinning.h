@@ -0,0 +1,35 @@
+#pragma once
+
+#include "params.h"
+
+#include <CCGeom.h>
+#include <PointCloud.h>
+#include <ReferenceCloud.h>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace tsdf {
+
+struct ThinningStats {
+    std::size_t input = 0;
+    std::size_t output = 0;
+    bool reused = false;     // 投影直接取自 native 滤波的同一趟邻域
+    double meanShift = 0.0;  // 平均投影位移（米）
+    double projectMs = 0.0;
+    double mergeMs = 0.0;
+};
+
+// 压薄滤波保留点（Filter.thin / Filter.merge_voxel）：
+// 1. 把 kept 中每个点的坐标原地替换为其 radius 邻域曲面上的投影。projected 为 runFilter 在 native 引擎下
+//    按原始索引给出的投影时直接采用，否则在 cloud 上重建体素索引重新收集邻域（邻域含被滤除的点，与滤波判据一致）。
+// 2. merge_voxel > 0 时把同一体素内的点合并：均值坐标写回该体素中原始索引最小的点，只保留这些代表点。
+// 返回按原始索引升序的引用云；点的下标不变，多帧模式下仍可按下标找到所属帧。
+std::unique_ptr<CCCoreLib::ReferenceCloud> thinCloud(CCCoreLib::PointCloud& cloud,
+                                                     const CCCoreLib::ReferenceCloud& kept,
+                                                     const FilterConfig& cfg,
+                                                     const std::vector<CCVector3>* projected,
+                                                     ThinningStats* stats);
+
+}  // namespace tsdf
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace tsdf {
+
+// 单个阶段的度量。cpuMs 为进程全部线程的 CPU 时间增量，utilization = cpuMs / (wallMs * 线程数)。
+struct StageRecord {
+    std::string name;
+    int depth = 0;               // 嵌套层级，0 为顶层阶段
+    double startMs = 0.0;        // 相对 Telemetry 启用时刻
+    double wallMs = 0.0;
+    double cpuMs = 0.0;
+    std::uint64_t points = 0;
+    std::uint64_t bytesRead = 0;
+    std::uint64_t bytesWritten = 0;
+    double peakRssMb = 0.0;      // 阶段结束时的进程峰值 RSS
+    double utilization = 0.0;
+};
+
+// 流水线一级的度量（见 stage_pipeline.h）。occupancy = busyMs / (wallMs * workers)，接近 1 的级即吞吐瓶颈，
+// 其上游 waitOutMs 偏高（被反压）、下游 waitInMs 偏高（等输入）。
+struct PipelineStageStats {
+    std::string pipeline;
+    std::string name;
+    int workers = 1;
+    std::uint64_t items = 0;
+    double wallMs = 0.0;
+    double busyMs = 0.0;     // 各线程处理数据项的耗时之和
+    double waitInMs = 0.0;   // 等上游：输入队列为空
+    double waitOutMs = 0.0;  // 等下游：输出队列已满或在途数据项已达上限
+    double occupancy = 0.0;
+};
+
+// 两个时刻之间的毫秒数；只给起点时量到当前时刻。
+inline double elapsedMs(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+inline double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return elapsedMs(start, std::chrono::steady_clock::now());
+}
+
+// 进程自启动以来的峰值 RSS（MB），不依赖 Telemetry 是否启用；不支持的平台返回 0。
+double peakRssMb();
+
+// 进程级度量收集器。未启用时 ScopedStage / TraceSpan 只做一次原子读，开销可忽略。
+class Telemetry {
+public:
+    static Telemetry& instance();
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+    static bool tracing() { return tracing_.load(std::memory_order_relaxed); }
+
+    // trace 为 true 时同时收集 Chrome trace 事件（含工作线程上的 TraceSpan）。
+    void enable(bool trace);
+    void setInfo(const std::string& key, const std::string& value);
+
+    void addStage(const StageRecord& record);
+    void addPipelineStage(const PipelineStageStats& stats);
+    void addTraceEvent(const char* name, double startUs, double durationUs);
+    double nowUs() const;
+
+    // JSON 报告：运行信息、各阶段记录、流水线各级记录与整体峰值 RSS。
+    void writeReport(const std::filesystem::path& path) const;
+    // Chrome trace-event 格式（可直接拖入 Perfetto / chrome://tracing）。
+    void writeTrace(const std::filesystem::path& path) const;
+
+private:
+    friend class ScopedStage;
+
+    struct TraceEvent {
+        const char* name;
+        double startUs;
+        double durationUs;
+        std::uint32_t tid;
+    };
+
+    static std::atomic<bool> enabled_;
+    static std::atomic<bool> tracing_;
+
+    std::chrono::steady_clock::time_point origin_ = std::chrono::steady_clock::now();
+    mutable std::mutex mutex_;
+    std::vector<StageRecord> stages_;
+    std::vector<PipelineStageStats> pipelineStages_;
+    std::vector<TraceEvent> events_;
+    std::map<std::string, std::string> info_;
+};
+
+// 作用域阶段计时：构造时取墙钟与 CPU 时间，析构时写入 Telemetry，并作为 trace 事件输出。
+class ScopedStage {
+public:
+    explicit ScopedStage(const char* name);
+    ~ScopedStage() { finish(); }
+
+    ScopedStage(const ScopedStage&) = delete;
+    ScopedStage& operator=(const ScopedStage&) = delete;
+
+    void setPoints(std::uint64_t points) { record_.points = points; }
+    void addBytesRead(std::uint64_t bytes) { record_.bytesRead += bytes; }
+    void addBytesWritten(std::uint64_t bytes) { record_.bytesWritten += bytes; }
+    // 提前结束阶段（作用域比阶段长时使用），之后析构不再重复记录。
+    void finish();
+
+private:
+    const char* name_ = nullptr;  // 仅在启用时记录
+    StageRecord record_;
+    double startUs_ = 0.0;
+    double startCpuMs_ = 0.0;
+};
+
+// 只进 trace 的轻量区间，用于并行循环体内观察各线程的分块执行情况。
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name) : name_(Telemetry::tracing() ? name : nullptr) {
+        if (name_) {
+            startUs_ = Telemetry::instance().nowUs();
+        }
+    }
+    ~TraceSpan() {
+        if (name_) {
+            Telemetry& telemetry = Telemetry::instance();
+            telemetry.addTraceEvent(name_, startUs_, telemetry.nowUs() - startUs_);
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name_;
+    double startUs_ = 0.0;
+};
+
+}  // namespace tsdf
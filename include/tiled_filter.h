@@ -0,0 +1,90 @@
+#pragma once
+
+#include "params.h"
+#include "telemetry.h"
+
+#include <CCGeom.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tsdf {
+
+struct TiledFilterStats {
+    std::size_t tiles = 0;          // 非空分块数
+    std::size_t inputPoints = 0;
+    std::size_t keptPoints = 0;
+    std::size_t maxTilePoints = 0;  // 含重叠边的单块最大点数，决定峰值内存
+    double tileSize = 0.0;
+    double spillMs = 0.0;           // 统计范围与分块落盘耗时
+    double octreeMs = 0.0;
+    double filterMs = 0.0;
+    double mergeMs = 0.0;           // 保留点按原始点号排序并写出的耗时
+    std::vector<PipelineStageStats> pipeline;  // Pipeline.enable 时各级统计
+};
+
+// 分块文件中的一条记录；分块文件即若干记录的原样二进制拼接。
+struct TileRecord {
+    std::uint64_t index;  // 原始点号
+    CCVector3 point;
+    std::uint32_t core;   // 1: 落在本块核心区，0: 仅属重叠边
+};
+
+// XY 平面上的方形分块：构造时扫描输入范围并确定分块边长（Filter.tile_size，或按 Filter.max_memory_mb 自动选择，
+// residentTiles 块同时驻留时按块均分上限），spill 再按块把记录写到 dir/tile_<i>.bin，每点同时写入所有覆盖其
+// radius 重叠边的分块。分块划分只取决于输入与配置，多次构造结果相同。
+class TilePartitioner {
+public:
+    TilePartitioner(const std::filesystem::path& input, const FilterConfig& cfg, int residentTiles);
+    ~TilePartitioner();
+
+    std::size_t inputPoints() const;
+    double tileSize() const;
+    std::size_t tileCount() const;
+    // 分块划分的文字描述（原点、边长、行列数、重叠边），用于判断两次运行的分块是否一致。
+    std::string describe() const;
+
+    static std::filesystem::path tilePath(const std::filesystem::path& dir, std::size_t tile);
+
+    // 写出全部分块（skip 返回 true 的分块不写），返回每块记录数；目录中这些分块的旧文件先被删除。
+    std::vector<std::size_t> spill(const std::filesystem::path& dir, const std::function<bool(std::size_t)>& skip = {}) const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// 读入整个分块文件；文件不存在时返回空。
+std::vector<TileRecord> readTileRecords(const std::filesystem::path& file);
+
+// 对一个分块滤波，返回保留的核心点的原始点号（升序）。
+std::vector<std::uint64_t> filterTileRecords(std::vector<TileRecord> records, const FilterConfig& cfg, double* octreeMs, double* filterMs);
+
+// 按 kept（升序原始点号）从输入取出保留点写到 output；keepFields 时整条记录原样拷贝，否则只写 xyz。
+// DATA binary 输入按映射随机读取，其余格式先完整载入。
+void writeSelectedPoints(const std::filesystem::path& input,
+                         const std::filesystem::path& output,
+                         const std::vector<std::uint64_t>& kept,
+                         bool keepFields);
+
+// Filter.tile_size 或 Filter.max_memory_mb 大于 0 时启用分块模式。
+bool tiledFilterEnabled(const FilterConfig& cfg);
+
+// out-of-core 噪声滤波：按 XY 平面把输入切成方形分块，每块向外扩 radius 的重叠边后落盘，
+// 再逐块载入、建八叉树滤波，只保留核心区内的点，收齐后按原始点号排序写到 output（为空则不写出）。
+// 每个核心点的 radius 邻域都完整落在其分块的重叠范围内，结果与整图滤波保留的点集一致，输出也同为原始点号次序；
+// keepFields 时带输入的全部字段（同 Base.keep_fields），否则只写 xyz。分块文件写在输出目录下本次运行独有的临时目录，结束时删除。
+// DATA binary 输入按映射流式读取，其余格式需先完整解码。
+// pipeline.enable 时落盘之后的读块、组装、滤波、写出四级经 StagePipeline 重叠执行，最多 max_inflight 块同时驻留。
+TiledFilterStats runTiledFilter(const std::filesystem::path& input,
+                                const std::filesystem::path& output,
+                                const FilterConfig& cfg,
+                                const PipelineConfig& pipeline,
+                                bool keepFields);
+
+}  // namespace tsdf
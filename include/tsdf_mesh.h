@@ -0,0 +1,50 @@
+#pragma once
+
+#include "tsdf_volume.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace tsdf {
+
+struct TsdfMeshStats {
+    std::size_t dirtyBlocks = 0;     // 上次提取后被积分过的块
+    std::size_t remeshedBlocks = 0;  // 本次重新提取的块（脏块及其 -x/-y/-z 方向的 7 个邻块）
+    std::size_t vertices = 0;        // 提取后整个网格的顶点数
+    std::size_t faces = 0;           // 提取后整个网格的三角形数
+    double meshMs = 0.0;
+};
+
+// TSDF 卷上的增量 Marching Cubes 网格。每个块只负责以本块体素为原点的立方体，以及以本块体素为低端点的格点边上的顶点；
+// 跨块立方体引用的顶点记为 (属主块下标, 边槽位)，写出时才换算为全局编号，因此块间顶点天然去重、按块并行提取无需任何锁。
+// update() 只重新提取 stamp 晚于上次提取批次的块及受其影响的邻块，其余块沿用缓存结果。
+// 一个 TsdfMesh 只对应一个 TsdfVolume（依赖其块下标不变）。应用目前每次作业积分完再提取一次，即全量提取。
+class TsdfMesh {
+public:
+    // 权重低于 minWeight 的体素视为未观测，不参与提取。
+    explicit TsdfMesh(double minWeight = 1.0);
+
+    TsdfMeshStats update(const TsdfVolume& volume);
+
+    std::size_t vertexCount() const;
+    std::size_t faceCount() const;
+
+    // 写出 binary_little_endian PLY：vertex (float x y z) + face (uchar int vertex_indices)，可直接供 mvs-texturing 使用。
+    void writePly(const std::filesystem::path& output) const;
+
+private:
+    // 块内边槽位 = 体素下标 * 3 + 轴，不超过 11 位。
+    struct BlockMesh {
+        std::vector<std::uint16_t> slots;    // 本块拥有的顶点，按槽位升序
+        std::vector<float> positions;        // 与 slots 对应的 xyz
+        std::vector<std::uint64_t> corners;  // 每个三角形 3 个 (属主块下标 << 11 | 槽位)
+    };
+
+    float minWeight_;
+    std::uint32_t lastEpoch_ = 0;
+    std::vector<BlockMesh> blocks_;  // 与 TsdfVolume 的块下标一一对应
+};
+
+}  // namespace tsdf
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "lidar_dataset.h"
+
+#include <CCGeom.h>
+#include <ReferenceCloud.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+
+namespace tsdf {
+
+struct TsdfVoxel {
+    float sdf = 1.0f;     // 归一化到 [-1, 1] 的截断符号距离，正值在传感器一侧
+    float weight = 0.0f;  // 0 表示未观测
+};
+
+constexpr int TSDF_BLOCK_SIDE = 8;
+constexpr int TSDF_BLOCK_VOXELS = TSDF_BLOCK_SIDE * TSDF_BLOCK_SIDE * TSDF_BLOCK_SIDE;
+
+// 8^3 体素块，体素按 x 最快、z 最慢存放。
+struct TsdfBlock {
+    std::int32_t coord[3] = {0, 0, 0};  // 块坐标 = floor(体素坐标 / 8)
+    std::uint32_t stamp = 0;            // 最近一次被积分时的批次号，供增量提取网格
+    TsdfVoxel voxels[TSDF_BLOCK_VOXELS];
+
+    static int voxelIndex(int x, int y, int z) { return (z * TSDF_BLOCK_SIDE + y) * TSDF_BLOCK_SIDE + x; }
+};
+
+struct TsdfIntegrateStats {
+    std::size_t points = 0;
+    std::size_t pairs = 0;          // (块, 点) 对数，即每条射线截断段平均跨越的块数之和
+    std::size_t touchedBlocks = 0;  // 本次被更新的块数
+    std::size_t newBlocks = 0;      // 本次新分配的块数
+    double pairMs = 0.0;            // 射线遍历收集 (块, 点) 对并排序
+    double integrateMs = 0.0;       // 按块并行积分
+
+    void merge(const TsdfIntegrateStats& other);
+};
+
+// 块稀疏的体素哈希 TSDF：每个点沿传感器原点到该点的射线，在 [depth - truncation, depth + truncation]
+// 内用 3D DDA 逐体素更新投影截断距离（加权平均，权重上限 max_weight）。
+// 积分时先并行遍历射线收集 (块, 点) 对并排序，新块串行插入哈希，再按块划分并行积分，
+// 每个块只由一个任务写入，无需任何锁；同一块内按点号顺序更新，结果与线程数无关。
+class TsdfVolume {
+public:
+    TsdfVolume(double voxelSize, double truncation, double maxWeight);
+
+    double voxelSize() const { return voxelSize_; }
+    double truncation() const { return truncation_; }
+
+    // 积分 count 个世界坐标点，第 i 个点的射线起点为 origins[originIds[i]]。可多次调用逐批追加，
+    // 每次调用批次号加一，本次更新过的块 stamp 记为新批次号。
+    TsdfIntegrateStats integrate(const CCVector3* points, const std::uint32_t* originIds, std::size_t count, const CCVector3d* origins);
+
+    std::uint32_t epoch() const { return epoch_; }
+    std::size_t blockCount() const { return blocks_.size(); }
+    const TsdfBlock& block(std::size_t index) const { return blocks_[index]; }
+    // 按块坐标查找，不存在时返回 nullptr / -1。块下标在卷的生命周期内不变。
+    const TsdfBlock* find(std::int32_t bx, std::int32_t by, std::int32_t bz) const;
+    std::int64_t findIndex(std::int32_t bx, std::int32_t by, std::int32_t bz) const;
+
+private:
+    double voxelSize_;
+    double truncation_;
+    float maxWeight_;
+    std::uint32_t epoch_ = 0;
+    std::deque<TsdfBlock> blocks_;  // deque 追加时不移动已有块
+    std::unordered_map<std::uint64_t, std::uint32_t> lookup_;
+};
+
+// 把多帧数据集中保留下来的点（kept 的全局下标）按所属帧的位姿平移作为射线起点积分进 volume，
+// 按批收集点坐标以限制 (块, 点) 对的内存。
+TsdfIntegrateStats integrateDataset(TsdfVolume& volume, const LidarDataset& dataset, const CCCoreLib::ReferenceCloud& kept);
+
+}  // namespace tsdf
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "lidar_dataset.h"
+#include "params.h"
+
+#include <PointCloud.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tsdf {
+
+struct DownsampleStats {
+    std::size_t input = 0;
+    std::size_t output = 0;
+    double keyMs = 0.0;     // 包围盒与 64 位体素键
+    double sortMs = 0.0;    // 基数排序
+    double reduceMs = 0.0;  // 按体素归约代表点并压实
+    double totalMs = 0.0;
+};
+
+// 把 indices（原始下标，须升序）指向的点按 voxelSize 网格分组：每轴 21 位打包成 64 位体素键后基数排序，
+// 每组以原始下标最小的点为代表，centroid 为 true 时把组内均值坐标写回代表点。返回升序的代表点下标。
+// 坐标含 NaN / Inf 的点不属于任何体素，直接丢弃（不计入包围盒，也不会成为代表点）。
+std::vector<std::uint32_t> mergeVoxels(CCCoreLib::PointCloud& cloud,
+                                       const std::vector<std::uint32_t>& indices,
+                                       double voxelSize,
+                                       bool centroid,
+                                       DownsampleStats* stats = nullptr);
+
+// Downsample.enable 时在建八叉树 / 体素索引之前把整个数据集降为每体素一点：原地缩小合并点云并按帧更新偏移与点数。
+// first 模式同时按代表点收集原始记录，仍可带属性写出；centroid 模式坐标已变，丢弃原始记录只写 xyz。
+DownsampleStats downsampleDataset(LidarDataset& dataset, const DownsampleConfig& cfg);
+
+}  // namespace tsdf
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <CCGeom.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tsdf {
+
+// 固定边长的体素邻域索引：点按所在体素的 Morton 码排序后以 SoA 存放，
+// 体素到排序区间的映射用开放寻址哈希表查找。体素边长取查询半径时，半径邻域只落在相邻 27 个体素内。
+// 非有限坐标（NaN / Inf）的点不进索引：size() 只计有限点，这些点不属于任何体素，滤波时即被剔除。
+class VoxelIndex {
+public:
+    struct Range {
+        std::uint32_t begin = 0;
+        std::uint32_t end = 0;
+    };
+
+    void build(const CCVector3* points, std::size_t count, double cellSize);
+
+    // 接管调用方的 SoA 坐标并在其上原地排序（不另存排序键、不需要等长辅助缓冲），额外内存只有体素表；
+    // trackOrder 时另存每点 4 字节的原始索引，否则 originalIndex() 不可用。供大图的省内存路径使用。
+    void adopt(std::vector<float>&& xs, std::vector<float>&& ys, std::vector<float>&& zs, double cellSize, bool trackOrder);
+
+    std::size_t size() const { return xs_.size(); }
+    std::size_t cellCount() const { return cellKeys_.size(); }
+    double cellSize() const { return cellSize_; }
+
+    // 第 index 个体素（Morton 序）内的点在排序数组中的区间
+    Range cell(std::size_t index) const { return {cellStart_[index], cellStart_[index + 1]}; }
+    // 写出 index 及其 26 个相邻体素中非空者的区间，返回个数（<= 27）
+    std::size_t neighborCells(std::size_t index, Range out[27]) const;
+    // 把与 index 体素切比雪夫距离恰为 ring（>= 1）的非空体素区间追加到 out，返回追加个数；供 kNN 逐层外扩。
+    std::size_t shellCells(std::size_t index, int ring, std::vector<Range>& out) const;
+
+    // 把 index 体素 27 邻域内的全部点按 SoA 拷进调用方缓冲（sorted 为其排序位置），返回点数；缓冲只增不减。
+    std::size_t gatherNeighborhood(std::size_t index,
+                                   std::vector<float>& xs,
+                                   std::vector<float>& ys,
+                                   std::vector<float>& zs,
+                                   std::vector<std::uint32_t>& sorted) const;
+
+    const float* xs() const { return xs_.data(); }
+    const float* ys() const { return ys_.data(); }
+    const float* zs() const { return zs_.data(); }
+    // 排序位置到原始点索引
+    std::uint32_t originalIndex(std::size_t sorted) const { return order_[sorted]; }
+
+private:
+    void setOrigin(const float min[3], const float max[3], std::size_t count);
+    std::uint64_t cellKey(float x, float y, float z) const;
+    template <typename KeyFn>
+    void indexCells(std::size_t count, const KeyFn& keyAt);
+    std::int64_t findCell(std::uint64_t key) const;
+
+    double cellSize_ = 0.0;
+    double origin_[3] = {0.0, 0.0, 0.0};
+    std::vector<float> xs_;
+    std::vector<float> ys_;
+    std::vector<float> zs_;
+    std::vector<std::uint32_t> order_;
+    std::vector<std::uint64_t> cellKeys_;     // 每个非空体素的 Morton 码（升序）
+    std::vector<std::uint32_t> cellStart_;    // cellCount() + 1 个区间起点
+    std::vector<std::uint64_t> hashKeys_;     // 开放寻址表，空槽为 EMPTY_KEY
+    std::vector<std::uint32_t> hashCells_;
+    std::uint64_t hashMask_ = 0;
+};
+
+}  // namespace tsdf
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "params.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+
+namespace tsdf {
+
+struct WatchStats {
+    std::size_t frames = 0;
+    std::size_t points = 0;      // 已插入点数
+    std::size_t evaluated = 0;   // 累计复评点数
+    std::size_t kept = 0;        // 退出时的保留点数
+    std::uint64_t rows = 0;      // 输出文件总行数（含已撤销）
+    std::uint64_t revoked = 0;   // 累计撤销行数
+    double meanFrameMs = 0.0;    // 单帧载入 + 插入 + 复评 + 写出
+    double maxFrameMs = 0.0;
+};
+
+// Watch.enable 时的在线模式：轮询 Base.depth_path 目录与 depth_pose 位姿文件，帧文件大小保持一个轮询间隔不变
+// 且对应位姿行已完整写出后，按帧序载入、变换并交给 IncrementalFilter。新保留点追加到 output（每帧回填点数并刷盘），
+// 被撤销的行号（0 起）逐行追加到 revokeLog。Ctrl-C / SIGTERM 或空闲超过 Watch.idle_exit_s 后正常收尾；逐帧进度写到 log。
+WatchStats runWatch(const AppConfig& cfg, const std::filesystem::path& output, const std::filesystem::path& revokeLog, std::ostream& log);
+
+}  // namespace tsdf
@@ -0,0 +1,280 @@
+#include "cloud_cache.h"
+
+#include "mapped_file.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char CACHE_MAGIC[8] = {'L', 'M', 'C', 'A', 'C', 'H', 'E', '1'};
+constexpr std::uint32_t CACHE_VERSION = 2;
+constexpr std::size_t ALIGNMENT = 64;
+constexpr std::size_t SAMPLE_BLOCK = 64 << 10;
+constexpr std::size_t SAMPLE_COUNT = 64;
+constexpr std::size_t CHECKSUM_BLOCK = 1 << 20;
+
+struct CacheKey {
+    std::uint64_t size = 0;
+    std::int64_t mtime = 0;
+    std::uint64_t hash = 0;
+};
+
+struct CacheHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t codeRecordSize;  // sizeof(IndexAndCode)，防止跨平台误读
+    CacheKey key;
+    std::uint64_t pointCount;
+    std::uint64_t codeCount;       // 0 表示缓存中没有八叉树
+    std::uint64_t pointsOffset;
+    std::uint64_t codesOffset;
+    std::uint64_t checksum;        // 点坐标与编码表两段内容的校验和，载入时核对
+    float bounds[12];              // dimMin dimMax pointsMin pointsMax
+};
+
+std::uint64_t mixBlock(std::uint64_t hash, const char* data, std::size_t size) {
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * 0x9e3779b97f4a7c15ULL;
+        hash ^= hash >> 29;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// 对大文件只哈希首尾与均匀分布的若干块，开销与文件大小无关；配合大小与 mtime 识别改动。
+bool computeKey(const fs::path& input, CacheKey* key) {
+    std::error_code ec;
+    if (!fs::is_regular_file(input, ec)) {
+        return false;
+    }
+    const tsdf::MappedFile mapped(input);
+    if (!mapped.valid()) {
+        return false;
+    }
+    key->size = mapped.size();
+    key->mtime = static_cast<std::int64_t>(fs::last_write_time(input, ec).time_since_epoch().count());
+    if (ec) {
+        return false;
+    }
+
+    std::uint64_t hash = 0xcbf29ce484222325ULL ^ key->size;
+    const std::size_t size = mapped.size();
+    if (size <= SAMPLE_BLOCK * (SAMPLE_COUNT + 2)) {
+        key->hash = mixBlock(hash, mapped.data(), size);
+        return true;
+    }
+    hash = mixBlock(hash, mapped.data(), SAMPLE_BLOCK);
+    const std::size_t stride = (size - SAMPLE_BLOCK) / (SAMPLE_COUNT + 1);
+    for (std::size_t s = 1; s <= SAMPLE_COUNT; ++s) {
+        hash = mixBlock(hash, mapped.data() + s * stride, SAMPLE_BLOCK);
+    }
+    key->hash = mixBlock(hash, mapped.data() + size - SAMPLE_BLOCK, SAMPLE_BLOCK);
+    return true;
+}
+
+// 按 1 MB 块并行哈希后依次合并，结果与线程数无关。
+std::uint64_t checksumOf(const char* data, std::size_t size, std::uint64_t seed) {
+    const std::size_t blocks = (size + CHECKSUM_BLOCK - 1) / CHECKSUM_BLOCK;
+    std::vector<std::uint64_t> hashes(blocks);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, blocks), [&](const tbb::blocked_range<std::size_t>& r) {
+        for (std::size_t b = r.begin(); b != r.end(); ++b) {
+            const std::size_t first = b * CHECKSUM_BLOCK;
+            hashes[b] = mixBlock(0xcbf29ce484222325ULL ^ b, data + first, std::min(CHECKSUM_BLOCK, size - first));
+        }
+    });
+    return mixBlock(seed ^ size, reinterpret_cast<const char*>(hashes.data()), hashes.size() * sizeof(std::uint64_t));
+}
+
+std::uint64_t payloadChecksum(const char* points, std::size_t pointBytes, const char* codes, std::size_t codeBytes) {
+    return checksumOf(codes, codeBytes, checksumOf(points, pointBytes, 0));
+}
+
+// 在目标所在目录新建唯一命名的临时文件（mkstemp），同一输入的并发写入各写各的，改名前互不覆盖。
+bool makeTempFile(const fs::path& target, fs::path* temp) {
+    std::string pattern = target.string() + ".XXXXXX";
+    const int fd = mkstemp(pattern.data());
+    if (fd < 0) {
+        return false;
+    }
+    fchmod(fd, 0644);
+    close(fd);
+    *temp = pattern;
+    return true;
+}
+
+std::uint64_t alignUp(std::uint64_t value) {
+    return (value + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+void writePadding(std::ofstream& out, std::uint64_t target) {
+    static const char zeros[ALIGNMENT] = {};
+    const std::uint64_t pos = static_cast<std::uint64_t>(out.tellp());
+    out.write(zeros, static_cast<std::streamsize>(target - pos));
+}
+
+}  // namespace
+
+namespace tsdf {
+
+CachedOctree::Bounds CachedOctree::bounds() const {
+    return {m_dimMin, m_dimMax, m_pointsMin, m_pointsMax};
+}
+
+void CachedOctree::restore(const Bounds& bounds, const IndexAndCode* codes, std::size_t count) {
+    clear();
+    m_dimMin = bounds.dimMin;
+    m_dimMax = bounds.dimMax;
+    m_pointsMin = bounds.pointsMin;
+    m_pointsMax = bounds.pointsMax;
+    m_thePointsAndTheirCellCodes.assign(codes, codes + count);
+    m_numberOfProjectedPoints = static_cast<unsigned>(count);
+    updateMinAndMaxTables();
+    updateCellSizeTable();
+    updateCellCountTable();
+}
+
+fs::path cloudCachePath(const fs::path& input) {
+    fs::path path = input;
+    path += ".lmcache";
+    return path;
+}
+
+bool loadCloudCache(const fs::path& input, CloudCacheEntry* entry) {
+    CacheKey key;
+    if (!computeKey(input, &key)) {
+        return false;
+    }
+    const MappedFile mapped(cloudCachePath(input));
+    if (!mapped.valid() || mapped.size() < sizeof(CacheHeader)) {
+        return false;
+    }
+    CacheHeader header;
+    std::memcpy(&header, mapped.data(), sizeof(header));
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != CACHE_VERSION ||
+        header.codeRecordSize != sizeof(CCCoreLib::DgmOctree::IndexAndCode) || header.key.size != key.size ||
+        header.key.mtime != key.mtime || header.key.hash != key.hash) {
+        return false;
+    }
+    const std::uint64_t pointBytes = header.pointCount * sizeof(CCVector3);
+    const std::uint64_t codeBytes = header.codeCount * sizeof(CCCoreLib::DgmOctree::IndexAndCode);
+    if (header.pointsOffset + pointBytes > mapped.size() || header.codesOffset + codeBytes > mapped.size() ||
+        (header.codeCount != 0 && header.codeCount != header.pointCount)) {
+        return false;
+    }
+    if (payloadChecksum(mapped.data() + header.pointsOffset, pointBytes, mapped.data() + header.codesOffset, codeBytes) != header.checksum) {
+        return false;
+    }
+
+    auto cloud = std::make_unique<CCCoreLib::PointCloud>();
+    if (header.pointCount > 0) {
+        if (!cloud->resize(static_cast<unsigned>(header.pointCount))) {
+            return false;
+        }
+        std::memcpy(static_cast<void*>(cloud->point(0)), mapped.data() + header.pointsOffset, pointBytes);
+    }
+    cloud->invalidateBoundingBox();
+
+    if (header.codeCount > 0) {
+        CachedOctree::Bounds bounds;
+        std::memcpy(bounds.dimMin.u, header.bounds + 0, sizeof(float) * 3);
+        std::memcpy(bounds.dimMax.u, header.bounds + 3, sizeof(float) * 3);
+        std::memcpy(bounds.pointsMin.u, header.bounds + 6, sizeof(float) * 3);
+        std::memcpy(bounds.pointsMax.u, header.bounds + 9, sizeof(float) * 3);
+        auto octree = std::make_unique<CachedOctree>(cloud.get());
+        octree->restore(bounds,
+                        reinterpret_cast<const CCCoreLib::DgmOctree::IndexAndCode*>(mapped.data() + header.codesOffset),
+                        static_cast<std::size_t>(header.codeCount));
+        entry->octree = std::move(octree);
+    } else {
+        entry->octree.reset();
+    }
+    entry->cloud = std::move(cloud);
+    entry->bytes = mapped.size();
+    return true;
+}
+
+bool saveCloudCache(const fs::path& input, const CCCoreLib::PointCloud& cloud, const CachedOctree* octree) {
+    CacheKey key;
+    if (!computeKey(input, &key)) {
+        return false;
+    }
+
+    CacheHeader header{};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.codeRecordSize = sizeof(CCCoreLib::DgmOctree::IndexAndCode);
+    header.key = key;
+    header.pointCount = cloud.size();
+    header.codeCount = octree ? octree->codes().size() : 0;
+    header.pointsOffset = alignUp(sizeof(CacheHeader));
+    header.codesOffset = alignUp(header.pointsOffset + header.pointCount * sizeof(CCVector3));
+    const std::uint64_t pointBytes = header.pointCount * sizeof(CCVector3);
+    const std::uint64_t codeBytes = header.codeCount * sizeof(CCCoreLib::DgmOctree::IndexAndCode);
+    header.checksum = payloadChecksum(pointBytes > 0 ? reinterpret_cast<const char*>(cloud.getPoint(0)) : nullptr, pointBytes,
+                                      codeBytes > 0 ? reinterpret_cast<const char*>(octree->codes().data()) : nullptr, codeBytes);
+    if (octree) {
+        const CachedOctree::Bounds bounds = octree->bounds();
+        std::memcpy(header.bounds + 0, bounds.dimMin.u, sizeof(float) * 3);
+        std::memcpy(header.bounds + 3, bounds.dimMax.u, sizeof(float) * 3);
+        std::memcpy(header.bounds + 6, bounds.pointsMin.u, sizeof(float) * 3);
+        std::memcpy(header.bounds + 9, bounds.pointsMax.u, sizeof(float) * 3);
+    }
+
+    const fs::path target = cloudCachePath(input);
+    fs::path temp;
+    if (!makeTempFile(target, &temp)) {
+        return false;
+    }
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::error_code ec;
+            fs::remove(temp, ec);
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        writePadding(out, header.pointsOffset);
+        if (header.pointCount > 0) {
+            out.write(reinterpret_cast<const char*>(cloud.getPoint(0)), static_cast<std::streamsize>(pointBytes));
+        }
+        if (header.codeCount > 0) {
+            writePadding(out, header.codesOffset);
+            out.write(reinterpret_cast<const char*>(octree->codes().data()), static_cast<std::streamsize>(codeBytes));
+        }
+        if (!out) {
+            std::error_code ec;
+            fs::remove(temp, ec);
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(temp, target, ec);
+    if (ec) {
+        fs::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace tsdf
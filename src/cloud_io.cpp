@@ -0,0 +1,125 @@
+#include "cloud_io.h"
+
+#include "ply_io.h"
+
+#include <cctype>
+#include <stdexcept>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 流式写出时点数字段预留的定宽长度。
+constexpr std::size_t COUNT_FIELD_WIDTH = 20;
+
+}  // namespace
+
+namespace tsdf {
+
+PointCloudFormat cloudFormatOf(const fs::path& path) {
+    std::string ext = path.extension().string();
+    for (char& c : ext) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return ext == ".ply" ? PointCloudFormat::kPly : PointCloudFormat::kPcd;
+}
+
+const char* cloudExtension(PointCloudFormat format) {
+    return format == PointCloudFormat::kPly ? ".ply" : ".pcd";
+}
+
+PcdHeader readCloudHeader(const fs::path& path) {
+    return cloudFormatOf(path) == PointCloudFormat::kPly ? readPlyHeader(path) : readPcdHeader(path);
+}
+
+CCCoreLib::PointCloud loadCloud(const fs::path& path, PcdLoadInfo* info) {
+    return cloudFormatOf(path) == PointCloudFormat::kPly ? loadPlyCloud(path, info) : loadBinaryCloud(path, info);
+}
+
+std::size_t loadCloudPoints(const fs::path& path, CCVector3* dst, std::size_t capacity, PcdLoadInfo* info, PcdRecords* records) {
+    return cloudFormatOf(path) == PointCloudFormat::kPly ? loadPlyPoints(path, dst, capacity, info, records)
+                                                         : loadBinaryPoints(path, dst, capacity, info, records);
+}
+
+PcdRecords loadCloudRecords(const fs::path& path) {
+    return cloudFormatOf(path) == PointCloudFormat::kPly ? loadPlyRecords(path) : loadPcdRecords(path);
+}
+
+void writeCloud(const fs::path& output, const CCCoreLib::ReferenceCloud& filtered, const PcdRecords* records, const PointColumns* columns) {
+    if (cloudFormatOf(output) == PointCloudFormat::kPly) {
+        writePlyCloud(output, filtered, records, columns);
+    } else {
+        writeBinaryCloud(output, filtered, records, columns);
+    }
+}
+
+CloudStreamWriter::CloudStreamWriter(const fs::path& output) : CloudStreamWriter(output, {{"x", 4, 'F', 1, 0}, {"y", 4, 'F', 1, 4}, {"z", 4, 'F', 1, 8}}) {}
+
+CloudStreamWriter::CloudStreamWriter(const fs::path& output, const std::vector<PcdField>& fields)
+    : path_(output), out_(output, std::ios::binary | std::ios::trunc) {
+    if (!out_) {
+        throw std::runtime_error("无法写出点云: " + output.string());
+    }
+    for (const PcdField& field : fields) {
+        recordSize_ += static_cast<std::size_t>(field.size) * static_cast<std::size_t>(field.count);
+    }
+    const std::string reserved(COUNT_FIELD_WIDTH, ' ');
+    if (cloudFormatOf(output) == PointCloudFormat::kPly) {
+        countPos_.resize(1);
+        writePlyHeader(out_, fields, reserved, &countPos_[0]);
+    } else {
+        countPos_.resize(2);
+        writePcdHeader(out_, fields, reserved, &countPos_[0], &countPos_[1]);
+    }
+}
+
+CloudStreamWriter::~CloudStreamWriter() {
+    if (out_.is_open()) {
+        try {
+            close();
+        } catch (...) {
+        }
+    }
+}
+
+void CloudStreamWriter::append(const CCVector3* points, std::size_t count) {
+    static_assert(sizeof(CCVector3) == 3 * sizeof(float), "CCVector3 须为紧密排列的 3 个 float");
+    if (recordSize_ != sizeof(CCVector3)) {
+        throw std::runtime_error("点云写出器的记录布局不是 xyz float32: " + path_.string());
+    }
+    appendRecords(reinterpret_cast<const char*>(points), count);
+}
+
+void CloudStreamWriter::appendRecords(const char* records, std::size_t count) {
+    out_.write(records, static_cast<std::streamsize>(count * recordSize_));
+    count_ += count;
+}
+
+void CloudStreamWriter::writeCount() {
+    std::string count = std::to_string(count_);
+    count.resize(COUNT_FIELD_WIDTH, ' ');
+    for (const std::streampos pos : countPos_) {
+        out_.seekp(pos);
+        out_.write(count.data(), static_cast<std::streamsize>(count.size()));
+    }
+}
+
+void CloudStreamWriter::flush() {
+    writeCount();
+    out_.seekp(0, std::ios::end);
+    out_.flush();
+    if (!out_) {
+        throw std::runtime_error("写出点云失败: " + path_.string());
+    }
+}
+
+void CloudStreamWriter::close() {
+    writeCount();
+    out_.close();
+    if (!out_) {
+        throw std::runtime_error("写出点云失败: " + path_.string());
+    }
+}
+
+}  // namespace tsdf
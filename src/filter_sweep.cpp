@@ -0,0 +1,228 @@
+#include "filter_sweep.h"
+
+#include "cloud_io.h"
+#include "noise_criterion.h"
+#include "telemetry.h"
+#include "voxel_index.h"
+
+#include <ReferenceCloud.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 单点在某个半径下的判定统计量；sigma < 0 表示平面无效。
+struct RadiusStat {
+    std::uint32_t neighbors = 0;
+    float distance = 0.0f;
+    float sigma = -1.0f;
+};
+
+struct SweepScratch {
+    std::vector<float> cx, cy, cz;
+    std::vector<std::uint32_t> sorted;
+    std::vector<tsdf::PlaneMoments> bins;  // 每个半径一个桶
+};
+
+std::string formatValue(double value) {
+    std::ostringstream out;
+    out << value;
+    return out.str();
+}
+
+}  // namespace
+
+namespace tsdf {
+
+SweepReport runFilterSweep(CCCoreLib::PointCloud& cloud,
+                           const FilterConfig& filter,
+                           const SweepConfig& sweep,
+                           const fs::path& cloudBase,
+                           const PcdRecords* records) {
+    if (sweep.radii.empty()) {
+        throw std::runtime_error("Sweep.radii 为空");
+    }
+    SweepReport report;
+    const std::size_t count = cloud.size();
+    report.inputPoints = count;
+
+    // 半径升序处理，squareRadius 与单次滤波相同按 float 截断后在 double 下比较。
+    std::vector<std::size_t> radiusOrder(sweep.radii.size());
+    std::iota(radiusOrder.begin(), radiusOrder.end(), std::size_t(0));
+    std::sort(radiusOrder.begin(), radiusOrder.end(), [&](std::size_t a, std::size_t b) { return sweep.radii[a] < sweep.radii[b]; });
+    std::vector<double> squareRadii(radiusOrder.size());
+    for (std::size_t j = 0; j < radiusOrder.size(); ++j) {
+        const PointCoordinateType r = static_cast<PointCoordinateType>(sweep.radii[radiusOrder[j]]);
+        squareRadii[j] = static_cast<double>(r) * r;
+    }
+    const double maxRadius = sweep.radii[radiusOrder.back()];
+
+    const auto indexStart = std::chrono::steady_clock::now();
+    VoxelIndex index;
+    index.build(count > 0 ? cloud.getPoint(0) : nullptr, count, maxRadius);
+    report.indexMs = elapsedMs(indexStart);
+
+    const auto statsStart = std::chrono::steady_clock::now();
+    std::vector<std::vector<RadiusStat>> stats(radiusOrder.size(), std::vector<RadiusStat>(count));
+    tbb::enumerable_thread_specific<SweepScratch> scratchPool;
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, index.cellCount(), 64), [&](const tbb::blocked_range<std::size_t>& range) {
+        const TraceSpan span("sweep_cells");
+        SweepScratch& scratch = scratchPool.local();
+        scratch.bins.resize(squareRadii.size());
+        const float* xs = index.xs();
+        const float* ys = index.ys();
+        const float* zs = index.zs();
+        for (std::size_t c = range.begin(); c != range.end(); ++c) {
+            const std::size_t candidates = index.gatherNeighborhood(c, scratch.cx, scratch.cy, scratch.cz, scratch.sorted);
+            const VoxelIndex::Range own = index.cell(c);
+            for (std::uint32_t s = own.begin; s < own.end; ++s) {
+                const CCVector3 query(xs[s], ys[s], zs[s]);
+                // 矩可加：邻点按所落入的最小半径分桶累加，再按半径升序前缀合并，避免逐点排序邻域。
+                std::fill(scratch.bins.begin(), scratch.bins.end(), PlaneMoments{});
+                for (std::size_t k = 0; k < candidates; ++k) {
+                    const float dx = scratch.cx[k] - query.x;
+                    const float dy = scratch.cy[k] - query.y;
+                    const float dz = scratch.cz[k] - query.z;
+                    const double d2 = static_cast<double>(dx) * dx + static_cast<double>(dy) * dy + static_cast<double>(dz) * dz;
+                    if (d2 > squareRadii.back() || scratch.sorted[k] == s) {
+                        continue;
+                    }
+                    std::size_t bin = 0;
+                    while (d2 > squareRadii[bin]) {
+                        ++bin;
+                    }
+                    scratch.bins[bin].add(static_cast<double>(scratch.cx[k]) - query.x,
+                                          static_cast<double>(scratch.cy[k]) - query.y,
+                                          static_cast<double>(scratch.cz[k]) - query.z);
+                }
+
+                const std::uint32_t original = index.originalIndex(s);
+                PlaneMoments moments;
+                for (std::size_t j = 0; j < squareRadii.size(); ++j) {
+                    moments.merge(scratch.bins[j]);
+                    RadiusStat& stat = stats[j][original];
+                    stat.neighbors = static_cast<std::uint32_t>(moments.count);
+                    if (moments.count == 3) {
+                        // 恰好 3 点时与单次滤波一致走叉积拟合，sigma 即 n_sigma = 1 时的阈值。
+                        float nx[3];
+                        float ny[3];
+                        float nz[3];
+                        std::size_t found = 0;
+                        for (std::size_t k = 0; k < candidates && found < 3; ++k) {
+                            const float dx = scratch.cx[k] - query.x;
+                            const float dy = scratch.cy[k] - query.y;
+                            const float dz = scratch.cz[k] - query.z;
+                            const double d2 = static_cast<double>(dx) * dx + static_cast<double>(dy) * dy + static_cast<double>(dz) * dz;
+                            if (d2 <= squareRadii[j] && scratch.sorted[k] != s) {
+                                nx[found] = scratch.cx[k];
+                                ny[found] = scratch.cy[k];
+                                nz[found] = scratch.cz[k];
+                                ++found;
+                            }
+                        }
+                        FilterConfig unit;
+                        unit.use_absolute_error = false;
+                        unit.n_sigma = 1.0;
+                        const NoiseScore score = scoreNoise(query, nx, ny, nz, 3, unit);
+                        stat.distance = score.distance;
+                        stat.sigma = score.threshold;
+                    } else if (moments.count > 3) {
+                        double sigma = 0.0;
+                        const PlaneFit plane = fitPlane(moments, &sigma);
+                        stat.distance = static_cast<float>(std::abs(plane.offset));
+                        stat.sigma = static_cast<float>(sigma);
+                    }
+                }
+            }
+        }
+    });
+    report.statsMs = elapsedMs(statsStart);
+
+    const bool writeClouds = sweep.write_clouds && !cloudBase.empty();
+    for (std::size_t j = 0; j < radiusOrder.size(); ++j) {
+        const double radius = sweep.radii[radiusOrder[j]];
+        const std::vector<RadiusStat>& radiusStats = stats[j];
+        auto evaluate = [&](bool absolute, double value) {
+            SweepResult result;
+            result.radius = radius;
+            result.absolute = absolute;
+            result.value = value;
+
+            const auto evalStart = std::chrono::steady_clock::now();
+            std::vector<std::uint8_t> keep(count, 0);
+            result.kept = tbb::parallel_reduce(
+                tbb::blocked_range<std::size_t>(0, count, 1 << 16),
+                std::size_t(0),
+                [&](const tbb::blocked_range<std::size_t>& range, std::size_t kept) {
+                    for (std::size_t i = range.begin(); i != range.end(); ++i) {
+                        const RadiusStat& stat = radiusStats[i];
+                        NoiseScore score;
+                        score.neighbors = stat.neighbors;
+                        score.distance = stat.distance;
+                        score.threshold = stat.sigma < 0.0f ? -1.0f : static_cast<float>(absolute ? value : stat.sigma * value);
+                        keep[i] = keepPoint(score, filter) ? 1 : 0;
+                        kept += keep[i];
+                    }
+                    return kept;
+                },
+                [](std::size_t a, std::size_t b) { return a + b; });
+            result.evalMs = elapsedMs(evalStart);
+
+            if (writeClouds) {
+                const auto writeStart = std::chrono::steady_clock::now();
+                CCCoreLib::ReferenceCloud kept(&cloud);
+                kept.reserve(static_cast<unsigned>(result.kept));
+                for (std::size_t i = 0; i < count; ++i) {
+                    if (keep[i]) {
+                        kept.addPointIndex(static_cast<unsigned>(i));
+                    }
+                }
+                result.cloudPath = cloudBase.parent_path() / (cloudBase.stem().string() + "_r" + formatValue(radius) + (absolute ? "_a" : "_s") +
+                                                              formatValue(value) + cloudBase.extension().string());
+                writeCloud(result.cloudPath, kept, records);
+                result.writeMs = elapsedMs(writeStart);
+            }
+            report.results.push_back(result);
+        };
+        for (const double sigma : sweep.n_sigmas) {
+            evaluate(false, sigma);
+        }
+        for (const double error : sweep.absolute_errors) {
+            evaluate(true, error);
+        }
+    }
+    return report;
+}
+
+void writeSweepSummary(const fs::path& csv, const SweepReport& report) {
+    std::ofstream out(csv, std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("无法写入扫描汇总: " + csv.string());
+    }
+    // stats_ms 为所有组合共享的邻域与平面统计耗时，index_ms 为按最大半径建索引耗时。
+    out << "radius,criterion,value,kept,removed,kept_ratio,index_ms,stats_ms,eval_ms,write_ms,cloud\n";
+    for (const SweepResult& result : report.results) {
+        const double ratio = report.inputPoints > 0 ? static_cast<double>(result.kept) / static_cast<double>(report.inputPoints) : 0.0;
+        out << result.radius << ',' << (result.absolute ? "absolute_error" : "n_sigma") << ',' << result.value << ','
+            << result.kept << ',' << report.inputPoints - result.kept << ',' << ratio << ','
+            << report.indexMs << ',' << report.statsMs << ',' << result.evalMs << ',' << result.writeMs << ','
+            << result.cloudPath.string() << '\n';
+    }
+}
+
+}  // namespace tsdf
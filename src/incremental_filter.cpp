@@ -0,0 +1,193 @@
+#include "incremental_filter.h"
+
+#include "noise_criterion.h"
+#include "telemetry.h"
+
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+constexpr unsigned AXIS_BITS = 21;
+constexpr std::int64_t AXIS_OFFSET = std::int64_t(1) << (AXIS_BITS - 1);
+
+struct GatherScratch {
+    std::vector<float> cx, cy, cz;
+    std::vector<float> nx, ny, nz;
+};
+
+}  // namespace
+
+namespace tsdf {
+
+IncrementalFilter::IncrementalFilter(const FilterConfig& cfg) : cfg_(cfg) {
+    if (!(cfg_.radius > 0.0)) {
+        throw std::runtime_error("Filter.radius 必须大于 0");
+    }
+    inv_ = 1.0 / cfg_.radius;
+}
+
+std::uint64_t IncrementalFilter::keyOf(const std::int32_t coord[3]) const {
+    std::uint64_t key = 0;
+    for (int k = 0; k < 3; ++k) {
+        key = (key << AXIS_BITS) | static_cast<std::uint64_t>(static_cast<std::int64_t>(coord[k]) + AXIS_OFFSET);
+    }
+    return key;
+}
+
+IncrementalFilter::Cell* IncrementalFilter::find(const std::int32_t coord[3]) {
+    for (int k = 0; k < 3; ++k) {
+        if (coord[k] < -AXIS_OFFSET || coord[k] >= AXIS_OFFSET) {
+            return nullptr;
+        }
+    }
+    const auto it = cells_.find(keyOf(coord));
+    return it == cells_.end() ? nullptr : &it->second;
+}
+
+IncrementalFilter::Update IncrementalFilter::insert(const CCVector3* points, std::size_t count) {
+    Update update;
+    update.inserted = count;
+    if (count == 0) {
+        return update;
+    }
+    if (!hasOrigin_) {
+        origin_[0] = points[0].x;
+        origin_[1] = points[0].y;
+        origin_[2] = points[0].z;
+        hasOrigin_ = true;
+    }
+    const std::uint64_t epoch = ++epoch_;
+
+    // 1. 新点追加到所在体素；被触及的体素记为本批种子。
+    std::vector<Cell*> seeds;
+    for (std::size_t i = 0; i < count; ++i) {
+        const CCVector3& p = points[i];
+        std::int32_t coord[3];
+        for (int k = 0; k < 3; ++k) {
+            const double c = std::floor((static_cast<double>(p.u[k]) - origin_[k]) * inv_);
+            if (!(c >= -static_cast<double>(AXIS_OFFSET) && c < static_cast<double>(AXIS_OFFSET))) {
+                throw std::runtime_error("点坐标超出增量体素索引范围（每轴 21 位）");
+            }
+            coord[k] = static_cast<std::int32_t>(c);
+        }
+        Cell& cell = cells_[keyOf(coord)];
+        if (cell.xs.empty()) {
+            std::copy(coord, coord + 3, cell.coord);
+        }
+        cell.xs.push_back(p.x);
+        cell.ys.push_back(p.y);
+        cell.zs.push_back(p.z);
+        cell.keep.push_back(0);
+        cell.row.push_back(-1);
+        if (cell.stamp != epoch) {
+            cell.stamp = epoch;
+            seeds.push_back(&cell);
+        }
+    }
+    size_ += count;
+
+    // 2. 复评范围：种子体素及其 26 邻域中的非空体素。
+    std::vector<Cell*> affected = seeds;
+    for (const Cell* seed : seeds) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dz = -1; dz <= 1; ++dz) {
+                    const std::int32_t coord[3] = {seed->coord[0] + dx, seed->coord[1] + dy, seed->coord[2] + dz};
+                    Cell* cell = find(coord);
+                    if (cell && cell->stamp != epoch) {
+                        cell->stamp = epoch;
+                        affected.push_back(cell);
+                    }
+                }
+            }
+        }
+    }
+    update.cells = affected.size();
+
+    // 3. 按体素并行复评：与 native 引擎相同的半径截断与判据，每个体素只写自己的 keep。
+    const PointCoordinateType radius = static_cast<PointCoordinateType>(cfg_.radius);
+    const double squareRadius = static_cast<double>(radius) * radius;
+    tbb::enumerable_thread_specific<GatherScratch> scratchPool;
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, affected.size(), 16), [&](const tbb::blocked_range<std::size_t>& range) {
+        const TraceSpan span("incremental_cells");
+        GatherScratch& scratch = scratchPool.local();
+        for (std::size_t a = range.begin(); a != range.end(); ++a) {
+            Cell& cell = *affected[a];
+            std::size_t candidates = 0;
+            std::size_t ownBegin = 0;
+            for (int dx = -1; dx <= 1; ++dx) {
+                for (int dy = -1; dy <= 1; ++dy) {
+                    for (int dz = -1; dz <= 1; ++dz) {
+                        const std::int32_t coord[3] = {cell.coord[0] + dx, cell.coord[1] + dy, cell.coord[2] + dz};
+                        const Cell* other = find(coord);
+                        if (!other) {
+                            continue;
+                        }
+                        const std::size_t n = other->xs.size();
+                        if (scratch.cx.size() < candidates + n) {
+                            scratch.cx.resize(2 * (candidates + n));
+                            scratch.cy.resize(2 * (candidates + n));
+                            scratch.cz.resize(2 * (candidates + n));
+                        }
+                        if (other == &cell) {
+                            ownBegin = candidates;
+                        }
+                        std::copy(other->xs.begin(), other->xs.end(), scratch.cx.begin() + static_cast<std::ptrdiff_t>(candidates));
+                        std::copy(other->ys.begin(), other->ys.end(), scratch.cy.begin() + static_cast<std::ptrdiff_t>(candidates));
+                        std::copy(other->zs.begin(), other->zs.end(), scratch.cz.begin() + static_cast<std::ptrdiff_t>(candidates));
+                        candidates += n;
+                    }
+                }
+            }
+            if (scratch.nx.size() < candidates) {
+                scratch.nx.resize(candidates);
+                scratch.ny.resize(candidates);
+                scratch.nz.resize(candidates);
+            }
+
+            for (std::size_t j = 0; j < cell.xs.size(); ++j) {
+                const CCVector3 query(cell.xs[j], cell.ys[j], cell.zs[j]);
+                std::size_t neighbors = 0;
+                for (std::size_t k = 0; k < candidates; ++k) {
+                    const float dx = scratch.cx[k] - query.x;
+                    const float dy = scratch.cy[k] - query.y;
+                    const float dz = scratch.cz[k] - query.z;
+                    const double d2 = static_cast<double>(dx) * dx + static_cast<double>(dy) * dy + static_cast<double>(dz) * dz;
+                    if (d2 <= squareRadius && k != ownBegin + j) {
+                        scratch.nx[neighbors] = scratch.cx[k];
+                        scratch.ny[neighbors] = scratch.cy[k];
+                        scratch.nz[neighbors] = scratch.cz[k];
+                        ++neighbors;
+                    }
+                }
+                const NoiseScore score = scoreNoise(query, scratch.nx.data(), scratch.ny.data(), scratch.nz.data(), neighbors, cfg_);
+                cell.keep[j] = keepPoint(score, cfg_) ? 1 : 0;
+            }
+        }
+    });
+
+    // 4. 与上一批的输出状态比对，按复评顺序分配新行号或撤销旧行号。
+    for (Cell* cell : affected) {
+        update.evaluated += cell->xs.size();
+        for (std::size_t j = 0; j < cell->xs.size(); ++j) {
+            if (cell->keep[j] && cell->row[j] < 0) {
+                cell->row[j] = static_cast<std::int64_t>(nextRow_++);
+                update.added.emplace_back(cell->xs[j], cell->ys[j], cell->zs[j]);
+                ++kept_;
+            } else if (!cell->keep[j] && cell->row[j] >= 0) {
+                update.revoked.push_back(static_cast<std::uint64_t>(cell->row[j]));
+                cell->row[j] = -1;
+                --kept_;
+            }
+        }
+    }
+    return update;
+}
+
+}  // namespace tsdf
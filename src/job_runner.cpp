@@ -0,0 +1,482 @@
+#include "job_runner.h"
+
+#include "cloud_cache.h"
+#include "cloud_io.h"
+#include "filter_sweep.h"
+#include "lean_filter.h"
+#include "lidar_dataset.h"
+#include "lod_writer.h"
+#include "native_noise_filter.h"
+#include "noise_filter.h"
+#include "shard_filter.h"
+#include "stage_pipeline.h"
+#include "surface_thinning.h"
+#include "telemetry.h"
+#include "tiled_filter.h"
+#include "tsdf_mesh.h"
+#include "tsdf_volume.h"
+#include "voxel_downsample.h"
+#include "watch_mode.h"
+
+#include <PointCloud.h>
+#include <ReferenceCloud.h>
+
+#include <chrono>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+tsdf::LidarDataset datasetFromCache(const tsdf::AppConfig& cfg, tsdf::CloudCacheEntry& cache) {
+    tsdf::LidarDataset dataset;
+    dataset.cloud = std::move(cache.cloud);
+    tsdf::LidarFrame frame;
+    frame.path = cfg.base.depth_path;
+    frame.pointCount = dataset.cloud->size();
+    dataset.frames.push_back(frame);
+    dataset.loadInfo.mapped = true;
+    dataset.loadInfo.dataBytes = cache.bytes;
+    dataset.loadInfo.decoder = "index-cache";
+    return dataset;
+}
+
+// 带属性写出需要原始记录；缓存命中时载入阶段没有读原始文件，写出前再补取（DATA binary 只是映射）。
+void ensureRecords(const tsdf::AppConfig& cfg, tsdf::LidarDataset& dataset) {
+    if (cfg.base.keep_fields && cfg.base.load_mode == tsdf::PointCloudLoadMode::kWholeMap && !dataset.records.valid()) {
+        dataset.records = tsdf::loadCloudRecords(cfg.base.depth_path);
+    }
+}
+
+// 被噪声滤波剔除的点：kept 的补集，按原始索引升序（CCCoreLib 引擎的结果按八叉树单元顺序，先展开成标记）。
+std::unique_ptr<CCCoreLib::ReferenceCloud> rejectedPoints(CCCoreLib::PointCloud& cloud, const CCCoreLib::ReferenceCloud& kept) {
+    std::vector<std::uint8_t> keep(cloud.size(), 0);
+    for (unsigned i = 0; i < kept.size(); ++i) {
+        keep[kept.getPointGlobalIndex(i)] = 1;
+    }
+    auto rejected = std::make_unique<CCCoreLib::ReferenceCloud>(&cloud);
+    if (!rejected->reserve(static_cast<unsigned>(cloud.size() - kept.size()))) {
+        throw std::runtime_error("剔除点索引内存不足");
+    }
+    for (std::size_t i = 0; i < keep.size(); ++i) {
+        if (!keep[i]) {
+            rejected->addPointIndex(static_cast<unsigned>(i));
+        }
+    }
+    return rejected;
+}
+
+// 逐点评估结果原样作为附加字段写出：NoiseScore 的内存布局即附加段的记录布局，写出时按下标整段拷贝。
+tsdf::PointColumns scoreColumns(const std::vector<tsdf::NoiseScore>& scores) {
+    static_assert(sizeof(tsdf::NoiseScore) == 16, "NoiseScore 须为紧密排列的 4 个 32 位字段");
+    tsdf::PointColumns columns;
+    columns.fields = {{"neighbors", 4, 'U', 1, offsetof(tsdf::NoiseScore, neighbors)},
+                      {"plane_distance", 4, 'F', 1, offsetof(tsdf::NoiseScore, distance)},
+                      {"threshold", 4, 'F', 1, offsetof(tsdf::NoiseScore, threshold)},
+                      {"sigma", 4, 'F', 1, offsetof(tsdf::NoiseScore, sigma)}};
+    columns.data = reinterpret_cast<const char*>(scores.data());
+    columns.step = sizeof(tsdf::NoiseScore);
+    return columns;
+}
+
+// 进程峰值 RSS 折合到每个输入点，衡量不同路径的内存开销（守护进程中为进程累计峰值）。
+void logPeakRss(std::ostream& log, std::size_t points) {
+    const double peakMb = tsdf::peakRssMb();
+    log << "峰值 RSS: " << peakMb << " MB";
+    if (points > 0) {
+        log << " (" << peakMb * 1024.0 * 1024.0 / static_cast<double>(points) << " 字节/点)";
+    }
+    log << '\n';
+}
+
+}  // namespace
+
+namespace tsdf {
+
+const char* engineName(FilterEngine engine) {
+    switch (engine) {
+        case FilterEngine::kNative:
+            return "native";
+        case FilterEngine::kParity:
+            return "parity";
+        case FilterEngine::kCCCoreLib:
+        default:
+            return "cccorelib";
+    }
+}
+
+std::string filterModeName(const std::vector<FilterMode>& modes) {
+    std::string name;
+    for (const FilterMode mode : modes) {
+        name += name.empty() ? "" : "+";
+        name += mode == FilterMode::kRadius ? "radius" : mode == FilterMode::kStatistical ? "statistical" : "plane";
+    }
+    return name;
+}
+
+fs::path resolveOutputPath(const AppConfig& cfg) {
+    // 指定 .pcd / .ply 文件时以其扩展名为准，否则视为目录。
+    const std::string defaultName = cfg.base.depth_path.stem().string() + "_denoised" + cloudExtension(cfg.base.pointcloud_format);
+    fs::path output;
+    if (!cfg.base.output_pcd_path.empty()) {
+        std::string ext = cfg.base.output_pcd_path.extension().string();
+        for (char& c : ext) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        if (ext == ".pcd" || ext == ".ply") {
+            output = cfg.base.output_pcd_path;
+        } else {
+            std::filesystem::create_directories(cfg.base.output_pcd_path);
+            output = cfg.base.output_pcd_path / defaultName;
+        }
+    } else {
+        output = cfg.base.output_dir / defaultName;
+    }
+
+    if (!output.parent_path().empty()) {
+        std::filesystem::create_directories(output.parent_path());
+    }
+    return output;
+}
+
+JobResult runJob(const AppConfig& cfg, std::ostream& log) {
+    JobResult result;
+    log << "输入点云: " << cfg.base.depth_path << '\n';
+    if (!cfg.filter.enable && !cfg.sweep.enable && !cfg.tsdf.enable) {
+        log << "Filter.enable=false，跳过噪声滤波。\n";
+        return result;
+    }
+    log << "滤波参数:"
+        << " radius=" << cfg.filter.radius
+        << " nSigma=" << cfg.filter.n_sigma
+        << " remove_isolated=" << (cfg.filter.remove_isolated ? "true" : "false")
+        << " use_absolute_error=" << (cfg.filter.use_absolute_error ? "true" : "false")
+        << " absolute_error=" << cfg.filter.absolute_error
+        << " engine=" << engineName(cfg.filter.engine)
+        << " mode=" << filterModeName(cfg.filter.modes);
+    if (hasFilterMode(cfg.filter, FilterMode::kRadius)) {
+        log << " min_neighbors=" << cfg.filter.min_neighbors;
+    }
+    if (hasFilterMode(cfg.filter, FilterMode::kStatistical)) {
+        log << " sor_neighbors=" << cfg.filter.sor_neighbors << " std_ratio=" << cfg.filter.std_ratio;
+    }
+    log << '\n';
+    log << "输出目录: " << cfg.base.output_dir << '\n';
+
+    if (cfg.watch.enable) {
+        const fs::path output = resolveOutputPath(cfg);
+        const fs::path revokeLog = output.parent_path() / (output.stem().string() + "_revoked.txt");
+        ScopedStage stage("watch");
+        const WatchStats stats = runWatch(cfg, output, revokeLog, log);
+        result.inputPoints = stats.points;
+        result.keptPoints = stats.kept;
+        result.output = output;
+        stage.setPoints(stats.points);
+        stage.addBytesWritten(fs::file_size(output));
+        log << "在线模式: " << stats.frames << " 帧  " << stats.points << " 点  累计复评: " << stats.evaluated << " 点"
+            << "  保留: " << stats.kept << "  输出行: " << stats.rows << " (撤销 " << stats.revoked << ")"
+            << "  单帧耗时: 平均 " << stats.meanFrameMs << " ms / 最大 " << stats.maxFrameMs << " ms\n";
+        log << "输出: " << output << "  撤销日志: " << revokeLog << '\n';
+        return result;
+    }
+
+    if (cfg.shard.enable) {
+        const fs::path output = cfg.base.save_pcd ? resolveOutputPath(cfg) : fs::path();
+        ScopedStage stage("shard_filter");
+        const ShardStats stats = runShardedFilter(cfg, output, log);
+        result.inputPoints = stats.inputPoints;
+        result.keptPoints = stats.keptPoints;
+        result.output = output;
+        stage.setPoints(stats.inputPoints);
+        log << "分片滤波: " << stats.tiles << " 块  边长: " << stats.tileSize << " m"
+            << "  worker: " << stats.launched << " 个 (并发 " << cfg.shard.workers << ")  复用: " << stats.reused << " 块"
+            << "  分块落盘: " << stats.partitionMs << " ms  滤波: " << stats.workMs << " ms\n";
+        log << "载入点数: " << stats.inputPoints << "  保留点数: " << stats.keptPoints << "  合并写出: " << stats.mergeMs << " ms\n";
+        if (!output.empty()) {
+            log << "输出: " << output << (cfg.base.keep_fields ? "" : "（仅 xyz）") << '\n';
+        }
+        return result;
+    }
+
+    if (tiledFilterEnabled(cfg.filter) && !cfg.sweep.enable) {
+        if (cfg.base.load_mode != PointCloudLoadMode::kWholeMap) {
+            throw std::runtime_error("分块模式目前仅支持整图输入 (pcl_load: -1)");
+        }
+        const fs::path output = cfg.base.save_pcd ? resolveOutputPath(cfg) : fs::path();
+        ScopedStage stage("tiled_filter");
+        const TiledFilterStats stats = runTiledFilter(cfg.base.depth_path, output, cfg.filter, cfg.pipeline, cfg.base.keep_fields);
+        result.inputPoints = stats.inputPoints;
+        result.keptPoints = stats.keptPoints;
+        result.output = output;
+        stage.setPoints(stats.inputPoints);
+        log << "分块滤波: " << stats.tiles << " 块  边长: " << stats.tileSize << " m"
+            << "  单块最大点数: " << stats.maxTilePoints
+            << "  分块落盘: " << stats.spillMs << " ms\n";
+        log << "载入点数: " << stats.inputPoints
+            << "  保留点数: " << stats.keptPoints
+            << "  八叉树: " << stats.octreeMs << " ms"
+            << "  滤波: " << stats.filterMs << " ms\n";
+        printPipelineStats(log, stats.pipeline);
+        if (!output.empty()) {
+            log << "输出: " << output << (cfg.base.keep_fields ? "" : "（仅 xyz）") << "  合并写出: " << stats.mergeMs << " ms\n";
+        }
+        return result;
+    }
+
+    if (cfg.filter.lean && cfg.filter.enable) {
+        const fs::path output = cfg.base.save_pcd ? resolveOutputPath(cfg) : fs::path();
+        ScopedStage stage("lean");
+        const LeanFilterStats stats = runLeanFilter(cfg.base.depth_path, output, cfg.filter, cfg.base.keep_fields);
+        result.inputPoints = stats.inputPoints;
+        result.keptPoints = stats.keptPoints;
+        result.output = output;
+        stage.setPoints(stats.inputPoints);
+        log << "载入点数: " << stats.inputPoints << "  耗时: " << stats.loadMs << " ms  (" << stats.decoder << ")"
+            << "  局部原点: (" << stats.origin[0] << ", " << stats.origin[1] << ", " << stats.origin[2] << ")\n";
+        log << "保留点数: " << stats.keptPoints << "  体素索引: " << stats.indexMs << " ms (" << stats.cells << " 体素)"
+            << "  滤波: " << stats.filterMs << " ms  邻域 arena: " << static_cast<double>(stats.scratchBytes) / (1024.0 * 1024.0) << " MB\n";
+        if (!output.empty()) {
+            log << "输出: " << output << "  耗时: " << stats.writeMs << " ms" << (cfg.base.keep_fields ? "" : "（体素序，仅 xyz）") << '\n';
+        } else {
+            log << "save_pcd_en=false，跳过写出步骤。\n";
+        }
+        logPeakRss(log, stats.inputPoints);
+        return result;
+    }
+
+    // 索引缓存只覆盖整图输入：命中时跳过解码与八叉树构建。
+    const bool useCache = cfg.base.cache_enabled && cfg.base.load_mode == PointCloudLoadMode::kWholeMap;
+    const bool needOctree = cfg.filter.enable && cfg.filter.engine != FilterEngine::kNative && !cfg.sweep.enable;
+    CloudCacheEntry cache;
+    const auto loadStart = std::chrono::steady_clock::now();
+    ScopedStage loadStage("load");
+    const bool cacheHit = useCache && loadCloudCache(cfg.base.depth_path, &cache);
+    LidarDataset dataset = cacheHit ? datasetFromCache(cfg, cache) : loadLidarDataset(cfg);
+    CCCoreLib::PointCloud& cloud = *dataset.cloud;
+    const PcdLoadInfo& loadInfo = dataset.loadInfo;
+    const auto loadEnd = std::chrono::steady_clock::now();
+    result.inputPoints = cloud.size();
+    loadStage.setPoints(cloud.size());
+    loadStage.addBytesRead(loadInfo.dataBytes);
+    loadStage.finish();
+    const double loadMs = std::chrono::duration<double, std::milli>(loadEnd - loadStart).count();
+    log << "载入点数: " << cloud.size()
+        << "  帧数: " << dataset.frames.size()
+        << "  耗时: " << loadMs << " ms"
+        << "  (" << (loadInfo.mapped ? "mmap" : "ifstream 回退") << ", " << loadInfo.decoder
+        << ", " << (loadMs > 0.0 ? static_cast<double>(loadInfo.dataBytes) / 1.0e3 / loadMs : 0.0) << " MB/s)";
+    if (useCache) {
+        log << "  缓存: " << (cacheHit ? "命中" : "未命中");
+    }
+    log << '\n';
+    printPipelineStats(log, dataset.pipeline);
+
+    // 降采样后点集改变，缓存只保存降采样前的点云，不使用也不保存八叉树。
+    const bool cacheOctree = needOctree && !cfg.downsample.enable;
+    std::unique_ptr<CachedOctree> octree = cfg.downsample.enable ? nullptr : std::move(cache.octree);
+    const bool octreeCached = octree != nullptr;
+    double octreeBuildMs = 0.0;
+    if (useCache && cacheOctree && !octree) {
+        const auto buildStart = std::chrono::steady_clock::now();
+        ScopedStage stage("octree_build");
+        stage.setPoints(cloud.size());
+        octree = std::make_unique<CachedOctree>(&cloud);
+        if (octree->buildParallel() <= 0) {
+            throw std::runtime_error("构建八叉树失败");
+        }
+        octreeBuildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+    }
+    if (useCache && (!cacheHit || (cacheOctree && !octreeCached))) {
+        const auto saveStart = std::chrono::steady_clock::now();
+        ScopedStage stage("cache_save");
+        stage.addBytesWritten(cloud.size() * sizeof(CCVector3) + (octree ? octree->codes().size() * sizeof(CCCoreLib::DgmOctree::IndexAndCode) : 0));
+        const bool saved = saveCloudCache(cfg.base.depth_path, cloud, octree.get());
+        const double saveMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - saveStart).count();
+        if (saved) {
+            log << "写入缓存: " << cloudCachePath(cfg.base.depth_path) << "  耗时: " << saveMs << " ms\n";
+        } else {
+            log << "警告: 无法写入缓存 " << cloudCachePath(cfg.base.depth_path) << '\n';
+        }
+    }
+
+    // rawRecords：dataset.records 与当前点坐标一致，可带属性写出。
+    bool rawRecords = true;
+    if (cfg.downsample.enable) {
+        if (cfg.downsample.mode == DownsampleMode::kFirst) {
+            ensureRecords(cfg, dataset);
+        }
+        ScopedStage stage("downsample");
+        stage.setPoints(cloud.size());
+        const DownsampleStats stats = downsampleDataset(dataset, cfg.downsample);
+        rawRecords = cfg.downsample.mode == DownsampleMode::kFirst;
+        log << "降采样: " << stats.input << " -> " << stats.output << " 点 ("
+            << (stats.input > 0 ? 100.0 * static_cast<double>(stats.output) / static_cast<double>(stats.input) : 0.0) << "%)"
+            << "  体素键: " << stats.keyMs << " ms  排序: " << stats.sortMs << " ms  归约: " << stats.reduceMs << " ms"
+            << "  合计: " << stats.totalMs << " ms\n";
+    }
+
+    if (cfg.sweep.enable) {
+        const fs::path output = resolveOutputPath(cfg);
+        const fs::path stem = output.parent_path() / cfg.base.depth_path.stem();
+        ScopedStage stage("sweep");
+        stage.setPoints(cloud.size());
+        if (cfg.sweep.write_clouds && rawRecords) {
+            ensureRecords(cfg, dataset);
+        }
+        fs::path cloudBase = stem;
+        cloudBase += output.extension();
+        const SweepReport report = runFilterSweep(cloud, cfg.filter, cfg.sweep, cloudBase, rawRecords ? &dataset.records : nullptr);
+        log << "参数扫描: " << report.results.size() << " 组  体素索引: " << report.indexMs << " ms"
+            << "  邻域统计: " << report.statsMs << " ms\n";
+        for (const SweepResult& result : report.results) {
+            log << "  radius=" << result.radius << (result.absolute ? " absolute_error=" : " nSigma=") << result.value
+                << "  保留点数: " << result.kept << "  判定: " << result.evalMs << " ms";
+            if (!result.cloudPath.empty()) {
+                log << "  输出: " << result.cloudPath;
+            }
+            log << '\n';
+        }
+        fs::path summary = stem;
+        summary += "_sweep.csv";
+        writeSweepSummary(summary, report);
+        result.output = summary;
+        log << "扫描汇总: " << summary << '\n';
+        return result;
+    }
+
+    const bool thinning = cfg.filter.enable && (cfg.filter.thin != ThinMethod::kNone || cfg.filter.merge_voxel > 0.0);
+    std::vector<CCVector3> projected;
+    std::vector<NoiseScore> scores;
+    std::unique_ptr<CCCoreLib::ReferenceCloud> filtered;
+    ScopedStage filterStage("filter");
+    filterStage.setPoints(cloud.size());
+    if (!cfg.filter.enable) {
+        // 只做 TSDF 时全部点参与积分。
+        log << "Filter.enable=false，跳过噪声滤波。\n";
+        filtered = std::make_unique<CCCoreLib::ReferenceCloud>(&cloud);
+        if (cloud.size() > 0 && !filtered->addPointIndex(0, cloud.size())) {
+            throw std::runtime_error("分配点索引失败");
+        }
+    } else if (cfg.filter.engine == FilterEngine::kParity) {
+        FilterParityReport parity = compareFilterEngines(cloud, cfg.filter, octree.get());
+        log << "引擎比对: cccorelib 保留 " << parity.cccorelibKept << " (" << parity.cccorelibMs << " ms)"
+            << "  native 保留 " << parity.nativeKept << " (" << parity.nativeMs << " ms)"
+            << "  不一致 " << parity.mismatches << " (阈值舍入 " << parity.borderline << ")\n";
+        if (!parity.consistent()) {
+            throw std::runtime_error("滤波引擎结果不一致");
+        }
+        filtered = std::move(parity.kept);
+    } else {
+        double octreeMs = 0.0;
+        double filterMs = 0.0;
+        filtered = runFilter(cloud, cfg.filter, &octreeMs, &filterMs, octree.get(), thinning ? &projected : nullptr,
+                             cfg.filter.export_scores ? &scores : nullptr);
+        log << "保留点数: " << filtered->size()
+            << (cfg.filter.engine == FilterEngine::kNative ? "  体素索引: " : "  八叉树: ") << octreeMs + octreeBuildMs << " ms"
+            << (octreeCached && needOctree ? " (缓存)" : "")
+            << "  滤波: " << filterMs << " ms\n";
+    }
+
+    filterStage.finish();
+    result.keptPoints = filtered->size();
+    // 剔除点取压薄之前的滤波结果的补集；压薄只移动保留点，剔除点的原始记录仍然有效。
+    const std::unique_ptr<CCCoreLib::ReferenceCloud> rejected =
+        cfg.filter.enable && cfg.filter.export_rejected ? rejectedPoints(cloud, *filtered) : nullptr;
+
+    if (thinning) {
+        ScopedStage stage("thin");
+        stage.setPoints(filtered->size());
+        ThinningStats stats;
+        filtered = thinCloud(cloud, *filtered, cfg.filter, projected.empty() ? nullptr : &projected, &stats);
+        std::vector<CCVector3>().swap(projected);
+        log << "压薄: " << stats.input << " -> " << stats.output << " 点  平均位移: " << stats.meanShift << " m"
+            << "  投影: " << stats.projectMs << " ms" << (stats.reused ? " (复用滤波邻域)" : "")
+            << "  合并: " << stats.mergeMs << " ms\n";
+        result.keptPoints = filtered->size();
+    }
+
+    // 未滤波时不重复写出输入点云。
+    if (cfg.filter.enable && !cfg.base.save_pcd) {
+        log << "save_pcd_en=false，跳过写出步骤。\n";
+    } else if (cfg.filter.enable) {
+        const fs::path output = resolveOutputPath(cfg);
+        ScopedStage writeStage("write");
+        writeStage.setPoints(filtered->size());
+        // 压薄或均值降采样改写了坐标，原始记录中的 xyz 已失效，只写 xyz。
+        const bool keptRecords = rawRecords && !thinning;
+        if (keptRecords || (rejected && rawRecords)) {
+            ensureRecords(cfg, dataset);
+        }
+        const PointColumns columns = scoreColumns(scores);
+        const PointColumns* extra = cfg.filter.export_scores ? &columns : nullptr;
+        writeCloud(output, *filtered, keptRecords ? &dataset.records : nullptr, extra);
+        result.output = output;
+        writeStage.addBytesWritten(fs::file_size(output));
+        writeStage.finish();
+        log << "输出: " << output << (extra ? "  (附加 neighbors / plane_distance / threshold / sigma)" : "") << '\n';
+
+        if (cfg.lod.enable) {
+            const fs::path lodDir = cfg.lod.output_dir.empty() ? output.parent_path() / (output.stem().string() + "_lod") : cfg.lod.output_dir;
+            ScopedStage stage("lod");
+            stage.setPoints(filtered->size());
+            const LodStats stats = writeLodPyramid(lodDir, *filtered, keptRecords ? &dataset.records : nullptr, cfg.lod, output.extension().string());
+            std::uintmax_t bytes = 0;
+            for (const fs::directory_entry& entry : fs::directory_iterator(lodDir)) {
+                bytes += entry.is_regular_file() ? entry.file_size() : 0;
+            }
+            stage.addBytesWritten(bytes);
+            log << "LOD: " << stats.levels << " 层  " << stats.nodes << " 节点  单节点最大点数: " << stats.maxNodePoints
+                << "  排序: " << stats.sortMs << " ms  写出: " << stats.writeMs << " ms  输出: " << lodDir << '\n';
+        }
+
+        if (rejected) {
+            const fs::path rejectedPath = output.parent_path() / (output.stem().string() + "_rejected" + output.extension().string());
+            ScopedStage stage("write_rejected");
+            stage.setPoints(rejected->size());
+            writeCloud(rejectedPath, *rejected, rawRecords ? &dataset.records : nullptr, extra);
+            stage.addBytesWritten(fs::file_size(rejectedPath));
+            log << "剔除点: " << rejected->size() << "  输出: " << rejectedPath << '\n';
+        }
+    }
+
+    if (cfg.tsdf.enable) {
+        ScopedStage stage("tsdf_integrate");
+        stage.setPoints(filtered->size());
+        TsdfVolume volume(cfg.tsdf.voxel_size, cfg.tsdf.truncation, cfg.tsdf.max_weight);
+        const TsdfIntegrateStats stats = integrateDataset(volume, dataset, *filtered);
+        log << "TSDF 积分: " << stats.points << " 点  体素块: " << volume.blockCount()
+            << "  射线-块对: " << stats.pairs
+            << "  射线遍历: " << stats.pairMs << " ms  积分: " << stats.integrateMs << " ms\n";
+        stage.finish();
+
+        if (cfg.tsdf.mesh) {
+            ScopedStage meshStage("tsdf_mesh");
+            TsdfMesh mesh(cfg.tsdf.min_weight);
+            const TsdfMeshStats meshStats = mesh.update(volume);
+            const fs::path meshPath = cfg.tsdf.mesh_path.empty()
+                ? resolveOutputPath(cfg).parent_path() / (cfg.base.depth_path.stem().string() + "_mesh.ply")
+                : cfg.tsdf.mesh_path;
+            if (!meshPath.parent_path().empty()) {
+                fs::create_directories(meshPath.parent_path());
+            }
+            mesh.writePly(meshPath);
+            meshStage.setPoints(meshStats.vertices);
+            meshStage.addBytesWritten(fs::file_size(meshPath));
+            meshStage.finish();
+            log << "网格: " << meshStats.vertices << " 顶点  " << meshStats.faces << " 三角形  提取块: "
+                << meshStats.remeshedBlocks << "  耗时: " << meshStats.meshMs << " ms\n";
+            log << "网格输出: " << meshPath << '\n';
+        }
+    }
+
+    logPeakRss(log, result.inputPoints);
+    return result;
+}
+
+}  // namespace tsdf
@@ -0,0 +1,424 @@
+#include "job_server.h"
+
+#include "job_runner.h"
+#include "params.h"
+#include "telemetry.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::size_t MAX_REQUEST = 1 << 16;
+constexpr int ACCEPT_POLL_MS = 200;
+// 已接受、尚未被工作线程取走的连接上限，超出时直接回复错误并关闭。
+constexpr std::size_t MAX_PENDING = 256;
+// 读取请求的超时：迟迟不发请求的连接不会长期占住工作线程。
+constexpr int REQUEST_TIMEOUT_SEC = 10;
+
+volatile std::sig_atomic_t g_stop = 0;
+
+void requestStop(int) {
+    g_stop = 1;
+}
+
+sockaddr_un socketAddress(const fs::path& socketPath) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    const std::string path = socketPath.string();
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("套接字路径为空或过长: " + path);
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return addr;
+}
+
+bool sendAll(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        const ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+// 按行回传到套接字的输出缓冲：作业日志每写完一行即发送；对端断开后静默丢弃，不影响作业本身。
+class SocketLineBuf : public std::streambuf {
+public:
+    explicit SocketLineBuf(int fd) : fd_(fd) {}
+    ~SocketLineBuf() override { sync(); }
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            line_.push_back(traits_type::to_char_type(ch));
+            if (ch == '\n') {
+                sync();
+            }
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        line_.append(s, static_cast<std::size_t>(n));
+        if (std::memchr(s, '\n', static_cast<std::size_t>(n))) {
+            sync();
+        }
+        return n;
+    }
+
+    int sync() override {
+        if (!line_.empty() && !broken_) {
+            broken_ = !sendAll(fd_, line_.data(), line_.size());
+        }
+        line_.clear();
+        return 0;
+    }
+
+private:
+    int fd_;
+    bool broken_ = false;
+    std::string line_;
+};
+
+struct PendingConnection {
+    int fd = -1;
+    std::chrono::steady_clock::time_point accepted;
+};
+
+struct ServerState {
+    std::mutex mutex;  // 保护以下队列、计数与服务端标准输出
+    std::condition_variable ready;
+    std::deque<PendingConnection> queue;
+    bool stopping = false;
+    std::size_t jobs = 0;
+    std::size_t failed = 0;
+};
+
+// 读到空行或对端关闭写端为止；返回首行配置路径与其后的覆盖项。
+bool readRequest(int fd, std::string* config, std::vector<std::string>* overrides) {
+    std::string request;
+    char chunk[4096];
+    while (request.size() < MAX_REQUEST && request.find("\n\n") == std::string::npos) {
+        const ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        request.append(chunk, static_cast<std::size_t>(n));
+    }
+    std::istringstream in(request);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            break;
+        }
+        if (config->empty()) {
+            *config = line;
+        } else {
+            overrides->push_back(line);
+        }
+    }
+    return !config->empty();
+}
+
+// 作业最后一行统计，message 中的换行替换为空格，保证客户端按行解析。
+std::string resultLine(std::string error, double queueMs, double runMs, const tsdf::JobResult& result) {
+    for (char& c : error) {
+        if (c == '\n' || c == '\r') {
+            c = ' ';
+        }
+    }
+    std::ostringstream line;
+    line << "@result status=" << (error.empty() ? "ok" : "error") << " queue_ms=" << queueMs << " run_ms=" << runMs
+         << " input=" << result.inputPoints << " kept=" << result.keptPoints << " output=" << result.output.string();
+    if (!error.empty()) {
+        line << " message=" << error;
+    }
+    line << '\n';
+    return line.str();
+}
+
+void serveConnection(const PendingConnection& connection, ServerState& state) {
+    const int fd = connection.fd;
+    const timeval timeout{REQUEST_TIMEOUT_SEC, 0};
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    std::string config;
+    std::vector<std::string> overrides;
+    if (!readRequest(fd, &config, &overrides)) {
+        // 空连接（如启动时的存活探测）不计作业。
+        ::close(fd);
+        return;
+    }
+
+    SocketLineBuf buffer(fd);
+    std::ostream log(&buffer);
+    const double queueMs = tsdf::elapsedMs(connection.accepted);
+    const auto runStart = std::chrono::steady_clock::now();
+    tsdf::JobResult result;
+    std::string error;
+    try {
+        const tsdf::AppConfig cfg = tsdf::loadAppConfig(config, overrides);
+        if (cfg.watch.enable) {
+            throw std::runtime_error("Watch 模式不能作为守护进程作业运行");
+        }
+        // 度量报告由 CLI 在进程级写出，Telemetry 为进程内单例，并发作业的阶段与 trace 会混在一起。
+        if (cfg.telemetry.enable) {
+            throw std::runtime_error("Telemetry 不能用于守护进程作业，请改用单次运行的 livomesh_app");
+        }
+        result = tsdf::runJob(cfg, log);
+    } catch (const std::exception& ex) {
+        error = ex.what();
+        if (error.empty()) {
+            error = "未知错误";
+        }
+    }
+    const double runMs = tsdf::elapsedMs(runStart);
+
+    log << resultLine(error, queueMs, runMs, result);
+    log.flush();
+    ::close(fd);
+
+    const std::lock_guard<std::mutex> lock(state.mutex);
+    ++state.jobs;
+    if (!error.empty()) {
+        ++state.failed;
+    }
+    std::cout << "作业 #" << state.jobs << ": " << config << (error.empty() ? "  完成" : "  失败: " + error)
+              << "  排队: " << queueMs << " ms  运行: " << runMs << " ms\n";
+}
+
+// 工作线程：从队列取连接逐个执行，停止后把队列中已接受的连接执行完再退出。
+void workerLoop(ServerState& state) {
+    while (true) {
+        PendingConnection connection;
+        {
+            std::unique_lock<std::mutex> lock(state.mutex);
+            state.ready.wait(lock, [&] { return state.stopping || !state.queue.empty(); });
+            if (state.queue.empty()) {
+                return;
+            }
+            connection = state.queue.front();
+            state.queue.pop_front();
+        }
+        serveConnection(connection, state);
+    }
+}
+
+// 固定 maxJobs 个工作线程；析构时（含接收循环抛出异常）通知停止并等待在途与排队的作业结束。
+class WorkerPool {
+public:
+    WorkerPool(ServerState& state, int workers) : state_(state) {
+        threads_.reserve(static_cast<std::size_t>(workers));
+        try {
+            for (int i = 0; i < workers; ++i) {
+                threads_.emplace_back(workerLoop, std::ref(state_));
+            }
+        } catch (...) {
+            join();
+            throw;
+        }
+    }
+
+    ~WorkerPool() { join(); }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // 队列已满时返回 false，连接仍归调用方。
+    bool submit(int fd) {
+        {
+            const std::lock_guard<std::mutex> lock(state_.mutex);
+            if (state_.queue.size() >= MAX_PENDING) {
+                return false;
+            }
+            state_.queue.push_back({fd, std::chrono::steady_clock::now()});
+        }
+        state_.ready.notify_one();
+        return true;
+    }
+
+    void join() {
+        {
+            const std::lock_guard<std::mutex> lock(state_.mutex);
+            state_.stopping = true;
+        }
+        state_.ready.notify_all();
+        for (std::thread& thread : threads_) {
+            thread.join();
+        }
+        threads_.clear();
+    }
+
+private:
+    ServerState& state_;
+    std::vector<std::thread> threads_;
+};
+
+}  // namespace
+
+namespace tsdf {
+
+void runJobServer(const fs::path& socketPath, int maxJobs) {
+    if (maxJobs <= 0) {
+        throw std::runtime_error("守护进程并发作业数须大于 0");
+    }
+    const sockaddr_un addr = socketAddress(socketPath);
+
+    // 套接字文件已存在时先探测：能连上说明已有守护进程在运行，否则视为上次异常退出的残留。
+    if (fs::exists(socketPath)) {
+        const int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        const bool alive = probe >= 0 && ::connect(probe, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+        if (probe >= 0) {
+            ::close(probe);
+        }
+        if (alive) {
+            throw std::runtime_error("已有守护进程在监听: " + socketPath.string());
+        }
+        fs::remove(socketPath);
+    }
+
+    const int listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0) {
+        throw std::runtime_error("创建套接字失败: " + std::string(std::strerror(errno)));
+    }
+    if (::bind(listener, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(listener, SOMAXCONN) != 0) {
+        const std::string reason = std::strerror(errno);
+        ::close(listener);
+        throw std::runtime_error("监听套接字失败: " + socketPath.string() + " (" + reason + ")");
+    }
+
+    g_stop = 0;
+    const auto previousInt = std::signal(SIGINT, requestStop);
+    const auto previousTerm = std::signal(SIGTERM, requestStop);
+    std::cout << "守护进程: 监听 " << socketPath << "  并发作业上限: " << maxJobs << std::endl;
+
+    // 停止或抛出异常时都先关闭监听，工作线程执行完在途与排队的作业后（WorkerPool 析构）再删除套接字文件、恢复信号处理。
+    ServerState state;
+    bool listening = true;
+    const auto stopListening = [&] {
+        if (listening) {
+            ::close(listener);
+            listening = false;
+        }
+    };
+    try {
+        WorkerPool pool(state, maxJobs);
+        const std::string busy = resultLine("排队作业过多（上限 " + std::to_string(MAX_PENDING) + "），请稍后重试", 0.0, 0.0, {});
+        try {
+            while (!g_stop) {
+                pollfd pending{listener, POLLIN, 0};
+                if (::poll(&pending, 1, ACCEPT_POLL_MS) <= 0) {
+                    continue;
+                }
+                const int client = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+                if (client < 0) {
+                    continue;
+                }
+                if (!pool.submit(client)) {
+                    sendAll(client, busy.data(), busy.size());
+                    ::close(client);
+                }
+            }
+        } catch (...) {
+            stopListening();
+            throw;
+        }
+        stopListening();
+        std::cout << "守护进程: 停止接收新作业，等待在途作业结束" << std::endl;
+    } catch (...) {
+        stopListening();
+        fs::remove(socketPath);
+        std::signal(SIGINT, previousInt);
+        std::signal(SIGTERM, previousTerm);
+        throw;
+    }
+    std::cout << "守护进程: 共处理 " << state.jobs << " 个作业，失败 " << state.failed << " 个\n";
+    fs::remove(socketPath);
+    std::signal(SIGINT, previousInt);
+    std::signal(SIGTERM, previousTerm);
+}
+
+bool submitJob(const fs::path& socketPath, const fs::path& config, const std::vector<std::string>& overrides, std::ostream& out) {
+    const sockaddr_un addr = socketAddress(socketPath);
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        const std::string reason = std::strerror(errno);
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        throw std::runtime_error("无法连接守护进程: " + socketPath.string() + " (" + reason + ")");
+    }
+
+    // 配置路径按客户端的工作目录解析。
+    std::string request = fs::absolute(config).string() + '\n';
+    for (const std::string& item : overrides) {
+        request += item + '\n';
+    }
+    request += '\n';
+    // 发送失败时仍读取回复：排队已满时守护进程不读请求，直接回复错误后关闭连接。
+    const bool sent = sendAll(fd, request.data(), request.size());
+
+    std::string pending;
+    std::string result;
+    char chunk[4096];
+    while (true) {
+        const ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        pending.append(chunk, static_cast<std::size_t>(n));
+        std::size_t newline;
+        while ((newline = pending.find('\n')) != std::string::npos) {
+            const std::string line = pending.substr(0, newline);
+            pending.erase(0, newline + 1);
+            if (line.rfind("@result ", 0) == 0) {
+                result = line.substr(8);
+            } else {
+                out << line << '\n';
+            }
+        }
+        out.flush();
+    }
+    ::close(fd);
+    if (result.empty()) {
+        throw std::runtime_error(sent ? "守护进程在返回作业结果前断开连接" : "发送作业失败: " + socketPath.string());
+    }
+    out << "作业统计: " << result << '\n';
+    return result.rfind("status=ok", 0) == 0;
+}
+
+}  // namespace tsdf
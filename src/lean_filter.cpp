@@ -0,0 +1,341 @@
+#include "lean_filter.h"
+
+#include "cloud_io.h"
+#include "noise_criterion.h"
+#include "pcd_decode.h"
+#include "pcd_io.h"
+#include "telemetry.h"
+#include "voxel_index.h"
+
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/task_arena.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 按块解码 / 写出的点数；写出缓冲也按此分批。
+constexpr std::size_t CHUNK = 1 << 16;
+// 局部原点取首点坐标按该步长取整：|坐标| < 512 m 的轴原点为 0，float 输入逐位保留；
+// UTM 等大坐标落到原点附近，float32 在数公里范围内仍有亚毫米分辨率。
+constexpr double ORIGIN_STEP = 1024.0;
+
+// 相对局部原点的 float32 SoA 坐标。
+struct LeanCloud {
+    double origin[3] = {0.0, 0.0, 0.0};
+    std::vector<float> xs, ys, zs;
+
+    void resize(std::size_t count) {
+        xs.resize(count);
+        ys.resize(count);
+        zs.resize(count);
+    }
+};
+
+// 每点 1 bit 的选择结果，替代按 32 位下标保存保留点的 ReferenceCloud；并行置位用原子 or。
+class SelectionMask {
+public:
+    explicit SelectionMask(std::size_t count) : words_((count + 63) / 64), bits_(new std::atomic<std::uint64_t>[words_]()) {}
+
+    void set(std::size_t i) { bits_[i >> 6].fetch_or(std::uint64_t(1) << (i & 63), std::memory_order_relaxed); }
+    bool test(std::size_t i) const { return (bits_[i >> 6].load(std::memory_order_relaxed) >> (i & 63)) & 1; }
+
+    std::size_t count() const {
+        std::size_t total = 0;
+        for (std::size_t w = 0; w < words_; ++w) {
+            total += std::bitset<64>(bits_[w].load(std::memory_order_relaxed)).count();
+        }
+        return total;
+    }
+
+private:
+    std::size_t words_;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> bits_;
+};
+
+bool isF8(const tsdf::FieldAttr& field) {
+    return field.type == 'F' && field.size == 8;
+}
+
+// DATA binary：并行按块解码并减去原点，每块处理完即释放对应文件页。三轴均为 F8 时直接按 double 读取相减。
+void loadFromView(const tsdf::PcdBinaryView& view, LeanCloud* cloud, const char** decoder) {
+    const tsdf::PcdHeader& header = view.header();
+    const std::size_t count = view.size();
+    cloud->resize(count);
+    const bool f64 = isF8(header.x) && isF8(header.y) && isF8(header.z);
+    *decoder = f64 ? "lean-f64" : tsdf::selectXyzDecoder(header).name;
+    if (count == 0) {
+        return;
+    }
+
+    const int offsets[3] = {header.x.offset, header.y.offset, header.z.offset};
+    const auto readF8 = [&](std::size_t i, double out[3]) {
+        for (int k = 0; k < 3; ++k) {
+            std::memcpy(&out[k], view.record(i) + offsets[k], sizeof(double));
+        }
+    };
+    double first[3];
+    if (f64) {
+        readF8(0, first);
+    } else {
+        CCVector3 point;
+        view.decode(0, 1, &point);
+        std::copy(point.u, point.u + 3, first);
+    }
+    for (int k = 0; k < 3; ++k) {
+        cloud->origin[k] = std::round(first[k] / ORIGIN_STEP) * ORIGIN_STEP + 0.0;  // 避免 -0
+    }
+
+    const double* origin = cloud->origin;
+    tbb::enumerable_thread_specific<std::vector<CCVector3>> buffers;
+    const std::size_t chunks = (count + CHUNK - 1) / CHUNK;
+    tbb::parallel_for(std::size_t(0), chunks, [&](std::size_t c) {
+        const tsdf::TraceSpan span("lean_decode");
+        const std::size_t first = c * CHUNK;
+        const std::size_t n = std::min(CHUNK, count - first);
+        if (f64) {
+            for (std::size_t i = first; i < first + n; ++i) {
+                double p[3];
+                readF8(i, p);
+                cloud->xs[i] = static_cast<float>(p[0] - origin[0]);
+                cloud->ys[i] = static_cast<float>(p[1] - origin[1]);
+                cloud->zs[i] = static_cast<float>(p[2] - origin[2]);
+            }
+        } else {
+            std::vector<CCVector3>& buffer = buffers.local();
+            buffer.resize(CHUNK);
+            view.decode(first, n, buffer.data());
+            for (std::size_t k = 0; k < n; ++k) {
+                cloud->xs[first + k] = static_cast<float>(static_cast<double>(buffer[k].x) - origin[0]);
+                cloud->ys[first + k] = static_cast<float>(static_cast<double>(buffer[k].y) - origin[1]);
+                cloud->zs[first + k] = static_cast<float>(static_cast<double>(buffer[k].z) - origin[2]);
+            }
+        }
+        view.evict(first, n);
+    });
+}
+
+// 其他格式（PLY、binary_compressed、ascii）：整体载入后转成 SoA 再释放，载入阶段的峰值不省。
+void loadFallback(const fs::path& input, LeanCloud* cloud, tsdf::PcdLoadInfo* info) {
+    CCCoreLib::PointCloud full = tsdf::loadCloud(input, info);
+    const std::size_t count = full.size();
+    cloud->resize(count);
+    if (count == 0) {
+        return;
+    }
+    const CCVector3* points = full.getPoint(0);
+    for (int k = 0; k < 3; ++k) {
+        cloud->origin[k] = std::round(points[0].u[k] / ORIGIN_STEP) * ORIGIN_STEP + 0.0;
+    }
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, count, CHUNK), [&](const tbb::blocked_range<std::size_t>& range) {
+        for (std::size_t i = range.begin(); i != range.end(); ++i) {
+            cloud->xs[i] = static_cast<float>(static_cast<double>(points[i].x) - cloud->origin[0]);
+            cloud->ys[i] = static_cast<float>(static_cast<double>(points[i].y) - cloud->origin[1]);
+            cloud->zs[i] = static_cast<float>(static_cast<double>(points[i].z) - cloud->origin[2]);
+        }
+    });
+}
+
+}  // namespace
+
+namespace tsdf {
+
+LeanFilterStats runLeanFilter(const fs::path& input, const fs::path& output, const FilterConfig& cfg, bool keepFields) {
+    if (!(cfg.radius > 0.0)) {
+        throw std::runtime_error("Filter.radius 必须大于 0");
+    }
+    LeanFilterStats stats;
+    const bool writeRecords = keepFields && !output.empty();
+
+    std::unique_ptr<PcdBinaryView> view;
+    LeanCloud cloud;
+    {
+        const auto start = std::chrono::steady_clock::now();
+        ScopedStage stage("lean_load");
+        if (cloudFormatOf(input) == PointCloudFormat::kPcd && readPcdHeader(input).data == PcdDataFormat::kBinary) {
+            view = std::make_unique<PcdBinaryView>(input);
+            loadFromView(*view, &cloud, &stats.decoder);
+            stats.dataBytes = view->size() * view->header().pointStep;
+            if (!writeRecords) {
+                view.reset();
+            }
+        } else {
+            PcdLoadInfo info;
+            loadFallback(input, &cloud, &info);
+            stats.decoder = info.decoder;
+            stats.dataBytes = info.dataBytes;
+        }
+        stats.inputPoints = cloud.xs.size();
+        std::copy(cloud.origin, cloud.origin + 3, stats.origin);
+        stage.setPoints(stats.inputPoints);
+        stage.addBytesRead(stats.dataBytes);
+        stats.loadMs = elapsedMs(start);
+    }
+
+    VoxelIndex index;
+    {
+        const auto start = std::chrono::steady_clock::now();
+        ScopedStage stage("lean_index");
+        stage.setPoints(stats.inputPoints);
+        index.adopt(std::move(cloud.xs), std::move(cloud.ys), std::move(cloud.zs), cfg.radius, writeRecords);
+        stats.cells = index.cellCount();
+        stats.indexMs = elapsedMs(start);
+    }
+
+    // 写原始记录时位图按原始索引置位，写出即按原始次序；否则按排序位置置位。
+    SelectionMask keep(stats.inputPoints);
+    {
+        const auto start = std::chrono::steady_clock::now();
+        ScopedStage stage("lean_filter");
+        stage.setPoints(stats.inputPoints);
+
+        // 每个线程的邻域缓冲是 arena 中定长的一段：27 邻域候选点与半径邻点各一组 SoA，长度取全图最大的 27 邻域点数。
+        const std::size_t maxCandidates = tbb::parallel_reduce(
+            tbb::blocked_range<std::size_t>(0, index.cellCount(), 1024),
+            std::size_t(0),
+            [&](const tbb::blocked_range<std::size_t>& range, std::size_t acc) {
+                VoxelIndex::Range ranges[27];
+                for (std::size_t c = range.begin(); c != range.end(); ++c) {
+                    const std::size_t cells = index.neighborCells(c, ranges);
+                    std::size_t total = 0;
+                    for (std::size_t r = 0; r < cells; ++r) {
+                        total += ranges[r].end - ranges[r].begin;
+                    }
+                    acc = std::max(acc, total);
+                }
+                return acc;
+            },
+            [](std::size_t a, std::size_t b) { return std::max(a, b); });
+        const std::size_t slots = static_cast<std::size_t>(tbb::this_task_arena::max_concurrency());
+        const std::size_t stride = 6 * maxCandidates;
+        const std::unique_ptr<float[]> arena(new float[std::max<std::size_t>(slots * stride, 1)]);
+        stats.scratchBytes = slots * stride * sizeof(float);
+
+        const PointCoordinateType radius = static_cast<PointCoordinateType>(cfg.radius);
+        const double squareRadius = static_cast<double>(radius) * radius;
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, index.cellCount(), 64), [&](const tbb::blocked_range<std::size_t>& range) {
+            const TraceSpan span("lean_filter_cells");
+            float* cx = arena.get() + static_cast<std::size_t>(tbb::this_task_arena::current_thread_index()) * stride;
+            float* cy = cx + maxCandidates;
+            float* cz = cy + maxCandidates;
+            float* nx = cz + maxCandidates;
+            float* ny = nx + maxCandidates;
+            float* nz = ny + maxCandidates;
+            const float* xs = index.xs();
+            const float* ys = index.ys();
+            const float* zs = index.zs();
+            VoxelIndex::Range ranges[27];
+            for (std::size_t c = range.begin(); c != range.end(); ++c) {
+                const VoxelIndex::Range own = index.cell(c);
+                const std::size_t cells = index.neighborCells(c, ranges);
+                std::size_t candidates = 0;
+                std::size_t ownOffset = 0;
+                for (std::size_t r = 0; r < cells; ++r) {
+                    const std::uint32_t n = ranges[r].end - ranges[r].begin;
+                    if (ranges[r].begin == own.begin) {
+                        ownOffset = candidates;
+                    }
+                    std::copy_n(xs + ranges[r].begin, n, cx + candidates);
+                    std::copy_n(ys + ranges[r].begin, n, cy + candidates);
+                    std::copy_n(zs + ranges[r].begin, n, cz + candidates);
+                    candidates += n;
+                }
+
+                for (std::uint32_t s = own.begin; s < own.end; ++s) {
+                    const CCVector3 query(xs[s], ys[s], zs[s]);
+                    const std::size_t self = ownOffset + (s - own.begin);
+                    std::size_t neighbors = 0;
+                    for (std::size_t k = 0; k < candidates; ++k) {
+                        const float dx = cx[k] - query.x;
+                        const float dy = cy[k] - query.y;
+                        const float dz = cz[k] - query.z;
+                        const double d2 = static_cast<double>(dx) * dx + static_cast<double>(dy) * dy + static_cast<double>(dz) * dz;
+                        if (d2 <= squareRadius && k != self) {
+                            nx[neighbors] = cx[k];
+                            ny[neighbors] = cy[k];
+                            nz[neighbors] = cz[k];
+                            ++neighbors;
+                        }
+                    }
+                    if (keepPoint(scoreNoise(query, nx, ny, nz, neighbors, cfg), cfg)) {
+                        keep.set(writeRecords ? index.originalIndex(s) : s);
+                    }
+                }
+            }
+        });
+        stats.keptPoints = keep.count();
+        stats.filterMs = elapsedMs(start);
+    }
+
+    if (output.empty()) {
+        return stats;
+    }
+    const auto writeStart = std::chrono::steady_clock::now();
+    ScopedStage stage("lean_write");
+    stage.setPoints(stats.keptPoints);
+    if (writeRecords) {
+        // DATA binary 沿用载入时的映射，其他格式另取记录；按块扫描位图，写完的文件页随即释放。
+        PcdRecords records;
+        if (!view) {
+            records = loadCloudRecords(input);
+        }
+        const PcdHeader& header = view ? view->header() : records.header();
+        const char* base = view ? view->record(0) : records.data();
+        const std::size_t step = header.pointStep;
+        CloudStreamWriter writer(output, header.fields);
+        std::vector<char> batch(CHUNK * step);
+        for (std::size_t first = 0; first < stats.inputPoints; first += CHUNK) {
+            const std::size_t n = std::min(CHUNK, stats.inputPoints - first);
+            std::size_t filled = 0;
+            for (std::size_t i = first; i < first + n; ++i) {
+                if (keep.test(i)) {
+                    std::memcpy(batch.data() + filled * step, base + i * step, step);
+                    ++filled;
+                }
+            }
+            writer.appendRecords(batch.data(), filled);
+            if (view) {
+                view->evict(first, n);
+            }
+        }
+        writer.close();
+    } else {
+        CloudStreamWriter writer(output);
+        std::vector<CCVector3> batch(CHUNK);
+        const float* xs = index.xs();
+        const float* ys = index.ys();
+        const float* zs = index.zs();
+        for (std::size_t first = 0; first < stats.inputPoints; first += CHUNK) {
+            const std::size_t n = std::min(CHUNK, stats.inputPoints - first);
+            std::size_t filled = 0;
+            for (std::size_t s = first; s < first + n; ++s) {
+                if (keep.test(s)) {
+                    batch[filled++] = CCVector3(static_cast<PointCoordinateType>(stats.origin[0] + xs[s]),
+                                                static_cast<PointCoordinateType>(stats.origin[1] + ys[s]),
+                                                static_cast<PointCoordinateType>(stats.origin[2] + zs[s]));
+                }
+            }
+            writer.append(batch.data(), filled);
+        }
+        writer.close();
+    }
+    stage.addBytesWritten(fs::file_size(output));
+    stats.writeMs = elapsedMs(writeStart);
+    return stats;
+}
+
+}  // namespace tsdf
@@ -0,0 +1,353 @@
+#include "lidar_dataset.h"
+
+#include "cloud_io.h"
+#include "stage_pipeline.h"
+#include "telemetry.h"
+
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cctype>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#if defined(__SSE2__)
+#include <xmmintrin.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+tsdf::FramePose poseFromQuaternion(const double* t, const double* q) {
+    double qx = q[0];
+    double qy = q[1];
+    double qz = q[2];
+    double qw = q[3];
+    const double norm = std::sqrt(qx * qx + qy * qy + qz * qz + qw * qw);
+    if (norm <= 0.0) {
+        throw std::runtime_error("位姿四元数为零");
+    }
+    qx /= norm;
+    qy /= norm;
+    qz /= norm;
+    qw /= norm;
+
+    tsdf::FramePose pose;
+    double* r = pose.rotation;
+    r[0] = 1 - 2 * (qy * qy + qz * qz);
+    r[1] = 2 * (qx * qy - qz * qw);
+    r[2] = 2 * (qx * qz + qy * qw);
+    r[3] = 2 * (qx * qy + qz * qw);
+    r[4] = 1 - 2 * (qx * qx + qz * qz);
+    r[5] = 2 * (qy * qz - qx * qw);
+    r[6] = 2 * (qx * qz - qy * qw);
+    r[7] = 2 * (qy * qz + qx * qw);
+    r[8] = 1 - 2 * (qx * qx + qy * qy);
+    std::copy(t, t + 3, pose.translation);
+    return pose;
+}
+
+tsdf::FramePose poseFromMatrix(const std::vector<double>& m) {
+    tsdf::FramePose pose;
+    for (int row = 0; row < 3; ++row) {
+        for (int col = 0; col < 3; ++col) {
+            pose.rotation[row * 3 + col] = m[static_cast<std::size_t>(row * 4 + col)];
+        }
+        pose.translation[row] = m[static_cast<std::size_t>(row * 4 + 3)];
+    }
+    return pose;
+}
+
+void allocateCloud(tsdf::LidarDataset& dataset, std::size_t total) {
+    if (total > std::numeric_limits<unsigned>::max()) {
+        throw std::runtime_error("点数超过 CCCoreLib 单云上限");
+    }
+    dataset.cloud = std::make_unique<CCCoreLib::PointCloud>();
+    if (!dataset.cloud->resize(static_cast<unsigned>(total))) {
+        throw std::runtime_error("点云预分配失败");
+    }
+}
+
+tsdf::LidarDataset loadWholeMap(const tsdf::AppConfig& config) {
+    tsdf::LidarDataset dataset;
+    tsdf::LidarFrame frame;
+    frame.path = config.base.depth_path;
+    frame.pointCount = tsdf::readCloudHeader(frame.path).pointCount;
+    allocateCloud(dataset, frame.pointCount);
+    if (frame.pointCount > 0) {
+        tsdf::loadCloudPoints(frame.path, dataset.cloud->point(0), frame.pointCount, &dataset.loadInfo,
+                              config.base.keep_fields ? &dataset.records : nullptr);
+    }
+    dataset.cloud->invalidateBoundingBox();
+    dataset.frames.push_back(frame);
+    return dataset;
+}
+
+// 流水线载入时一帧在读盘级与解码级之间传递的数据。
+struct FrameWork {
+    std::size_t index = 0;
+    std::vector<char> bytes;  // PCD 帧的整个文件内容；PLY 帧为空，由解码级按路径载入
+    tsdf::PcdLoadInfo info;
+};
+
+// Pipeline.enable 时：读盘级把 PCD 帧整文件读入内存，解码级解析 Header、解码 DATA 段并就地变换，
+// 读盘与解码在不同线程上重叠；在途帧数（即驻留的文件缓冲）不超过 max_inflight。
+std::vector<tsdf::PcdLoadInfo> loadFramesPipelined(const tsdf::AppConfig& config, tsdf::LidarDataset& dataset) {
+    std::vector<tsdf::PcdLoadInfo> infos(dataset.frames.size());
+    CCVector3* merged = dataset.cloud->point(0);
+    tsdf::StagePipeline<FrameWork> stages("frames", static_cast<std::size_t>(config.pipeline.max_inflight));
+    stages.source("read", config.pipeline.readers, dataset.frames.size(), [&](std::size_t seq, FrameWork& work) {
+        const tsdf::TraceSpan span("frame_read");
+        work.index = seq;
+        const fs::path& path = dataset.frames[seq].path;
+        if (tsdf::cloudFormatOf(path) == tsdf::PointCloudFormat::kPly) {
+            return;
+        }
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (in) {
+            work.bytes.resize(static_cast<std::size_t>(in.tellg()));
+            in.seekg(0);
+            in.read(work.bytes.data(), static_cast<std::streamsize>(work.bytes.size()));
+        }
+        if (!in) {
+            throw std::runtime_error("无法读取帧: " + path.string());
+        }
+    });
+    stages.stage("decode", config.pipeline.decoders, [&](FrameWork& work) {
+        const tsdf::TraceSpan span("frame_decode");
+        const tsdf::LidarFrame& frame = dataset.frames[work.index];
+        CCVector3* dst = merged + frame.pointOffset;
+        std::size_t loaded = 0;
+        if (work.bytes.empty()) {
+            loaded = tsdf::loadCloudPoints(frame.path, dst, frame.pointCount, &work.info);
+        } else {
+            std::size_t dataOffset = 0;
+            const tsdf::PcdHeader header = tsdf::parseBinaryHeader(work.bytes.data(), work.bytes.size(), &dataOffset);
+            loaded = header.pointCount;
+            if (loaded == frame.pointCount) {
+                tsdf::decodeDataBlock(work.bytes.data() + dataOffset, work.bytes.size() - dataOffset, header, dst, &work.info.decoder);
+            }
+            work.info.dataBytes = work.bytes.size() - dataOffset;
+            work.bytes = std::vector<char>();
+        }
+        if (loaded != frame.pointCount) {
+            throw std::runtime_error("帧点数在载入期间发生变化: " + frame.path.string());
+        }
+        tsdf::transformPoints(frame.pose, dst, loaded);
+    });
+    stages.sink("merge", [&](FrameWork& work) { infos[work.index] = work.info; });
+    dataset.pipeline = stages.run();
+    return infos;
+}
+
+// 先并行只读各帧 Header 得到点数与偏移，一次性预分配合并点云；
+// 再按帧并行解码到各自的区间并就地变换。每个任务只持有一帧的映射，
+// 同时在途的帧数不超过工作线程数，内存占用与帧总数无关。
+tsdf::LidarDataset loadFrameSequence(const tsdf::AppConfig& config) {
+    const std::string extension = tsdf::cloudExtension(config.base.pointcloud_format);
+    const std::vector<fs::path> files = tsdf::listFrameFiles(config.base.depth_path, extension);
+    if (files.empty()) {
+        throw std::runtime_error("目录下没有 " + extension + " 帧: " + config.base.depth_path.string());
+    }
+    const std::vector<tsdf::FramePose> poses = tsdf::loadPoses(config.base.depth_pose);
+    if (poses.size() < files.size()) {
+        throw std::runtime_error("位姿数量 (" + std::to_string(poses.size()) + ") 少于帧数 (" + std::to_string(files.size()) + ")");
+    }
+
+    tsdf::LidarDataset dataset;
+    dataset.frames.resize(files.size());
+    tbb::parallel_for(std::size_t(0), files.size(), [&](std::size_t i) {
+        dataset.frames[i].path = files[i];
+        dataset.frames[i].pointCount = tsdf::readCloudHeader(files[i]).pointCount;
+        dataset.frames[i].pose = poses[i];
+    });
+
+    std::size_t total = 0;
+    for (tsdf::LidarFrame& frame : dataset.frames) {
+        frame.pointOffset = total;
+        total += frame.pointCount;
+    }
+    allocateCloud(dataset, total);
+
+    std::vector<tsdf::PcdLoadInfo> infos(files.size());
+    if (total > 0 && config.pipeline.enable) {
+        infos = loadFramesPipelined(config, dataset);
+    } else if (total > 0) {
+        CCVector3* merged = dataset.cloud->point(0);
+        tbb::parallel_for(std::size_t(0), files.size(), [&](std::size_t i) {
+            const tsdf::TraceSpan span("load_frame");
+            const tsdf::LidarFrame& frame = dataset.frames[i];
+            CCVector3* dst = merged + frame.pointOffset;
+            const std::size_t loaded = tsdf::loadCloudPoints(frame.path, dst, frame.pointCount, &infos[i]);
+            if (loaded != frame.pointCount) {
+                throw std::runtime_error("帧点数在载入期间发生变化: " + frame.path.string());
+            }
+            tsdf::transformPoints(frame.pose, dst, loaded);
+        });
+    }
+    dataset.cloud->invalidateBoundingBox();
+
+    dataset.loadInfo.mapped = true;
+    dataset.loadInfo.decoder = infos.front().decoder;
+    for (const tsdf::PcdLoadInfo& info : infos) {
+        dataset.loadInfo.mapped = dataset.loadInfo.mapped && info.mapped;
+        dataset.loadInfo.dataBytes += info.dataBytes;
+    }
+    return dataset;
+}
+
+}  // namespace
+
+namespace tsdf {
+
+std::size_t LidarDataset::frameOf(std::size_t index) const {
+    const auto it = std::upper_bound(frames.begin(), frames.end(), index, [](std::size_t value, const LidarFrame& frame) {
+        return value < frame.pointOffset;
+    });
+    return it == frames.begin() ? 0 : static_cast<std::size_t>(it - frames.begin()) - 1;
+}
+
+std::vector<fs::path> listFrameFiles(const fs::path& dir, const std::string& extension) {
+    if (!fs::is_directory(dir)) {
+        throw std::runtime_error("多帧模式要求 Base.depth_path 为目录: " + dir.string());
+    }
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        std::string ext = entry.path().extension().string();
+        for (char& c : ext) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        if (entry.is_regular_file() && ext == extension) {
+            files.push_back(entry.path());
+        }
+    }
+    const bool numeric = std::all_of(files.begin(), files.end(), [](const fs::path& p) {
+        const std::string stem = p.stem().string();
+        return !stem.empty() && std::all_of(stem.begin(), stem.end(), [](unsigned char c) { return std::isdigit(c); });
+    });
+    std::sort(files.begin(), files.end(), [numeric](const fs::path& a, const fs::path& b) {
+        if (numeric) {
+            const std::string sa = a.stem().string();
+            const std::string sb = b.stem().string();
+            if (sa.size() != sb.size()) {
+                return sa.size() < sb.size();
+            }
+            return sa < sb;
+        }
+        return a.filename() < b.filename();
+    });
+    return files;
+}
+
+bool parsePoseLine(const std::string& line, std::size_t lineNo, const fs::path& file, FramePose* pose) {
+    const auto first = line.find_first_not_of(" \t\r");
+    if (first == std::string::npos || line[first] == '#') {
+        return false;
+    }
+    std::istringstream iss(line);
+    std::vector<double> values;
+    double v = 0.0;
+    while (iss >> v) {
+        values.push_back(v);
+    }
+    if (!iss.eof()) {
+        throw std::runtime_error("位姿文件第 " + std::to_string(lineNo) + " 行解析失败: " + file.string());
+    }
+    switch (values.size()) {
+        case 7:
+            *pose = poseFromQuaternion(values.data(), values.data() + 3);
+            return true;
+        case 8:
+            *pose = poseFromQuaternion(values.data() + 1, values.data() + 4);
+            return true;
+        case 12:
+        case 16:
+            *pose = poseFromMatrix(values);
+            return true;
+        default:
+            throw std::runtime_error("位姿文件第 " + std::to_string(lineNo) + " 行列数不支持 (" + std::to_string(values.size()) + ")");
+    }
+}
+
+std::vector<FramePose> loadPoses(const fs::path& file) {
+    std::ifstream in(file);
+    if (!in) {
+        throw std::runtime_error("无法打开位姿文件: " + file.string());
+    }
+
+    std::vector<FramePose> poses;
+    std::string line;
+    std::size_t lineNo = 0;
+    FramePose pose;
+    while (std::getline(in, line)) {
+        if (parsePoseLine(line, ++lineNo, file, &pose)) {
+            poses.push_back(pose);
+        }
+    }
+    return poses;
+}
+
+void transformPoints(const FramePose& pose, CCVector3* points, std::size_t count) {
+    float r[9];
+    float t[3];
+    for (int k = 0; k < 9; ++k) {
+        r[k] = static_cast<float>(pose.rotation[k]);
+    }
+    for (int k = 0; k < 3; ++k) {
+        t[k] = static_cast<float>(pose.translation[k]);
+    }
+
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    static_assert(sizeof(CCVector3) == 3 * sizeof(float), "CCVector3 须为紧密排列的 3 个 float");
+    float* data = reinterpret_cast<float*>(points);
+    for (; i + 4 <= count; i += 4) {
+        float* p = data + 3 * i;
+        // 4 个点 = 3 个向量 (x0 y0 z0 x1)(y1 z1 x2 y2)(z2 x3 y3 z3)，先拆成 SoA 再做矩阵乘。
+        const __m128 v0 = _mm_loadu_ps(p);
+        const __m128 v1 = _mm_loadu_ps(p + 4);
+        const __m128 v2 = _mm_loadu_ps(p + 8);
+        const __m128 x = _mm_shuffle_ps(v0, _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+        const __m128 y = _mm_shuffle_ps(_mm_shuffle_ps(v0, v1, _MM_SHUFFLE(0, 0, 1, 1)),
+                                        _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 z = _mm_shuffle_ps(_mm_shuffle_ps(v0, v1, _MM_SHUFFLE(1, 1, 2, 2)), v2, _MM_SHUFFLE(3, 0, 2, 0));
+
+        __m128 out[3];
+        for (int row = 0; row < 3; ++row) {
+            out[row] = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(r[row * 3]), x), _mm_mul_ps(_mm_set1_ps(r[row * 3 + 1]), y)),
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(r[row * 3 + 2]), z), _mm_set1_ps(t[row])));
+        }
+        const __m128& ox = out[0];
+        const __m128& oy = out[1];
+        const __m128& oz = out[2];
+        _mm_storeu_ps(p, _mm_shuffle_ps(_mm_shuffle_ps(ox, oy, _MM_SHUFFLE(0, 0, 0, 0)),
+                                        _mm_shuffle_ps(oz, ox, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(p + 4, _mm_shuffle_ps(_mm_shuffle_ps(oy, oz, _MM_SHUFFLE(1, 1, 1, 1)),
+                                            _mm_shuffle_ps(ox, oy, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(p + 8, _mm_shuffle_ps(_mm_shuffle_ps(oz, ox, _MM_SHUFFLE(3, 3, 2, 2)),
+                                            _mm_shuffle_ps(oy, oz, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+    }
+#endif
+    for (; i < count; ++i) {
+        const CCVector3 p = points[i];
+        points[i] = CCVector3(
+            r[0] * p.x + r[1] * p.y + r[2] * p.z + t[0],
+            r[3] * p.x + r[4] * p.y + r[5] * p.z + t[1],
+            r[6] * p.x + r[7] * p.y + r[8] * p.z + t[2]);
+    }
+}
+
+LidarDataset loadLidarDataset(const AppConfig& config) {
+    if (config.base.load_mode == PointCloudLoadMode::kFrameSequence) {
+        return loadFrameSequence(config);
+    }
+    return loadWholeMap(config);
+}
+
+}  // namespace tsdf
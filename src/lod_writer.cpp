@@ -0,0 +1,331 @@
+#include "lod_writer.h"
+
+#include "cloud_io.h"
+#include "morton.h"
+#include "radix_sort.h"
+#include "telemetry.h"
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr int KEY_LEVELS = static_cast<int>(tsdf::MORTON_AXIS_BITS);
+constexpr int KEY_BITS = 3 * KEY_LEVELS;
+constexpr std::size_t GRAIN = 1 << 14;
+constexpr std::size_t WRITE_BATCH = 1 << 16;
+constexpr std::uint32_t INDEX_VERSION = 1;
+// 非有限坐标的点不进金字塔，排序时用全 1 键排到末尾后截掉。
+constexpr std::uint64_t REJECTED = std::numeric_limits<std::uint64_t>::max();
+// 编码完全相同的点在任何层都不是采样格的首点，归入最深一层。
+constexpr std::uint8_t DEEPEST = std::numeric_limits<std::uint8_t>::max();
+
+struct Box {
+    double min[3] = {std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+    double max[3] = {std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest()};
+
+    void add(const CCVector3& p) {
+        for (unsigned k = 0; k < 3; ++k) {
+            min[k] = std::min(min[k], static_cast<double>(p.u[k]));
+            max[k] = std::max(max[k], static_cast<double>(p.u[k]));
+        }
+    }
+
+    void join(const Box& other) {
+        for (unsigned k = 0; k < 3; ++k) {
+            min[k] = std::min(min[k], other.min[k]);
+            max[k] = std::max(max[k], other.max[k]);
+        }
+    }
+};
+
+bool finite(const CCVector3& p) {
+    return std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z);
+}
+
+// 第 level 层节点编码：63 位编码的高 3*level 位。
+inline std::uint64_t nodeKey(std::uint64_t key, int level) {
+    return key >> (KEY_BITS - 3 * level);
+}
+
+int log2Exact(int v) {
+    int r = 0;
+    while ((1 << r) < v) {
+        ++r;
+    }
+    return r;
+}
+
+// 第 leaf 层各节点中层号 >= leaf 的点数（即该层作为最深层时单节点的点数）的最大值。
+// 按块并行，块边界向后移到节点边界，使每个节点只落在一个块内。
+// 跨过多个块的大节点只扫描一次：下一块从上一块已移到的边界之后开始找，总扫描量为 O(n)。
+std::size_t maxLeafNodePoints(const std::vector<tsdf::KeyIndex>& items, const std::vector<std::uint8_t>& levels, int leaf) {
+    const std::size_t n = items.size();
+    const std::size_t chunks = std::max<std::size_t>(1, (n + GRAIN - 1) / GRAIN);
+    std::vector<std::size_t> starts(chunks + 1, n);
+    starts[0] = 0;
+    for (std::size_t c = 1; c < chunks; ++c) {
+        std::size_t s = std::max(c * GRAIN, starts[c - 1]);
+        while (s > 0 && s < n && nodeKey(items[s].key, leaf) == nodeKey(items[s - 1].key, leaf)) {
+            ++s;
+        }
+        starts[c] = s;
+    }
+    return tbb::parallel_reduce(
+        tbb::blocked_range<std::size_t>(0, chunks), std::size_t{0},
+        [&](const tbb::blocked_range<std::size_t>& r, std::size_t best) {
+            for (std::size_t c = r.begin(); c != r.end(); ++c) {
+                std::size_t run = 0;
+                for (std::size_t j = starts[c]; j < starts[c + 1]; ++j) {
+                    if (j > starts[c] && nodeKey(items[j].key, leaf) != nodeKey(items[j - 1].key, leaf)) {
+                        run = 0;
+                    }
+                    if (levels[j] >= leaf) {
+                        best = std::max(best, ++run);
+                    }
+                }
+            }
+            return best;
+        },
+        [](std::size_t a, std::size_t b) { return std::max(a, b); });
+}
+
+void writeIndex(const fs::path& path,
+                const tsdf::LodIndexHeader& header,
+                const std::vector<tsdf::LodLevelEntry>& levels,
+                const std::vector<tsdf::LodNodeEntry>& nodes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("无法写出 LOD 索引: " + path.string());
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(levels.data()), static_cast<std::streamsize>(levels.size() * sizeof(tsdf::LodLevelEntry)));
+    out.write(reinterpret_cast<const char*>(nodes.data()), static_cast<std::streamsize>(nodes.size() * sizeof(tsdf::LodNodeEntry)));
+    if (!out) {
+        throw std::runtime_error("写出 LOD 索引失败: " + path.string());
+    }
+}
+
+}  // namespace
+
+namespace tsdf {
+
+LodStats writeLodPyramid(const fs::path& dir,
+                         const CCCoreLib::ReferenceCloud& kept,
+                         const PcdRecords* records,
+                         const LodConfig& cfg,
+                         const std::string& extension) {
+    const auto sortStart = std::chrono::steady_clock::now();
+    const std::size_t count = kept.size();
+    const int gridBits = log2Exact(cfg.grid);
+    const int maxLeaf = KEY_LEVELS - gridBits;
+
+    const Box box = tbb::parallel_reduce(
+        tbb::blocked_range<std::size_t>(0, count, GRAIN), Box{},
+        [&](const tbb::blocked_range<std::size_t>& r, Box local) {
+            for (std::size_t i = r.begin(); i != r.end(); ++i) {
+                const CCVector3& p = *kept.getPoint(static_cast<unsigned>(i));
+                if (finite(p)) {
+                    local.add(p);
+                }
+            }
+            return local;
+        },
+        [](Box a, const Box& b) {
+            a.join(b);
+            return a;
+        });
+    double size = 0.0;
+    for (unsigned k = 0; k < 3; ++k) {
+        size = std::max(size, box.max[k] - box.min[k]);
+    }
+    // 稍放大使最大坐标仍落在最后一格内；全部点重合时取单位边长。
+    size = size > 0.0 ? size * (1.0 + 1e-6) : 1.0;
+    const double scale = static_cast<double>(1u << KEY_LEVELS) / size;
+
+    std::vector<KeyIndex> items(count);
+    std::atomic<std::size_t> rejected{0};
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, count, GRAIN), [&](const tbb::blocked_range<std::size_t>& r) {
+        std::size_t localRejected = 0;
+        for (std::size_t i = r.begin(); i != r.end(); ++i) {
+            const CCVector3& p = *kept.getPoint(static_cast<unsigned>(i));
+            items[i].index = static_cast<std::uint32_t>(i);
+            if (!finite(p)) {
+                items[i].key = REJECTED;
+                ++localRejected;
+                continue;
+            }
+            std::uint64_t key = 0;
+            for (unsigned k = 0; k < 3; ++k) {
+                const auto cell = static_cast<std::uint64_t>(std::max(0.0, (p.u[k] - box.min[k]) * scale));
+                key |= spreadBits(std::min(cell, MORTON_AXIS_MAX)) << k;
+            }
+            items[i].key = key;
+        }
+        if (localRejected > 0) {
+            rejected += localRejected;
+        }
+    });
+    radixSortByKey(items, rejected > 0 ? 64u : static_cast<unsigned>(KEY_BITS));
+    items.resize(count - rejected);
+    const std::size_t n = items.size();
+
+    // 点所在的最粗层：与前一点编码的最高不同位决定二者从哪一层的采样格（节点边长 / grid）起分开，
+    // 即该点是哪些层上其采样格的首点。
+    std::vector<std::uint8_t> levels(n);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, n, GRAIN), [&](const tbb::blocked_range<std::size_t>& r) {
+        for (std::size_t j = r.begin(); j != r.end(); ++j) {
+            if (j == 0) {
+                levels[j] = 0;
+                continue;
+            }
+            const std::uint64_t diff = items[j].key ^ items[j - 1].key;
+            if (diff == 0) {
+                levels[j] = DEEPEST;
+                continue;
+            }
+            const int highBit = 63 - __builtin_clzll(diff);
+            levels[j] = static_cast<std::uint8_t>(std::max(0, KEY_LEVELS - gridBits - highBit / 3));
+        }
+    });
+
+    // 最深层取满足单节点点数上限的最浅一层；层越深单节点点数越少，二分查找。
+    int leaf = maxLeaf;
+    if (n > 0) {
+        int lo = 0;
+        int hi = maxLeaf;
+        while (lo < hi) {
+            const int mid = (lo + hi) / 2;
+            if (maxLeafNodePoints(items, levels, mid) <= static_cast<std::size_t>(cfg.max_node_points)) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+        leaf = lo;
+    } else {
+        leaf = -1;
+    }
+    const std::size_t levelCount = static_cast<std::size_t>(leaf + 1);
+
+    // 按层稳定分组：同层内保持 Morton 序，节点的点连续。
+    std::vector<KeyIndex> order(n);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, n, GRAIN), [&](const tbb::blocked_range<std::size_t>& r) {
+        for (std::size_t j = r.begin(); j != r.end(); ++j) {
+            order[j].key = std::min<int>(levels[j], leaf);
+            order[j].index = static_cast<std::uint32_t>(j);
+        }
+    });
+    std::vector<std::uint8_t>().swap(levels);
+    radixSortByKey(order, 8);
+    std::vector<std::size_t> levelStart(levelCount + 1, n);
+    for (std::size_t j = n; j-- > 0;) {
+        levelStart[order[j].key] = j;
+    }
+    for (std::size_t d = levelCount; d-- > 0;) {
+        levelStart[d] = std::min(levelStart[d], levelStart[d + 1]);
+    }
+
+    LodStats stats;
+    stats.levels = levelCount;
+    stats.points = n;
+    stats.sortMs = elapsedMs(sortStart);
+
+    const auto writeStart = std::chrono::steady_clock::now();
+    fs::create_directories(dir);
+    // 上次运行可能分了更多层，先清掉旧的层文件。
+    for (const fs::directory_entry& entry : fs::directory_iterator(dir)) {
+        if (entry.is_regular_file() && entry.path().filename().string().rfind("level_", 0) == 0) {
+            fs::remove(entry.path());
+        }
+    }
+    if (!recordsCover(kept, records)) {
+        records = nullptr;
+    }
+    const std::vector<PcdField> xyzFields = {{"x", 4, 'F', 1, 0}, {"y", 4, 'F', 1, 4}, {"z", 4, 'F', 1, 8}};
+    const std::vector<PcdField>& fields = records ? records->header().fields : xyzFields;
+    std::size_t recordSize = 0;
+    for (const PcdField& field : fields) {
+        recordSize += static_cast<std::size_t>(field.size) * static_cast<std::size_t>(field.count);
+    }
+    const std::size_t step = records ? records->header().pointStep : recordSize;
+
+    std::vector<LodLevelEntry> levelEntries(levelCount);
+    std::vector<std::vector<LodNodeEntry>> levelNodes(levelCount);
+    tbb::parallel_for(std::size_t{0}, levelCount, [&](std::size_t d) {
+        const TraceSpan span("lod_level");
+        const std::size_t first = levelStart[d];
+        const std::size_t total = levelStart[d + 1] - first;
+        const fs::path path = dir / ("level_" + std::to_string(d) + extension);
+        std::vector<LodNodeEntry>& nodes = levelNodes[d];
+        {
+            CloudStreamWriter writer(path, fields);
+            std::vector<char> batch(std::min(WRITE_BATCH, std::max<std::size_t>(total, 1)) * recordSize);
+            for (std::size_t begin = 0; begin < total; begin += WRITE_BATCH) {
+                const std::size_t len = std::min(WRITE_BATCH, total - begin);
+                for (std::size_t i = 0; i < len; ++i) {
+                    const std::size_t pos = begin + i;
+                    const KeyIndex& item = items[order[first + pos].index];
+                    const std::uint64_t node = nodeKey(item.key, static_cast<int>(d));
+                    if (nodes.empty() || nodes.back().key != node) {
+                        nodes.push_back({node, static_cast<std::uint32_t>(d), 0, pos, 0});
+                    }
+                    ++nodes.back().count;
+                    if (records) {
+                        const std::size_t global = kept.getPointGlobalIndex(item.index);
+                        std::memcpy(batch.data() + i * recordSize, records->data() + global * step, recordSize);
+                    } else {
+                        std::memcpy(batch.data() + i * recordSize, kept.getPoint(item.index), recordSize);
+                    }
+                }
+                writer.appendRecords(batch.data(), len);
+            }
+            writer.close();
+        }
+        levelEntries[d].points = total;
+        levelEntries[d].dataOffset = fs::file_size(path) - total * recordSize;
+    });
+
+    std::vector<LodNodeEntry> nodes;
+    for (std::size_t d = 0; d < levelCount; ++d) {
+        levelEntries[d].firstNode = nodes.size();
+        levelEntries[d].nodeCount = levelNodes[d].size();
+        for (const LodNodeEntry& node : levelNodes[d]) {
+            stats.maxNodePoints = std::max<std::size_t>(stats.maxNodePoints, node.count);
+        }
+        nodes.insert(nodes.end(), levelNodes[d].begin(), levelNodes[d].end());
+    }
+
+    LodIndexHeader header{};
+    std::memcpy(header.magic, "LMLOD", 5);
+    header.version = INDEX_VERSION;
+    header.levels = static_cast<std::uint32_t>(levelCount);
+    header.grid = static_cast<std::uint32_t>(cfg.grid);
+    header.pointStep = static_cast<std::uint32_t>(recordSize);
+    header.points = n;
+    header.nodes = nodes.size();
+    for (unsigned k = 0; k < 3; ++k) {
+        header.origin[k] = n > 0 ? box.min[k] : 0.0;
+    }
+    header.size = size;
+    writeIndex(dir / "index.bin", header, levelEntries, nodes);
+
+    stats.nodes = nodes.size();
+    stats.writeMs = elapsedMs(writeStart);
+    return stats;
+}
+
+}  // namespace tsdf
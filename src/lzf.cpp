@@ -0,0 +1,59 @@
+#include "lzf.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace tsdf {
+
+std::size_t lzfDecompress(const char* input, std::size_t inputSize, char* output, std::size_t outputSize) {
+    const auto* ip = reinterpret_cast<const unsigned char*>(input);
+    const auto* const inEnd = ip + inputSize;
+    auto* op = reinterpret_cast<unsigned char*>(output);
+    auto* const outBegin = op;
+    auto* const outEnd = op + outputSize;
+
+    while (ip < inEnd) {
+        std::size_t ctrl = *ip++;
+        if (ctrl < (1u << 5)) {
+            // 字面量段：ctrl + 1 个原样字节。
+            const std::size_t len = ctrl + 1;
+            if (static_cast<std::size_t>(inEnd - ip) < len || static_cast<std::size_t>(outEnd - op) < len) {
+                throw std::runtime_error("LZF 数据损坏: 字面量越界");
+            }
+            std::memcpy(op, ip, len);
+            ip += len;
+            op += len;
+            continue;
+        }
+
+        // 回溯引用：长度高 3 位（7 表示再读一个字节），偏移 13 位。
+        std::size_t len = ctrl >> 5;
+        if (ip >= inEnd) {
+            throw std::runtime_error("LZF 数据损坏: 引用截断");
+        }
+        if (len == 7) {
+            len += *ip++;
+            if (ip >= inEnd) {
+                throw std::runtime_error("LZF 数据损坏: 引用截断");
+            }
+        }
+        len += 2;
+        const std::size_t back = ((ctrl & 0x1f) << 8) + *ip++ + 1;
+        if (static_cast<std::size_t>(op - outBegin) < back || static_cast<std::size_t>(outEnd - op) < len) {
+            throw std::runtime_error("LZF 数据损坏: 引用越界");
+        }
+        const unsigned char* ref = op - back;
+        if (back >= len) {
+            std::memcpy(op, ref, len);
+            op += len;
+        } else {
+            // 源与目标重叠时只能逐字节复制（用于重复模式展开）。
+            for (std::size_t i = 0; i < len; ++i) {
+                *op++ = *ref++;
+            }
+        }
+    }
+    return static_cast<std::size_t>(op - outBegin);
+}
+
+}  // namespace tsdf
@@ -0,0 +1,109 @@
+#include "job_runner.h"
+#include "job_server.h"
+#include "params.h"
+#include "shard_filter.h"
+#include "telemetry.h"
+#include "tiled_filter.h"
+
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 启用 Telemetry 时在 main 退出（含异常展开）时写出 JSON 报告与可选的 trace 文件。
+class TelemetryOutput {
+public:
+    explicit TelemetryOutput(const tsdf::AppConfig& cfg) : cfg_(cfg) {
+        if (!cfg_.telemetry.enable) {
+            return;
+        }
+        tsdf::Telemetry& telemetry = tsdf::Telemetry::instance();
+        telemetry.enable(cfg_.telemetry.trace);
+        telemetry.setInfo("input", cfg_.base.depth_path.string());
+        telemetry.setInfo("engine", tsdf::engineName(cfg_.filter.engine));
+        telemetry.setInfo("filter_mode", tsdf::filterModeName(cfg_.filter.modes));
+        telemetry.setInfo("mode", cfg_.watch.enable ? "watch" : cfg_.sweep.enable ? "sweep" : cfg_.shard.enable ? "shard" : (tsdf::tiledFilterEnabled(cfg_.filter) ? "tiled" : (cfg_.filter.lean ? "lean" : "filter")));
+    }
+
+    ~TelemetryOutput() {
+        if (!cfg_.telemetry.enable) {
+            return;
+        }
+        try {
+            const fs::path dir = tsdf::resolveOutputPath(cfg_).parent_path();
+            const std::string stem = cfg_.base.depth_path.stem().string();
+            const fs::path report = cfg_.telemetry.report_path.empty() ? dir / (stem + "_telemetry.json") : cfg_.telemetry.report_path;
+            tsdf::Telemetry::instance().writeReport(report);
+            std::cout << "度量报告: " << report << '\n';
+            if (cfg_.telemetry.trace) {
+                const fs::path trace = cfg_.telemetry.trace_path.empty() ? dir / (stem + "_trace.json") : cfg_.telemetry.trace_path;
+                tsdf::Telemetry::instance().writeTrace(trace);
+                std::cout << "Trace: " << trace << '\n';
+            }
+        } catch (const std::exception& ex) {
+            std::cerr << "度量文件写出失败: " << ex.what() << '\n';
+        }
+    }
+
+    TelemetryOutput(const TelemetryOutput&) = delete;
+    TelemetryOutput& operator=(const TelemetryOutput&) = delete;
+
+private:
+    const tsdf::AppConfig& cfg_;
+};
+
+void printUsage() {
+    std::cerr << "Usage: livomesh_app <config.yaml> [Section.key=value ...]\n"
+              << "       livomesh_app --serve <socket> [max_jobs]\n"
+              << "       livomesh_app --submit <socket> <config.yaml> [Section.key=value ...]\n"
+              << "       livomesh_app --shard-worker <filter.yaml> <tile.bin> <tile.kept>\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+
+    try {
+        const std::string command = argv[1];
+        if (command == "--serve") {
+            if (argc < 3) {
+                printUsage();
+                return 1;
+            }
+            tsdf::runJobServer(argv[2], argc > 3 ? std::stoi(argv[3]) : 2);
+            return 0;
+        }
+        if (command == "--submit") {
+            if (argc < 4) {
+                printUsage();
+                return 1;
+            }
+            return tsdf::submitJob(argv[2], argv[3], std::vector<std::string>(argv + 4, argv + argc), std::cout) ? 0 : 1;
+        }
+        if (command == "--shard-worker") {
+            if (argc < 5) {
+                printUsage();
+                return 1;
+            }
+            tsdf::runShardWorker(argv[2], argv[3], argv[4]);
+            return 0;
+        }
+
+        const tsdf::AppConfig cfg = tsdf::loadAppConfig(argv[1], std::vector<std::string>(argv + 2, argv + argc));
+        const TelemetryOutput telemetryOutput(cfg);
+        tsdf::runJob(cfg, std::cout);
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "处理失败: " << ex.what() << '\n';
+        return 1;
+    }
+}
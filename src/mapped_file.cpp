@@ -0,0 +1,133 @@
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LIVOMESH_HAS_MMAP 1
+#endif
+
+namespace tsdf {
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+#ifdef LIVOMESH_HAS_MMAP
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* addr = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            data_ = static_cast<const char*>(addr);
+            size_ = static_cast<std::size_t>(st.st_size);
+            // 解码阶段会并行访问整段数据，提前让内核预读。
+            ::madvise(addr, size_, MADV_WILLNEED);
+        }
+    }
+    // 映射建立后即可关闭描述符，映射本身保持有效。
+    ::close(fd);
+#else
+    (void)path;
+#endif
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+void MappedFile::evict(std::size_t offset, std::size_t length) const {
+#ifdef LIVOMESH_HAS_MMAP
+    if (!data_ || offset >= size_) {
+        return;
+    }
+    const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const std::size_t begin = (offset + page - 1) / page * page;
+    const std::size_t end = std::min(offset + length, size_) / page * page;
+    if (begin < end) {
+        ::madvise(const_cast<char*>(data_) + begin, end - begin, MADV_DONTNEED);
+    }
+#else
+    (void)offset;
+    (void)length;
+#endif
+}
+
+void MappedFile::release() {
+#ifdef LIVOMESH_HAS_MMAP
+    if (data_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
+
+MappedOutputFile::MappedOutputFile(const std::filesystem::path& path, std::size_t size) : path_(path.string()), size_(size) {
+#ifdef LIVOMESH_HAS_MMAP
+    if (size == 0) {
+        return;
+    }
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+        return;
+    }
+    if (::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+        ::close(fd_);
+        fd_ = -1;
+        return;
+    }
+    void* addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (addr == MAP_FAILED) {
+        ::close(fd_);
+        fd_ = -1;
+        return;
+    }
+    data_ = static_cast<char*>(addr);
+#else
+    (void)path;
+#endif
+}
+
+MappedOutputFile::~MappedOutputFile() {
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+void MappedOutputFile::close() {
+#ifdef LIVOMESH_HAS_MMAP
+    bool ok = true;
+    if (data_) {
+        ok = ::munmap(data_, size_) == 0;
+        data_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ok = ::close(fd_) == 0 && ok;
+        fd_ = -1;
+    }
+    if (!ok) {
+        throw std::runtime_error("写出点云失败: " + path_);
+    }
+#endif
+}
+
+}  // namespace tsdf
@@ -0,0 +1,504 @@
+#include "native_noise_filter.h"
+
+#include "noise_filter.h"
+#include "telemetry.h"
+#include "voxel_index.h"
+
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_invoke.h>
+#include <tbb/task_arena.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+
+// kNN 壳层外扩的最大层数；更远的近邻（远离其余点的离群点）改由 CellTree 查找，逐层探查的体素数有上界。
+// 点云稀疏到 27 邻域普遍装不下 k 个近邻时不外扩，直接查 CellTree。
+constexpr int KNN_MAX_RING = 4;
+// CellTree 叶节点的体素数与并行建树的最小区间。
+constexpr std::size_t TREE_LEAF_CELLS = 8;
+constexpr std::size_t TREE_PARALLEL_CELLS = 1 << 14;
+
+// 每线程复用的邻域缓冲：一个体素的 27 邻域候选点与单个查询点的半径邻点，均为 SoA；
+// d2 / shell / frontier 供统计离群判据求 kNN，knn 为本线程的 kNN 计数。
+struct GatherScratch {
+    std::vector<float> cx, cy, cz;
+    std::vector<std::uint32_t> sorted;
+    std::vector<float> nx, ny, nz;
+    std::vector<double> d2;
+    std::vector<tsdf::VoxelIndex::Range> shell;
+    std::vector<std::pair<double, std::size_t>> frontier;
+    tsdf::NativeKnnStats knn;
+};
+
+double squaredDistance(const CCVector3& query, float x, float y, float z) {
+    const float dx = x - query.x;
+    const float dy = y - query.y;
+    const float dz = z - query.z;
+    return static_cast<double>(dx) * dx + static_cast<double>(dy) * dy + static_cast<double>(dz) * dz;
+}
+
+struct Box {
+    float min[3] = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+    float max[3] = {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+
+    void add(float x, float y, float z) {
+        const float p[3] = {x, y, z};
+        for (int k = 0; k < 3; ++k) {
+            min[k] = std::min(min[k], p[k]);
+            max[k] = std::max(max[k], p[k]);
+        }
+    }
+
+    void join(const Box& other) {
+        for (int k = 0; k < 3; ++k) {
+            min[k] = std::min(min[k], other.min[k]);
+            max[k] = std::max(max[k], other.max[k]);
+        }
+    }
+
+    // 查询点到盒内任一点的平方距离下界。
+    double lowerBound(const CCVector3& query) const {
+        double sum = 0.0;
+        for (int k = 0; k < 3; ++k) {
+            const double d = std::max({0.0, static_cast<double>(min[k]) - query.u[k], static_cast<double>(query.u[k]) - max[k]});
+            sum += d * d;
+        }
+        return sum;
+    }
+};
+
+// 非空体素上的 kd 树：叶为至多 TREE_LEAF_CELLS 个体素，节点存子树内点的包围盒，隐式完全二叉树布局（子节点 2i+1 / 2i+2）。
+// kNN 按包围盒距离下界最优先遍历，只访问可能含前 k 近邻的体素，代价与体素总数、查询点离其余点多远无关。
+class CellTree {
+public:
+    explicit CellTree(const tsdf::VoxelIndex& index) : index_(index), cells_(index.cellCount()), cellBoxes_(index.cellCount()) {
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, cells_.size(), 256), [&](const tbb::blocked_range<std::size_t>& r) {
+            for (std::size_t c = r.begin(); c != r.end(); ++c) {
+                cells_[c] = static_cast<std::uint32_t>(c);
+                const tsdf::VoxelIndex::Range range = index.cell(c);
+                for (std::uint32_t s = range.begin; s < range.end; ++s) {
+                    cellBoxes_[c].add(index.xs()[s], index.ys()[s], index.zs()[s]);
+                }
+            }
+        });
+        std::size_t leaves = 1;
+        while (leaves * TREE_LEAF_CELLS < cells_.size()) {
+            leaves *= 2;
+        }
+        nodes_.resize(2 * leaves - 1);
+        build(0, 0, cells_.size());
+    }
+
+    // 排序位置 self 之外离 query 最近的 k 个点的平方距离写入 d2 前 k 项（无序），返回实际个数。
+    std::size_t nearest(const CCVector3& query, std::uint32_t self, std::size_t k, GatherScratch& scratch) const {
+        std::vector<double>& best = scratch.d2;  // 前 found 项为大顶堆
+        std::vector<std::pair<double, std::size_t>>& frontier = scratch.frontier;  // 按下界的小顶堆
+        const auto byBound = [](const std::pair<double, std::size_t>& a, const std::pair<double, std::size_t>& b) { return a.first > b.first; };
+        if (best.size() < k) {
+            best.resize(k);
+        }
+        std::size_t found = 0;
+        frontier.clear();
+        frontier.emplace_back(nodes_[0].lowerBound(query), 0);
+        while (!frontier.empty()) {
+            std::pop_heap(frontier.begin(), frontier.end(), byBound);
+            const auto [bound, node] = frontier.back();
+            frontier.pop_back();
+            if (found == k && bound >= best[0]) {
+                break;
+            }
+            const std::size_t left = 2 * node + 1;
+            if (left < nodes_.size() && nodes_[left].begin < nodes_[left].end) {
+                for (const std::size_t child : {left, left + 1}) {
+                    const double childBound = nodes_[child].lowerBound(query);
+                    if (found < k || childBound < best[0]) {
+                        frontier.emplace_back(childBound, child);
+                        std::push_heap(frontier.begin(), frontier.end(), byBound);
+                    }
+                }
+                continue;
+            }
+            for (std::size_t i = nodes_[node].begin; i < nodes_[node].end; ++i) {
+                const std::uint32_t c = cells_[i];
+                if (found == k && cellBoxes_[c].lowerBound(query) >= best[0]) {
+                    continue;
+                }
+                const tsdf::VoxelIndex::Range range = index_.cell(c);
+                scratch.knn.treeCandidates += range.end - range.begin;
+                for (std::uint32_t s = range.begin; s < range.end; ++s) {
+                    if (s == self) {
+                        continue;
+                    }
+                    const double d2 = squaredDistance(query, index_.xs()[s], index_.ys()[s], index_.zs()[s]);
+                    if (found < k) {
+                        best[found++] = d2;
+                        std::push_heap(best.begin(), best.begin() + static_cast<std::ptrdiff_t>(found));
+                    } else if (d2 < best[0]) {
+                        std::pop_heap(best.begin(), best.begin() + static_cast<std::ptrdiff_t>(found));
+                        best[found - 1] = d2;
+                        std::push_heap(best.begin(), best.begin() + static_cast<std::ptrdiff_t>(found));
+                    }
+                }
+            }
+        }
+        return found;
+    }
+
+private:
+    struct Node {
+        Box box;
+        std::size_t begin = 0;
+        std::size_t end = 0;
+
+        double lowerBound(const CCVector3& query) const { return box.lowerBound(query); }
+    };
+
+    // 按包围盒最长轴的体素中心中位数二分；子树互不相交，大区间并行建。
+    void build(std::size_t node, std::size_t begin, std::size_t end) {
+        Node& n = nodes_[node];
+        n.begin = begin;
+        n.end = end;
+        for (std::size_t i = begin; i < end; ++i) {
+            n.box.join(cellBoxes_[cells_[i]]);
+        }
+        const std::size_t left = 2 * node + 1;
+        if (left >= nodes_.size() || end - begin <= TREE_LEAF_CELLS) {
+            return;
+        }
+        int axis = 0;
+        for (int k = 1; k < 3; ++k) {
+            if (n.box.max[k] - n.box.min[k] > n.box.max[axis] - n.box.min[axis]) {
+                axis = k;
+            }
+        }
+        const std::size_t mid = begin + (end - begin) / 2;
+        std::nth_element(cells_.begin() + static_cast<std::ptrdiff_t>(begin), cells_.begin() + static_cast<std::ptrdiff_t>(mid),
+                         cells_.begin() + static_cast<std::ptrdiff_t>(end), [&](std::uint32_t a, std::uint32_t b) {
+                             return cellBoxes_[a].min[axis] + cellBoxes_[a].max[axis] < cellBoxes_[b].min[axis] + cellBoxes_[b].max[axis];
+                         });
+        if (end - begin >= TREE_PARALLEL_CELLS) {
+            tbb::parallel_invoke([&] { build(left, begin, mid); }, [&] { build(left + 1, mid, end); });
+        } else {
+            build(left, begin, mid);
+            build(left + 1, mid, end);
+        }
+    }
+
+    const tsdf::VoxelIndex& index_;
+    std::vector<std::uint32_t> cells_;
+    std::vector<Box> cellBoxes_;
+    std::vector<Node> nodes_;
+};
+
+// 首次需要时才建 CellTree（只有壳层外扩超过 KNN_MAX_RING 的点才用到）；并行段中多线程同时请求时只建一次。
+class LazyCellTree {
+public:
+    explicit LazyCellTree(const tsdf::VoxelIndex& index) : index_(index) {}
+
+    const CellTree& get() const {
+        std::call_once(once_, [&] {
+            // 隔离建树的并行任务，避免等待期间本线程窃取外层任务再次进入 call_once。
+            tbb::this_task_arena::isolate([&] { tree_ = std::make_unique<CellTree>(index_); });
+        });
+        return *tree_;
+    }
+
+private:
+    const tsdf::VoxelIndex& index_;
+    mutable std::once_flag once_;
+    mutable std::unique_ptr<CellTree> tree_;
+};
+
+// 统计离群判据的平均近邻距离，口径同 Open3D remove_statistical_outlier：查询点自身算作距离 0 的第一个近邻，
+// 取 sorNeighbors 个近邻求均值（全图点数不足时取全部）。scratch.d2 前 found 项为 27 邻域内其余点的平方距离；
+// 第 k 近超出已搜索范围时按体素壳层逐层外扩，超过 maxRing 层（或壳层将覆盖全部非空体素）时改由 tree 查找。
+double meanKnnDistance(const tsdf::VoxelIndex& index, const LazyCellTree& tree, std::size_t cell, std::uint32_t self, const CCVector3& query,
+                       std::size_t found, std::size_t sorNeighbors, int maxRing, GatherScratch& scratch) {
+    const std::size_t others = std::min(sorNeighbors, index.size()) - 1;
+    if (others == 0) {
+        return 0.0;
+    }
+    std::vector<double>& d2 = scratch.d2;
+    const float* xs = index.xs();
+    const float* ys = index.ys();
+    const float* zs = index.zs();
+    // 已搜索 ring 层时，未搜索区域内的点与查询点的距离不小于 ring * cellSize。
+    for (int ring = 1;; ++ring) {
+        if (found >= others) {
+            std::nth_element(d2.begin(), d2.begin() + static_cast<std::ptrdiff_t>(others - 1), d2.begin() + static_cast<std::ptrdiff_t>(found));
+            const double reach = ring * index.cellSize();
+            if (d2[others - 1] <= reach * reach || found == index.size() - 1) {
+                break;
+            }
+        }
+        const std::size_t side = static_cast<std::size_t>(2 * ring + 3);
+        if (ring > maxRing || side * side * side > index.cellCount()) {
+            ++scratch.knn.treeQueries;
+            tree.get().nearest(query, self, others, scratch);
+            break;
+        }
+        if (ring == 1) {
+            ++scratch.knn.shellQueries;
+        }
+        scratch.shell.clear();
+        index.shellCells(cell, ring + 1, scratch.shell);
+        for (const tsdf::VoxelIndex::Range& range : scratch.shell) {
+            if (d2.size() < found + (range.end - range.begin)) {
+                d2.resize(found + (range.end - range.begin));
+            }
+            scratch.knn.shellCandidates += range.end - range.begin;
+            for (std::uint32_t s = range.begin; s < range.end; ++s) {
+                d2[found++] = squaredDistance(query, xs[s], ys[s], zs[s]);
+            }
+        }
+    }
+    double sum = 0.0;
+    for (std::size_t i = 0; i < others; ++i) {
+        sum += std::sqrt(d2[i]);
+    }
+    return sum / static_cast<double>(others + 1);
+}
+
+}  // namespace
+
+namespace tsdf {
+
+std::unique_ptr<CCCoreLib::ReferenceCloud> runNativeFilter(CCCoreLib::PointCloud& cloud,
+                                                           const FilterConfig& cfg,
+                                                           double* indexMs,
+                                                           double* filterMs,
+                                                           std::vector<NoiseScore>* scores,
+                                                           std::vector<CCVector3>* projected,
+                                                           NativeKnnStats* knn) {
+    if (!(cfg.radius > 0.0)) {
+        throw std::runtime_error("Filter.radius 必须大于 0");
+    }
+    const std::size_t count = cloud.size();
+    const CCVector3* points = count > 0 ? cloud.getPoint(0) : nullptr;
+
+    const auto indexStart = std::chrono::steady_clock::now();
+    VoxelIndex index;
+    {
+        ScopedStage stage("voxel_index");
+        stage.setPoints(count);
+        index.build(points, count, cfg.radius);
+    }
+    const auto indexEnd = std::chrono::steady_clock::now();
+
+    // 与 CCCoreLib 一致：半径按 PointCoordinateType 截断，坐标差在 float 下求得，平方距离在 double 下比较。
+    const PointCoordinateType radius = static_cast<PointCoordinateType>(cfg.radius);
+    const double squareRadius = static_cast<double>(radius) * radius;
+
+    const auto filterStart = std::chrono::steady_clock::now();
+    ScopedStage stage("native_filter");
+    stage.setPoints(count);
+    std::vector<std::uint8_t> keep(count, 0);
+    if (scores) {
+        scores->assign(count, NoiseScore{});
+    }
+    const bool project = projected && cfg.thin != ThinMethod::kNone;
+    if (project) {
+        projected->assign(points, points + count);
+    }
+    const bool planeMode = hasFilterMode(cfg, FilterMode::kPlane);
+    const bool radiusMode = hasFilterMode(cfg, FilterMode::kRadius);
+    const bool statisticalMode = hasFilterMode(cfg, FilterMode::kStatistical);
+    const std::size_t minNeighbors = static_cast<std::size_t>(std::max(0, cfg.min_neighbors));
+    std::vector<double> meanDistance(statisticalMode ? count : 0, 0.0);
+    // kNN 与半径邻域共用 Radius 体素索引：先取 27 邻域，不够再逐层外扩壳层，远处的近邻由同一索引上的 CellTree 回答。
+    // 按每个非空体素的平均点数估计（近似面状分布，27 邻域约 9 个体素有点），27 邻域明显装不下 sor_neighbors 个点时不外扩壳层。
+    const std::size_t sorNeighbors = static_cast<std::size_t>(cfg.sor_neighbors);
+    const double pointsPerCell = index.cellCount() > 0 ? static_cast<double>(index.size()) / static_cast<double>(index.cellCount()) : 1.0;
+    const double knnScale = std::sqrt(static_cast<double>(sorNeighbors) / (9.0 * pointsPerCell));
+    const int maxRing = knnScale <= 1.5 ? KNN_MAX_RING : 0;
+    // 不拟合平面、也不求 kNN 时，半径计数数够 min_neighbors 即可停止。
+    const bool earlyExit = radiusMode && !planeMode && !statisticalMode && !scores;
+    const LazyCellTree tree(index);
+    tbb::enumerable_thread_specific<GatherScratch> scratchPool;
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, index.cellCount(), 64), [&](const tbb::blocked_range<std::size_t>& range) {
+        const TraceSpan span("native_filter_cells");
+        GatherScratch& scratch = scratchPool.local();
+        const float* xs = index.xs();
+        const float* ys = index.ys();
+        const float* zs = index.zs();
+        for (std::size_t c = range.begin(); c != range.end(); ++c) {
+            // 一次性把 27 邻域候选点拷进连续缓冲，体素内所有查询点共享。
+            const std::size_t candidates = index.gatherNeighborhood(c, scratch.cx, scratch.cy, scratch.cz, scratch.sorted);
+            if (scratch.nx.size() < candidates) {
+                scratch.nx.resize(candidates);
+                scratch.ny.resize(candidates);
+                scratch.nz.resize(candidates);
+            }
+            if (statisticalMode && scratch.d2.size() < candidates) {
+                scratch.d2.resize(candidates);
+            }
+
+            const VoxelIndex::Range own = index.cell(c);
+            for (std::uint32_t s = own.begin; s < own.end; ++s) {
+                const CCVector3 query(xs[s], ys[s], zs[s]);
+                std::size_t neighbors = 0;
+                std::size_t others = 0;
+                for (std::size_t k = 0; k < candidates; ++k) {
+                    if (scratch.sorted[k] == s) {
+                        continue;
+                    }
+                    const double d2 = squaredDistance(query, scratch.cx[k], scratch.cy[k], scratch.cz[k]);
+                    if (statisticalMode) {
+                        scratch.d2[others++] = d2;
+                    }
+                    if (d2 <= squareRadius) {
+                        if (planeMode) {
+                            scratch.nx[neighbors] = scratch.cx[k];
+                            scratch.ny[neighbors] = scratch.cy[k];
+                            scratch.nz[neighbors] = scratch.cz[k];
+                        }
+                        ++neighbors;
+                        if (earlyExit && neighbors >= minNeighbors) {
+                            break;
+                        }
+                    }
+                }
+                const std::uint32_t original = index.originalIndex(s);
+                bool kept = true;
+                PlaneFit plane;
+                NoiseScore score;
+                score.neighbors = static_cast<std::uint32_t>(neighbors);
+                if (planeMode) {
+                    score = scoreNoise(query, scratch.nx.data(), scratch.ny.data(), scratch.nz.data(), neighbors, cfg, &plane);
+                    kept = keepPoint(score, cfg);
+                }
+                if (radiusMode) {
+                    kept = kept && neighbors >= minNeighbors;
+                }
+                if (statisticalMode) {
+                    meanDistance[original] = meanKnnDistance(index, tree, c, s, query, others, sorNeighbors, maxRing, scratch);
+                }
+                keep[original] = kept ? 1 : 0;
+                if (scores) {
+                    (*scores)[original] = score;
+                }
+                if (project && kept) {
+                    (*projected)[original] =
+                        projectToSurface(query, plane, scratch.nx.data(), scratch.ny.data(), scratch.nz.data(), neighbors, cfg.thin, cfg.radius);
+                }
+            }
+        }
+    });
+
+    if (knn) {
+        *knn = NativeKnnStats{};
+        for (const GatherScratch& scratch : scratchPool) {
+            knn->shellQueries += scratch.knn.shellQueries;
+            knn->shellCandidates += scratch.knn.shellCandidates;
+            knn->treeQueries += scratch.knn.treeQueries;
+            knn->treeCandidates += scratch.knn.treeCandidates;
+        }
+    }
+
+    if (statisticalMode) {
+        // 同 Open3D：均值与样本标准差只统计平均距离大于 0 的点，平均距离为 0 或不小于均值 + std_ratio * 标准差的点剔除。
+        double sum = 0.0;
+        std::size_t valid = 0;
+        for (const double d : meanDistance) {
+            if (d > 0.0) {
+                sum += d;
+                ++valid;
+            }
+        }
+        const double mean = valid > 0 ? sum / static_cast<double>(valid) : 0.0;
+        double squares = 0.0;
+        for (const double d : meanDistance) {
+            if (d > 0.0) {
+                squares += (d - mean) * (d - mean);
+            }
+        }
+        const double deviation = valid > 1 ? std::sqrt(squares / static_cast<double>(valid - 1)) : 0.0;
+        const double threshold = mean + cfg.std_ratio * deviation;
+        for (std::size_t i = 0; i < count; ++i) {
+            if (!(meanDistance[i] > 0.0 && meanDistance[i] < threshold)) {
+                keep[i] = 0;
+            }
+        }
+    }
+
+    auto filtered = std::make_unique<CCCoreLib::ReferenceCloud>(&cloud);
+    const std::size_t keptCount = static_cast<std::size_t>(std::count(keep.begin(), keep.end(), std::uint8_t(1)));
+    if (!filtered->reserve(static_cast<unsigned>(keptCount))) {
+        throw std::runtime_error("原生滤波结果内存不足");
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        if (keep[i]) {
+            filtered->addPointIndex(static_cast<unsigned>(i));
+        }
+    }
+    const auto filterEnd = std::chrono::steady_clock::now();
+    stage.finish();
+
+    if (indexMs) {
+        *indexMs = elapsedMs(indexStart, indexEnd);
+    }
+    if (filterMs) {
+        *filterMs = elapsedMs(filterStart, filterEnd);
+    }
+    return filtered;
+}
+
+FilterParityReport compareFilterEngines(CCCoreLib::PointCloud& cloud, const FilterConfig& cfg, CCCoreLib::DgmOctree* octree) {
+    FilterConfig engineCfg = cfg;
+    engineCfg.engine = FilterEngine::kCCCoreLib;
+
+    FilterParityReport report;
+    double octreeMs = 0.0;
+    double ccFilterMs = 0.0;
+    report.kept = runFilter(cloud, engineCfg, &octreeMs, &ccFilterMs, octree);
+    report.cccorelibMs = octreeMs + ccFilterMs;
+
+    double indexMs = 0.0;
+    double nativeFilterMs = 0.0;
+    std::vector<NoiseScore> scores;
+    const std::unique_ptr<CCCoreLib::ReferenceCloud> native = runNativeFilter(cloud, engineCfg, &indexMs, &nativeFilterMs, &scores);
+    report.nativeMs = indexMs + nativeFilterMs;
+
+    // CCCoreLib 按八叉树单元顺序输出，逐点比对前先展开成按原始索引的标记。
+    const std::size_t count = cloud.size();
+    std::vector<std::uint8_t> state(count, 0);
+    for (unsigned i = 0; i < report.kept->size(); ++i) {
+        state[report.kept->getPointGlobalIndex(i)] |= 1;
+    }
+    for (unsigned i = 0; i < native->size(); ++i) {
+        state[native->getPointGlobalIndex(i)] |= 2;
+    }
+    report.cccorelibKept = report.kept->size();
+    report.nativeKept = native->size();
+
+    const float epsilon = std::numeric_limits<float>::epsilon();
+    for (std::size_t i = 0; i < count; ++i) {
+        if (state[i] == 0 || state[i] == 3) {
+            continue;
+        }
+        ++report.mismatches;
+        // CCCoreLib 的平面参数为 float，距离误差与坐标量级成正比；阈值附近的分歧视为舍入差异。
+        const NoiseScore& score = scores[i];
+        const CCVector3* p = cloud.getPoint(static_cast<unsigned>(i));
+        const float magnitude = std::abs(p->x) + std::abs(p->y) + std::abs(p->z) + static_cast<float>(cfg.radius);
+        if (score.threshold >= 0.0f && std::abs(score.distance - score.threshold) <= 64.0f * epsilon * magnitude) {
+            ++report.borderline;
+        }
+    }
+    return report;
+}
+
+}  // namespace tsdf
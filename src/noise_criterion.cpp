@@ -0,0 +1,315 @@
+#include "noise_criterion.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+
+// 3x3 对称矩阵 Jacobi 特征分解，返回最小特征值并写出对应的单位特征向量。
+double smallestEigenvector(double a[3][3], double out[3]) {
+    double v[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    for (int sweep = 0; sweep < 50; ++sweep) {
+        int p = 0;
+        int q = 1;
+        double largest = std::abs(a[0][1]);
+        if (std::abs(a[0][2]) > largest) {
+            p = 0;
+            q = 2;
+            largest = std::abs(a[0][2]);
+        }
+        if (std::abs(a[1][2]) > largest) {
+            p = 1;
+            q = 2;
+            largest = std::abs(a[1][2]);
+        }
+        if (largest < 1e-30) {
+            break;
+        }
+        const double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+        const double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+        const double c = 1.0 / std::sqrt(t * t + 1.0);
+        const double s = t * c;
+        for (int k = 0; k < 3; ++k) {
+            const double akp = a[k][p];
+            const double akq = a[k][q];
+            a[k][p] = c * akp - s * akq;
+            a[k][q] = s * akp + c * akq;
+        }
+        for (int k = 0; k < 3; ++k) {
+            const double apk = a[p][k];
+            const double aqk = a[q][k];
+            a[p][k] = c * apk - s * aqk;
+            a[q][k] = s * apk + c * aqk;
+        }
+        for (int k = 0; k < 3; ++k) {
+            const double vkp = v[k][p];
+            const double vkq = v[k][q];
+            v[k][p] = c * vkp - s * vkq;
+            v[k][q] = s * vkp + c * vkq;
+        }
+    }
+    int minIndex = 0;
+    for (int k = 1; k < 3; ++k) {
+        if (a[k][k] < a[minIndex][minIndex]) {
+            minIndex = k;
+        }
+    }
+    const double norm = std::sqrt(v[0][minIndex] * v[0][minIndex] + v[1][minIndex] * v[1][minIndex] + v[2][minIndex] * v[2][minIndex]);
+    for (int k = 0; k < 3; ++k) {
+        out[k] = v[k][minIndex] / norm;
+    }
+    return a[minIndex][minIndex];
+}
+
+// 以 foot 为原点、normal 为高度轴的局部坐标系内加权拟合 h = c0 + c1 u + c2 v + c3 u^2 + c4 uv + c5 v^2，
+// 返回原点处的高度 c0；法方程病态时返回 0（即平面垂足）。
+double fitQuadricHeight(const double foot[3], const double normal[3], const float* xs, const float* ys, const float* zs, std::size_t count, double radius) {
+    // 与法向不平行的任一轴叉乘得到切平面基。
+    const double axis[3] = {std::abs(normal[0]) < 0.9 ? 1.0 : 0.0, std::abs(normal[0]) < 0.9 ? 0.0 : 1.0, 0.0};
+    double u[3] = {normal[1] * axis[2] - normal[2] * axis[1], normal[2] * axis[0] - normal[0] * axis[2], normal[0] * axis[1] - normal[1] * axis[0]};
+    const double un = std::sqrt(u[0] * u[0] + u[1] * u[1] + u[2] * u[2]);
+    for (double& c : u) {
+        c /= un;
+    }
+    const double v[3] = {normal[1] * u[2] - normal[2] * u[1], normal[2] * u[0] - normal[0] * u[2], normal[0] * u[1] - normal[1] * u[0]};
+
+    // 6x6 法方程 A c = b，坐标按 radius 归一化以改善条件数。
+    const double invRadius = 1.0 / radius;
+    double a[6][7] = {};
+    for (std::size_t i = 0; i < count; ++i) {
+        const double d[3] = {xs[i] - foot[0], ys[i] - foot[1], zs[i] - foot[2]};
+        const double pu = (d[0] * u[0] + d[1] * u[1] + d[2] * u[2]) * invRadius;
+        const double pv = (d[0] * v[0] + d[1] * v[1] + d[2] * v[2]) * invRadius;
+        const double h = d[0] * normal[0] + d[1] * normal[1] + d[2] * normal[2];
+        const double w = std::exp(-(pu * pu + pv * pv));
+        const double basis[6] = {1.0, pu, pv, pu * pu, pu * pv, pv * pv};
+        for (int r = 0; r < 6; ++r) {
+            const double wb = w * basis[r];
+            for (int c = r; c < 6; ++c) {
+                a[r][c] += wb * basis[c];
+            }
+            a[r][6] += wb * h;
+        }
+    }
+    for (int r = 1; r < 6; ++r) {
+        for (int c = 0; c < r; ++c) {
+            a[r][c] = a[c][r];
+        }
+    }
+
+    // 列主元高斯消元，只需回代出 c0。
+    for (int col = 0; col < 6; ++col) {
+        int pivot = col;
+        for (int r = col + 1; r < 6; ++r) {
+            if (std::abs(a[r][col]) > std::abs(a[pivot][col])) {
+                pivot = r;
+            }
+        }
+        if (std::abs(a[pivot][col]) < 1e-12 * (std::abs(a[0][0]) + 1e-300)) {
+            return 0.0;
+        }
+        if (pivot != col) {
+            std::swap(a[pivot], a[col]);
+        }
+        for (int r = col + 1; r < 6; ++r) {
+            const double f = a[r][col] / a[col][col];
+            for (int c = col; c < 7; ++c) {
+                a[r][c] -= f * a[col][c];
+            }
+        }
+    }
+    double coeff[6];
+    for (int r = 5; r >= 0; --r) {
+        double sum = a[r][6];
+        for (int c = r + 1; c < 6; ++c) {
+            sum -= a[r][c] * coeff[c];
+        }
+        coeff[r] = sum / a[r][r];
+    }
+    // 高度超出邻域半径说明拟合发散，退回平面。
+    return std::abs(coeff[0]) <= radius ? coeff[0] : 0.0;
+}
+
+}  // namespace
+
+namespace tsdf {
+
+PlaneFit fitPlane(const float* xs, const float* ys, const float* zs, std::size_t count) {
+    PlaneFit fit;
+    if (count < 3) {
+        return fit;
+    }
+
+    double gx = 0.0;
+    double gy = 0.0;
+    double gz = 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+        gx += xs[i];
+        gy += ys[i];
+        gz += zs[i];
+    }
+    const double inv = 1.0 / static_cast<double>(count);
+    gx *= inv;
+    gy *= inv;
+    gz *= inv;
+
+    if (count == 3) {
+        const double ux = xs[1] - xs[0];
+        const double uy = ys[1] - ys[0];
+        const double uz = zs[1] - zs[0];
+        const double vx = xs[2] - xs[0];
+        const double vy = ys[2] - ys[0];
+        const double vz = zs[2] - zs[0];
+        double n[3] = {uy * vz - uz * vy, uz * vx - ux * vz, ux * vy - uy * vx};
+        const double norm = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (norm <= 0.0) {
+            return fit;
+        }
+        for (int k = 0; k < 3; ++k) {
+            fit.normal[k] = n[k] / norm;
+        }
+    } else {
+        // SoA 连续数组上的去中心化协方差累加，循环体无分支便于编译器向量化。
+        double cxx = 0.0;
+        double cxy = 0.0;
+        double cxz = 0.0;
+        double cyy = 0.0;
+        double cyz = 0.0;
+        double czz = 0.0;
+        for (std::size_t i = 0; i < count; ++i) {
+            const double dx = xs[i] - gx;
+            const double dy = ys[i] - gy;
+            const double dz = zs[i] - gz;
+            cxx += dx * dx;
+            cxy += dx * dy;
+            cxz += dx * dz;
+            cyy += dy * dy;
+            cyz += dy * dz;
+            czz += dz * dz;
+        }
+        double cov[3][3] = {{cxx * inv, cxy * inv, cxz * inv}, {cxy * inv, cyy * inv, cyz * inv}, {cxz * inv, cyz * inv, czz * inv}};
+        smallestEigenvector(cov, fit.normal);
+    }
+
+    fit.offset = fit.normal[0] * gx + fit.normal[1] * gy + fit.normal[2] * gz;
+    fit.valid = true;
+    return fit;
+}
+
+void PlaneMoments::add(double x, double y, double z) {
+    ++count;
+    sx += x;
+    sy += y;
+    sz += z;
+    sxx += x * x;
+    sxy += x * y;
+    sxz += x * z;
+    syy += y * y;
+    syz += y * z;
+    szz += z * z;
+}
+
+void PlaneMoments::merge(const PlaneMoments& other) {
+    count += other.count;
+    sx += other.sx;
+    sy += other.sy;
+    sz += other.sz;
+    sxx += other.sxx;
+    sxy += other.sxy;
+    sxz += other.sxz;
+    syy += other.syy;
+    syz += other.syz;
+    szz += other.szz;
+}
+
+PlaneFit fitPlane(const PlaneMoments& moments, double* sigma) {
+    PlaneFit fit;
+    if (moments.count <= 3) {
+        return fit;
+    }
+    const double inv = 1.0 / static_cast<double>(moments.count);
+    const double gx = moments.sx * inv;
+    const double gy = moments.sy * inv;
+    const double gz = moments.sz * inv;
+    double cov[3][3] = {{moments.sxx * inv - gx * gx, moments.sxy * inv - gx * gy, moments.sxz * inv - gx * gz},
+                        {0.0, moments.syy * inv - gy * gy, moments.syz * inv - gy * gz},
+                        {0.0, 0.0, moments.szz * inv - gz * gz}};
+    cov[1][0] = cov[0][1];
+    cov[2][0] = cov[0][2];
+    cov[2][1] = cov[1][2];
+    const double lambda = smallestEigenvector(cov, fit.normal);
+    fit.offset = fit.normal[0] * gx + fit.normal[1] * gy + fit.normal[2] * gz;
+    fit.valid = true;
+    if (sigma) {
+        // 平面过质心，邻点有符号距离均值为 0，其方差即最小特征值。
+        *sigma = std::sqrt(std::max(lambda, 0.0));
+    }
+    return fit;
+}
+
+NoiseScore scoreNoise(const CCVector3& query,
+                      const float* xs,
+                      const float* ys,
+                      const float* zs,
+                      std::size_t count,
+                      const FilterConfig& cfg,
+                      PlaneFit* fitted) {
+    NoiseScore score;
+    score.neighbors = static_cast<std::uint32_t>(count);
+    if (count < 3) {
+        return score;
+    }
+
+    const PlaneFit plane = fitPlane(xs, ys, zs, count);
+    if (fitted) {
+        *fitted = plane;
+    }
+    if (!plane.valid) {
+        return score;
+    }
+    const double nx = plane.normal[0];
+    const double ny = plane.normal[1];
+    const double nz = plane.normal[2];
+
+    double sum = 0.0;
+    double sum2 = 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const double d = nx * xs[i] + ny * ys[i] + nz * zs[i] - plane.offset;
+        sum += d;
+        sum2 += d * d;
+    }
+    const double k = static_cast<double>(count);
+    const double sigma = std::sqrt(std::abs(sum2 * k - sum * sum)) / k;
+    const double maxDistance = cfg.use_absolute_error ? cfg.absolute_error : sigma * cfg.n_sigma;
+
+    score.distance = static_cast<float>(std::abs(nx * query.x + ny * query.y + nz * query.z - plane.offset));
+    score.threshold = static_cast<float>(maxDistance);
+    score.sigma = static_cast<float>(sigma);
+    return score;
+}
+
+CCVector3 projectToSurface(const CCVector3& query,
+                           const PlaneFit& plane,
+                           const float* xs,
+                           const float* ys,
+                           const float* zs,
+                           std::size_t count,
+                           ThinMethod method,
+                           double radius) {
+    if (!plane.valid || method == ThinMethod::kNone) {
+        return query;
+    }
+    const double* n = plane.normal;
+    const double signedDistance = n[0] * query.x + n[1] * query.y + n[2] * query.z - plane.offset;
+    const double foot[3] = {query.x - n[0] * signedDistance, query.y - n[1] * signedDistance, query.z - n[2] * signedDistance};
+    double height = 0.0;
+    if (method == ThinMethod::kMls && count >= 6) {
+        height = fitQuadricHeight(foot, n, xs, ys, zs, count, radius);
+    }
+    return CCVector3(static_cast<PointCoordinateType>(foot[0] + n[0] * height),
+                     static_cast<PointCoordinateType>(foot[1] + n[1] * height),
+                     static_cast<PointCoordinateType>(foot[2] + n[2] * height));
+}
+
+}  // namespace tsdf
@@ -0,0 +1,179 @@
+#include "parallel_octree.h"
+
+#include "morton.h"
+#include "radix_sort.h"
+#include "telemetry.h"
+
+#include <CCMiscTools.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+using CellCode = CCCoreLib::DgmOctree::CellCode;
+
+constexpr int MAX_LEVEL = CCCoreLib::DgmOctree::MAX_OCTREE_LEVEL;
+constexpr int MAX_CELL_POS = (1 << MAX_LEVEL) - 1;
+constexpr std::size_t GRAIN = 1 << 14;
+// 不在点包围盒内的点（NaN）不进八叉树，排序时用全 1 键排到末尾后截掉。
+constexpr std::uint64_t REJECTED = std::numeric_limits<std::uint64_t>::max();
+
+struct Box {
+    CCVector3 min{std::numeric_limits<PointCoordinateType>::max(), std::numeric_limits<PointCoordinateType>::max(),
+                  std::numeric_limits<PointCoordinateType>::max()};
+    CCVector3 max{std::numeric_limits<PointCoordinateType>::lowest(), std::numeric_limits<PointCoordinateType>::lowest(),
+                  std::numeric_limits<PointCoordinateType>::lowest()};
+
+    void add(const CCVector3& p) {
+        for (unsigned k = 0; k < 3; ++k) {
+            if (p.u[k] < min.u[k]) {
+                min.u[k] = p.u[k];
+            }
+            if (p.u[k] > max.u[k]) {
+                max.u[k] = p.u[k];
+            }
+        }
+    }
+
+    void join(const Box& other) {
+        for (unsigned k = 0; k < 3; ++k) {
+            min.u[k] = std::min(min.u[k], other.min.u[k]);
+            max.u[k] = std::max(max.u[k], other.max.u[k]);
+        }
+    }
+};
+
+inline std::uint64_t clampedCell(int v) {
+    return static_cast<std::uint64_t>(std::clamp(v, 0, MAX_CELL_POS));
+}
+
+inline std::uint64_t cellCode(int x, int y, int z) {
+    return tsdf::mortonEncode(clampedCell(x), clampedCell(y), clampedCell(z));
+}
+
+}  // namespace
+
+namespace tsdf {
+
+int ParallelOctree::buildParallel() {
+    clear();
+    const std::size_t count = cloud_->size();
+    if (count == 0) {
+        return -1;
+    }
+    const CCVector3* points = cloud_->getPoint(0);
+
+    const Box box = tbb::parallel_reduce(
+        tbb::blocked_range<std::size_t>(0, count, GRAIN), Box{},
+        [&](const tbb::blocked_range<std::size_t>& r, Box local) {
+            for (std::size_t i = r.begin(); i != r.end(); ++i) {
+                local.add(points[i]);
+            }
+            return local;
+        },
+        [](Box a, const Box& b) {
+            a.join(b);
+            return a;
+        });
+    m_pointsMin = box.min;
+    m_pointsMax = box.max;
+    m_dimMin = m_pointsMin;
+    m_dimMax = m_pointsMax;
+    CCCoreLib::CCMiscTools::MakeMinAndMaxCubical(m_dimMin, m_dimMax, 0.001);
+    updateMinAndMaxTables();
+    updateCellSizeTable();
+
+    // 量化与 getTheCellPosWhichIncludesThePoint 相同：(P - dimMin) / 最大层级单元边长，截断取整。
+    std::vector<KeyIndex> items(count);
+    std::atomic<std::size_t> rejected{0};
+    const PointCoordinateType cellSize = getCellSize(MAX_LEVEL);
+    const CCVector3 dimMin = m_dimMin;
+    const CCVector3 boxMin = m_pointsMin;
+    const CCVector3 boxMax = m_pointsMax;
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, count, GRAIN), [&](const tbb::blocked_range<std::size_t>& r) {
+        const TraceSpan span("octree_codes");
+        std::size_t localRejected = 0;
+        auto scalar = [&](std::size_t i) {
+            const CCVector3& p = points[i];
+            items[i].index = static_cast<std::uint32_t>(i);
+            if (p.x >= boxMin.x && p.x <= boxMax.x && p.y >= boxMin.y && p.y <= boxMax.y && p.z >= boxMin.z && p.z <= boxMax.z) {
+                Tuple3i pos;
+                getTheCellPosWhichIncludesThePoint(&p, pos);
+                items[i].key = cellCode(pos.x, pos.y, pos.z);
+            } else {
+                items[i].key = REJECTED;
+                ++localRejected;
+            }
+        };
+        std::size_t i = r.begin();
+#if defined(__SSE2__)
+        static_assert(sizeof(CCVector3) == 3 * sizeof(float), "CCVector3 须为紧密排列的 3 个 float");
+        const __m128 cs = _mm_set1_ps(cellSize);
+        const __m128 origin[3] = {_mm_set1_ps(dimMin.x), _mm_set1_ps(dimMin.y), _mm_set1_ps(dimMin.z)};
+        const __m128 lo[3] = {_mm_set1_ps(boxMin.x), _mm_set1_ps(boxMin.y), _mm_set1_ps(boxMin.z)};
+        const __m128 hi[3] = {_mm_set1_ps(boxMax.x), _mm_set1_ps(boxMax.y), _mm_set1_ps(boxMax.z)};
+        alignas(16) std::int32_t pos[3][4];
+        for (; i + 4 <= r.end(); i += 4) {
+            // 4 点 12 个 float 拆成 x / y / z 三个向量。
+            const float* in = reinterpret_cast<const float*>(points + i);
+            const __m128 a = _mm_loadu_ps(in);      // x0 y0 z0 x1
+            const __m128 b = _mm_loadu_ps(in + 4);  // y1 z1 x2 y2
+            const __m128 c = _mm_loadu_ps(in + 8);  // z2 x3 y3 z3
+            const __m128 axis[3] = {
+                _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0)),
+                _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)),
+                _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0)),
+            };
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (int k = 0; k < 3; ++k) {
+                inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmpge_ps(axis[k], lo[k]), _mm_cmple_ps(axis[k], hi[k])));
+                _mm_store_si128(reinterpret_cast<__m128i*>(pos[k]), _mm_cvttps_epi32(_mm_div_ps(_mm_sub_ps(axis[k], origin[k]), cs)));
+            }
+            if (_mm_movemask_ps(inside) != 0xF) {
+                for (std::size_t j = i; j < i + 4; ++j) {
+                    scalar(j);
+                }
+                continue;
+            }
+            for (int j = 0; j < 4; ++j) {
+                items[i + j].key = cellCode(pos[0][j], pos[1][j], pos[2][j]);
+                items[i + j].index = static_cast<std::uint32_t>(i + j);
+            }
+        }
+#endif
+        for (; i < r.end(); ++i) {
+            scalar(i);
+        }
+        if (localRejected > 0) {
+            rejected += localRejected;
+        }
+    });
+
+    // 输入按下标升序，稳定的基数排序使同一单元内的点保持下标次序。
+    radixSortByKey(items, rejected > 0 ? 64u : 3u * MAX_LEVEL);
+    const std::size_t projected = count - rejected;
+    m_thePointsAndTheirCellCodes.resize(projected);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, projected, GRAIN), [&](const tbb::blocked_range<std::size_t>& r) {
+        for (std::size_t i = r.begin(); i != r.end(); ++i) {
+            m_thePointsAndTheirCellCodes[i] = IndexAndCode(items[i].index, static_cast<CellCode>(items[i].key));
+        }
+    });
+    m_numberOfProjectedPoints = static_cast<unsigned>(projected);
+    updateCellCountTable();
+    return static_cast<int>(projected);
+}
+
+}  // namespace tsdf
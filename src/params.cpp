@@ -1,5 +1,6 @@
 #include "params.h"
 
+#include <algorithm>
 #include <cctype>
 #include <filesystem>
 #include <fstream>
@@ -10,6 +11,7 @@
 #include <string_view>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace {
 
@@ -93,6 +95,19 @@ public:
         return keyIt->second;
     }
 
+    // "Section.key=value"，键中最后一个 '.' 之前为段名。
+    void set(const std::string& item) {
+        const auto eq = item.find('=');
+        const std::string path = trim(item.substr(0, eq));
+        const auto dot = path.rfind('.');
+        if (eq == std::string::npos || dot == std::string::npos || dot == 0 || dot + 1 == path.size()) {
+            throw std::runtime_error("覆盖项须为 Section.key=value: " + item);
+        }
+        const std::string section = canonicalizeKey(toLowerCopy(trim(path.substr(0, dot))));
+        const std::string key = canonicalizeKey(toLowerCopy(trim(path.substr(dot + 1))));
+        values_[section][key] = trim(stripQuotes(trim(item.substr(eq + 1))));
+    }
+
 private:
     void parse(std::istream& in) {
         std::string currentSection = canonicalizeKey("global");
@@ -172,6 +187,32 @@ int parseInt(const std::string& value, const std::string& fieldName) {
     }
 }
 
+// 列表写成行内形式 [a, b, c]，也接受不带括号的逗号或空格分隔。
+std::vector<double> parseDoubleList(const std::string& value, const std::string& fieldName) {
+    std::string body = trim(value);
+    if (!body.empty() && body.front() == '[') {
+        if (body.back() != ']') {
+            throw std::runtime_error("字段 " + fieldName + " 列表缺少 ]: " + value);
+        }
+        body = body.substr(1, body.size() - 2);
+    }
+    std::vector<double> result;
+    std::string item;
+    for (std::size_t i = 0; i <= body.size(); ++i) {
+        const char c = i < body.size() ? body[i] : ',';
+        if (c == ',' || c == ' ' || c == '\t') {
+            item = trim(item);
+            if (!item.empty()) {
+                result.push_back(parseDouble(item, fieldName));
+            }
+            item.clear();
+        } else {
+            item.push_back(c);
+        }
+    }
+    return result;
+}
+
 tsdf::PointCloudFormat parsePointCloudFormat(const std::string& value, const std::string& fieldName) {
     const std::string normalized = toLowerCopy(trim(value));
     if (normalized == "0" || normalized == "pcd") {
@@ -194,6 +235,79 @@ tsdf::PointCloudLoadMode parsePointCloudLoadMode(const std::string& value, const
     throw std::runtime_error("字段 " + fieldName + " 仅支持 -1/1 或 map/frames");
 }
 
+tsdf::FilterEngine parseFilterEngine(const std::string& value, const std::string& fieldName) {
+    const std::string normalized = toLowerCopy(trim(value));
+    if (normalized == "cccorelib" || normalized == "cc" || normalized == "octree") {
+        return tsdf::FilterEngine::kCCCoreLib;
+    }
+    if (normalized == "native" || normalized == "voxel" || normalized == "livomesh") {
+        return tsdf::FilterEngine::kNative;
+    }
+    if (normalized == "parity" || normalized == "compare") {
+        return tsdf::FilterEngine::kParity;
+    }
+    throw std::runtime_error("字段 " + fieldName + " 仅支持 cccorelib/native/parity");
+}
+
+// 以 + 或逗号连接的判据列表（也接受 YAML 行内列表），去重后按 plane、radius、statistical 的固定次序返回。
+std::vector<tsdf::FilterMode> parseFilterModes(const std::string& value, const std::string& fieldName) {
+    std::string body = trim(value);
+    if (!body.empty() && body.front() == '[' && body.back() == ']') {
+        body = body.substr(1, body.size() - 2);
+    }
+    std::vector<tsdf::FilterMode> modes;
+    std::string item;
+    for (std::size_t i = 0; i <= body.size(); ++i) {
+        const char c = i < body.size() ? body[i] : '+';
+        if (c != '+' && c != ',') {
+            item.push_back(c);
+            continue;
+        }
+        const std::string normalized = toLowerCopy(trim(item));
+        item.clear();
+        tsdf::FilterMode mode;
+        if (normalized == "plane" || normalized == "noise" || normalized == "cloudcompare") {
+            mode = tsdf::FilterMode::kPlane;
+        } else if (normalized == "radius" || normalized == "ror") {
+            mode = tsdf::FilterMode::kRadius;
+        } else if (normalized == "statistical" || normalized == "sor") {
+            mode = tsdf::FilterMode::kStatistical;
+        } else {
+            throw std::runtime_error("字段 " + fieldName + " 仅支持 plane/radius/statistical 及其 + 组合");
+        }
+        if (std::find(modes.begin(), modes.end(), mode) == modes.end()) {
+            modes.push_back(mode);
+        }
+    }
+    std::sort(modes.begin(), modes.end());
+    return modes;
+}
+
+tsdf::DownsampleMode parseDownsampleMode(const std::string& value, const std::string& fieldName) {
+    const std::string normalized = toLowerCopy(trim(value));
+    if (normalized == "centroid" || normalized == "mean") {
+        return tsdf::DownsampleMode::kCentroid;
+    }
+    if (normalized == "first") {
+        return tsdf::DownsampleMode::kFirst;
+    }
+    throw std::runtime_error("字段 " + fieldName + " 仅支持 centroid/first");
+}
+
+tsdf::ThinMethod parseThinMethod(const std::string& value, const std::string& fieldName) {
+    const std::string normalized = toLowerCopy(trim(value));
+    if (normalized == "none" || normalized == "off" || normalized == "false" || normalized == "0") {
+        return tsdf::ThinMethod::kNone;
+    }
+    if (normalized == "plane") {
+        return tsdf::ThinMethod::kPlane;
+    }
+    if (normalized == "mls") {
+        return tsdf::ThinMethod::kMls;
+    }
+    throw std::runtime_error("字段 " + fieldName + " 仅支持 none/plane/mls");
+}
+
 std::filesystem::path resolveRelativeTo(const std::filesystem::path& anchor, std::filesystem::path candidate) {
     if (candidate.empty()) {
         return candidate;
@@ -223,7 +337,14 @@ std::filesystem::path makeAbsolute(const std::filesystem::path& input) {
 namespace tsdf {
 
 AppConfig loadAppConfig(const std::filesystem::path& file) {
+    return loadAppConfig(file, {});
+}
+
+AppConfig loadAppConfig(const std::filesystem::path& file, const std::vector<std::string>& overrides) {
     RawConfig raw(file);
+    for (const std::string& item : overrides) {
+        raw.set(item);
+    }
     AppConfig cfg;
 
     const std::filesystem::path configPath = std::filesystem::absolute(file);
@@ -245,6 +366,12 @@ AppConfig loadAppConfig(const std::filesystem::path& file) {
     if (auto value = pickValue(raw, "base", {"pcl_load", "load_mode"})) {
         cfg.base.load_mode = parsePointCloudLoadMode(value->value, "Base." + value->key);
     }
+    if (auto value = pickValue(raw, "base", {"cache_en", "index_cache"})) {
+        cfg.base.cache_enabled = parseBool(value->value, "Base." + value->key);
+    }
+    if (auto value = pickValue(raw, "base", {"keep_fields_en", "keep_fields"})) {
+        cfg.base.keep_fields = parseBool(value->value, "Base." + value->key);
+    }
     if (auto value = pickValue(raw, "base", {"save_pcd_en", "save_pcd", "save_output_en"})) {
         cfg.base.save_pcd = parseBool(value->value, "Base." + value->key);
     }
@@ -292,6 +419,19 @@ AppConfig loadAppConfig(const std::filesystem::path& file) {
         cfg.base.depth_pose = resolveDataPath(cfg.base.depth_pose);
     }
 
+    if (auto value = pickValue(raw, "downsample", {"enable", "enabled", "downsample_en"})) {
+        cfg.downsample.enable = parseBool(value->value, "Downsample." + value->key);
+    }
+    if (auto value = pickValue(raw, "downsample", {"voxel_size", "leaf_size"})) {
+        cfg.downsample.voxel_size = parseDouble(value->value, "Downsample." + value->key);
+    }
+    if (auto value = pickValue(raw, "downsample", {"mode"})) {
+        cfg.downsample.mode = parseDownsampleMode(value->value, "Downsample." + value->key);
+    }
+    if (cfg.downsample.enable && !(cfg.downsample.voxel_size > 0.0)) {
+        throw std::runtime_error("Downsample.voxel_size 须大于 0");
+    }
+
     if (auto value = pickValue(raw, "filter", {"enable", "enabled", "denoise_en"})) {
         cfg.filter.enable = parseBool(value->value, "Filter." + value->key);
     }
@@ -315,6 +455,278 @@ AppConfig loadAppConfig(const std::filesystem::path& file) {
     if (auto value = pickValue(raw, "filter", {"remove_isolated"})) {
         cfg.filter.remove_isolated = parseBool(value->value, "Filter." + value->key);
     }
+    if (auto value = pickValue(raw, "filter", {"tile_size"})) {
+        cfg.filter.tile_size = parseDouble(value->value, "Filter." + value->key);
+    }
+    if (auto value = pickValue(raw, "filter", {"max_memory_mb", "memory_limit_mb"})) {
+        cfg.filter.max_memory_mb = parseDouble(value->value, "Filter." + value->key);
+    }
+    if (auto value = pickValue(raw, "filter", {"engine", "filter_engine"})) {
+        cfg.filter.engine = parseFilterEngine(value->value, "Filter." + value->key);
+    }
+    if (auto value = pickValue(raw, "filter", {"mode", "modes", "filter_mode"})) {
+        cfg.filter.modes = parseFilterModes(value->value, "Filter." + value->key);
+    }
+    if (auto value = pickValue(raw, "filter", {"min_neighbors", "nb_points"})) {
+        cfg.filter.min_neighbors = parseInt(value->value, "Filter." + value->key);
+    }
+    if (auto value = pickValue(raw, "filter", {"sor_neighbors", "nb_neighbors"})) {
+        cfg.filter.sor_neighbors = parseInt(value->value, "Filter." + value->key);
+    }
+    if (auto value = pickValue(raw, "filter", {"std_ratio", "sor_std_ratio"})) {
+        cfg.filter.std_ratio = parseDouble(value->value, "Filter." + value->key);
+    }
+    if (auto value = pickValue(raw, "filter", {"thin", "thin_method"})) {
+        cfg.filter.thin = parseThinMethod(value->value, "Filter." + value->key);
+    }
+    if (auto value = pickValue(raw, "filter", {"merge_voxel", "merge_voxel_size"})) {
+        cfg.filter.merge_voxel = parseDouble(value->value, "Filter." + value->key);
+    }
+    if (auto value = pickValue(raw, "filter", {"lean", "low_memory"})) {
+        cfg.filter.lean = parseBool(value->value, "Filter." + value->key);
+    }
+    if (auto value = pickValue(raw, "filter", {"export_rejected", "keep_statistics"})) {
+        cfg.filter.export_rejected = parseBool(value->value, "Filter." + value->key);
+    }
+    if (auto value = pickValue(raw, "filter", {"export_scores", "noise_scores"})) {
+        cfg.filter.export_scores = parseBool(value->value, "Filter." + value->key);
+    }
+    if (cfg.filter.merge_voxel < 0.0) {
+        throw std::runtime_error("Filter.merge_voxel 不能为负");
+    }
+    const bool planeOnly = cfg.filter.modes.size() == 1 && cfg.filter.modes.front() == FilterMode::kPlane;
+    if (!planeOnly && cfg.filter.enable) {
+        if (cfg.filter.engine != FilterEngine::kNative) {
+            throw std::runtime_error("Filter.mode 含 radius / statistical 时需要 engine: native");
+        }
+        if (cfg.filter.min_neighbors < 0 || cfg.filter.sor_neighbors < 2 || !(cfg.filter.std_ratio >= 0.0)) {
+            throw std::runtime_error("Filter.min_neighbors 不能为负，Filter.sor_neighbors 须不小于 2，Filter.std_ratio 不能为负");
+        }
+        if ((cfg.filter.thin != ThinMethod::kNone || cfg.filter.merge_voxel > 0.0) && !hasFilterMode(cfg.filter, FilterMode::kPlane)) {
+            throw std::runtime_error("Filter.thin / Filter.merge_voxel 需要 Filter.mode 含 plane");
+        }
+        if (hasFilterMode(cfg.filter, FilterMode::kStatistical) && (cfg.filter.tile_size > 0.0 || cfg.filter.max_memory_mb > 0.0)) {
+            throw std::runtime_error("Filter.mode: statistical 的阈值取自全图统计，不支持分块滤波模式");
+        }
+    }
+    if (cfg.filter.tile_size < 0.0 || cfg.filter.max_memory_mb < 0.0) {
+        throw std::runtime_error("Filter.tile_size / Filter.max_memory_mb 不能为负");
+    }
+    if (cfg.filter.tile_size > 0.0 && cfg.filter.tile_size <= 2.0 * cfg.filter.radius) {
+        throw std::runtime_error("Filter.tile_size 须大于 2 * Filter.radius");
+    }
+    if ((cfg.filter.thin != ThinMethod::kNone || cfg.filter.merge_voxel > 0.0) && (cfg.filter.tile_size > 0.0 || cfg.filter.max_memory_mb > 0.0)) {
+        throw std::runtime_error("Filter.thin / Filter.merge_voxel 暂不支持分块滤波模式");
+    }
+    if (cfg.downsample.enable && (cfg.filter.tile_size > 0.0 || cfg.filter.max_memory_mb > 0.0)) {
+        throw std::runtime_error("Downsample 暂不支持分块滤波模式");
+    }
+
+    if (auto value = pickValue(raw, "telemetry", {"enable", "enabled", "telemetry_en"})) {
+        cfg.telemetry.enable = parseBool(value->value, "Telemetry." + value->key);
+    }
+    if (auto value = pickValue(raw, "telemetry", {"report_path", "json_path"})) {
+        cfg.telemetry.report_path = makeAbsolute(resolveRelativeTo(configDir, value->value));
+    }
+    if (auto value = pickValue(raw, "telemetry", {"trace_en", "trace"})) {
+        cfg.telemetry.trace = parseBool(value->value, "Telemetry." + value->key);
+    }
+    if (auto value = pickValue(raw, "telemetry", {"trace_path"})) {
+        cfg.telemetry.trace_path = makeAbsolute(resolveRelativeTo(configDir, value->value));
+    }
+
+    if (auto value = pickValue(raw, "tsdf", {"enable", "enabled", "tsdf_en"})) {
+        cfg.tsdf.enable = parseBool(value->value, "Tsdf." + value->key);
+    }
+    if (auto value = pickValue(raw, "tsdf", {"voxel_size", "voxel_length"})) {
+        cfg.tsdf.voxel_size = parseDouble(value->value, "Tsdf." + value->key);
+    }
+    if (auto value = pickValue(raw, "tsdf", {"truncation", "sdf_trunc"})) {
+        cfg.tsdf.truncation = parseDouble(value->value, "Tsdf." + value->key);
+    }
+    if (auto value = pickValue(raw, "tsdf", {"max_weight"})) {
+        cfg.tsdf.max_weight = parseDouble(value->value, "Tsdf." + value->key);
+    }
+    if (auto value = pickValue(raw, "tsdf", {"mesh_en", "mesh"})) {
+        cfg.tsdf.mesh = parseBool(value->value, "Tsdf." + value->key);
+    }
+    if (auto value = pickValue(raw, "tsdf", {"min_weight"})) {
+        cfg.tsdf.min_weight = parseDouble(value->value, "Tsdf." + value->key);
+    }
+    if (auto value = pickValue(raw, "tsdf", {"mesh_path"})) {
+        cfg.tsdf.mesh_path = makeAbsolute(resolveRelativeTo(configDir, value->value));
+    }
+    if (cfg.tsdf.enable) {
+        if (!(cfg.tsdf.voxel_size > 0.0) || cfg.tsdf.truncation < cfg.tsdf.voxel_size) {
+            throw std::runtime_error("Tsdf.voxel_size 须大于 0 且 Tsdf.truncation 不小于 voxel_size");
+        }
+        if (cfg.tsdf.max_weight < 1.0) {
+            throw std::runtime_error("Tsdf.max_weight 须不小于 1");
+        }
+        if (!(cfg.tsdf.min_weight > 0.0)) {
+            throw std::runtime_error("Tsdf.min_weight 须大于 0");
+        }
+        if (cfg.base.load_mode != PointCloudLoadMode::kFrameSequence) {
+            throw std::runtime_error("Tsdf.enable 需要多帧模式 (pcl_load: 1)，整图点云没有逐帧传感器位姿");
+        }
+    }
+
+    if (auto value = pickValue(raw, "sweep", {"enable", "enabled", "sweep_en"})) {
+        cfg.sweep.enable = parseBool(value->value, "Sweep." + value->key);
+    }
+    if (auto value = pickValue(raw, "sweep", {"radii", "radius"})) {
+        cfg.sweep.radii = parseDoubleList(value->value, "Sweep." + value->key);
+    }
+    if (auto value = pickValue(raw, "sweep", {"n_sigmas", "n_sigma", "max_errors"})) {
+        cfg.sweep.n_sigmas = parseDoubleList(value->value, "Sweep." + value->key);
+    }
+    if (auto value = pickValue(raw, "sweep", {"absolute_errors", "absolute_error"})) {
+        cfg.sweep.absolute_errors = parseDoubleList(value->value, "Sweep." + value->key);
+    }
+    if (auto value = pickValue(raw, "sweep", {"write_clouds", "save_pcd_en"})) {
+        cfg.sweep.write_clouds = parseBool(value->value, "Sweep." + value->key);
+    }
+    if (cfg.sweep.enable) {
+        if (cfg.sweep.radii.empty()) {
+            cfg.sweep.radii.push_back(cfg.filter.radius);
+        }
+        if (cfg.sweep.n_sigmas.empty() && cfg.sweep.absolute_errors.empty()) {
+            if (cfg.filter.use_absolute_error) {
+                cfg.sweep.absolute_errors.push_back(cfg.filter.absolute_error);
+            } else {
+                cfg.sweep.n_sigmas.push_back(cfg.filter.n_sigma);
+            }
+        }
+        for (const double r : cfg.sweep.radii) {
+            if (!(r > 0.0)) {
+                throw std::runtime_error("Sweep.radii 必须全部大于 0");
+            }
+        }
+        if (!planeOnly) {
+            throw std::runtime_error("Sweep 只评估 Filter.mode: plane 的参数组合");
+        }
+    }
+
+    if (auto value = pickValue(raw, "watch", {"enable", "enabled", "watch_en"})) {
+        cfg.watch.enable = parseBool(value->value, "Watch." + value->key);
+    }
+    if (auto value = pickValue(raw, "watch", {"poll_ms", "interval_ms"})) {
+        cfg.watch.poll_ms = parseInt(value->value, "Watch." + value->key);
+    }
+    if (auto value = pickValue(raw, "watch", {"idle_exit_s", "idle_timeout_s"})) {
+        cfg.watch.idle_exit_s = parseDouble(value->value, "Watch." + value->key);
+    }
+    if (cfg.watch.enable) {
+        if (cfg.watch.poll_ms <= 0 || cfg.watch.idle_exit_s < 0.0) {
+            throw std::runtime_error("Watch.poll_ms 须大于 0 且 Watch.idle_exit_s 不能为负");
+        }
+        if (cfg.base.load_mode != PointCloudLoadMode::kFrameSequence) {
+            throw std::runtime_error("Watch.enable 需要多帧模式 (pcl_load: 1)");
+        }
+        if (!cfg.filter.enable || !(cfg.filter.radius > 0.0)) {
+            throw std::runtime_error("Watch.enable 需要 Filter.enable 且 Filter.radius 大于 0");
+        }
+        if (cfg.downsample.enable || cfg.sweep.enable || cfg.tsdf.enable || cfg.filter.thin != ThinMethod::kNone || cfg.filter.merge_voxel > 0.0 ||
+            cfg.filter.tile_size > 0.0 || cfg.filter.max_memory_mb > 0.0) {
+            throw std::runtime_error("Watch 模式暂不支持 Downsample / Sweep / Tsdf / 压薄 / 分块滤波");
+        }
+        if (!planeOnly) {
+            throw std::runtime_error("Watch 模式只支持 Filter.mode: plane");
+        }
+    }
+    if (auto value = pickValue(raw, "pipeline", {"enable", "enabled", "pipeline_en"})) {
+        cfg.pipeline.enable = parseBool(value->value, "Pipeline." + value->key);
+    }
+    if (auto value = pickValue(raw, "pipeline", {"readers", "reader_threads"})) {
+        cfg.pipeline.readers = parseInt(value->value, "Pipeline." + value->key);
+    }
+    if (auto value = pickValue(raw, "pipeline", {"decoders", "decoder_threads"})) {
+        cfg.pipeline.decoders = parseInt(value->value, "Pipeline." + value->key);
+    }
+    if (auto value = pickValue(raw, "pipeline", {"filters", "filter_threads"})) {
+        cfg.pipeline.filters = parseInt(value->value, "Pipeline." + value->key);
+    }
+    if (auto value = pickValue(raw, "pipeline", {"max_inflight", "queue_depth"})) {
+        cfg.pipeline.max_inflight = parseInt(value->value, "Pipeline." + value->key);
+    }
+    if (cfg.pipeline.enable && (cfg.pipeline.readers <= 0 || cfg.pipeline.decoders <= 0 || cfg.pipeline.filters <= 0 || cfg.pipeline.max_inflight <= 0)) {
+        throw std::runtime_error("Pipeline.readers / decoders / filters / max_inflight 须大于 0");
+    }
+
+    if (auto value = pickValue(raw, "shard", {"enable", "enabled", "shard_en"})) {
+        cfg.shard.enable = parseBool(value->value, "Shard." + value->key);
+    }
+    if (auto value = pickValue(raw, "shard", {"workers", "processes"})) {
+        cfg.shard.workers = parseInt(value->value, "Shard." + value->key);
+    }
+    if (auto value = pickValue(raw, "shard", {"launcher", "launch_command"})) {
+        cfg.shard.launcher = value->value;
+    }
+    if (auto value = pickValue(raw, "shard", {"work_dir", "shard_dir"})) {
+        cfg.shard.work_dir = makeAbsolute(resolveRelativeTo(configDir, value->value));
+    }
+    if (cfg.shard.enable) {
+        if (cfg.shard.workers <= 0) {
+            throw std::runtime_error("Shard.workers 须大于 0");
+        }
+        if (cfg.base.load_mode != PointCloudLoadMode::kWholeMap || !cfg.filter.enable) {
+            throw std::runtime_error("Shard.enable 需要整图输入 (pcl_load: -1) 且 Filter.enable");
+        }
+        if (!(cfg.filter.tile_size > 0.0 || cfg.filter.max_memory_mb > 0.0)) {
+            throw std::runtime_error("Shard.enable 按分块模式切分，需要 Filter.tile_size 或 Filter.max_memory_mb 大于 0");
+        }
+        if (cfg.sweep.enable) {
+            throw std::runtime_error("Shard 模式暂不支持 Sweep");
+        }
+    }
+
+    if ((cfg.filter.export_rejected || cfg.filter.export_scores) && cfg.filter.enable) {
+        if (cfg.filter.export_scores && cfg.filter.engine != FilterEngine::kNative) {
+            throw std::runtime_error("Filter.export_scores 需要 engine: native（逐点统计取自原生引擎的同一趟滤波）");
+        }
+        if (cfg.filter.lean || cfg.sweep.enable || cfg.watch.enable || cfg.filter.tile_size > 0.0 || cfg.filter.max_memory_mb > 0.0) {
+            throw std::runtime_error("Filter.export_rejected / export_scores 暂不支持 lean / Sweep / Watch / 分块滤波");
+        }
+    }
+    if (cfg.filter.lean && cfg.filter.enable) {
+        if (cfg.base.load_mode != PointCloudLoadMode::kWholeMap) {
+            throw std::runtime_error("Filter.lean 需要整图输入 (pcl_load: -1)");
+        }
+        if (cfg.filter.engine == FilterEngine::kParity) {
+            throw std::runtime_error("Filter.lean 固定使用原生判据，不支持 engine: parity");
+        }
+        if (cfg.base.cache_enabled || cfg.downsample.enable || cfg.sweep.enable || cfg.tsdf.enable || cfg.filter.thin != ThinMethod::kNone ||
+            cfg.filter.merge_voxel > 0.0 || cfg.filter.tile_size > 0.0 || cfg.filter.max_memory_mb > 0.0) {
+            throw std::runtime_error("Filter.lean 暂不支持索引缓存 / Downsample / Sweep / Tsdf / 压薄 / 分块滤波");
+        }
+        if (!planeOnly) {
+            throw std::runtime_error("Filter.lean 只支持 Filter.mode: plane");
+        }
+    }
+
+    if (auto value = pickValue(raw, "lod", {"enable", "enabled", "lod_en"})) {
+        cfg.lod.enable = parseBool(value->value, "Lod." + value->key);
+    }
+    if (auto value = pickValue(raw, "lod", {"grid", "node_grid"})) {
+        cfg.lod.grid = parseInt(value->value, "Lod." + value->key);
+    }
+    if (auto value = pickValue(raw, "lod", {"max_node_points", "node_points"})) {
+        cfg.lod.max_node_points = parseInt(value->value, "Lod." + value->key);
+    }
+    if (auto value = pickValue(raw, "lod", {"output_dir", "lod_dir"})) {
+        cfg.lod.output_dir = makeAbsolute(resolveRelativeTo(configDir, value->value));
+    }
+    if (cfg.lod.enable) {
+        if (cfg.lod.grid < 8 || cfg.lod.grid > 1024 || (cfg.lod.grid & (cfg.lod.grid - 1)) != 0 || cfg.lod.max_node_points <= 0) {
+            throw std::runtime_error("Lod.grid 须为 8 ~ 1024 之间的 2 的幂，Lod.max_node_points 须大于 0");
+        }
+        if (!cfg.filter.enable || !cfg.base.save_pcd) {
+            throw std::runtime_error("Lod.enable 需要 Filter.enable 且 save_pcd_en");
+        }
+        if (cfg.filter.lean || cfg.sweep.enable || cfg.watch.enable || cfg.shard.enable || cfg.filter.tile_size > 0.0 || cfg.filter.max_memory_mb > 0.0) {
+            throw std::runtime_error("Lod 输出暂不支持 lean / Sweep / Watch / Shard / 分块滤波");
+        }
+    }
 
     return cfg;
 }
@@ -0,0 +1,196 @@
+#include "pcd_decode.h"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+using tsdf::FieldAttr;
+using tsdf::PcdHeader;
+
+template <typename T>
+inline PointCoordinateType loadAs(const char* ptr) {
+    T v;
+    std::memcpy(&v, ptr, sizeof(T));
+    return static_cast<PointCoordinateType>(v);
+}
+
+using ScalarLoadFn = PointCoordinateType (*)(const char*);
+
+// 字段类型编码：高 8 位为类型字符，低 8 位为字节数。
+constexpr int typeKey(char type, int size) {
+    return (static_cast<int>(type) << 8) | size;
+}
+
+ScalarLoadFn scalarLoader(const FieldAttr& attr) {
+    switch (typeKey(attr.type, attr.size)) {
+        case typeKey('F', 4): return &loadAs<float>;
+        case typeKey('F', 8): return &loadAs<double>;
+        case typeKey('I', 1): return &loadAs<std::int8_t>;
+        case typeKey('I', 2): return &loadAs<std::int16_t>;
+        case typeKey('I', 4): return &loadAs<std::int32_t>;
+        case typeKey('I', 8): return &loadAs<std::int64_t>;
+        case typeKey('U', 1): return &loadAs<std::uint8_t>;
+        case typeKey('U', 2): return &loadAs<std::uint16_t>;
+        case typeKey('U', 4): return &loadAs<std::uint32_t>;
+        case typeKey('U', 8): return &loadAs<std::uint64_t>;
+        default: return nullptr;
+    }
+}
+
+void decodePackedXyzF32(const char* records, std::size_t count, const PcdHeader&, CCVector3* dst) {
+    static_assert(sizeof(CCVector3) == 3 * sizeof(float), "CCVector3 须为紧密排列的 3 个 float");
+    std::memcpy(static_cast<void*>(dst), records, count * sizeof(CCVector3));
+}
+
+// x y z 为记录前 12 字节且步长 >= 16：每条记录可安全读取 16 字节，
+// 4 条记录一组用 shuffle 拼成 3 个紧密排列的向量写出。
+void decodePrefixXyzF32(const char* records, std::size_t count, const PcdHeader& header, CCVector3* dst) {
+    const std::size_t step = header.pointStep;
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    float* out = reinterpret_cast<float*>(dst);
+    for (; i + 4 <= count; i += 4) {
+        const char* rec = records + i * step;
+        const __m128 a = _mm_loadu_ps(reinterpret_cast<const float*>(rec));
+        const __m128 b = _mm_loadu_ps(reinterpret_cast<const float*>(rec + step));
+        const __m128 c = _mm_loadu_ps(reinterpret_cast<const float*>(rec + 2 * step));
+        const __m128 d = _mm_loadu_ps(reinterpret_cast<const float*>(rec + 3 * step));
+        const __m128 ab = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 2, 2));   // a2 a2 b0 b0
+        const __m128 cd = _mm_shuffle_ps(c, d, _MM_SHUFFLE(0, 0, 2, 2));   // c2 c2 d0 d0
+        _mm_storeu_ps(out + 3 * i, _mm_shuffle_ps(a, ab, _MM_SHUFFLE(2, 0, 1, 0)));      // a0 a1 a2 b0
+        _mm_storeu_ps(out + 3 * i + 4, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 0, 2, 1)));  // b1 b2 c0 c1
+        _mm_storeu_ps(out + 3 * i + 8, _mm_shuffle_ps(cd, d, _MM_SHUFFLE(2, 1, 2, 0))); // c2 d0 d1 d2
+    }
+#endif
+    for (; i < count; ++i) {
+        const char* rec = records + i * step;
+        dst[i] = CCVector3(loadAs<float>(rec), loadAs<float>(rec + 4), loadAs<float>(rec + 8));
+    }
+}
+
+template <typename T>
+void decodeUniform(const char* records, std::size_t count, const PcdHeader& header, CCVector3* dst) {
+    const std::size_t step = header.pointStep;
+    const std::size_t ox = static_cast<std::size_t>(header.x.offset);
+    const std::size_t oy = static_cast<std::size_t>(header.y.offset);
+    const std::size_t oz = static_cast<std::size_t>(header.z.offset);
+    for (std::size_t i = 0; i < count; ++i) {
+        const char* rec = records + i * step;
+        dst[i] = CCVector3(loadAs<T>(rec + ox), loadAs<T>(rec + oy), loadAs<T>(rec + oz));
+    }
+}
+
+void decodeMixed(const char* records, std::size_t count, const PcdHeader& header, CCVector3* dst) {
+    const ScalarLoadFn lx = scalarLoader(header.x);
+    const ScalarLoadFn ly = scalarLoader(header.y);
+    const ScalarLoadFn lz = scalarLoader(header.z);
+    const std::size_t step = header.pointStep;
+    for (std::size_t i = 0; i < count; ++i) {
+        const char* rec = records + i * step;
+        dst[i] = CCVector3(lx(rec + header.x.offset), ly(rec + header.y.offset), lz(rec + header.z.offset));
+    }
+}
+
+template <typename T>
+void decodeFieldMajorUniform(const char* block, std::size_t first, std::size_t count, const PcdHeader& header, CCVector3* dst) {
+    const std::size_t n = header.pointCount;
+    const char* xs = block + n * static_cast<std::size_t>(header.x.offset) + first * sizeof(T);
+    const char* ys = block + n * static_cast<std::size_t>(header.y.offset) + first * sizeof(T);
+    const char* zs = block + n * static_cast<std::size_t>(header.z.offset) + first * sizeof(T);
+    for (std::size_t i = 0; i < count; ++i) {
+        dst[i] = CCVector3(loadAs<T>(xs + i * sizeof(T)), loadAs<T>(ys + i * sizeof(T)), loadAs<T>(zs + i * sizeof(T)));
+    }
+}
+
+void decodeFieldMajorMixed(const char* block, std::size_t first, std::size_t count, const PcdHeader& header, CCVector3* dst) {
+    const ScalarLoadFn lx = scalarLoader(header.x);
+    const ScalarLoadFn ly = scalarLoader(header.y);
+    const ScalarLoadFn lz = scalarLoader(header.z);
+    const std::size_t n = header.pointCount;
+    const char* xs = block + n * static_cast<std::size_t>(header.x.offset);
+    const char* ys = block + n * static_cast<std::size_t>(header.y.offset);
+    const char* zs = block + n * static_cast<std::size_t>(header.z.offset);
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::size_t k = first + i;
+        dst[i] = CCVector3(lx(xs + k * header.x.size), ly(ys + k * header.y.size), lz(zs + k * header.z.size));
+    }
+}
+
+void checkSupported(const PcdHeader& header) {
+    for (const FieldAttr* attr : {&header.x, &header.y, &header.z}) {
+        if (!scalarLoader(*attr)) {
+            throw std::runtime_error(std::string("不支持的字段类型: ") + attr->type + std::to_string(attr->size));
+        }
+    }
+}
+
+bool sameType(const FieldAttr& a, const FieldAttr& b) {
+    return a.type == b.type && a.size == b.size;
+}
+
+}  // namespace
+
+namespace tsdf {
+
+XyzDecoder selectXyzDecoder(const PcdHeader& header) {
+    checkSupported(header);
+
+    if (!sameType(header.x, header.y) || !sameType(header.x, header.z)) {
+        return {&decodeMixed, "mixed"};
+    }
+
+    const bool xyzPrefix = header.x.offset == 0 && header.y.offset == 4 && header.z.offset == 8;
+    if (typeKey(header.x.type, header.x.size) == typeKey('F', 4)) {
+        if constexpr (std::is_same_v<PointCoordinateType, float>) {
+            if (xyzPrefix && header.pointStep == 12) {
+                return {&decodePackedXyzF32, "packed-xyz-f32"};
+            }
+            if (xyzPrefix && header.pointStep >= 16) {
+                return {&decodePrefixXyzF32, "prefix-xyz-f32"};
+            }
+        }
+        return {&decodeUniform<float>, "uniform-f32"};
+    }
+
+    switch (typeKey(header.x.type, header.x.size)) {
+        case typeKey('F', 8): return {&decodeUniform<double>, "uniform-f64"};
+        case typeKey('I', 1): return {&decodeUniform<std::int8_t>, "uniform-i8"};
+        case typeKey('I', 2): return {&decodeUniform<std::int16_t>, "uniform-i16"};
+        case typeKey('I', 4): return {&decodeUniform<std::int32_t>, "uniform-i32"};
+        case typeKey('I', 8): return {&decodeUniform<std::int64_t>, "uniform-i64"};
+        case typeKey('U', 1): return {&decodeUniform<std::uint8_t>, "uniform-u8"};
+        case typeKey('U', 2): return {&decodeUniform<std::uint16_t>, "uniform-u16"};
+        case typeKey('U', 4): return {&decodeUniform<std::uint32_t>, "uniform-u32"};
+        default: return {&decodeUniform<std::uint64_t>, "uniform-u64"};
+    }
+}
+
+FieldMajorDecoder selectFieldMajorDecoder(const PcdHeader& header) {
+    checkSupported(header);
+
+    if (!sameType(header.x, header.y) || !sameType(header.x, header.z)) {
+        return {&decodeFieldMajorMixed, "field-major-mixed"};
+    }
+    switch (typeKey(header.x.type, header.x.size)) {
+        case typeKey('F', 4): return {&decodeFieldMajorUniform<float>, "field-major-f32"};
+        case typeKey('F', 8): return {&decodeFieldMajorUniform<double>, "field-major-f64"};
+        case typeKey('I', 1): return {&decodeFieldMajorUniform<std::int8_t>, "field-major-i8"};
+        case typeKey('I', 2): return {&decodeFieldMajorUniform<std::int16_t>, "field-major-i16"};
+        case typeKey('I', 4): return {&decodeFieldMajorUniform<std::int32_t>, "field-major-i32"};
+        case typeKey('I', 8): return {&decodeFieldMajorUniform<std::int64_t>, "field-major-i64"};
+        case typeKey('U', 1): return {&decodeFieldMajorUniform<std::uint8_t>, "field-major-u8"};
+        case typeKey('U', 2): return {&decodeFieldMajorUniform<std::uint16_t>, "field-major-u16"};
+        case typeKey('U', 4): return {&decodeFieldMajorUniform<std::uint32_t>, "field-major-u32"};
+        default: return {&decodeFieldMajorUniform<std::uint64_t>, "field-major-u64"};
+    }
+}
+
+}  // namespace tsdf
@@ -0,0 +1,757 @@
+#include "pcd_io.h"
+
+#include "lzf.h"
+#include "mapped_file.h"
+#include "pcd_decode.h"
+#include "telemetry.h"
+
+#include <CCGeom.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 并行解码时每个任务处理的点数，足够大以摊薄调度开销。
+constexpr std::size_t DECODE_GRAIN = 1 << 16;
+// ASCII 解析按此字节数切块，再对齐到换行。
+constexpr std::size_t ASCII_CHUNK_BYTES = 1 << 22;
+
+std::string trim(const std::string& s) {
+    const auto first = s.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) {
+        return {};
+    }
+    const auto last = s.find_last_not_of(" \t\r\n");
+    return s.substr(first, last - first + 1);
+}
+
+std::string normalize(std::string v) {
+    for (char& c : v) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return v;
+}
+
+// 逐行累积 Header 信息，流式与映射两种入口共用。
+class HeaderParser {
+public:
+    // 返回 true 表示已读到 DATA 行，Header 结束。
+    bool consume(const std::string& line) {
+        const std::string current = trim(line);
+        if (current.empty()) {
+            return false;
+        }
+        if (current.rfind("DATA", 0) == 0) {
+            const std::string format = normalize(trim(current.substr(4)));
+            if (format == "binary") {
+                header_.data = tsdf::PcdDataFormat::kBinary;
+            } else if (format == "binary_compressed") {
+                header_.data = tsdf::PcdDataFormat::kBinaryCompressed;
+            } else if (format == "ascii") {
+                header_.data = tsdf::PcdDataFormat::kAscii;
+            } else {
+                throw std::runtime_error("不支持的 DATA 格式: " + format);
+            }
+            dataFound_ = true;
+            return true;
+        }
+
+        std::istringstream iss(current);
+        std::string token;
+        iss >> token;
+        token = normalize(token);
+
+        if (token == "fields") {
+            std::string name;
+            while (iss >> name) {
+                fields_.push_back(name);
+            }
+        } else if (token == "size") {
+            int s = 0;
+            while (iss >> s) {
+                sizes_.push_back(s);
+            }
+        } else if (token == "type") {
+            std::string type;
+            while (iss >> type) {
+                types_.push_back(type.empty() ? 'F' : static_cast<char>(std::toupper(type.front())));
+            }
+        } else if (token == "count") {
+            int c = 0;
+            while (iss >> c) {
+                counts_.push_back(c);
+            }
+        } else if (token == "points") {
+            iss >> header_.pointCount;
+        }
+        return false;
+    }
+
+    tsdf::PcdHeader finish() {
+        if (!dataFound_) {
+            throw std::runtime_error("PCD Header 缺少 DATA 行。");
+        }
+        if (fields_.empty()) {
+            throw std::runtime_error("PCD Header 缺少 FIELDS。");
+        }
+        if (sizes_.size() != fields_.size()) {
+            sizes_.assign(fields_.size(), 4);
+        }
+        if (types_.size() != fields_.size()) {
+            types_.assign(fields_.size(), 'F');
+        }
+        if (counts_.size() != fields_.size()) {
+            counts_.assign(fields_.size(), 1);
+        }
+
+        std::size_t offset = 0;
+        for (std::size_t i = 0; i < fields_.size(); ++i) {
+            const std::size_t bytes = static_cast<std::size_t>(sizes_[i]) * static_cast<std::size_t>(counts_[i]);
+            const std::string key = normalize(fields_[i]);
+            header_.fields.push_back({fields_[i], sizes_[i], types_[i], counts_[i], offset});
+            if (counts_[i] == 1) {
+                tsdf::FieldAttr* attr = nullptr;
+                if (key == "x") {
+                    attr = &header_.x;
+                } else if (key == "y") {
+                    attr = &header_.y;
+                } else if (key == "z") {
+                    attr = &header_.z;
+                }
+                if (attr) {
+                    attr->offset = static_cast<int>(offset);
+                    attr->size = sizes_[i];
+                    attr->type = types_[i];
+                }
+            }
+            offset += bytes;
+        }
+
+        if (header_.x.offset < 0 || header_.y.offset < 0 || header_.z.offset < 0) {
+            throw std::runtime_error("PCD 缺少 x/y/z 字段。");
+        }
+
+        header_.pointStep = offset;
+        return header_;
+    }
+
+private:
+    tsdf::PcdHeader header_;
+    std::vector<std::string> fields_;
+    std::vector<int> sizes_;
+    std::vector<char> types_;
+    std::vector<int> counts_;
+    bool dataFound_ = false;
+};
+
+void resizeCloud(CCCoreLib::PointCloud& cloud, std::size_t pointCount) {
+    if (pointCount > std::numeric_limits<unsigned>::max()) {
+        throw std::runtime_error("点数超过 CCCoreLib 单云上限");
+    }
+    if (!cloud.resize(static_cast<unsigned>(pointCount))) {
+        throw std::runtime_error("点云预分配失败");
+    }
+}
+
+template <typename T>
+const char* parseToken(const char* first, const char* last, char* dst) {
+    T v{};
+    const auto result = std::from_chars(first, last, v);
+    if (result.ec != std::errc()) {
+        return nullptr;
+    }
+    std::memcpy(dst, &v, sizeof(T));
+    return result.ptr;
+}
+
+using TokenParseFn = const char* (*)(const char*, const char*, char*);
+
+TokenParseFn tokenParser(const tsdf::PcdField& field) {
+    switch ((static_cast<int>(field.type) << 8) | field.size) {
+        case ('F' << 8) | 4: return &parseToken<float>;
+        case ('F' << 8) | 8: return &parseToken<double>;
+        case ('I' << 8) | 1: return &parseToken<std::int8_t>;
+        case ('I' << 8) | 2: return &parseToken<std::int16_t>;
+        case ('I' << 8) | 4: return &parseToken<std::int32_t>;
+        case ('I' << 8) | 8: return &parseToken<std::int64_t>;
+        case ('U' << 8) | 1: return &parseToken<std::uint8_t>;
+        case ('U' << 8) | 2: return &parseToken<std::uint16_t>;
+        case ('U' << 8) | 4: return &parseToken<std::uint32_t>;
+        case ('U' << 8) | 8: return &parseToken<std::uint64_t>;
+        default: throw std::runtime_error("不支持的字段类型: " + field.name);
+    }
+}
+
+bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+bool blankLine(const char* first, const char* last) {
+    return std::all_of(first, last, isBlank);
+}
+
+// 对 [first, last) 内的每个非空行调用 fn(lineBegin, lineEnd)。
+template <typename Fn>
+void forEachLine(const char* first, const char* last, Fn&& fn) {
+    while (first < last) {
+        const void* nl = std::memchr(first, '\n', static_cast<std::size_t>(last - first));
+        const char* end = nl ? static_cast<const char*>(nl) : last;
+        if (!blankLine(first, end)) {
+            fn(first, end);
+        }
+        first = end + 1;
+    }
+}
+
+// 多线程 ASCII 解析：按换行边界切块，先并行数行确定每块的起始点号，再并行用 from_chars
+// 把每行的所有字段写成与 DATA binary 相同布局的记录，之后复用二进制解码核。
+std::vector<char> parseAsciiRecords(const char* text, std::size_t bytes, const tsdf::PcdHeader& header) {
+    std::vector<std::size_t> bounds{0};
+    while (bounds.back() + ASCII_CHUNK_BYTES < bytes) {
+        const std::size_t probe = bounds.back() + ASCII_CHUNK_BYTES;
+        const void* nl = std::memchr(text + probe, '\n', bytes - probe);
+        if (!nl) {
+            break;
+        }
+        bounds.push_back(static_cast<std::size_t>(static_cast<const char*>(nl) - text) + 1);
+    }
+    bounds.push_back(bytes);
+    const std::size_t chunkCount = bounds.size() - 1;
+
+    std::vector<std::size_t> firstLine(chunkCount + 1, 0);
+    tbb::parallel_for(std::size_t(0), chunkCount, [&](std::size_t c) {
+        std::size_t lines = 0;
+        forEachLine(text + bounds[c], text + bounds[c + 1], [&](const char*, const char*) { ++lines; });
+        firstLine[c + 1] = lines;
+    });
+    for (std::size_t c = 0; c < chunkCount; ++c) {
+        firstLine[c + 1] += firstLine[c];
+    }
+    if (firstLine.back() < header.pointCount) {
+        throw std::runtime_error("PCD 数据长度不足");
+    }
+
+    std::vector<TokenParseFn> parsers;
+    for (const tsdf::PcdField& field : header.fields) {
+        parsers.push_back(tokenParser(field));
+    }
+
+    std::vector<char> records(header.pointCount * header.pointStep);
+    tbb::parallel_for(std::size_t(0), chunkCount, [&](std::size_t c) {
+        const tsdf::TraceSpan span("ascii_parse_chunk");
+        std::size_t index = firstLine[c];
+        forEachLine(text + bounds[c], text + bounds[c + 1], [&](const char* p, const char* end) {
+            if (index >= header.pointCount) {
+                return;
+            }
+            char* rec = records.data() + index * header.pointStep;
+            for (std::size_t f = 0; f < header.fields.size(); ++f) {
+                const tsdf::PcdField& field = header.fields[f];
+                for (int k = 0; k < field.count; ++k) {
+                    while (p < end && isBlank(*p)) {
+                        ++p;
+                    }
+                    p = p < end ? parsers[f](p, end, rec + field.offset + static_cast<std::size_t>(k * field.size)) : nullptr;
+                    if (!p) {
+                        throw std::runtime_error("ASCII PCD 第 " + std::to_string(index + 1) + " 个点解析失败");
+                    }
+                }
+            }
+            ++index;
+        });
+    });
+    return records;
+}
+
+void decodeRecordsParallel(const char* records, const tsdf::PcdHeader& header, CCVector3* dst, const char** decoderName) {
+    const tsdf::XyzDecoder decoder = tsdf::selectXyzDecoder(header);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, header.pointCount, DECODE_GRAIN),
+                      [&](const tbb::blocked_range<std::size_t>& range) {
+                          const tsdf::TraceSpan span("decode_chunk");
+                          decoder.decode(records + range.begin() * header.pointStep, range.size(), header, dst + range.begin());
+                      });
+    *decoderName = decoder.name;
+}
+
+// binary_compressed：4 字节压缩长度 + 4 字节原始长度 + LZF 数据，解压后按字段连续存放。
+std::vector<char> decompressBlock(const char* data, std::size_t bytes, const tsdf::PcdHeader& header) {
+    std::uint32_t compressedSize = 0;
+    std::uint32_t rawSize = 0;
+    if (bytes < 2 * sizeof(std::uint32_t)) {
+        throw std::runtime_error("PCD 数据长度不足");
+    }
+    std::memcpy(&compressedSize, data, sizeof(compressedSize));
+    std::memcpy(&rawSize, data + sizeof(compressedSize), sizeof(rawSize));
+    if (bytes - 2 * sizeof(std::uint32_t) < compressedSize) {
+        throw std::runtime_error("PCD 数据长度不足");
+    }
+    if (rawSize != header.pointCount * header.pointStep) {
+        throw std::runtime_error("binary_compressed 解压长度与 Header 不符");
+    }
+
+    std::vector<char> block(rawSize);
+    const tsdf::TraceSpan span("lzf_decompress");
+    if (tsdf::lzfDecompress(data + 2 * sizeof(std::uint32_t), compressedSize, block.data(), block.size()) != block.size()) {
+        throw std::runtime_error("binary_compressed 解压长度与 Header 不符");
+    }
+    return block;
+}
+
+// 把 field-major 的解压块转置为与 DATA binary 相同布局的 point-major 记录。
+std::vector<char> transposeFieldMajor(const std::vector<char>& block, const tsdf::PcdHeader& header) {
+    std::vector<char> records(block.size());
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, header.pointCount, DECODE_GRAIN),
+                      [&](const tbb::blocked_range<std::size_t>& range) {
+                          for (const tsdf::PcdField& field : header.fields) {
+                              const std::size_t bytes = static_cast<std::size_t>(field.size) * static_cast<std::size_t>(field.count);
+                              const char* src = block.data() + field.offset * header.pointCount;
+                              for (std::size_t i = range.begin(); i != range.end(); ++i) {
+                                  std::memcpy(records.data() + i * header.pointStep + field.offset, src + i * bytes, bytes);
+                              }
+                          }
+                      });
+    return records;
+}
+
+void decodeCompressed(const char* data,
+                      std::size_t bytes,
+                      const tsdf::PcdHeader& header,
+                      CCVector3* dst,
+                      const char** decoderName,
+                      std::vector<char>* keep) {
+    const std::vector<char> block = decompressBlock(data, bytes, header);
+    const tsdf::FieldMajorDecoder decoder = tsdf::selectFieldMajorDecoder(header);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, header.pointCount, DECODE_GRAIN),
+                      [&](const tbb::blocked_range<std::size_t>& range) {
+                          const tsdf::TraceSpan span("decode_chunk");
+                          decoder.decode(block.data(), range.begin(), range.size(), header, dst + range.begin());
+                      });
+    *decoderName = decoder.name;
+    if (keep) {
+        *keep = transposeFieldMajor(block, header);
+    }
+}
+
+// 根据 Header 给出解码目标（至少 pointCount 个点的连续空间）。
+using PointSink = std::function<CCVector3*(const tsdf::PcdHeader&)>;
+
+// 映射路径：Header 与数据都直接取自映射内存，按大块并行解码进调用方预分配的空间。
+// records 非空时 DATA binary 把映射整体移交给 records，其余格式保留解码过程中的记录缓冲。
+tsdf::PcdHeader loadMapped(tsdf::MappedFile& file, const PointSink& sink, tsdf::PcdLoadInfo* info, tsdf::PcdRecords* records) {
+    std::size_t dataOffset = 0;
+    const tsdf::PcdHeader header = tsdf::parseBinaryHeader(file.data(), file.size(), &dataOffset);
+    const std::size_t dataBytes = file.size() - dataOffset;
+
+    CCVector3* dst = sink(header);
+    const char* decoderName = "";
+    std::vector<char> kept;
+    if (header.pointCount > 0) {
+        tsdf::decodeDataBlock(file.data() + dataOffset, dataBytes, header, dst, &decoderName, records ? &kept : nullptr);
+    }
+    if (records && header.pointCount > 0) {
+        *records = header.data == tsdf::PcdDataFormat::kBinary ? tsdf::PcdRecords(std::move(file), dataOffset, header)
+                                                               : tsdf::PcdRecords(std::move(kept), header);
+    }
+
+    if (info) {
+        info->mapped = true;
+        info->dataBytes = dataBytes;
+        info->decoder = decoderName;
+    }
+    return header;
+}
+
+// 回退路径：无法映射时，binary 按块读入缓冲再解码，避免逐点 read；其余格式整段读入后解码。
+tsdf::PcdHeader loadStreamed(const fs::path& path, const PointSink& sink, tsdf::PcdLoadInfo* info, tsdf::PcdRecords* records) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("无法打开点云文件: " + path.string());
+    }
+
+    const tsdf::PcdHeader header = tsdf::parseBinaryHeader(in);
+    CCVector3* dst = sink(header);
+    const char* decoderName = "";
+    std::size_t dataBytes = 0;
+
+    if (header.data == tsdf::PcdDataFormat::kBinary && !records) {
+        const tsdf::XyzDecoder decoder = tsdf::selectXyzDecoder(header);
+        std::vector<char> buffer(DECODE_GRAIN * header.pointStep);
+        for (std::size_t first = 0; first < header.pointCount; first += DECODE_GRAIN) {
+            const std::size_t count = std::min(DECODE_GRAIN, header.pointCount - first);
+            const std::size_t bytes = count * header.pointStep;
+            in.read(buffer.data(), static_cast<std::streamsize>(bytes));
+            if (static_cast<std::size_t>(in.gcount()) != bytes) {
+                throw std::runtime_error("PCD 数据长度不足");
+            }
+            decoder.decode(buffer.data(), count, header, dst + first);
+        }
+        decoderName = decoder.name;
+        dataBytes = header.pointCount * header.pointStep;
+    } else {
+        std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::vector<char> kept;
+        if (header.pointCount > 0) {
+            tsdf::decodeDataBlock(data.data(), data.size(), header, dst, &decoderName, records ? &kept : nullptr);
+        }
+        dataBytes = data.size();
+        if (records && header.pointCount > 0) {
+            if (header.data == tsdf::PcdDataFormat::kBinary) {
+                data.resize(header.pointCount * header.pointStep);
+                kept = std::move(data);
+            }
+            *records = tsdf::PcdRecords(std::move(kept), header);
+        }
+    }
+
+    if (info) {
+        info->mapped = false;
+        info->dataBytes = dataBytes;
+        info->decoder = decoderName;
+    }
+    return header;
+}
+
+tsdf::PcdHeader loadInto(const fs::path& path, const PointSink& sink, tsdf::PcdLoadInfo* info, tsdf::PcdRecords* records = nullptr) {
+    tsdf::MappedFile file(path);
+    if (file.valid()) {
+        return loadMapped(file, sink, info, records);
+    }
+    return loadStreamed(path, sink, info, records);
+}
+
+// 写出时每个任务 gather 的点数。
+constexpr std::size_t WRITE_GRAIN = 1 << 16;
+
+// gather(first, count, dst) 把第 [first, first + count) 条输出记录写到 dst。
+using RecordGather = std::function<void(std::size_t, std::size_t, char*)>;
+
+// 预分配 header + count * step 字节的输出映射，按 WRITE_GRAIN 分块并行 gather；
+// 无法映射时退回单线程分块 gather 到缓冲后整块写出。
+void writeGathered(const fs::path& output, const std::string& header, std::size_t count, std::size_t step, const RecordGather& gather) {
+    tsdf::MappedOutputFile file(output, header.size() + count * step);
+    if (file.valid()) {
+        std::memcpy(file.data(), header.data(), header.size());
+        char* records = file.data() + header.size();
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, count, WRITE_GRAIN), [&](const tbb::blocked_range<std::size_t>& range) {
+            const tsdf::TraceSpan span("write_chunk");
+            gather(range.begin(), range.size(), records + range.begin() * step);
+        });
+        file.close();
+        return;
+    }
+    file.close();
+
+    std::ofstream out(output, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("无法写出点云: " + output.string());
+    }
+    out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    std::vector<char> buffer(std::min(count, WRITE_GRAIN) * step);
+    for (std::size_t first = 0; first < count; first += WRITE_GRAIN) {
+        const std::size_t n = std::min(WRITE_GRAIN, count - first);
+        gather(first, n, buffer.data());
+        out.write(buffer.data(), static_cast<std::streamsize>(n * step));
+    }
+    out.close();
+    if (!out) {
+        throw std::runtime_error("写出点云失败: " + output.string());
+    }
+}
+
+}  // namespace
+
+namespace tsdf {
+
+PcdHeader parseBinaryHeader(std::istream& in) {
+    HeaderParser parser;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (parser.consume(line)) {
+            break;
+        }
+    }
+    return parser.finish();
+}
+
+PcdHeader parseBinaryHeader(const char* data, std::size_t size, std::size_t* dataOffset) {
+    HeaderParser parser;
+    std::size_t pos = 0;
+    while (pos < size) {
+        const void* nl = std::memchr(data + pos, '\n', size - pos);
+        const std::size_t end = nl ? static_cast<std::size_t>(static_cast<const char*>(nl) - data) : size;
+        const bool done = parser.consume(std::string(data + pos, end - pos));
+        pos = nl ? end + 1 : size;
+        if (done) {
+            break;
+        }
+    }
+    PcdHeader header = parser.finish();
+    if (dataOffset) {
+        *dataOffset = pos;
+    }
+    return header;
+}
+
+void decodeDataBlock(const char* data,
+                     std::size_t bytes,
+                     const PcdHeader& header,
+                     CCVector3* dst,
+                     const char** decoderName,
+                     std::vector<char>* keep) {
+    switch (header.data) {
+        case PcdDataFormat::kBinary:
+            if (bytes < header.pointCount * header.pointStep) {
+                throw std::runtime_error("PCD 数据长度不足");
+            }
+            decodeRecordsParallel(data, header, dst, decoderName);
+            break;
+        case PcdDataFormat::kBinaryCompressed:
+            decodeCompressed(data, bytes, header, dst, decoderName, keep);
+            break;
+        case PcdDataFormat::kAscii: {
+            std::vector<char> records = parseAsciiRecords(data, bytes, header);
+            decodeRecordsParallel(records.data(), header, dst, decoderName);
+            if (keep) {
+                *keep = std::move(records);
+            }
+            break;
+        }
+    }
+}
+
+std::vector<char> recordsFromBlock(const char* data, std::size_t bytes, const PcdHeader& header) {
+    switch (header.data) {
+        case PcdDataFormat::kBinary:
+            if (bytes < header.pointCount * header.pointStep) {
+                throw std::runtime_error("PCD 数据长度不足");
+            }
+            return std::vector<char>(data, data + header.pointCount * header.pointStep);
+        case PcdDataFormat::kBinaryCompressed:
+            return transposeFieldMajor(decompressBlock(data, bytes, header), header);
+        case PcdDataFormat::kAscii:
+            return parseAsciiRecords(data, bytes, header);
+    }
+    return {};
+}
+
+PcdHeader readPcdHeader(const fs::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("无法打开点云文件: " + path.string());
+    }
+    return parseBinaryHeader(in);
+}
+
+CCCoreLib::PointCloud loadBinaryCloud(const fs::path& path, PcdLoadInfo* info) {
+    CCCoreLib::PointCloud cloud;
+    loadInto(
+        path,
+        [&](const PcdHeader& header) -> CCVector3* {
+            resizeCloud(cloud, header.pointCount);
+            return header.pointCount > 0 ? cloud.point(0) : nullptr;
+        },
+        info);
+    cloud.invalidateBoundingBox();
+    return cloud;
+}
+
+std::size_t loadBinaryPoints(const fs::path& path, CCVector3* dst, std::size_t capacity, PcdLoadInfo* info, PcdRecords* records) {
+    const PcdHeader header = loadInto(
+        path,
+        [&](const PcdHeader& h) {
+            if (h.pointCount > capacity) {
+                throw std::runtime_error("点云点数超出预留空间: " + path.string());
+            }
+            return dst;
+        },
+        info,
+        records);
+    return header.pointCount;
+}
+
+bool recordsCover(const CCCoreLib::ReferenceCloud& filtered, const PcdRecords* records) {
+    return records && records->valid() && filtered.getAssociatedCloud() && records->size() == filtered.getAssociatedCloud()->size();
+}
+
+void writePcdHeader(std::ostream& out,
+                    const std::vector<PcdField>& fields,
+                    const std::string& count,
+                    std::streampos* widthPos,
+                    std::streampos* pointsPos) {
+    out << "# Filtered by livomesh noise filter\n";
+    out << "VERSION 0.7\n";
+    out << "FIELDS";
+    for (const PcdField& field : fields) {
+        out << ' ' << field.name;
+    }
+    out << "\nSIZE";
+    for (const PcdField& field : fields) {
+        out << ' ' << field.size;
+    }
+    out << "\nTYPE";
+    for (const PcdField& field : fields) {
+        out << ' ' << field.type;
+    }
+    out << "\nCOUNT";
+    for (const PcdField& field : fields) {
+        out << ' ' << field.count;
+    }
+    out << '\n';
+    out << "WIDTH ";
+    if (widthPos) {
+        *widthPos = out.tellp();
+    }
+    out << count << '\n';
+    out << "HEIGHT 1\n";
+    out << "VIEWPOINT 0 0 0 1 0 0 0\n";
+    out << "POINTS ";
+    if (pointsPos) {
+        *pointsPos = out.tellp();
+    }
+    out << count << '\n';
+    out << "DATA binary\n";
+}
+
+std::vector<PcdField> gatherFields(const CCCoreLib::ReferenceCloud& filtered, const PcdRecords* records, const PointColumns* columns) {
+    static const std::vector<PcdField> xyz{{"x", 4, 'F', 1, 0}, {"y", 4, 'F', 1, 4}, {"z", 4, 'F', 1, 8}};
+    std::vector<PcdField> fields = recordsCover(filtered, records) ? records->header().fields : xyz;
+    if (columns) {
+        const std::size_t base = recordsCover(filtered, records) ? records->header().pointStep : 3 * sizeof(float);
+        for (PcdField field : columns->fields) {
+            field.offset += base;
+            fields.push_back(field);
+        }
+    }
+    return fields;
+}
+
+void writeGatheredCloud(const fs::path& output,
+                        const std::string& header,
+                        const CCCoreLib::ReferenceCloud& filtered,
+                        const PcdRecords* records,
+                        const PointColumns* columns) {
+    const std::size_t count = filtered.size();
+    const std::size_t extra = columns ? columns->step : 0;
+    // 附加段按全局下标从 columns 拷到每条记录末尾。
+    const auto appendColumns = [&](std::size_t first, std::size_t n, char* dst, std::size_t step) {
+        if (!columns) {
+            return;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::size_t index = filtered.getPointGlobalIndex(static_cast<unsigned>(first + i));
+            std::memcpy(dst + i * step + step - extra, columns->data + index * extra, extra);
+        }
+    };
+    if (recordsCover(filtered, records)) {
+        // 原始记录按全局下标整条拷贝，xyz 与其余字段保持原始类型与字节序。
+        const char* src = records->data();
+        const std::size_t recordStep = records->header().pointStep;
+        const std::size_t step = recordStep + extra;
+        writeGathered(output, header, count, step, [&](std::size_t first, std::size_t n, char* dst) {
+            for (std::size_t i = 0; i < n; ++i) {
+                const std::size_t index = filtered.getPointGlobalIndex(static_cast<unsigned>(first + i));
+                std::memcpy(dst + i * step, src + index * recordStep, recordStep);
+            }
+            appendColumns(first, n, dst, step);
+        });
+        return;
+    }
+
+    const std::size_t step = 3 * sizeof(float) + extra;
+    writeGathered(output, header, count, step, [&](std::size_t first, std::size_t n, char* dst) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const CCVector3* pt = filtered.getPoint(static_cast<unsigned>(first + i));
+            const float coords[3] = {
+                static_cast<float>(pt->x),
+                static_cast<float>(pt->y),
+                static_cast<float>(pt->z)};
+            std::memcpy(dst + i * step, coords, sizeof(coords));
+        }
+        appendColumns(first, n, dst, step);
+    });
+}
+
+void writeBinaryCloud(const fs::path& output, const CCCoreLib::ReferenceCloud& filtered, const PcdRecords* records, const PointColumns* columns) {
+    std::ostringstream header;
+    writePcdHeader(header, gatherFields(filtered, records, columns), std::to_string(filtered.size()), nullptr, nullptr);
+    writeGatheredCloud(output, header.str(), filtered, records, columns);
+}
+
+PcdRecords::PcdRecords(MappedFile file, std::size_t dataOffset, const PcdHeader& header)
+    : file_(std::move(file)), dataOffset_(dataOffset), header_(header) {}
+
+PcdRecords::PcdRecords(std::vector<char> buffer, const PcdHeader& header) : buffer_(std::move(buffer)), header_(header) {}
+
+PcdRecords loadPcdRecords(const fs::path& path) {
+    MappedFile file(path);
+    if (file.valid()) {
+        std::size_t dataOffset = 0;
+        const PcdHeader header = parseBinaryHeader(file.data(), file.size(), &dataOffset);
+        const std::size_t dataBytes = file.size() - dataOffset;
+        if (header.pointCount == 0) {
+            return {};
+        }
+        if (header.data == PcdDataFormat::kBinary) {
+            if (dataBytes < header.pointCount * header.pointStep) {
+                throw std::runtime_error("PCD 数据长度不足");
+            }
+            return PcdRecords(std::move(file), dataOffset, header);
+        }
+        return PcdRecords(recordsFromBlock(file.data() + dataOffset, dataBytes, header), header);
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("无法打开点云文件: " + path.string());
+    }
+    const PcdHeader header = parseBinaryHeader(in);
+    if (header.pointCount == 0) {
+        return {};
+    }
+    const std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return PcdRecords(recordsFromBlock(data.data(), data.size(), header), header);
+}
+
+PcdBinaryView::PcdBinaryView(const fs::path& path) : file_(path) {
+    if (!file_.valid()) {
+        throw std::runtime_error("无法映射点云文件: " + path.string());
+    }
+    std::size_t dataOffset = 0;
+    header_ = parseBinaryHeader(file_.data(), file_.size(), &dataOffset);
+    if (header_.data != PcdDataFormat::kBinary) {
+        throw std::runtime_error("随机访问仅支持 DATA binary: " + path.string());
+    }
+    if (file_.size() - dataOffset < header_.pointCount * header_.pointStep) {
+        throw std::runtime_error("PCD 数据长度不足");
+    }
+    records_ = file_.data() + dataOffset;
+    decode_ = selectXyzDecoder(header_).decode;
+}
+
+void PcdBinaryView::decode(std::size_t first, std::size_t count, CCVector3* dst) const {
+    decode_(record(first), count, header_, dst);
+}
+
+void PcdBinaryView::evict(std::size_t first, std::size_t count) const {
+    file_.evict(static_cast<std::size_t>(record(first) - file_.data()), count * header_.pointStep);
+}
+
+}  // namespace tsdf
@@ -0,0 +1,363 @@
+#include "ply_io.h"
+
+#include "mapped_file.h"
+
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct PlyElement {
+    std::string name;
+    std::size_t count = 0;
+    std::size_t step = 0;  // 标量属性的记录字节数
+    bool hasList = false;
+    std::vector<tsdf::PcdField> fields;
+};
+
+std::string lower(std::string v) {
+    for (char& c : v) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return v;
+}
+
+// PLY 标量类型到 PCD SIZE/TYPE 的映射，同时接受 int8/float32 等带位宽的别名。
+std::pair<int, char> plyScalar(const std::string& name) {
+    const std::string type = lower(name);
+    if (type == "char" || type == "int8") {
+        return {1, 'I'};
+    }
+    if (type == "uchar" || type == "uint8") {
+        return {1, 'U'};
+    }
+    if (type == "short" || type == "int16") {
+        return {2, 'I'};
+    }
+    if (type == "ushort" || type == "uint16") {
+        return {2, 'U'};
+    }
+    if (type == "int" || type == "int32") {
+        return {4, 'I'};
+    }
+    if (type == "uint" || type == "uint32") {
+        return {4, 'U'};
+    }
+    if (type == "float" || type == "float32") {
+        return {4, 'F'};
+    }
+    if (type == "double" || type == "float64") {
+        return {8, 'F'};
+    }
+    throw std::runtime_error("不支持的 PLY 属性类型: " + name);
+}
+
+const char* plyTypeName(const tsdf::PcdField& field) {
+    switch ((static_cast<int>(field.type) << 8) | field.size) {
+        case ('I' << 8) | 1: return "char";
+        case ('U' << 8) | 1: return "uchar";
+        case ('I' << 8) | 2: return "short";
+        case ('U' << 8) | 2: return "ushort";
+        case ('I' << 8) | 4: return "int";
+        case ('U' << 8) | 4: return "uint";
+        case ('F' << 8) | 4: return "float";
+        case ('F' << 8) | 8: return "double";
+        default: throw std::runtime_error("PLY 无法表示的字段类型: " + field.name);
+    }
+}
+
+// 映射成功时直接用映射内存，否则整段读入 buffer。
+struct PlySource {
+    tsdf::MappedFile file;
+    std::vector<char> buffer;
+    const char* data = nullptr;
+    std::size_t size = 0;
+
+    explicit PlySource(const fs::path& path) : file(path) {
+        if (file.valid()) {
+            data = file.data();
+            size = file.size();
+            return;
+        }
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("无法打开点云文件: " + path.string());
+        }
+        buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        data = buffer.data();
+        size = buffer.size();
+    }
+
+    // 把 binary vertex 记录移交给 PcdRecords：映射直接移交，回退缓冲裁掉 Header 与尾部元素后移交。
+    tsdf::PcdRecords takeBinaryRecords(std::size_t dataOffset, const tsdf::PcdHeader& header) {
+        if (file.valid()) {
+            return tsdf::PcdRecords(std::move(file), dataOffset, header);
+        }
+        buffer.erase(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(dataOffset));
+        buffer.resize(header.pointCount * header.pointStep);
+        return tsdf::PcdRecords(std::move(buffer), header);
+    }
+};
+
+using PointSink = std::function<CCVector3*(const tsdf::PcdHeader&)>;
+
+tsdf::PcdHeader loadInto(const fs::path& path, const PointSink& sink, tsdf::PcdLoadInfo* info, tsdf::PcdRecords* records) {
+    PlySource source(path);
+    const bool mapped = source.file.valid();
+    std::size_t dataOffset = 0;
+    const tsdf::PcdHeader header = tsdf::parsePlyHeader(source.data, source.size, &dataOffset);
+    const std::size_t dataBytes = source.size - dataOffset;
+
+    CCVector3* dst = sink(header);
+    const char* decoderName = "";
+    std::vector<char> kept;
+    if (header.pointCount > 0) {
+        tsdf::decodeDataBlock(source.data + dataOffset, dataBytes, header, dst, &decoderName, records ? &kept : nullptr);
+    }
+    if (records && header.pointCount > 0) {
+        *records = header.data == tsdf::PcdDataFormat::kBinary ? source.takeBinaryRecords(dataOffset, header)
+                                                               : tsdf::PcdRecords(std::move(kept), header);
+    }
+
+    if (info) {
+        info->mapped = mapped;
+        info->dataBytes = header.data == tsdf::PcdDataFormat::kBinary ? header.pointCount * header.pointStep : dataBytes;
+        info->decoder = decoderName;
+    }
+    return header;
+}
+
+}  // namespace
+
+namespace tsdf {
+
+PcdHeader parsePlyHeader(const char* data, std::size_t size, std::size_t* dataOffset) {
+    std::vector<PlyElement> elements;
+    PcdDataFormat format = PcdDataFormat::kBinary;
+    bool formatFound = false;
+    bool ended = false;
+    std::size_t pos = 0;
+    std::size_t lineNo = 0;
+    while (pos < size) {
+        const void* nl = std::memchr(data + pos, '\n', size - pos);
+        const std::size_t end = nl ? static_cast<std::size_t>(static_cast<const char*>(nl) - data) : size;
+        std::istringstream iss(std::string(data + pos, end - pos));
+        pos = nl ? end + 1 : size;
+        std::string token;
+        iss >> token;
+        if (lineNo++ == 0) {
+            if (token != "ply") {
+                throw std::runtime_error("不是 PLY 文件（缺少 ply 魔数行）");
+            }
+            continue;
+        }
+
+        if (token == "format") {
+            std::string name;
+            iss >> name;
+            if (name == "binary_little_endian") {
+                format = PcdDataFormat::kBinary;
+            } else if (name == "ascii") {
+                format = PcdDataFormat::kAscii;
+            } else if (name == "binary_big_endian") {
+                throw std::runtime_error("暂不支持 binary_big_endian PLY");
+            } else {
+                throw std::runtime_error("不支持的 PLY 格式: " + name);
+            }
+            formatFound = true;
+        } else if (token == "element") {
+            PlyElement element;
+            iss >> element.name >> element.count;
+            elements.push_back(element);
+        } else if (token == "property") {
+            if (elements.empty()) {
+                throw std::runtime_error("PLY property 出现在 element 之前");
+            }
+            PlyElement& element = elements.back();
+            std::string type;
+            iss >> type;
+            if (type == "list") {
+                element.hasList = true;
+                continue;
+            }
+            std::string name;
+            iss >> name;
+            const auto [bytes, kind] = plyScalar(type);
+            element.fields.push_back({name, bytes, kind, 1, element.step});
+            element.step += static_cast<std::size_t>(bytes);
+        } else if (token == "end_header") {
+            ended = true;
+            break;
+        }
+        // comment / obj_info 等其余行忽略。
+    }
+    if (!ended) {
+        throw std::runtime_error("PLY Header 缺少 end_header");
+    }
+    if (!formatFound) {
+        throw std::runtime_error("PLY Header 缺少 format 行");
+    }
+
+    std::size_t vertex = elements.size();
+    for (std::size_t i = 0; i < elements.size(); ++i) {
+        if (elements[i].name == "vertex") {
+            vertex = i;
+            break;
+        }
+    }
+    if (vertex == elements.size()) {
+        throw std::runtime_error("PLY 缺少 vertex 元素");
+    }
+    const PlyElement& vertices = elements[vertex];
+    if (vertices.hasList) {
+        throw std::runtime_error("PLY vertex 含 list 属性，暂不支持");
+    }
+
+    PcdHeader header;
+    header.pointCount = vertices.count;
+    header.pointStep = vertices.step;
+    header.data = format;
+    header.fields = vertices.fields;
+    for (const PcdField& field : header.fields) {
+        const std::string key = lower(field.name);
+        FieldAttr* attr = key == "x" ? &header.x : key == "y" ? &header.y : key == "z" ? &header.z : nullptr;
+        if (attr) {
+            attr->offset = static_cast<int>(field.offset);
+            attr->size = field.size;
+            attr->type = field.type;
+        }
+    }
+    if (header.x.offset < 0 || header.y.offset < 0 || header.z.offset < 0) {
+        throw std::runtime_error("PLY 缺少 x/y/z 属性。");
+    }
+
+    if (dataOffset) {
+        // 跳过 vertex 之前的元素：binary 按定长记录跳字节，ascii 按行跳过。
+        for (std::size_t i = 0; i < vertex; ++i) {
+            const PlyElement& element = elements[i];
+            if (format == PcdDataFormat::kBinary) {
+                if (element.hasList) {
+                    throw std::runtime_error("PLY vertex 之前的元素含 list 属性，暂不支持: " + element.name);
+                }
+                pos += element.count * element.step;
+                continue;
+            }
+            for (std::size_t k = 0; k < element.count && pos < size; ++k) {
+                const void* nl = std::memchr(data + pos, '\n', size - pos);
+                pos = nl ? static_cast<std::size_t>(static_cast<const char*>(nl) - data) + 1 : size;
+            }
+        }
+        if (pos > size) {
+            throw std::runtime_error("PLY 数据长度不足");
+        }
+        *dataOffset = pos;
+    }
+    return header;
+}
+
+PcdHeader readPlyHeader(const fs::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("无法打开点云文件: " + path.string());
+    }
+    std::string text;
+    std::string line;
+    while (std::getline(in, line)) {
+        text += line;
+        text += '\n';
+        if (line.rfind("end_header", 0) == 0) {
+            break;
+        }
+    }
+    return parsePlyHeader(text.data(), text.size(), nullptr);
+}
+
+CCCoreLib::PointCloud loadPlyCloud(const fs::path& path, PcdLoadInfo* info) {
+    CCCoreLib::PointCloud cloud;
+    loadInto(
+        path,
+        [&](const PcdHeader& header) -> CCVector3* {
+            if (header.pointCount > std::numeric_limits<unsigned>::max()) {
+                throw std::runtime_error("点数超过 CCCoreLib 单云上限");
+            }
+            if (!cloud.resize(static_cast<unsigned>(header.pointCount))) {
+                throw std::runtime_error("点云预分配失败");
+            }
+            return header.pointCount > 0 ? cloud.point(0) : nullptr;
+        },
+        info,
+        nullptr);
+    cloud.invalidateBoundingBox();
+    return cloud;
+}
+
+std::size_t loadPlyPoints(const fs::path& path, CCVector3* dst, std::size_t capacity, PcdLoadInfo* info, PcdRecords* records) {
+    const PcdHeader header = loadInto(
+        path,
+        [&](const PcdHeader& h) {
+            if (h.pointCount > capacity) {
+                throw std::runtime_error("点云点数超出预留空间: " + path.string());
+            }
+            return dst;
+        },
+        info,
+        records);
+    return header.pointCount;
+}
+
+PcdRecords loadPlyRecords(const fs::path& path) {
+    PlySource source(path);
+    std::size_t dataOffset = 0;
+    const PcdHeader header = parsePlyHeader(source.data, source.size, &dataOffset);
+    if (header.pointCount == 0) {
+        return {};
+    }
+    if (header.data == PcdDataFormat::kBinary) {
+        if (source.size - dataOffset < header.pointCount * header.pointStep) {
+            throw std::runtime_error("PLY 数据长度不足");
+        }
+        return source.takeBinaryRecords(dataOffset, header);
+    }
+    return PcdRecords(recordsFromBlock(source.data + dataOffset, source.size - dataOffset, header), header);
+}
+
+void writePlyHeader(std::ostream& out, const std::vector<PcdField>& fields, const std::string& count, std::streampos* countPos) {
+    out << "ply\n";
+    out << "format binary_little_endian 1.0\n";
+    out << "comment Filtered by livomesh noise filter\n";
+    out << "element vertex ";
+    if (countPos) {
+        *countPos = out.tellp();
+    }
+    out << count << '\n';
+    for (const PcdField& field : fields) {
+        const char* type = plyTypeName(field);
+        if (field.count == 1) {
+            out << "property " << type << ' ' << field.name << '\n';
+            continue;
+        }
+        for (int k = 0; k < field.count; ++k) {
+            out << "property " << type << ' ' << field.name << '_' << k << '\n';
+        }
+    }
+    out << "end_header\n";
+}
+
+void writePlyCloud(const fs::path& output, const CCCoreLib::ReferenceCloud& filtered, const PcdRecords* records, const PointColumns* columns) {
+    std::ostringstream header;
+    writePlyHeader(header, gatherFields(filtered, records, columns), std::to_string(filtered.size()), nullptr);
+    writeGatheredCloud(output, header.str(), filtered, records, columns);
+}
+
+}  // namespace tsdf
@@ -0,0 +1,84 @@
+#include "radix_sort.h"
+
+#include "telemetry.h"
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <array>
+
+namespace {
+
+constexpr unsigned DIGIT_BITS = 8;
+constexpr std::size_t BUCKETS = std::size_t(1) << DIGIT_BITS;
+// 每块的元素数：直方图与写指针常驻 L1，散射时每个桶的写入流保持顺序。
+constexpr std::size_t CHUNK = 1 << 16;
+// 元素较少时直接用 std::stable_sort。
+constexpr std::size_t SMALL = 1 << 12;
+
+}  // namespace
+
+namespace tsdf {
+
+void radixSortByKey(std::vector<KeyIndex>& items, unsigned keyBits) {
+    const std::size_t count = items.size();
+    if (count < SMALL) {
+        std::stable_sort(items.begin(), items.end(), [](const KeyIndex& a, const KeyIndex& b) { return a.key < b.key; });
+        return;
+    }
+
+    const std::size_t chunks = (count + CHUNK - 1) / CHUNK;
+    std::vector<std::array<std::size_t, BUCKETS>> offsets(chunks);
+    std::vector<KeyIndex> scratch(count);
+    KeyIndex* src = items.data();
+    KeyIndex* dst = scratch.data();
+    const unsigned passes = (std::min(keyBits, 64u) + DIGIT_BITS - 1) / DIGIT_BITS;
+    for (unsigned pass = 0; pass < passes; ++pass) {
+        const unsigned shift = pass * DIGIT_BITS;
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, chunks, 1), [&](const tbb::blocked_range<std::size_t>& range) {
+            for (std::size_t c = range.begin(); c != range.end(); ++c) {
+                std::array<std::size_t, BUCKETS>& histogram = offsets[c];
+                histogram.fill(0);
+                const std::size_t end = std::min(count, (c + 1) * CHUNK);
+                for (std::size_t i = c * CHUNK; i < end; ++i) {
+                    ++histogram[(src[i].key >> shift) & (BUCKETS - 1)];
+                }
+            }
+        });
+
+        // 桶优先、块次之的前缀和即每块每桶的写入起点，保证稳定。
+        std::size_t total = 0;
+        bool single = false;
+        for (std::size_t b = 0; b < BUCKETS; ++b) {
+            std::size_t bucket = 0;
+            for (std::size_t c = 0; c < chunks; ++c) {
+                const std::size_t n = offsets[c][b];
+                offsets[c][b] = total;
+                total += n;
+                bucket += n;
+            }
+            single = single || bucket == count;
+        }
+        if (single) {
+            continue;
+        }
+
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, chunks, 1), [&](const tbb::blocked_range<std::size_t>& range) {
+            const TraceSpan span("radix_scatter");
+            for (std::size_t c = range.begin(); c != range.end(); ++c) {
+                std::array<std::size_t, BUCKETS>& cursor = offsets[c];
+                const std::size_t end = std::min(count, (c + 1) * CHUNK);
+                for (std::size_t i = c * CHUNK; i < end; ++i) {
+                    dst[cursor[(src[i].key >> shift) & (BUCKETS - 1)]++] = src[i];
+                }
+            }
+        });
+        std::swap(src, dst);
+    }
+    if (src != items.data()) {
+        items.swap(scratch);
+    }
+}
+
+}  // namespace tsdf
@@ -0,0 +1,332 @@
+#include "shard_filter.h"
+
+#include "cloud_io.h"
+#include "job_runner.h"
+#include "pcd_io.h"
+#include "telemetry.h"
+#include "tiled_filter.h"
+
+#include <PointCloud.h>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <tbb/parallel_sort.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+extern char** environ;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr int REAP_POLL_MS = 5;
+
+// worker 使用的配置：只含影响单块滤波结果的 Filter 键，数值按最短往返精度写出。
+// 不写任何路径（配置解析器不处理转义，路径里的引号、# 会被误读）；必填的 Base.depth_path 由 worker 用命令行上的分块路径覆盖。
+std::string renderFilterConfig(const tsdf::AppConfig& cfg) {
+    const tsdf::FilterConfig& filter = cfg.filter;
+    std::ostringstream out;
+    out.precision(17);
+    out << "Base:\n"
+        << "    output_dir: .\n"
+        << "    save_pcd_en: false\n"
+        << "Filter:\n"
+        << "    enable: true\n"
+        << "    engine: " << tsdf::engineName(filter.engine) << '\n'
+        << "    mode: " << tsdf::filterModeName(filter.modes) << '\n'
+        << "    radius: " << filter.radius << '\n'
+        << "    n_sigma: " << filter.n_sigma << '\n'
+        << "    absolute_error: " << filter.absolute_error << '\n'
+        << "    use_absolute_error: " << (filter.use_absolute_error ? "true" : "false") << '\n'
+        << "    remove_isolated: " << (filter.remove_isolated ? "true" : "false") << '\n'
+        << "    min_neighbors: " << filter.min_neighbors << '\n'
+        << "    sor_neighbors: " << filter.sor_neighbors << '\n'
+        << "    std_ratio: " << filter.std_ratio << '\n';
+    return out.str();
+}
+
+// 输入文件的身份：路径、大小与修改时间，任一变化都使 work_dir 中的已有结果失效。
+std::string inputSignature(const fs::path& input) {
+    struct stat st {};
+    if (::stat(input.c_str(), &st) != 0) {
+        throw std::runtime_error("无法读取输入文件信息: " + input.string());
+    }
+    std::ostringstream out;
+    out << "input " << input.string() << " bytes " << st.st_size << " mtime " << st.st_mtim.tv_sec << '.' << st.st_mtim.tv_nsec;
+    return out.str();
+}
+
+std::string readText(const fs::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream out;
+    out << in.rdbuf();
+    return out.str();
+}
+
+void writeText(const fs::path& path, const std::string& text) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << text;
+    if (!out) {
+        throw std::runtime_error("写文件失败: " + path.string());
+    }
+}
+
+std::string shellQuote(const std::string& value) {
+    std::string quoted = "'";
+    for (const char c : value) {
+        quoted += c == '\'' ? std::string("'\\''") : std::string(1, c);
+    }
+    return quoted + "'";
+}
+
+std::string replaceAll(std::string text, const std::string& from, const std::string& to) {
+    for (std::size_t pos = text.find(from); pos != std::string::npos; pos = text.find(from, pos + to.size())) {
+        text.replace(pos, from.size(), to);
+    }
+    return text;
+}
+
+pid_t spawn(const std::vector<std::string>& args) {
+    std::vector<char*> argv;
+    for (const std::string& arg : args) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+    pid_t pid = 0;
+    const int rc = ::posix_spawn(&pid, argv.front(), nullptr, nullptr, argv.data(), environ);
+    if (rc != 0) {
+        throw std::runtime_error("启动 worker 失败: " + args.front() + ": " + std::strerror(rc));
+    }
+    return pid;
+}
+
+std::vector<std::uint64_t> readKept(const fs::path& path) {
+    const std::uintmax_t bytes = fs::file_size(path);
+    if (bytes % sizeof(std::uint64_t) != 0) {
+        throw std::runtime_error("分块结果文件长度异常: " + path.string());
+    }
+    std::vector<std::uint64_t> kept(static_cast<std::size_t>(bytes / sizeof(std::uint64_t)));
+    std::ifstream in(path, std::ios::binary);
+    in.read(reinterpret_cast<char*>(kept.data()), static_cast<std::streamsize>(bytes));
+    if (!in) {
+        throw std::runtime_error("读取分块结果失败: " + path.string());
+    }
+    return kept;
+}
+
+// 分片目录的独占锁（flock 旁路文件 <work_dir>.lock，分片目录本身会被整体删除）：同一输入的并发作业
+// （守护进程内的多个作业或多个 CLI 进程）依次使用同一分片目录，后来者等前者结束后复用或重建其中的结果。
+class WorkDirLock {
+public:
+    WorkDirLock(const fs::path& workDir, std::ostream& log) {
+        fs::path path = workDir;
+        path += ".lock";
+        if (path.has_parent_path()) {
+            fs::create_directories(path.parent_path());
+        }
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            throw std::runtime_error("无法打开分片目录锁: " + path.string() + ": " + std::strerror(errno));
+        }
+        if (::flock(fd_, LOCK_EX | LOCK_NB) != 0) {
+            log << "分片目录 " << workDir << " 正被其他作业使用，等待其结束\n";
+            while (::flock(fd_, LOCK_EX) != 0) {
+                if (errno != EINTR) {
+                    ::close(fd_);
+                    throw std::runtime_error("锁定分片目录失败: " + path.string() + ": " + std::strerror(errno));
+                }
+            }
+        }
+    }
+
+    ~WorkDirLock() { ::close(fd_); }
+
+    WorkDirLock(const WorkDirLock&) = delete;
+    WorkDirLock& operator=(const WorkDirLock&) = delete;
+
+private:
+    int fd_ = -1;
+};
+
+}  // namespace
+
+namespace tsdf {
+
+ShardStats runShardedFilter(const AppConfig& cfg, const fs::path& output, std::ostream& log) {
+    ShardStats stats;
+    const fs::path& input = cfg.base.depth_path;
+    const fs::path workDir = !cfg.shard.work_dir.empty()
+                               ? cfg.shard.work_dir
+                               : (output.empty() ? cfg.base.output_dir : output.parent_path()) / (".livomesh_shards_" + input.stem().string());
+    const WorkDirLock lock(workDir, log);
+
+    const auto partitionStart = std::chrono::steady_clock::now();
+    ScopedStage partitionStage("shard_partition");
+    // 每个 worker 是独立进程（可能在别的节点上），内存上限按单块计。
+    const TilePartitioner partitioner(input, cfg.filter, 1);
+    stats.inputPoints = partitioner.inputPoints();
+    stats.tileSize = partitioner.tileSize();
+    const std::size_t tileCount = partitioner.tileCount();
+
+    const std::string filterYaml = renderFilterConfig(cfg);
+    const std::string plan = inputSignature(input) + '\n' + partitioner.describe() + '\n' + filterYaml;
+    const fs::path planPath = workDir / "plan.txt";
+    if (fs::exists(planPath) && readText(planPath) != plan) {
+        log << "分片目录 " << workDir << " 的输入或分块划分已变化，丢弃旧结果\n";
+        fs::remove_all(workDir);
+    }
+    fs::create_directories(workDir);
+    const fs::path filterPath = workDir / "filter.yaml";
+    writeText(filterPath, filterYaml);
+    writeText(planPath, plan);
+
+    auto keptPath = [&](std::size_t tile) { return workDir / ("tile_" + std::to_string(tile) + ".kept"); };
+    const std::vector<std::size_t> counts = partitioner.spill(workDir, [&](std::size_t tile) { return fs::exists(keptPath(tile)); });
+    std::vector<std::size_t> pending;
+    for (std::size_t tile = 0; tile < tileCount; ++tile) {
+        if (fs::exists(keptPath(tile))) {
+            ++stats.reused;
+        } else if (counts[tile] > 0) {
+            pending.push_back(tile);
+        }
+    }
+    stats.tiles = stats.reused + pending.size();
+    stats.partitionMs = elapsedMs(partitionStart);
+    partitionStage.setPoints(stats.inputPoints);
+    partitionStage.finish();
+
+    const auto workStart = std::chrono::steady_clock::now();
+    ScopedStage workStage("shard_work");
+    const std::string self = fs::read_symlink("/proc/self/exe").string();
+    struct Running {
+        pid_t pid;
+        std::size_t tile;
+        int slot;
+    };
+    std::vector<Running> running;
+    std::vector<int> freeSlots;
+    for (int slot = cfg.shard.workers - 1; slot >= 0; --slot) {
+        freeSlots.push_back(slot);
+    }
+    std::string failure;
+    std::size_t next = 0;
+    std::size_t finished = 0;
+    while ((failure.empty() && next < pending.size()) || !running.empty()) {
+        while (failure.empty() && next < pending.size() && !freeSlots.empty()) {
+            const std::size_t tile = pending[next++];
+            const int slot = freeSlots.back();
+            std::vector<std::string> args{self, "--shard-worker", filterPath.string(), TilePartitioner::tilePath(workDir, tile).string(),
+                                          keptPath(tile).string()};
+            if (!cfg.shard.launcher.empty()) {
+                std::string command;
+                for (const std::string& arg : args) {
+                    command += (command.empty() ? "" : " ") + shellQuote(arg);
+                }
+                std::string line = cfg.shard.launcher;
+                if (line.find("{cmd}") == std::string::npos) {
+                    line += " {cmd}";
+                }
+                line = replaceAll(replaceAll(line, "{tile}", std::to_string(tile)), "{slot}", std::to_string(slot));
+                args = {"/bin/sh", "-c", replaceAll(line, "{cmd}", command)};
+            }
+            try {
+                running.push_back(Running{spawn(args), tile, slot});
+                freeSlots.pop_back();
+                ++stats.launched;
+            } catch (const std::exception& ex) {
+                failure = ex.what();
+            }
+        }
+
+        bool reaped = false;
+        for (auto it = running.begin(); it != running.end();) {
+            int status = 0;
+            const pid_t rc = ::waitpid(it->pid, &status, WNOHANG);
+            if (rc == 0 || (rc < 0 && errno == EINTR)) {
+                ++it;
+                continue;
+            }
+            reaped = true;
+            const bool ok = rc == it->pid && WIFEXITED(status) && WEXITSTATUS(status) == 0 && fs::exists(keptPath(it->tile));
+            if (ok) {
+                std::error_code ec;
+                fs::remove(TilePartitioner::tilePath(workDir, it->tile), ec);
+                log << "  分块 " << it->tile << " 完成 (" << ++finished << '/' << pending.size() << ")\n";
+            } else if (failure.empty()) {
+                failure = "分块 " + std::to_string(it->tile) + " 的 worker 失败"
+                        + (rc == it->pid && WIFEXITED(status) ? "（退出码 " + std::to_string(WEXITSTATUS(status)) + "）" : std::string());
+            }
+            freeSlots.push_back(it->slot);
+            it = running.erase(it);
+        }
+        if (!reaped) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(REAP_POLL_MS));
+        }
+    }
+    stats.workMs = elapsedMs(workStart);
+    workStage.finish();
+    if (!failure.empty()) {
+        throw std::runtime_error(failure + "，已完成的分块保留在 " + workDir.string() + "，重新运行时复用");
+    }
+
+    const auto mergeStart = std::chrono::steady_clock::now();
+    ScopedStage mergeStage("shard_merge");
+    std::vector<std::uint64_t> kept;
+    for (std::size_t tile = 0; tile < tileCount; ++tile) {
+        if (fs::exists(keptPath(tile))) {
+            const std::vector<std::uint64_t> part = readKept(keptPath(tile));
+            kept.insert(kept.end(), part.begin(), part.end());
+        }
+    }
+    // 各块核心区互不重叠，按原始点号排序即得与整图滤波相同的次序。
+    tbb::parallel_sort(kept.begin(), kept.end());
+    stats.keptPoints = kept.size();
+    if (!output.empty()) {
+        writeSelectedPoints(input, output, kept, cfg.base.keep_fields);
+        mergeStage.addBytesWritten(fs::file_size(output));
+    }
+    stats.mergeMs = elapsedMs(mergeStart);
+    mergeStage.setPoints(stats.keptPoints);
+    mergeStage.finish();
+
+    std::error_code ec;
+    fs::remove_all(workDir, ec);
+    return stats;
+}
+
+void runShardWorker(const fs::path& filterConfig, const fs::path& tile, const fs::path& kept) {
+    const AppConfig cfg = loadAppConfig(filterConfig, {"Base.depth_path=" + tile.string()});
+    if (!fs::exists(tile)) {
+        throw std::runtime_error("分块文件不存在: " + tile.string());
+    }
+    const std::vector<std::uint64_t> indices = filterTileRecords(readTileRecords(tile), cfg.filter, nullptr, nullptr);
+    const fs::path partial = kept.string() + ".part";
+    {
+        std::ofstream out(partial, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(indices.data()), static_cast<std::streamsize>(indices.size() * sizeof(std::uint64_t)));
+        if (!out) {
+            throw std::runtime_error("写分块结果失败: " + partial.string());
+        }
+    }
+    fs::rename(partial, kept);
+}
+
+}  // namespace tsdf
@@ -0,0 +1,13 @@
+#include "stage_pipeline.h"
+
+namespace tsdf {
+
+void printPipelineStats(std::ostream& out, const std::vector<PipelineStageStats>& stats) {
+    for (const PipelineStageStats& s : stats) {
+        out << "  流水线 " << s.pipeline << '.' << s.name << ": " << s.workers << " 线程  " << s.items << " 项"
+            << "  占用率: " << s.occupancy * 100.0 << "%"
+            << "  等上游: " << s.waitInMs << " ms  等下游: " << s.waitOutMs << " ms\n";
+    }
+}
+
+}  // namespace tsdf
@@ -0,0 +1,160 @@
+#include "surface_thinning.h"
+
+#include "noise_criterion.h"
+#include "telemetry.h"
+#include "voxel_downsample.h"
+#include "voxel_index.h"
+
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/parallel_sort.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+namespace {
+
+constexpr std::size_t POINT_GRAIN = 1 << 14;
+
+struct GatherScratch {
+    std::vector<float> cx, cy, cz;
+    std::vector<std::uint32_t> sorted;
+    std::vector<float> nx, ny, nz;
+};
+
+// 未复用滤波邻域时的回退：在整块点云上按 radius 建体素索引，只为保留点拟合并投影。
+std::vector<CCVector3> projectKept(const CCCoreLib::PointCloud& cloud, const std::vector<std::uint8_t>& keep, const tsdf::FilterConfig& cfg) {
+    const std::size_t count = cloud.size();
+    const CCVector3* points = count > 0 ? cloud.getPoint(0) : nullptr;
+    std::vector<CCVector3> projected(points, points + count);
+    tsdf::VoxelIndex index;
+    index.build(points, count, cfg.radius);
+
+    const PointCoordinateType radius = static_cast<PointCoordinateType>(cfg.radius);
+    const double squareRadius = static_cast<double>(radius) * radius;
+    tbb::enumerable_thread_specific<GatherScratch> scratchPool;
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, index.cellCount(), 64), [&](const tbb::blocked_range<std::size_t>& range) {
+        const tsdf::TraceSpan span("thin_cells");
+        GatherScratch& scratch = scratchPool.local();
+        for (std::size_t c = range.begin(); c != range.end(); ++c) {
+            const tsdf::VoxelIndex::Range own = index.cell(c);
+            bool any = false;
+            for (std::uint32_t s = own.begin; s < own.end && !any; ++s) {
+                any = keep[index.originalIndex(s)] != 0;
+            }
+            if (!any) {
+                continue;
+            }
+            const std::size_t candidates = index.gatherNeighborhood(c, scratch.cx, scratch.cy, scratch.cz, scratch.sorted);
+            if (scratch.nx.size() < candidates) {
+                scratch.nx.resize(candidates);
+                scratch.ny.resize(candidates);
+                scratch.nz.resize(candidates);
+            }
+            for (std::uint32_t s = own.begin; s < own.end; ++s) {
+                const std::uint32_t original = index.originalIndex(s);
+                if (!keep[original]) {
+                    continue;
+                }
+                const CCVector3 query(index.xs()[s], index.ys()[s], index.zs()[s]);
+                std::size_t neighbors = 0;
+                for (std::size_t k = 0; k < candidates; ++k) {
+                    const float dx = scratch.cx[k] - query.x;
+                    const float dy = scratch.cy[k] - query.y;
+                    const float dz = scratch.cz[k] - query.z;
+                    const double d2 = static_cast<double>(dx) * dx + static_cast<double>(dy) * dy + static_cast<double>(dz) * dz;
+                    if (d2 <= squareRadius && scratch.sorted[k] != s) {
+                        scratch.nx[neighbors] = scratch.cx[k];
+                        scratch.ny[neighbors] = scratch.cy[k];
+                        scratch.nz[neighbors] = scratch.cz[k];
+                        ++neighbors;
+                    }
+                }
+                tsdf::PlaneFit plane;
+                if (neighbors >= 3) {
+                    plane = tsdf::fitPlane(scratch.nx.data(), scratch.ny.data(), scratch.nz.data(), neighbors);
+                }
+                projected[original] =
+                    tsdf::projectToSurface(query, plane, scratch.nx.data(), scratch.ny.data(), scratch.nz.data(), neighbors, cfg.thin, cfg.radius);
+            }
+        }
+    });
+    return projected;
+}
+
+}  // namespace
+
+namespace tsdf {
+
+std::unique_ptr<CCCoreLib::ReferenceCloud> thinCloud(CCCoreLib::PointCloud& cloud,
+                                                     const CCCoreLib::ReferenceCloud& kept,
+                                                     const FilterConfig& cfg,
+                                                     const std::vector<CCVector3>* projected,
+                                                     ThinningStats* stats) {
+    ThinningStats local;
+    ThinningStats& out = stats ? *stats : local;
+    out = ThinningStats{};
+    const std::size_t keptCount = kept.size();
+    out.input = keptCount;
+
+    std::vector<std::uint32_t> indices(keptCount);
+    for (std::size_t i = 0; i < keptCount; ++i) {
+        indices[i] = kept.getPointGlobalIndex(static_cast<unsigned>(i));
+    }
+    // CCCoreLib 引擎按八叉树单元顺序输出，统一为原始索引升序。
+    tbb::parallel_sort(indices.begin(), indices.end());
+
+    // 1. 投影：先全部算完再写回，保证每个点的邻域都是投影前的原始坐标。
+    if (cfg.thin != ThinMethod::kNone) {
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<CCVector3> computed;
+        out.reused = projected && projected->size() == cloud.size();
+        if (!out.reused) {
+            std::vector<std::uint8_t> keep(cloud.size(), 0);
+            for (const std::uint32_t index : indices) {
+                keep[index] = 1;
+            }
+            computed = projectKept(cloud, keep, cfg);
+            projected = &computed;
+        }
+        const double shift = tbb::parallel_reduce(
+            tbb::blocked_range<std::size_t>(0, keptCount, POINT_GRAIN), 0.0,
+            [&](const tbb::blocked_range<std::size_t>& range, double sum) {
+                for (std::size_t i = range.begin(); i != range.end(); ++i) {
+                    CCVector3* point = cloud.point(indices[i]);
+                    const CCVector3& target = (*projected)[indices[i]];
+                    sum += std::sqrt(static_cast<double>((target - *point).norm2()));
+                    *point = target;
+                }
+                return sum;
+            },
+            [](double a, double b) { return a + b; });
+        out.meanShift = keptCount > 0 ? shift / static_cast<double>(keptCount) : 0.0;
+        cloud.invalidateBoundingBox();
+        out.projectMs = elapsedMs(start);
+    }
+
+    // 2. 体素合并：均值写回每个体素中原始索引最小的代表点。
+    if (cfg.merge_voxel > 0.0 && keptCount > 0) {
+        const auto start = std::chrono::steady_clock::now();
+        indices = mergeVoxels(cloud, indices, cfg.merge_voxel, true);
+        out.mergeMs = elapsedMs(start);
+    }
+
+    auto result = std::make_unique<CCCoreLib::ReferenceCloud>(&cloud);
+    if (!result->reserve(static_cast<unsigned>(indices.size()))) {
+        throw std::runtime_error("压薄结果内存不足");
+    }
+    for (const std::uint32_t index : indices) {
+        result->addPointIndex(index);
+    }
+    out.output = indices.size();
+    return result;
+}
+
+}  // namespace tsdf
@@ -0,0 +1,221 @@
+#include "telemetry.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#define LIVOMESH_HAS_RUSAGE 1
+#endif
+
+namespace {
+
+thread_local int stageDepth = 0;
+
+double processCpuMs() {
+#ifdef LIVOMESH_HAS_RUSAGE
+    rusage usage {};
+    if (::getrusage(RUSAGE_SELF, &usage) == 0) {
+        return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1.0e3 + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1.0e3;
+    }
+#endif
+    return 0.0;
+}
+
+// 线程在 trace 中的编号：按首次出现顺序分配的小整数，比原生线程 id 易读。
+std::uint32_t traceThreadId() {
+    static std::atomic<std::uint32_t> next{1};
+    thread_local const std::uint32_t id = next.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+std::string escapeJson(const std::string& text) {
+    std::string out;
+    out.reserve(text.size() + 2);
+    for (const char c : text) {
+        switch (c) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned>(c));
+                    out += buffer;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+std::ofstream openOutput(const std::filesystem::path& path) {
+    if (!path.parent_path().empty()) {
+        std::filesystem::create_directories(path.parent_path());
+    }
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("无法写入度量文件: " + path.string());
+    }
+    return out;
+}
+
+}  // namespace
+
+namespace tsdf {
+
+double peakRssMb() {
+#ifdef LIVOMESH_HAS_RUSAGE
+    rusage usage {};
+    if (::getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+        return static_cast<double>(usage.ru_maxrss) / (1024.0 * 1024.0);
+#else
+        return static_cast<double>(usage.ru_maxrss) / 1024.0;
+#endif
+    }
+#endif
+    return 0.0;
+}
+
+std::atomic<bool> Telemetry::enabled_{false};
+std::atomic<bool> Telemetry::tracing_{false};
+
+Telemetry& Telemetry::instance() {
+    static Telemetry telemetry;
+    return telemetry;
+}
+
+void Telemetry::enable(bool trace) {
+    origin_ = std::chrono::steady_clock::now();
+    enabled_.store(true, std::memory_order_relaxed);
+    tracing_.store(trace, std::memory_order_relaxed);
+}
+
+void Telemetry::setInfo(const std::string& key, const std::string& value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    info_[key] = value;
+}
+
+double Telemetry::nowUs() const {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - origin_).count();
+}
+
+void Telemetry::addStage(const StageRecord& record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stages_.push_back(record);
+}
+
+void Telemetry::addPipelineStage(const PipelineStageStats& stats) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pipelineStages_.push_back(stats);
+}
+
+void Telemetry::addTraceEvent(const char* name, double startUs, double durationUs) {
+    const std::uint32_t tid = traceThreadId();
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.push_back({name, startUs, durationUs, tid});
+}
+
+void Telemetry::writeReport(const std::filesystem::path& path) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ofstream out = openOutput(path);
+    // 固定 3 位小数（微秒分辨率）：默认 6 位有效数字在运行十几秒后就会截断 start_ms / wall_ms。
+    out << std::fixed << std::setprecision(3);
+    std::vector<StageRecord> stages = stages_;
+    std::stable_sort(stages.begin(), stages.end(), [](const StageRecord& a, const StageRecord& b) { return a.startMs < b.startMs; });
+
+    out << "{\n  \"info\": {";
+    bool first = true;
+    for (const auto& [key, value] : info_) {
+        out << (first ? "\n" : ",\n") << "    \"" << escapeJson(key) << "\": \"" << escapeJson(value) << '"';
+        first = false;
+    }
+    out << (first ? "},\n" : "\n  },\n");
+    out << "  \"hardware_threads\": " << std::max(1u, std::thread::hardware_concurrency()) << ",\n";
+    out << "  \"total_ms\": " << nowUs() / 1.0e3 << ",\n";
+    out << "  \"peak_rss_mb\": " << peakRssMb() << ",\n";
+    out << "  \"stages\": [";
+    for (std::size_t i = 0; i < stages.size(); ++i) {
+        const StageRecord& s = stages[i];
+        const double seconds = s.wallMs / 1.0e3;
+        out << (i == 0 ? "\n" : ",\n")
+            << "    {\"name\": \"" << escapeJson(s.name) << "\", \"depth\": " << s.depth
+            << ", \"start_ms\": " << s.startMs << ", \"wall_ms\": " << s.wallMs << ", \"cpu_ms\": " << s.cpuMs
+            << ", \"points\": " << s.points
+            << ", \"points_per_s\": " << (seconds > 0.0 ? static_cast<double>(s.points) / seconds : 0.0)
+            << ", \"bytes_read\": " << s.bytesRead << ", \"bytes_written\": " << s.bytesWritten
+            << ", \"peak_rss_mb\": " << s.peakRssMb << ", \"utilization\": " << s.utilization << '}';
+    }
+    out << (stages.empty() ? "],\n" : "\n  ],\n");
+    out << "  \"pipeline_stages\": [";
+    for (std::size_t i = 0; i < pipelineStages_.size(); ++i) {
+        const PipelineStageStats& s = pipelineStages_[i];
+        out << (i == 0 ? "\n" : ",\n")
+            << "    {\"pipeline\": \"" << escapeJson(s.pipeline) << "\", \"name\": \"" << escapeJson(s.name) << "\", \"workers\": " << s.workers
+            << ", \"items\": " << s.items << ", \"wall_ms\": " << s.wallMs << ", \"busy_ms\": " << s.busyMs
+            << ", \"wait_in_ms\": " << s.waitInMs << ", \"wait_out_ms\": " << s.waitOutMs << ", \"occupancy\": " << s.occupancy << '}';
+    }
+    out << (pipelineStages_.empty() ? "]\n" : "\n  ]\n") << "}\n";
+}
+
+void Telemetry::writeTrace(const std::filesystem::path& path) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ofstream out = openOutput(path);
+    // ts / dur 以微秒计，保留到纳秒，长时间运行后各区间仍能在 Perfetto 中对齐。
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    for (std::size_t i = 0; i < events_.size(); ++i) {
+        const TraceEvent& e = events_[i];
+        out << (i == 0 ? "\n" : ",\n") << "{\"name\": \"" << escapeJson(e.name) << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << e.tid
+            << ", \"ts\": " << e.startUs << ", \"dur\": " << e.durationUs << '}';
+    }
+    out << "\n]}\n";
+}
+
+ScopedStage::ScopedStage(const char* name) {
+    if (!Telemetry::enabled()) {
+        return;
+    }
+    name_ = name;
+    record_.name = name;
+    record_.depth = stageDepth++;
+    startUs_ = Telemetry::instance().nowUs();
+    startCpuMs_ = processCpuMs();
+}
+
+void ScopedStage::finish() {
+    if (!name_) {
+        return;
+    }
+    --stageDepth;
+    Telemetry& telemetry = Telemetry::instance();
+    const double endUs = telemetry.nowUs();
+    record_.startMs = startUs_ / 1.0e3;
+    record_.wallMs = (endUs - startUs_) / 1.0e3;
+    record_.cpuMs = processCpuMs() - startCpuMs_;
+    record_.peakRssMb = peakRssMb();
+    const double threads = static_cast<double>(std::max(1u, std::thread::hardware_concurrency()));
+    record_.utilization = record_.wallMs > 0.0 ? record_.cpuMs / (record_.wallMs * threads) : 0.0;
+    telemetry.addStage(record_);
+    if (Telemetry::tracing()) {
+        telemetry.addTraceEvent(name_, startUs_, endUs - startUs_);
+    }
+    name_ = nullptr;
+}
+
+}  // namespace tsdf
@@ -0,0 +1,102 @@
+#include "cloud_cache.h"
+
+#include "cloud_io.h"
+#include "synthetic_cloud.h"
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace tsdf {
+namespace {
+
+class CloudCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = fs::temp_directory_path() / ("livomesh_cache_test_" + std::to_string(::getpid()));
+        fs::create_directories(dir_);
+        input_ = dir_ / "scene.pcd";
+        writeSyntheticPcd(input_, generateSyntheticCloud(20000));
+        cloud_ = std::make_unique<CCCoreLib::PointCloud>(loadCloud(input_));
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        fs::remove_all(dir_, ec);
+    }
+
+    bool save() {
+        CachedOctree octree(cloud_.get());
+        return octree.buildParallel() > 0 && saveCloudCache(input_, *cloud_, &octree);
+    }
+
+    void expectHit() {
+        CloudCacheEntry entry;
+        ASSERT_TRUE(loadCloudCache(input_, &entry));
+        ASSERT_EQ(entry.cloud->size(), cloud_->size());
+        EXPECT_EQ(std::memcmp(entry.cloud->getPoint(0), cloud_->getPoint(0), cloud_->size() * sizeof(CCVector3)), 0);
+        ASSERT_TRUE(entry.octree);
+        EXPECT_EQ(entry.octree->codes().size(), cloud_->size());
+    }
+
+    std::size_t filesInDir() const {
+        return static_cast<std::size_t>(std::distance(fs::directory_iterator(dir_), fs::directory_iterator()));
+    }
+
+    fs::path dir_;
+    fs::path input_;
+    std::unique_ptr<CCCoreLib::PointCloud> cloud_;
+};
+
+TEST_F(CloudCacheTest, SaveThenLoad_Hits) {
+    ASSERT_TRUE(save());
+    expectHit();
+    EXPECT_EQ(filesInDir(), 2u);
+}
+
+TEST_F(CloudCacheTest, CorruptPayload_Misses) {
+    ASSERT_TRUE(save());
+    const fs::path cache = cloudCachePath(input_);
+    const std::uintmax_t size = fs::file_size(cache);
+    {
+        // 改动编码表末尾的一个字节，文件头与缓存键不变。
+        std::fstream file(cache, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekg(static_cast<std::streamoff>(size - 3));
+        char byte = 0;
+        file.read(&byte, 1);
+        byte = static_cast<char>(byte ^ 0x5a);
+        file.seekp(static_cast<std::streamoff>(size - 3));
+        file.write(&byte, 1);
+    }
+    CloudCacheEntry entry;
+    EXPECT_FALSE(loadCloudCache(input_, &entry));
+}
+
+TEST_F(CloudCacheTest, ConcurrentSaves_LeaveValidCache) {
+    std::vector<std::thread> writers;
+    std::vector<char> ok(4, 0);
+    for (std::size_t i = 0; i < ok.size(); ++i) {
+        writers.emplace_back([&, i] { ok[i] = save() ? 1 : 0; });
+    }
+    for (std::thread& writer : writers) {
+        writer.join();
+    }
+    for (const char saved : ok) {
+        EXPECT_TRUE(saved);
+    }
+    expectHit();
+    EXPECT_EQ(filesInDir(), 2u);
+}
+
+}  // namespace
+}  // namespace tsdf
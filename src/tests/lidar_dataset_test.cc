@@ -0,0 +1,210 @@
+#include "lidar_dataset.h"
+
+#include "synthetic_cloud.h"
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace tsdf {
+namespace {
+
+// 绕 (1, 2, 3) 轴旋转约 1 rad，平移 (12.5, -3.25, 0.75)。
+constexpr double QUAT[4] = {0.1281, 0.2562, 0.3843, 0.8776};
+constexpr double TRANS[3] = {12.5, -3.25, 0.75};
+
+FramePose parse(const std::string& line) {
+    FramePose pose;
+    EXPECT_TRUE(parsePoseLine(line, 1, "poses.txt", &pose)) << line;
+    return pose;
+}
+
+std::string joined(const std::vector<double>& values) {
+    std::ostringstream out;
+    out.precision(17);
+    for (const double v : values) {
+        out << v << ' ';
+    }
+    return out.str();
+}
+
+// 同一位姿的四种写法。
+std::vector<std::string> poseLines() {
+    const FramePose pose = parse(joined({TRANS[0], TRANS[1], TRANS[2], QUAT[0], QUAT[1], QUAT[2], QUAT[3]}));
+    const double* r = pose.rotation;
+    const double* t = pose.translation;
+    return {
+        joined({TRANS[0], TRANS[1], TRANS[2], QUAT[0], QUAT[1], QUAT[2], QUAT[3]}),
+        joined({1700000000.25, TRANS[0], TRANS[1], TRANS[2], QUAT[0], QUAT[1], QUAT[2], QUAT[3]}),
+        joined({r[0], r[1], r[2], t[0], r[3], r[4], r[5], t[1], r[6], r[7], r[8], t[2]}),
+        joined({r[0], r[1], r[2], t[0], r[3], r[4], r[5], t[1], r[6], r[7], r[8], t[2], 0, 0, 0, 1}),
+    };
+}
+
+CCVector3 reference(const FramePose& pose, const CCVector3& p) {
+    const double* r = pose.rotation;
+    const double* t = pose.translation;
+    return CCVector3(static_cast<float>(r[0] * p.x + r[1] * p.y + r[2] * p.z + t[0]), static_cast<float>(r[3] * p.x + r[4] * p.y + r[5] * p.z + t[1]),
+                     static_cast<float>(r[6] * p.x + r[7] * p.y + r[8] * p.z + t[2]));
+}
+
+void expectNear(const CCVector3& a, const CCVector3& b, const std::string& what) {
+    // float 矩阵乘的舍入误差随坐标量级增长。
+    const auto tol = [](float v) { return 1e-5f * (1.0f + std::abs(v)); };
+    EXPECT_NEAR(a.x, b.x, tol(b.x)) << what;
+    EXPECT_NEAR(a.y, b.y, tol(b.y)) << what;
+    EXPECT_NEAR(a.z, b.z, tol(b.z)) << what;
+}
+
+TEST(LidarDataset, PoseFormats_SameRigidTransform) {
+    const std::vector<std::string> lines = poseLines();
+    const FramePose expected = parse(lines[0]);
+    // 四元数已归一化：旋转矩阵正交。
+    const double* r = expected.rotation;
+    EXPECT_NEAR(r[0] * r[0] + r[1] * r[1] + r[2] * r[2], 1.0, 1e-12);
+    EXPECT_NEAR(r[0] * r[3] + r[1] * r[4] + r[2] * r[5], 0.0, 1e-12);
+    for (const std::string& line : lines) {
+        const FramePose pose = parse(line);
+        for (int k = 0; k < 9; ++k) {
+            EXPECT_NEAR(pose.rotation[k], expected.rotation[k], 1e-12) << line;
+        }
+        for (int k = 0; k < 3; ++k) {
+            EXPECT_DOUBLE_EQ(pose.translation[k], TRANS[k]) << line;
+        }
+    }
+    // 未归一化的四元数按单位四元数处理。
+    const FramePose scaled = parse(joined({TRANS[0], TRANS[1], TRANS[2], 2 * QUAT[0], 2 * QUAT[1], 2 * QUAT[2], 2 * QUAT[3]}));
+    for (int k = 0; k < 9; ++k) {
+        EXPECT_NEAR(scaled.rotation[k], expected.rotation[k], 1e-12);
+    }
+
+    FramePose pose;
+    EXPECT_FALSE(parsePoseLine("", 1, "poses.txt", &pose));
+    EXPECT_FALSE(parsePoseLine("  \t\r", 1, "poses.txt", &pose));
+    EXPECT_FALSE(parsePoseLine("  # timestamp tx ty tz qx qy qz qw", 1, "poses.txt", &pose));
+    EXPECT_THROW(parsePoseLine("1 2 3 4 5 6", 1, "poses.txt", &pose), std::runtime_error);
+    EXPECT_THROW(parsePoseLine("1 2 3 4 5 6 x", 1, "poses.txt", &pose), std::runtime_error);
+    EXPECT_THROW(parsePoseLine("1 2 3 0 0 0 0", 1, "poses.txt", &pose), std::runtime_error);
+}
+
+// SSE 每 4 点一组，其余点走标量尾部：覆盖 count % 4 的全部余数，且不写越界。
+TEST(LidarDataset, TransformPoints_MatchesScalarReference) {
+    const FramePose pose = parse(poseLines()[0]);
+    const std::vector<CCVector3> source = generateSyntheticCloud(1027);
+    for (const std::size_t count : {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 13, 1026, 1027}) {
+        std::vector<CCVector3> points(source.begin(), source.begin() + static_cast<std::ptrdiff_t>(count));
+        const CCVector3 guard(-7.0f, 8.0f, -9.0f);
+        points.push_back(guard);
+        transformPoints(pose, points.data(), count);
+        for (std::size_t i = 0; i < count; ++i) {
+            expectNear(points[i], reference(pose, source[i]), "count=" + std::to_string(count) + " i=" + std::to_string(i));
+        }
+        EXPECT_EQ(points[count].x, guard.x);
+        EXPECT_EQ(points[count].y, guard.y);
+        EXPECT_EQ(points[count].z, guard.z);
+    }
+}
+
+TEST(LidarDataset, FrameOf_SkipsEmptyFrames) {
+    LidarDataset dataset;
+    // 帧 0 与帧 2 为空帧，与下一帧的起点相同。
+    for (const std::size_t offset : {0, 0, 5, 5, 12}) {
+        LidarFrame frame;
+        frame.pointOffset = offset;
+        dataset.frames.push_back(frame);
+    }
+    EXPECT_EQ(dataset.frameOf(0), 1u);
+    EXPECT_EQ(dataset.frameOf(4), 1u);
+    EXPECT_EQ(dataset.frameOf(5), 3u);
+    EXPECT_EQ(dataset.frameOf(11), 3u);
+    EXPECT_EQ(dataset.frameOf(12), 4u);
+    EXPECT_EQ(dataset.frameOf(1000), 4u);
+}
+
+class LidarDatasetTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = fs::temp_directory_path() / ("livomesh_lidar_dataset_test_" + std::to_string(::getpid()));
+        fs::create_directories(dir_ / "frames");
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        fs::remove_all(dir_, ec);
+    }
+
+    fs::path dir_;
+};
+
+// 11 帧（文件名按数值排序，10.pcd 在 9.pcd 之后）、四种位姿写法轮换：合并点云等于逐帧变换，frameOf 指回所属帧。
+TEST_F(LidarDatasetTest, FrameSequence_TransformsEachFrame) {
+    const std::vector<std::string> lines = poseLines();
+    std::vector<std::vector<CCVector3>> frames;
+    std::vector<FramePose> poses;
+    {
+        std::ofstream out(dir_ / "poses.txt");
+        out << "# tx ty tz qx qy qz qw\n\n";
+        for (std::size_t f = 0; f < 11; ++f) {
+            // 每帧位姿不同：在公共位姿的平移上加帧号。
+            std::istringstream iss(lines[f % lines.size()]);
+            std::vector<double> values;
+            double v = 0.0;
+            while (iss >> v) {
+                values.push_back(v);
+            }
+            const std::size_t tx = values.size() == 7 ? 0 : values.size() == 8 ? 1 : 3;
+            values[tx] += static_cast<double>(f);
+            const std::string line = joined(values);
+            out << line << '\n';
+            poses.push_back(parse(line));
+            frames.push_back(generateSyntheticCloud(100 + f * 37, 100 + f));
+            writeSyntheticPcd(dir_ / "frames" / (std::to_string(f) + ".pcd"), frames.back());
+        }
+    }
+
+    for (const bool pipelined : {false, true}) {
+        AppConfig config;
+        config.base.load_mode = PointCloudLoadMode::kFrameSequence;
+        config.base.pointcloud_format = PointCloudFormat::kPcd;
+        config.base.depth_path = dir_ / "frames";
+        config.base.depth_pose = dir_ / "poses.txt";
+        config.pipeline.enable = pipelined;
+        config.pipeline.decoders = 2;
+        const LidarDataset dataset = loadLidarDataset(config);
+        ASSERT_EQ(dataset.frames.size(), frames.size());
+        std::size_t index = 0;
+        for (std::size_t f = 0; f < frames.size(); ++f) {
+            EXPECT_EQ(dataset.frames[f].path.filename(), std::to_string(f) + ".pcd");
+            ASSERT_EQ(dataset.frames[f].pointCount, frames[f].size());
+            ASSERT_EQ(dataset.frames[f].pointOffset, index);
+            for (const CCVector3& p : frames[f]) {
+                EXPECT_EQ(dataset.frameOf(index), f);
+                expectNear(*dataset.cloud->getPoint(static_cast<unsigned>(index)), reference(poses[f], p),
+                           "pipelined=" + std::to_string(pipelined) + " frame=" + std::to_string(f));
+                ++index;
+            }
+        }
+        EXPECT_EQ(dataset.cloud->size(), index);
+    }
+
+    // 位姿少于帧数时报错。
+    std::ofstream(dir_ / "poses.txt") << lines[0] << '\n';
+    AppConfig config;
+    config.base.load_mode = PointCloudLoadMode::kFrameSequence;
+    config.base.depth_path = dir_ / "frames";
+    config.base.depth_pose = dir_ / "poses.txt";
+    EXPECT_THROW(loadLidarDataset(config), std::runtime_error);
+}
+
+}  // namespace
+}  // namespace tsdf
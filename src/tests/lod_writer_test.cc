@@ -0,0 +1,166 @@
+#include "lod_writer.h"
+
+#include "cloud_io.h"
+#include "synthetic_cloud.h"
+
+#include <gtest/gtest.h>
+
+#include <PointCloud.h>
+#include <ReferenceCloud.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace tsdf {
+namespace {
+
+struct LodIndex {
+    LodIndexHeader header{};
+    std::vector<LodLevelEntry> levels;
+    std::vector<LodNodeEntry> nodes;
+};
+
+LodIndex readIndex(const fs::path& path) {
+    LodIndex index;
+    std::ifstream in(path, std::ios::binary);
+    in.read(reinterpret_cast<char*>(&index.header), sizeof(index.header));
+    index.levels.resize(index.header.levels);
+    index.nodes.resize(index.header.nodes);
+    in.read(reinterpret_cast<char*>(index.levels.data()), static_cast<std::streamsize>(index.levels.size() * sizeof(LodLevelEntry)));
+    in.read(reinterpret_cast<char*>(index.nodes.data()), static_cast<std::streamsize>(index.nodes.size() * sizeof(LodNodeEntry)));
+    EXPECT_TRUE(in) << path;
+    EXPECT_EQ(in.peek(), std::char_traits<char>::eof()) << "trailing bytes in " << path;
+    return index;
+}
+
+// 根立方体内的 63 位 Morton 编码（x 在最低位），按索引中的 origin / size 逐位交织。
+std::uint64_t mortonKey(const LodIndexHeader& header, const CCVector3& p) {
+    const double scale = static_cast<double>(1u << 21) / header.size;
+    std::uint64_t key = 0;
+    for (unsigned k = 0; k < 3; ++k) {
+        const auto cell = std::min<std::uint64_t>(static_cast<std::uint64_t>(std::max(0.0, (p.u[k] - header.origin[k]) * scale)), (1u << 21) - 1);
+        for (int bit = 0; bit < 21; ++bit) {
+            key |= ((cell >> bit) & 1) << (3 * bit + static_cast<int>(k));
+        }
+    }
+    return key;
+}
+
+class LodWriterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = fs::temp_directory_path() / ("livomesh_lod_writer_test_" + std::to_string(::getpid()));
+        fs::create_directories(dir_);
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        fs::remove_all(dir_, ec);
+    }
+
+    fs::path dir_;
+};
+
+// 合成场景 + 一团 64000 点的致密点簇（粗层上单个节点跨多个并行块）+ 若干 NaN 点：
+// 重新读入 index.bin，各层节点区间恰好首尾相接地铺满层文件，区间内每点都落在该节点内，全部层合起来正好是全部有限点。
+TEST_F(LodWriterTest, IndexNodeRanges_TileLevelFiles) {
+    std::vector<CCVector3> points = generateSyntheticCloud(150000);
+    for (int z = 0; z < 40; ++z) {
+        for (int y = 0; y < 40; ++y) {
+            for (int x = 0; x < 40; ++x) {
+                points.emplace_back(1.0f + x * 2.5e-5f, 2.0f + y * 2.5e-5f, 0.5f + z * 2.5e-5f);
+            }
+        }
+    }
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    for (std::size_t i = 0; i < 5; ++i) {
+        points.insert(points.begin() + static_cast<std::ptrdiff_t>(i * 40000), CCVector3(nan, 0.0f, 0.0f));
+    }
+    CCCoreLib::PointCloud cloud;
+    for (const CCVector3& p : points) {
+        cloud.addPoint(p);
+    }
+    CCCoreLib::ReferenceCloud kept(&cloud);
+    kept.addPointIndex(0, static_cast<unsigned>(points.size()));
+
+    std::vector<std::tuple<float, float, float>> expected;
+    for (const CCVector3& p : points) {
+        if (std::isfinite(p.x)) {
+            expected.emplace_back(p.x, p.y, p.z);
+        }
+    }
+    std::sort(expected.begin(), expected.end());
+
+    LodConfig cfg;
+    cfg.grid = 16;
+    cfg.max_node_points = 5000;
+    for (const std::string extension : {".pcd", ".ply"}) {
+        const fs::path dir = dir_ / extension.substr(1);
+        const LodStats stats = writeLodPyramid(dir, kept, nullptr, cfg, extension);
+        const LodIndex index = readIndex(dir / "index.bin");
+        EXPECT_EQ(std::string(index.header.magic, 5), "LMLOD");
+        ASSERT_EQ(index.header.levels, stats.levels);
+        ASSERT_EQ(index.header.nodes, stats.nodes);
+        EXPECT_EQ(index.header.points, expected.size());
+        EXPECT_EQ(index.header.pointStep, 12u);
+        ASSERT_GT(stats.levels, 1u);
+
+        std::vector<std::tuple<float, float, float>> all;
+        std::size_t nextNode = 0;
+        std::size_t maxNodePoints = 0;
+        for (std::size_t d = 0; d < index.levels.size(); ++d) {
+            const LodLevelEntry& level = index.levels[d];
+            const fs::path path = dir / ("level_" + std::to_string(d) + extension);
+            EXPECT_EQ(fs::file_size(path), level.dataOffset + level.points * index.header.pointStep) << path;
+            const CCCoreLib::PointCloud file = loadCloud(path);
+            ASSERT_EQ(file.size(), level.points) << path;
+
+            // 节点按层连续编号，层内编码严格递增，点区间从 0 起首尾相接到层末。
+            ASSERT_EQ(level.firstNode, nextNode);
+            std::uint64_t next = 0;
+            for (std::size_t k = 0; k < level.nodeCount; ++k) {
+                const LodNodeEntry& node = index.nodes[level.firstNode + k];
+                ASSERT_EQ(node.level, d);
+                ASSERT_EQ(node.first, next) << "level " << d << " node " << k;
+                ASSERT_GT(node.count, 0u);
+                if (k > 0) {
+                    ASSERT_GT(node.key, index.nodes[level.firstNode + k - 1].key);
+                }
+                for (std::uint64_t j = node.first; j < node.first + node.count; ++j) {
+                    const CCVector3& p = *file.getPoint(static_cast<unsigned>(j));
+                    const std::uint64_t key = mortonKey(index.header, p);
+                    ASSERT_EQ(d == 0 ? 0 : key >> (63 - 3 * d), node.key) << "level " << d << " point " << j;
+                    all.emplace_back(p.x, p.y, p.z);
+                }
+                next = node.first + node.count;
+                maxNodePoints = std::max<std::size_t>(maxNodePoints, node.count);
+            }
+            ASSERT_EQ(next, level.points) << "level " << d;
+            nextNode += level.nodeCount;
+        }
+        EXPECT_EQ(nextNode, index.nodes.size());
+        EXPECT_EQ(maxNodePoints, stats.maxNodePoints);
+        // 最深一层单节点点数不超过上限。
+        const LodLevelEntry& leaf = index.levels.back();
+        for (std::size_t k = 0; k < leaf.nodeCount; ++k) {
+            EXPECT_LE(index.nodes[leaf.firstNode + k].count, static_cast<std::uint64_t>(cfg.max_node_points));
+        }
+        std::sort(all.begin(), all.end());
+        EXPECT_EQ(all, expected);
+    }
+}
+
+}  // namespace
+}  // namespace tsdf
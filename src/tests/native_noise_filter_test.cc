@@ -0,0 +1,198 @@
+#include "native_noise_filter.h"
+
+#include "synthetic_cloud.h"
+
+#include <gtest/gtest.h>
+
+#include <PointCloud.h>
+#include <ReferenceCloud.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <set>
+#include <vector>
+
+namespace tsdf {
+namespace {
+
+// 远离场景的离群点：落在以场景包围盒最小角为心、半径 50~500 m 的球壳的正卦限内，彼此相距也很远。
+// 包围盒最小角不变，体素网格的对齐与不加离群点时相同。
+std::vector<CCVector3> farOutliers(const std::vector<CCVector3>& scene, std::size_t count) {
+    CCVector3 corner = scene.front();
+    for (const CCVector3& p : scene) {
+        corner.x = std::min(corner.x, p.x);
+        corner.y = std::min(corner.y, p.y);
+        corner.z = std::min(corner.z, p.z);
+    }
+    std::vector<CCVector3> points;
+    std::uint64_t state = 7;
+    const auto next = [&state] {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<double>(state >> 11) / static_cast<double>(1ULL << 53);
+    };
+    for (std::size_t i = 0; i < count; ++i) {
+        const double theta = next() * 6.283185307179586;
+        const double z = next() * 2.0 - 1.0;
+        const double r = 50.0 + next() * 450.0;
+        const double planar = std::sqrt(1.0 - z * z);
+        points.emplace_back(corner.x + static_cast<float>(r * planar * std::abs(std::cos(theta))),
+                            corner.y + static_cast<float>(r * planar * std::abs(std::sin(theta))), corner.z + static_cast<float>(r * std::abs(z)));
+    }
+    return points;
+}
+
+CCCoreLib::PointCloud makeCloud(const std::vector<CCVector3>& points) {
+    CCCoreLib::PointCloud cloud;
+    cloud.reserve(static_cast<unsigned>(points.size()));
+    for (const CCVector3& p : points) {
+        cloud.addPoint(p);
+    }
+    return cloud;
+}
+
+FilterConfig statisticalConfig() {
+    FilterConfig cfg;
+    cfg.engine = FilterEngine::kNative;
+    cfg.modes = {FilterMode::kStatistical};
+    cfg.radius = 0.1;
+    return cfg;
+}
+
+std::set<unsigned> keptIndices(const CCCoreLib::ReferenceCloud& kept) {
+    std::set<unsigned> indices;
+    for (unsigned i = 0; i < kept.size(); ++i) {
+        indices.insert(kept.getPointGlobalIndex(i));
+    }
+    return indices;
+}
+
+// 暴力 kNN 的统计离群判据（同 Open3D remove_statistical_outlier）。
+std::set<unsigned> bruteForceStatistical(const std::vector<CCVector3>& points, const FilterConfig& cfg) {
+    const std::size_t k = std::min(static_cast<std::size_t>(cfg.sor_neighbors), points.size());
+    std::vector<double> mean(points.size(), 0.0);
+    std::vector<double> d2(points.size());
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        for (std::size_t j = 0; j < points.size(); ++j) {
+            const CCVector3 d = points[j] - points[i];
+            d2[j] = static_cast<double>(d.x) * d.x + static_cast<double>(d.y) * d.y + static_cast<double>(d.z) * d.z;
+        }
+        d2[i] = -1.0;  // 自身排在最前，不计入距离和
+        std::partial_sort(d2.begin(), d2.begin() + static_cast<std::ptrdiff_t>(k), d2.end());
+        for (std::size_t j = 1; j < k; ++j) {
+            mean[i] += std::sqrt(d2[j]);
+        }
+        mean[i] /= static_cast<double>(k);
+    }
+    double sum = 0.0;
+    std::size_t valid = 0;
+    for (const double d : mean) {
+        if (d > 0.0) {
+            sum += d;
+            ++valid;
+        }
+    }
+    const double average = sum / static_cast<double>(valid);
+    double squares = 0.0;
+    for (const double d : mean) {
+        if (d > 0.0) {
+            squares += (d - average) * (d - average);
+        }
+    }
+    const double threshold = average + cfg.std_ratio * std::sqrt(squares / static_cast<double>(valid - 1));
+    std::set<unsigned> kept;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        if (mean[i] > 0.0 && mean[i] < threshold) {
+            kept.insert(static_cast<unsigned>(i));
+        }
+    }
+    return kept;
+}
+
+TEST(NativeNoiseFilter, StatisticalFarOutliers_MatchesBruteForce) {
+    std::vector<CCVector3> points = generateSyntheticCloud(8000);
+    const std::vector<CCVector3> far = farOutliers(points, 60);
+    points.insert(points.end(), far.begin(), far.end());
+    CCCoreLib::PointCloud cloud = makeCloud(points);
+    FilterConfig cfg = statisticalConfig();
+    const std::set<unsigned> expected = bruteForceStatistical(points, cfg);
+    // 0.1 m 体素下 kNN 多在 27 邻域与壳层内求得；0.01 m 体素下 27 邻域普遍装不下，直接查体素 kd 树。
+    for (const double radius : {0.1, 0.01}) {
+        cfg.radius = radius;
+        const std::unique_ptr<CCCoreLib::ReferenceCloud> kept = runNativeFilter(cloud, cfg, nullptr, nullptr);
+        ASSERT_TRUE(kept);
+        EXPECT_EQ(keptIndices(*kept), expected) << "radius=" << radius;
+    }
+    for (std::size_t i = points.size() - far.size(); i < points.size(); ++i) {
+        EXPECT_EQ(expected.count(static_cast<unsigned>(i)), 0u);
+    }
+}
+
+// 远离群点的 kNN 由体素 kd 树回答，计算过距离的候选点数只随离群点数增长，与场景点数无关（逐点遍历全图时为 O(N) / 点）。
+TEST(NativeNoiseFilter, StatisticalFarOutliers_CandidatesBoundedPerOutlier) {
+    SyntheticSceneMix mix;
+    mix.outliers = 0.0;
+    const std::vector<CCVector3> scene = generateSyntheticCloud(50000, 20240601, mix);
+    const std::vector<CCVector3> far = farOutliers(scene, 500);
+    std::vector<CCVector3> points = scene;
+    points.insert(points.end(), far.begin(), far.end());
+    CCCoreLib::PointCloud clean = makeCloud(scene);
+    CCCoreLib::PointCloud noisy = makeCloud(points);
+    FilterConfig cfg = statisticalConfig();
+    cfg.radius = 0.05;
+
+    NativeKnnStats cleanKnn;
+    NativeKnnStats noisyKnn;
+    const std::unique_ptr<CCCoreLib::ReferenceCloud> cleanKept = runNativeFilter(clean, cfg, nullptr, nullptr, nullptr, nullptr, &cleanKnn);
+    const std::unique_ptr<CCCoreLib::ReferenceCloud> noisyKept = runNativeFilter(noisy, cfg, nullptr, nullptr, nullptr, nullptr, &noisyKnn);
+
+    // 体素网格对齐不变，场景点的 kNN 不受远离群点影响，计数之差全部来自离群点。
+    EXPECT_EQ(noisyKnn.shellCandidates, cleanKnn.shellCandidates);
+    EXPECT_EQ(noisyKnn.treeQueries - cleanKnn.treeQueries, far.size());
+    const std::uint64_t extra = noisyKnn.shellCandidates + noisyKnn.treeCandidates - cleanKnn.shellCandidates - cleanKnn.treeCandidates;
+    EXPECT_LE(extra, far.size() * 16 * static_cast<std::uint64_t>(cfg.sor_neighbors)) << "per outlier " << extra / far.size();
+
+    const std::set<unsigned> kept = keptIndices(*noisyKept);
+    for (std::size_t i = scene.size(); i < points.size(); ++i) {
+        EXPECT_EQ(kept.count(static_cast<unsigned>(i)), 0u) << "far outlier " << i << " kept";
+    }
+    // 远离群点不是场景点的近邻，只会拉高全图均值与标准差，场景点保留得只多不少。
+    EXPECT_GT(cleanKept->size(), 0u);
+    EXPECT_GE(kept.size(), cleanKept->size());
+}
+
+// 非有限坐标的点不进体素索引：不被保留，也不影响其余点的取舍（同 CCCoreLib 八叉树不收录这些点）。
+TEST(NativeNoiseFilter, NonFinitePoints_DroppedWithoutAffectingOthers) {
+    const std::vector<CCVector3> scene = generateSyntheticCloud(20000);
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float inf = std::numeric_limits<float>::infinity();
+    std::vector<CCVector3> points;
+    std::vector<unsigned> sceneIndex;  // points 下标 -> scene 下标，非有限点为 -1
+    for (std::size_t i = 0; i < scene.size(); ++i) {
+        if (i % 97 == 0) {
+            points.emplace_back(i % 2 == 0 ? nan : scene[i].x, scene[i].y, i % 2 == 0 ? scene[i].z : inf);
+            sceneIndex.push_back(static_cast<unsigned>(-1));
+        }
+        points.push_back(scene[i]);
+        sceneIndex.push_back(static_cast<unsigned>(i));
+    }
+    CCCoreLib::PointCloud clean = makeCloud(scene);
+    CCCoreLib::PointCloud dirty = makeCloud(points);
+    for (const std::vector<FilterMode>& modes : {std::vector<FilterMode>{FilterMode::kPlane}, std::vector<FilterMode>{FilterMode::kStatistical}}) {
+        FilterConfig cfg = statisticalConfig();
+        cfg.modes = modes;
+        const std::unique_ptr<CCCoreLib::ReferenceCloud> cleanKept = runNativeFilter(clean, cfg, nullptr, nullptr);
+        const std::unique_ptr<CCCoreLib::ReferenceCloud> dirtyKept = runNativeFilter(dirty, cfg, nullptr, nullptr);
+        std::set<unsigned> mapped;
+        for (const unsigned i : keptIndices(*dirtyKept)) {
+            ASSERT_NE(sceneIndex[i], static_cast<unsigned>(-1)) << "non-finite point " << i << " kept";
+            mapped.insert(sceneIndex[i]);
+        }
+        EXPECT_EQ(mapped, keptIndices(*cleanKept));
+    }
+}
+
+}  // namespace
+}  // namespace tsdf
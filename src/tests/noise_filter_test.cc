@@ -0,0 +1,109 @@
+#include "noise_filter.h"
+
+#include "native_noise_filter.h"
+
+#include <gtest/gtest.h>
+
+#include <PointCloud.h>
+#include <ReferenceCloud.h>
+
+#include <cstdint>
+#include <memory>
+#include <set>
+
+namespace tsdf {
+namespace {
+
+// 确定性伪随机数（LCG），不依赖标准库分布的实现。
+class Lcg {
+public:
+    explicit Lcg(std::uint64_t seed) : state_(seed) {}
+
+    // [0, 1) 均匀分布
+    double next() {
+        state_ = state_ * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<double>(state_ >> 11) / static_cast<double>(1ULL << 53);
+    }
+
+private:
+    std::uint64_t state_;
+};
+
+// 地面 + 竖墙（带 1 cm 量级的噪声），再加贴近表面的噪声层与包围盒内的离群点。
+CCCoreLib::PointCloud makeScene(std::size_t surfacePoints, std::size_t noisyPoints) {
+    Lcg rng(20240601);
+    CCCoreLib::PointCloud cloud;
+    cloud.reserve(static_cast<unsigned>(surfacePoints + noisyPoints));
+    for (std::size_t i = 0; i < surfacePoints; ++i) {
+        const double u = rng.next() * 4.0;
+        const double v = rng.next() * 4.0;
+        const double jitter = (rng.next() - 0.5) * 0.01;
+        if (i % 3 == 0) {
+            cloud.addPoint(CCVector3(static_cast<float>(u), 4.0f + static_cast<float>(jitter), static_cast<float>(v * 0.5)));
+        } else {
+            cloud.addPoint(CCVector3(static_cast<float>(u), static_cast<float>(v), static_cast<float>(jitter)));
+        }
+    }
+    for (std::size_t i = 0; i < noisyPoints; ++i) {
+        const double offset = i % 2 == 0 ? 0.05 + rng.next() * 0.2 : rng.next() * 2.0;
+        cloud.addPoint(CCVector3(static_cast<float>(rng.next() * 4.0), static_cast<float>(rng.next() * 4.0), static_cast<float>(offset)));
+    }
+    return cloud;
+}
+
+std::set<unsigned> keptIndices(const CCCoreLib::ReferenceCloud& kept) {
+    std::set<unsigned> indices;
+    for (unsigned i = 0; i < kept.size(); ++i) {
+        indices.insert(kept.getPointGlobalIndex(i));
+    }
+    return indices;
+}
+
+TEST(NoiseFilter, NativeVsCCCoreLib_SameKeptSet) {
+    CCCoreLib::PointCloud cloud = makeScene(60000, 3000);
+    for (const bool removeIsolated : {false, true}) {
+        FilterConfig cfg;
+        cfg.radius = 0.1;
+        cfg.n_sigma = 1.0;
+        cfg.remove_isolated = removeIsolated;
+
+        cfg.engine = FilterEngine::kCCCoreLib;
+        const std::unique_ptr<CCCoreLib::ReferenceCloud> cccorelib = runFilter(cloud, cfg, nullptr, nullptr);
+        cfg.engine = FilterEngine::kNative;
+        const std::unique_ptr<CCCoreLib::ReferenceCloud> native = runFilter(cloud, cfg, nullptr, nullptr);
+        ASSERT_TRUE(cccorelib);
+        ASSERT_TRUE(native);
+
+        const std::set<unsigned> expected = keptIndices(*cccorelib);
+        EXPECT_GT(expected.size(), 0u);
+        EXPECT_LT(expected.size(), cloud.size());
+        EXPECT_EQ(keptIndices(*native), expected) << "remove_isolated=" << removeIsolated;
+    }
+}
+
+TEST(NoiseFilter, NativeVsCCCoreLib_AbsoluteErrorSameKeptSet) {
+    CCCoreLib::PointCloud cloud = makeScene(60000, 3000);
+    FilterConfig cfg;
+    cfg.radius = 0.1;
+    cfg.use_absolute_error = true;
+    cfg.absolute_error = 0.02;
+
+    cfg.engine = FilterEngine::kCCCoreLib;
+    const std::unique_ptr<CCCoreLib::ReferenceCloud> cccorelib = runFilter(cloud, cfg, nullptr, nullptr);
+    cfg.engine = FilterEngine::kNative;
+    const std::unique_ptr<CCCoreLib::ReferenceCloud> native = runFilter(cloud, cfg, nullptr, nullptr);
+    EXPECT_EQ(keptIndices(*native), keptIndices(*cccorelib));
+}
+
+TEST(NoiseFilter, ParityEngine_ReportsConsistent) {
+    CCCoreLib::PointCloud cloud = makeScene(30000, 1500);
+    FilterConfig cfg;
+    cfg.radius = 0.1;
+    cfg.engine = FilterEngine::kParity;
+    const FilterParityReport report = compareFilterEngines(cloud, cfg);
+    EXPECT_TRUE(report.consistent());
+    EXPECT_EQ(report.cccorelibKept, report.nativeKept);
+}
+
+}  // namespace
+}  // namespace tsdf
@@ -0,0 +1,104 @@
+#include "parallel_octree.h"
+
+#include "synthetic_cloud.h"
+
+#include <gtest/gtest.h>
+
+#include <DgmOctree.h>
+#include <PointCloud.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace tsdf {
+namespace {
+
+using Entries = std::vector<std::pair<CCCoreLib::DgmOctree::CellCode, unsigned>>;
+
+CCCoreLib::PointCloud makeCloud(const std::vector<CCVector3>& points) {
+    CCCoreLib::PointCloud cloud;
+    cloud.reserve(static_cast<unsigned>(points.size()));
+    for (const CCVector3& p : points) {
+        cloud.addPoint(p);
+    }
+    return cloud;
+}
+
+// 编码表按 (编码, 下标) 排列：build() 的排序不稳定，单元内次序未定义。
+Entries sortedEntries(const CCCoreLib::DgmOctree& octree) {
+    Entries entries;
+    for (const CCCoreLib::DgmOctree::IndexAndCode& item : octree.pointsAndTheirCellCodes()) {
+        entries.emplace_back(item.theCode, item.theIndex);
+    }
+    std::sort(entries.begin(), entries.end());
+    return entries;
+}
+
+// 第 level 层每个单元（截断编码）的点数。
+std::map<CCCoreLib::DgmOctree::CellCode, unsigned> cellPopulation(const CCCoreLib::DgmOctree& octree, unsigned char level) {
+    std::map<CCCoreLib::DgmOctree::CellCode, unsigned> population;
+    for (const CCCoreLib::DgmOctree::IndexAndCode& item : octree.pointsAndTheirCellCodes()) {
+        ++population[item.theCode >> (3 * (CCCoreLib::DgmOctree::MAX_OCTREE_LEVEL - level))];
+    }
+    return population;
+}
+
+void expectSameOctree(CCCoreLib::PointCloud& cloud) {
+    CCCoreLib::DgmOctree reference(&cloud);
+    const int referenceProjected = reference.build();
+    ParallelOctree parallel(&cloud);
+    const int parallelProjected = parallel.buildParallel();
+
+    ASSERT_EQ(parallelProjected, referenceProjected);
+    EXPECT_EQ(parallel.getNumberOfProjectedPoints(), reference.getNumberOfProjectedPoints());
+    for (unsigned k = 0; k < 3; ++k) {
+        EXPECT_EQ(parallel.getOctreeMins().u[k], reference.getOctreeMins().u[k]);
+        EXPECT_EQ(parallel.getOctreeMaxs().u[k], reference.getOctreeMaxs().u[k]);
+    }
+
+    // 编码表逐项相同；并行版单元内已按下标排列，不需再排序。
+    const Entries expected = sortedEntries(reference);
+    Entries actual;
+    for (const CCCoreLib::DgmOctree::IndexAndCode& item : parallel.pointsAndTheirCellCodes()) {
+        actual.emplace_back(item.theCode, item.theIndex);
+    }
+    EXPECT_EQ(actual, expected);
+
+    for (const unsigned char level : {1, 5, 8, 10, 12, CCCoreLib::DgmOctree::MAX_OCTREE_LEVEL}) {
+        EXPECT_EQ(parallel.getCellNumber(level), reference.getCellNumber(level)) << "level " << int(level);
+        EXPECT_EQ(parallel.getMaxCellPopulation(level), reference.getMaxCellPopulation(level)) << "level " << int(level);
+        EXPECT_EQ(parallel.getAverageCellPopulation(level), reference.getAverageCellPopulation(level)) << "level " << int(level);
+        EXPECT_EQ(cellPopulation(parallel, level), cellPopulation(reference, level)) << "level " << int(level);
+    }
+}
+
+TEST(ParallelOctree, SyntheticCloud_SameAsBuild) {
+    CCCoreLib::PointCloud cloud = makeCloud(generateSyntheticCloud(200000));
+    expectSameOctree(cloud);
+}
+
+// 点数不是 4 的倍数（走 SSE 尾部的逐点路径），并夹有 NaN 点（不在包围盒内，不进八叉树；含 4 点一组中只有部分点为 NaN 的情形）。
+TEST(ParallelOctree, NanPointsAndOddCount_SameAsBuild) {
+    std::vector<CCVector3> points = generateSyntheticCloud(50003);
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    for (std::size_t i = 1; i < points.size(); i += 101) {
+        points[i].u[i % 3] = nan;
+    }
+    points.back().x = nan;
+    ASSERT_NE(points.size() % 4, 0u);
+    CCCoreLib::PointCloud cloud = makeCloud(points);
+    expectSameOctree(cloud);
+}
+
+TEST(ParallelOctree, FewerPointsThanOneSimdGroup_SameAsBuild) {
+    for (std::size_t count = 1; count < 8; ++count) {
+        CCCoreLib::PointCloud cloud = makeCloud(generateSyntheticCloud(count));
+        expectSameOctree(cloud);
+    }
+}
+
+}  // namespace
+}  // namespace tsdf
@@ -0,0 +1,261 @@
+#include "pcd_io.h"
+
+#include "lzf.h"
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace tsdf {
+namespace {
+
+std::vector<char> bytes(const std::string& s) {
+    return std::vector<char>(s.begin(), s.end());
+}
+
+std::string decompress(const std::vector<char>& input, std::size_t capacity) {
+    std::string out(capacity, '\0');
+    out.resize(lzfDecompress(input.data(), input.size(), out.data(), out.size()));
+    return out;
+}
+
+// 贪心 LZF 压缩（3 字节哈希找最近一次出现），只供构造 binary_compressed 测试文件。
+std::vector<char> lzfCompress(const std::vector<char>& in) {
+    std::vector<char> out;
+    std::vector<char> literal;
+    const auto flush = [&] {
+        if (!literal.empty()) {
+            out.push_back(static_cast<char>(literal.size() - 1));
+            out.insert(out.end(), literal.begin(), literal.end());
+            literal.clear();
+        }
+    };
+    std::unordered_map<std::uint32_t, std::size_t> last;
+    const auto key = [&](std::size_t i) {
+        return static_cast<std::uint32_t>(static_cast<unsigned char>(in[i])) | static_cast<std::uint32_t>(static_cast<unsigned char>(in[i + 1])) << 8 |
+               static_cast<std::uint32_t>(static_cast<unsigned char>(in[i + 2])) << 16;
+    };
+    std::size_t i = 0;
+    while (i < in.size()) {
+        std::size_t len = 0;
+        std::size_t back = 0;
+        if (i + 3 <= in.size()) {
+            const auto it = last.find(key(i));
+            if (it != last.end() && i - it->second <= 8192) {
+                back = i - it->second;
+                while (i + len < in.size() && len < 264 && in[it->second + len] == in[i + len]) {
+                    ++len;
+                }
+            }
+            last[key(i)] = i;
+        }
+        if (len >= 3) {
+            flush();
+            const std::size_t code = len - 2;
+            const std::size_t offset = back - 1;
+            if (code < 7) {
+                out.push_back(static_cast<char>(code << 5 | offset >> 8));
+            } else {
+                out.push_back(static_cast<char>(7 << 5 | offset >> 8));
+                out.push_back(static_cast<char>(code - 7));
+            }
+            out.push_back(static_cast<char>(offset & 0xff));
+            i += len;
+            continue;
+        }
+        literal.push_back(in[i++]);
+        if (literal.size() == 32) {
+            flush();
+        }
+    }
+    flush();
+    return out;
+}
+
+TEST(Lzf, KnownVectors_Decode) {
+    EXPECT_EQ(decompress(bytes(std::string("\x02" "abc", 4)), 16), "abc");
+    // 回溯 3 字节、长度 6：源与目标重叠，按字节展开重复模式。
+    EXPECT_EQ(decompress(bytes(std::string("\x02" "abc" "\x80\x02", 6)), 16), "abcabcabc");
+    // 长度 19 需要扩展长度字节（高 3 位为 7）。
+    EXPECT_EQ(decompress(bytes(std::string("\x00" "a" "\xe0\x0a\x00", 5)), 32), std::string(20, 'a'));
+    EXPECT_EQ(decompress({}, 4), "");
+}
+
+TEST(Lzf, TruncatedOrCorrupt_Throws) {
+    const std::size_t capacity = 64;
+    EXPECT_THROW(decompress(bytes(std::string("\x05" "ab", 3)), capacity), std::runtime_error);          // 字面量截断
+    EXPECT_THROW(decompress(bytes(std::string("\x00" "a" "\x20", 3)), capacity), std::runtime_error);    // 引用缺偏移字节
+    EXPECT_THROW(decompress(bytes(std::string("\x00" "a" "\xe0", 3)), capacity), std::runtime_error);    // 引用缺扩展长度
+    EXPECT_THROW(decompress(bytes(std::string("\x00" "a" "\x20\x05", 4)), capacity), std::runtime_error);  // 回溯到输出之前
+    EXPECT_THROW(decompress(bytes(std::string("\x02" "abc" "\x80\x02", 6)), 5), std::runtime_error);     // 输出越界
+}
+
+TEST(Lzf, CompressedRoundTrip) {
+    std::vector<char> data;
+    for (int i = 0; i < 100000; ++i) {
+        data.push_back(static_cast<char>(i % 7 == 0 ? i * 31 : i % 13));
+    }
+    const std::vector<char> packed = lzfCompress(data);
+    ASSERT_LT(packed.size(), data.size());
+    std::vector<char> out(data.size());
+    ASSERT_EQ(lzfDecompress(packed.data(), packed.size(), out.data(), out.size()), data.size());
+    EXPECT_EQ(out, data);
+}
+
+class PcdIoTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = fs::temp_directory_path() / ("livomesh_pcd_io_test_" + std::to_string(::getpid()));
+        fs::create_directories(dir_);
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        fs::remove_all(dir_, ec);
+    }
+
+    fs::path dir_;
+};
+
+// 混合字段的一条记录：x F4、intensity U1、y F4、z F8、label U1 COUNT 3，步长 4 + 1 + 4 + 8 + 3 = 20。
+struct MixedPoint {
+    float x;
+    std::uint8_t intensity;
+    float y;
+    double z;
+    std::uint8_t label[3];
+};
+
+constexpr std::size_t MIXED_STEP = 20;
+const char* const MIXED_FIELDS =
+    "FIELDS x intensity y z label\n"
+    "SIZE 4 1 4 8 1\n"
+    "TYPE F U F F U\n"
+    "COUNT 1 1 1 1 3\n";
+
+std::vector<MixedPoint> mixedPoints(std::size_t count) {
+    std::vector<MixedPoint> points(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        points[i].x = static_cast<float>(i) * 0.25f - 100.0f;
+        points[i].intensity = static_cast<std::uint8_t>(i * 7);
+        points[i].y = static_cast<float>(i % 1000) * 0.5f;
+        points[i].z = static_cast<double>(i) * 0.125 - 3.0;
+        for (int k = 0; k < 3; ++k) {
+            points[i].label[k] = static_cast<std::uint8_t>(i + k);
+        }
+    }
+    return points;
+}
+
+// point-major 记录，与 DATA binary 的布局相同。
+std::vector<char> pointMajor(const std::vector<MixedPoint>& points) {
+    std::vector<char> records(points.size() * MIXED_STEP);
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        char* rec = records.data() + i * MIXED_STEP;
+        std::memcpy(rec, &points[i].x, 4);
+        std::memcpy(rec + 4, &points[i].intensity, 1);
+        std::memcpy(rec + 5, &points[i].y, 4);
+        std::memcpy(rec + 9, &points[i].z, 8);
+        std::memcpy(rec + 17, points[i].label, 3);
+    }
+    return records;
+}
+
+std::string headerText(std::size_t count, const std::string& data) {
+    std::ostringstream out;
+    out << "# .PCD v0.7 - Point Cloud Data file format\nVERSION 0.7\n" << MIXED_FIELDS << "WIDTH " << count << "\nHEIGHT 1\n"
+        << "VIEWPOINT 0 0 0 1 0 0 0\nPOINTS " << count << "\nDATA " << data << "\n";
+    return out.str();
+}
+
+void expectMixedCloud(const fs::path& path, const std::vector<MixedPoint>& points) {
+    const CCCoreLib::PointCloud cloud = loadBinaryCloud(path);
+    ASSERT_EQ(cloud.size(), points.size());
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        const CCVector3& p = *cloud.getPoint(static_cast<unsigned>(i));
+        ASSERT_EQ(p.x, points[i].x) << i;
+        ASSERT_EQ(p.y, points[i].y) << i;
+        ASSERT_EQ(p.z, static_cast<float>(points[i].z)) << i;
+    }
+    const PcdRecords records = loadPcdRecords(path);
+    ASSERT_EQ(records.size(), points.size());
+    ASSERT_EQ(records.header().pointStep, MIXED_STEP);
+    const std::vector<char> expected = pointMajor(points);
+    EXPECT_EQ(std::memcmp(records.data(), expected.data(), expected.size()), 0);
+}
+
+TEST_F(PcdIoTest, BinaryCompressedMixedFields_RoundTrip) {
+    const std::vector<MixedPoint> points = mixedPoints(100003);
+    // field-major：每个字段的全部点连续存放，字段块的起点为 offset * 点数。
+    const std::vector<char> records = pointMajor(points);
+    std::vector<char> fieldMajor(records.size());
+    const std::size_t offsets[] = {0, 4, 5, 9, 17};
+    const std::size_t sizes[] = {4, 1, 4, 8, 3};
+    for (std::size_t f = 0; f < 5; ++f) {
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            std::memcpy(fieldMajor.data() + offsets[f] * points.size() + i * sizes[f], records.data() + i * MIXED_STEP + offsets[f], sizes[f]);
+        }
+    }
+    const std::vector<char> packed = lzfCompress(fieldMajor);
+    const fs::path path = dir_ / "compressed.pcd";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << headerText(points.size(), "binary_compressed");
+        const std::uint32_t sizesHeader[2] = {static_cast<std::uint32_t>(packed.size()), static_cast<std::uint32_t>(fieldMajor.size())};
+        out.write(reinterpret_cast<const char*>(sizesHeader), sizeof(sizesHeader));
+        out.write(packed.data(), static_cast<std::streamsize>(packed.size()));
+    }
+    expectMixedCloud(path, points);
+
+    // 截断的压缩数据必须报错，而不是读出部分点。
+    const fs::path truncated = dir_ / "truncated.pcd";
+    fs::copy_file(path, truncated);
+    fs::resize_file(truncated, fs::file_size(path) - packed.size() / 2);
+    EXPECT_THROW(loadBinaryCloud(truncated), std::runtime_error);
+}
+
+// ASCII 按 4 MB 切块并行解析：几百万字节的 CRLF 文件保证有行跨过切块位置。
+TEST_F(PcdIoTest, AsciiCrlfAcrossChunks_RoundTrip) {
+    const std::vector<MixedPoint> points = mixedPoints(300001);
+    const fs::path path = dir_ / "ascii.pcd";
+    {
+        std::ofstream out(path, std::ios::binary);
+        std::string header = headerText(points.size(), "ascii");
+        std::string crlf;
+        for (const char c : header) {
+            crlf += c == '\n' ? "\r\n" : std::string(1, c);
+        }
+        out << crlf;
+        out.precision(17);
+        for (const MixedPoint& p : points) {
+            out << p.x << ' ' << static_cast<int>(p.intensity) << '\t' << p.y << ' ' << p.z << ' ' << static_cast<int>(p.label[0]) << ' '
+                << static_cast<int>(p.label[1]) << ' ' << static_cast<int>(p.label[2]) << " \r\n";
+        }
+    }
+    ASSERT_GT(fs::file_size(path), std::uintmax_t(8) << 20);
+    expectMixedCloud(path, points);
+}
+
+TEST_F(PcdIoTest, AsciiMissingRows_Throws) {
+    const fs::path path = dir_ / "short.pcd";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << headerText(3, "ascii") << "1 2 3 4 5 6 7\n1 2 3 4 5 6 7\n";
+    }
+    EXPECT_THROW(loadBinaryCloud(path), std::runtime_error);
+}
+
+}  // namespace
+}  // namespace tsdf
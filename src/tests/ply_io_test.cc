@@ -0,0 +1,240 @@
+#include "ply_io.h"
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace tsdf {
+namespace {
+
+// vertex 记录：x float、intensity uchar、y float、z double，步长 4 + 1 + 4 + 8 = 17。
+struct Vertex {
+    float x;
+    std::uint8_t intensity;
+    float y;
+    double z;
+};
+
+constexpr std::size_t VERTEX_STEP = 17;
+const char* const VERTEX_PROPERTIES =
+    "property float x\n"
+    "property uchar intensity\n"
+    "property float y\n"
+    "property double z\n";
+
+// vertex 之前的元素：两个 camera 记录，float + uchar，步长 5。
+const char* const CAMERA_ELEMENT =
+    "element camera 2\n"
+    "property float view\n"
+    "property uchar id\n";
+
+std::vector<Vertex> vertices(std::size_t count) {
+    std::vector<Vertex> points(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        points[i].x = static_cast<float>(i) * 0.25f - 10.0f;
+        points[i].intensity = static_cast<std::uint8_t>(i * 13);
+        points[i].y = static_cast<float>(i % 100) * 0.5f;
+        points[i].z = static_cast<double>(i) * 0.125 - 3.0;
+    }
+    return points;
+}
+
+std::vector<char> vertexRecords(const std::vector<Vertex>& points) {
+    std::vector<char> records(points.size() * VERTEX_STEP);
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        char* rec = records.data() + i * VERTEX_STEP;
+        std::memcpy(rec, &points[i].x, 4);
+        std::memcpy(rec + 4, &points[i].intensity, 1);
+        std::memcpy(rec + 5, &points[i].y, 4);
+        std::memcpy(rec + 9, &points[i].z, 8);
+    }
+    return records;
+}
+
+class PlyIoTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = fs::temp_directory_path() / ("livomesh_ply_io_test_" + std::to_string(::getpid()));
+        fs::create_directories(dir_);
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        fs::remove_all(dir_, ec);
+    }
+
+    fs::path write(const std::string& name, const std::string& content) {
+        const fs::path path = dir_ / name;
+        std::ofstream out(path, std::ios::binary);
+        out << content;
+        return path;
+    }
+
+    fs::path dir_;
+};
+
+void expectVertices(const fs::path& path, const std::vector<Vertex>& points) {
+    const CCCoreLib::PointCloud cloud = loadPlyCloud(path);
+    ASSERT_EQ(cloud.size(), points.size());
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        const CCVector3& p = *cloud.getPoint(static_cast<unsigned>(i));
+        ASSERT_EQ(p.x, points[i].x) << i;
+        ASSERT_EQ(p.y, points[i].y) << i;
+        ASSERT_EQ(p.z, static_cast<float>(points[i].z)) << i;
+    }
+    const PcdRecords records = loadPlyRecords(path);
+    ASSERT_EQ(records.size(), points.size());
+    ASSERT_EQ(records.header().pointStep, VERTEX_STEP);
+    const std::vector<char> expected = vertexRecords(points);
+    EXPECT_EQ(std::memcmp(records.data(), expected.data(), expected.size()), 0);
+}
+
+TEST_F(PlyIoTest, BinaryLittleEndian_SkipsPrecedingElement) {
+    const std::vector<Vertex> points = vertices(1001);
+    std::ostringstream content;
+    content << "ply\nformat binary_little_endian 1.0\ncomment test\n" << CAMERA_ELEMENT << "element vertex " << points.size() << '\n'
+            << VERTEX_PROPERTIES << "element face 0\nproperty list uchar int vertex_indices\nend_header\n";
+    // camera 记录的字节里故意放上换行与 "end_header"，跳过时只能按定长步进。
+    const char camera[10] = {'\n', 'e', 'n', 'd', '_', 1, '\n', '\n', 'h', 2};
+    content.write(camera, sizeof(camera));
+    const std::vector<char> records = vertexRecords(points);
+    content.write(records.data(), static_cast<std::streamsize>(records.size()));
+    const fs::path path = write("binary.ply", content.str());
+
+    const PcdHeader header = readPlyHeader(path);
+    EXPECT_EQ(header.pointCount, points.size());
+    EXPECT_EQ(header.data, PcdDataFormat::kBinary);
+    ASSERT_EQ(header.fields.size(), 4u);
+    EXPECT_EQ(header.fields[1].name, "intensity");
+    EXPECT_EQ(header.z.offset, 9);
+    EXPECT_EQ(header.z.size, 8);
+    expectVertices(path, points);
+
+    // 数据段比 Header 声明的少一个点。
+    const fs::path truncated = write("truncated.ply", content.str().substr(0, content.str().size() - 1));
+    EXPECT_THROW(loadPlyCloud(truncated), std::runtime_error);
+}
+
+TEST_F(PlyIoTest, Ascii_SkipsPrecedingElement) {
+    const std::vector<Vertex> points = vertices(257);
+    std::ostringstream content;
+    content << "ply\r\nformat ascii 1.0\r\n" << CAMERA_ELEMENT << "element vertex " << points.size() << '\n' << VERTEX_PROPERTIES << "end_header\n";
+    content << "0.5 1\n1.5 2\n";
+    content.precision(17);
+    for (const Vertex& p : points) {
+        content << p.x << ' ' << static_cast<int>(p.intensity) << '\t' << p.y << ' ' << p.z << "\r\n";
+    }
+    const fs::path path = write("ascii.ply", content.str());
+    EXPECT_EQ(readPlyHeader(path).data, PcdDataFormat::kAscii);
+    expectVertices(path, points);
+}
+
+TEST_F(PlyIoTest, UnsupportedInput_Throws) {
+    const std::string vertex = std::string("element vertex 1\n") + VERTEX_PROPERTIES;
+    const auto header = [](const std::string& body) { return "ply\n" + body + "end_header\n"; };
+
+    const std::string bigEndian = header("format binary_big_endian 1.0\n" + vertex);
+    EXPECT_THROW(parsePlyHeader(bigEndian.data(), bigEndian.size(), nullptr), std::runtime_error);
+
+    const std::string vertexList = header("format binary_little_endian 1.0\n" + vertex + "property list uchar float normals\n");
+    EXPECT_THROW(parsePlyHeader(vertexList.data(), vertexList.size(), nullptr), std::runtime_error);
+
+    // binary 下 vertex 之前的元素含 list 时无法定长跳过。
+    const std::string precedingList =
+        header("format binary_little_endian 1.0\nelement face 1\nproperty list uchar int vertex_indices\n" + vertex);
+    std::size_t offset = 0;
+    EXPECT_THROW(parsePlyHeader(precedingList.data(), precedingList.size(), &offset), std::runtime_error);
+
+    const std::string noZ = header("format ascii 1.0\nelement vertex 1\nproperty float x\nproperty float y\n");
+    EXPECT_THROW(parsePlyHeader(noZ.data(), noZ.size(), nullptr), std::runtime_error);
+
+    const std::string noEnd = "ply\nformat ascii 1.0\n" + vertex;
+    EXPECT_THROW(parsePlyHeader(noEnd.data(), noEnd.size(), nullptr), std::runtime_error);
+
+    const fs::path path = write("big_endian.ply", bigEndian + std::string(VERTEX_STEP, '\0'));
+    EXPECT_THROW(loadPlyCloud(path), std::runtime_error);
+}
+
+// PCD 记录（含 COUNT 3 的 label）经 writePlyCloud 写出后再读回：字段逐个展开，原始字节保持不变。
+TEST_F(PlyIoTest, WriteRead_PreservesExtraFieldsAndExpandsCount) {
+    const std::size_t count = 5000;
+    constexpr std::size_t step = 4 + 4 + 4 + 2 + 3;
+    std::vector<char> records(count * step);
+    for (std::size_t i = 0; i < count; ++i) {
+        char* rec = records.data() + i * step;
+        const float xyz[3] = {static_cast<float>(i) * 0.01f, static_cast<float>(i % 71), -static_cast<float>(i) * 0.5f};
+        const std::uint16_t ring = static_cast<std::uint16_t>(i * 3);
+        std::memcpy(rec, xyz, sizeof(xyz));
+        std::memcpy(rec + 12, &ring, 2);
+        for (int k = 0; k < 3; ++k) {
+            rec[14 + k] = static_cast<char>(i + k);
+        }
+    }
+    const fs::path pcd = dir_ / "source.pcd";
+    {
+        std::ofstream out(pcd, std::ios::binary);
+        out << "VERSION 0.7\nFIELDS x y z ring label\nSIZE 4 4 4 2 1\nTYPE F F F U U\nCOUNT 1 1 1 1 3\nWIDTH " << count
+            << "\nHEIGHT 1\nVIEWPOINT 0 0 0 1 0 0 0\nPOINTS " << count << "\nDATA binary\n";
+        out.write(records.data(), static_cast<std::streamsize>(records.size()));
+    }
+    CCCoreLib::PointCloud cloud = loadBinaryCloud(pcd);
+    const PcdRecords source = loadPcdRecords(pcd);
+    ASSERT_EQ(source.size(), count);
+
+    // 保留每第三个点，检验按全局下标 gather。
+    CCCoreLib::ReferenceCloud kept(&cloud);
+    std::vector<std::size_t> indices;
+    for (std::size_t i = 0; i < count; i += 3) {
+        kept.addPointIndex(static_cast<unsigned>(i));
+        indices.push_back(i);
+    }
+    const fs::path ply = dir_ / "filtered.ply";
+    writePlyCloud(ply, kept, &source);
+
+    const PcdHeader header = readPlyHeader(ply);
+    EXPECT_EQ(header.pointCount, indices.size());
+    EXPECT_EQ(header.pointStep, step);
+    std::vector<std::string> names;
+    for (const PcdField& field : header.fields) {
+        names.push_back(field.name);
+        EXPECT_EQ(field.count, 1);
+    }
+    EXPECT_EQ(names, (std::vector<std::string>{"x", "y", "z", "ring", "label_0", "label_1", "label_2"}));
+    EXPECT_EQ(header.fields[3].size, 2);
+    EXPECT_EQ(header.fields[3].type, 'U');
+
+    const PcdRecords written = loadPlyRecords(ply);
+    ASSERT_EQ(written.size(), indices.size());
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        ASSERT_EQ(std::memcmp(written.data() + i * step, records.data() + indices[i] * step, step), 0) << i;
+    }
+    const CCCoreLib::PointCloud reread = loadPlyCloud(ply);
+    ASSERT_EQ(reread.size(), indices.size());
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        const CCVector3& a = *reread.getPoint(static_cast<unsigned>(i));
+        const CCVector3& b = *cloud.getPoint(static_cast<unsigned>(indices[i]));
+        ASSERT_EQ(a.x, b.x);
+        ASSERT_EQ(a.y, b.y);
+        ASSERT_EQ(a.z, b.z);
+    }
+
+    // 不带原始记录时只写 xyz。
+    const fs::path bare = dir_ / "bare.ply";
+    writePlyCloud(bare, kept);
+    EXPECT_EQ(readPlyHeader(bare).fields.size(), 3u);
+    EXPECT_EQ(loadPlyCloud(bare).size(), indices.size());
+}
+
+}  // namespace
+}  // namespace tsdf
@@ -0,0 +1,76 @@
+#include "stage_pipeline.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstddef>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace tsdf {
+namespace {
+
+// 三级以上的流水线：首级产生序号，decode 级可放慢，filter 级在第 throwAt 项抛出，末级按序收集。
+std::vector<std::size_t> runNumbers(std::size_t count, std::size_t maxInflight, int workers, std::size_t throwAt, bool throwInSource, bool throwInSink) {
+    std::vector<std::size_t> out;
+    StagePipeline<std::size_t> pipeline("test", maxInflight);
+    pipeline.source("read", workers, count, [&](std::size_t seq, std::size_t& item) {
+        if (throwInSource && seq == throwAt) {
+            throw std::runtime_error("source failed");
+        }
+        item = seq;
+    });
+    pipeline.stage("decode", workers, [](std::size_t&) { std::this_thread::sleep_for(std::chrono::milliseconds(2)); });
+    pipeline.stage("filter", workers, [&](std::size_t& item) {
+        if (!throwInSource && !throwInSink && item == throwAt) {
+            throw std::runtime_error("filter failed");
+        }
+        item *= 2;
+    });
+    pipeline.sink("write", [&](std::size_t& item) {
+        if (throwInSink && item == 2 * throwAt) {
+            throw std::runtime_error("sink failed");
+        }
+        out.push_back(item);
+    });
+    pipeline.run();
+    return out;
+}
+
+constexpr std::size_t NO_THROW = static_cast<std::size_t>(-1);
+
+TEST(StagePipeline, InOrder_SinkSeesSerialOrder) {
+    for (const int workers : {1, 3}) {
+        const std::vector<std::size_t> out = runNumbers(200, 2, workers, NO_THROW, false, false);
+        ASSERT_EQ(out.size(), 200u);
+        for (std::size_t i = 0; i < out.size(); ++i) {
+            EXPECT_EQ(out[i], 2 * i);
+        }
+    }
+}
+
+TEST(StagePipeline, MiddleStageThrows_RunRethrows) {
+    for (const int workers : {1, 2}) {
+        for (const std::size_t throwAt : {std::size_t{0}, std::size_t{5}, std::size_t{150}}) {
+            const auto start = std::chrono::steady_clock::now();
+            EXPECT_THROW(runNumbers(200, 2, workers, throwAt, false, false), std::runtime_error) << "workers=" << workers << " throwAt=" << throwAt;
+            EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(10));
+        }
+    }
+}
+
+TEST(StagePipeline, SourceThrows_RunRethrows) {
+    for (const int workers : {1, 2}) {
+        EXPECT_THROW(runNumbers(200, 2, workers, 7, true, false), std::runtime_error);
+    }
+}
+
+TEST(StagePipeline, SinkThrows_RunRethrows) {
+    for (const int workers : {1, 2}) {
+        EXPECT_THROW(runNumbers(200, 2, workers, 3, false, true), std::runtime_error);
+    }
+}
+
+}  // namespace
+}  // namespace tsdf
@@ -0,0 +1,53 @@
+#include "telemetry.h"
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace tsdf {
+namespace {
+
+namespace fs = std::filesystem;
+
+std::string readAll(const fs::path& path) {
+    std::ifstream in(path);
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    return buffer.str();
+}
+
+// 运行数分钟后的时间戳（微秒）不能被截成 6 位有效数字。
+TEST(Telemetry, WriteTrace_KeepsMicrosecondResolutionForLongRuns) {
+    Telemetry& telemetry = Telemetry::instance();
+    telemetry.addTraceEvent("late_span", 123456789.25, 10.5);
+    const fs::path path = fs::temp_directory_path() / ("livomesh_trace_test_" + std::to_string(::getpid()) + ".json");
+    telemetry.writeTrace(path);
+    const std::string trace = readAll(path);
+    fs::remove(path);
+    EXPECT_NE(trace.find("\"ts\": 123456789.250"), std::string::npos) << trace;
+    EXPECT_NE(trace.find("\"dur\": 10.500"), std::string::npos) << trace;
+    EXPECT_EQ(trace.find("e+"), std::string::npos) << trace;
+}
+
+TEST(Telemetry, WriteReport_KeepsMillisecondFractions) {
+    Telemetry& telemetry = Telemetry::instance();
+    StageRecord record;
+    record.name = "late_stage";
+    record.startMs = 1234567.125;
+    record.wallMs = 7654321.5;
+    telemetry.addStage(record);
+    const fs::path path = fs::temp_directory_path() / ("livomesh_report_test_" + std::to_string(::getpid()) + ".json");
+    telemetry.writeReport(path);
+    const std::string report = readAll(path);
+    fs::remove(path);
+    EXPECT_NE(report.find("\"start_ms\": 1234567.125"), std::string::npos) << report;
+    EXPECT_NE(report.find("\"wall_ms\": 7654321.500"), std::string::npos) << report;
+}
+
+}  // namespace
+}  // namespace tsdf
@@ -0,0 +1,100 @@
+#include "tiled_filter.h"
+
+#include "cloud_io.h"
+#include "noise_filter.h"
+#include "synthetic_cloud.h"
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace tsdf {
+namespace {
+
+class TiledFilterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = fs::temp_directory_path() / ("livomesh_tiled_test_" + std::to_string(::getpid()));
+        fs::create_directories(dir_);
+        input_ = dir_ / "scene.pcd";
+        writeSyntheticPcd(input_, generateSyntheticCloud(60000));
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        fs::remove_all(dir_, ec);
+    }
+
+    // 整图滤波并按原始记录写出，作为分块结果的参照。
+    fs::path wholeMap(const FilterConfig& cfg, bool keepFields) {
+        const fs::path output = dir_ / (keepFields ? "whole_fields.pcd" : "whole_xyz.pcd");
+        CCCoreLib::PointCloud cloud = loadCloud(input_);
+        const PcdRecords records = loadCloudRecords(input_);
+        const std::unique_ptr<CCCoreLib::ReferenceCloud> kept = runFilter(cloud, cfg, nullptr, nullptr);
+        writeCloud(output, *kept, keepFields ? &records : nullptr);
+        return output;
+    }
+
+    static void expectSameRecords(const fs::path& actual, const fs::path& expected) {
+        const PcdRecords a = loadCloudRecords(actual);
+        const PcdRecords b = loadCloudRecords(expected);
+        ASSERT_EQ(a.size(), b.size());
+        ASSERT_EQ(a.header().pointStep, b.header().pointStep);
+        ASSERT_EQ(a.header().fields.size(), b.header().fields.size());
+        EXPECT_EQ(std::memcmp(a.data(), b.data(), a.size() * a.header().pointStep), 0);
+    }
+
+    bool spillDirsLeft() const {
+        for (const fs::directory_entry& entry : fs::directory_iterator(dir_)) {
+            if (entry.path().filename().string().rfind(".livomesh_tiles_", 0) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    fs::path dir_;
+    fs::path input_;
+};
+
+TEST_F(TiledFilterTest, KeepFields_MatchesWholeMapByteForByte) {
+    FilterConfig cfg;
+    cfg.radius = 0.1;
+    cfg.engine = FilterEngine::kNative;
+    cfg.tile_size = 2.0;
+    const fs::path expected = wholeMap(cfg, true);
+
+    for (const bool pipelined : {false, true}) {
+        PipelineConfig pipeline;
+        pipeline.enable = pipelined;
+        pipeline.filters = 2;
+        const fs::path output = dir_ / (pipelined ? "tiled_pipeline.pcd" : "tiled.pcd");
+        const TiledFilterStats stats = runTiledFilter(input_, output, cfg, pipeline, true);
+        EXPECT_GT(stats.tiles, 1u);
+        EXPECT_LT(stats.keptPoints, stats.inputPoints);
+        expectSameRecords(output, expected);
+    }
+    EXPECT_FALSE(spillDirsLeft());
+}
+
+TEST_F(TiledFilterTest, XyzOnly_MatchesWholeMap) {
+    FilterConfig cfg;
+    cfg.radius = 0.1;
+    cfg.engine = FilterEngine::kCCCoreLib;
+    cfg.tile_size = 2.5;
+    const fs::path expected = wholeMap(cfg, false);
+    const fs::path output = dir_ / "tiled_xyz.pcd";
+    runTiledFilter(input_, output, cfg, PipelineConfig{}, false);
+    expectSameRecords(output, expected);
+    EXPECT_EQ(readCloudHeader(output).fields.size(), 3u);
+}
+
+}  // namespace
+}  // namespace tsdf
@@ -0,0 +1,214 @@
+#include "tsdf_mesh.h"
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace tsdf {
+namespace {
+
+struct Mesh {
+    std::vector<float> vertices;       // xyz
+    std::vector<std::int32_t> faces;  // 每个三角形 3 个顶点号
+};
+
+std::string readFile(const fs::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// 解析 TsdfMesh::writePly 的输出：vertex (float x y z) + face (uchar 3, int x 3)。
+Mesh parseMesh(const std::string& bytes) {
+    const std::string endHeader = "end_header\n";
+    const std::size_t headerEnd = bytes.find(endHeader);
+    EXPECT_NE(headerEnd, std::string::npos);
+    const std::string header = bytes.substr(0, headerEnd);
+    const auto countOf = [&](const std::string& element) {
+        const std::size_t pos = header.find("element " + element + ' ');
+        EXPECT_NE(pos, std::string::npos) << element;
+        return static_cast<std::size_t>(std::stoull(header.substr(pos + element.size() + 9)));
+    };
+    Mesh mesh;
+    mesh.vertices.resize(countOf("vertex") * 3);
+    mesh.faces.resize(countOf("face") * 3);
+    const char* data = bytes.data() + headerEnd + endHeader.size();
+    EXPECT_EQ(bytes.size(), headerEnd + endHeader.size() + mesh.vertices.size() * 4 + mesh.faces.size() / 3 * 13);
+    std::memcpy(mesh.vertices.data(), data, mesh.vertices.size() * sizeof(float));
+    data += mesh.vertices.size() * sizeof(float);
+    for (std::size_t f = 0; f < mesh.faces.size(); f += 3) {
+        EXPECT_EQ(data[0], 3);
+        std::memcpy(&mesh.faces[f], data + 1, 3 * sizeof(std::int32_t));
+        data += 13;
+    }
+    return mesh;
+}
+
+class TsdfMeshTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = fs::temp_directory_path() / ("livomesh_tsdf_mesh_test_" + std::to_string(::getpid()));
+        fs::create_directories(dir_);
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        fs::remove_all(dir_, ec);
+    }
+
+    fs::path dir_;
+};
+
+// z = 0 平面上 x ∈ [x0, x1]、y ∈ [-0.5, 0.5] 的网格点。
+std::vector<CCVector3> planePatch(double x0, double x1) {
+    std::vector<CCVector3> points;
+    for (double y = -0.5; y <= 0.5; y += 0.01) {
+        for (double x = x0; x <= x1; x += 0.01) {
+            points.emplace_back(static_cast<float>(x), static_cast<float>(y), 0.0f);
+        }
+    }
+    return points;
+}
+
+// 第二批只覆盖一部分已有区域：增量提取只重做第二批积分过的块及其 -x/-y/-z 邻块，写出结果与从头提取逐字节相同。
+TEST_F(TsdfMeshTest, IncrementalUpdate_MatchesFullExtraction) {
+    TsdfVolume volume(0.02, 0.06, 64.0);
+    const CCVector3d origins[2] = {CCVector3d(-0.4, 0.0, 1.5), CCVector3d(0.7, 0.1, 1.2)};
+    const std::vector<CCVector3> first = planePatch(-1.0, 0.3);
+    const std::vector<CCVector3> second = planePatch(0.2, 1.0);
+    const std::vector<std::uint32_t> firstIds(first.size(), 0);
+    const std::vector<std::uint32_t> secondIds(second.size(), 1);
+
+    TsdfMesh mesh;
+    volume.integrate(first.data(), firstIds.data(), first.size(), origins);
+    const TsdfMeshStats full = mesh.update(volume);
+    EXPECT_EQ(full.dirtyBlocks, volume.blockCount());
+    EXPECT_EQ(full.remeshedBlocks, volume.blockCount());
+    EXPECT_GT(full.faces, 0u);
+
+    // 没有新的积分时不重新提取。
+    const TsdfMeshStats idle = mesh.update(volume);
+    EXPECT_EQ(idle.dirtyBlocks, 0u);
+    EXPECT_EQ(idle.remeshedBlocks, 0u);
+    EXPECT_EQ(idle.faces, full.faces);
+
+    volume.integrate(second.data(), secondIds.data(), second.size(), origins);
+    std::set<std::size_t> dirty;
+    std::set<std::size_t> expected;
+    for (std::size_t b = 0; b < volume.blockCount(); ++b) {
+        const TsdfBlock& block = volume.block(b);
+        if (block.stamp != volume.epoch()) {
+            continue;
+        }
+        dirty.insert(b);
+        for (int n = 0; n < 8; ++n) {
+            const std::int64_t index = volume.findIndex(block.coord[0] - (n & 1), block.coord[1] - ((n >> 1) & 1), block.coord[2] - ((n >> 2) & 1));
+            if (index >= 0) {
+                expected.insert(static_cast<std::size_t>(index));
+            }
+        }
+    }
+    const TsdfMeshStats incremental = mesh.update(volume);
+    EXPECT_EQ(incremental.dirtyBlocks, dirty.size());
+    EXPECT_EQ(incremental.remeshedBlocks, expected.size());
+    EXPECT_LT(incremental.remeshedBlocks, volume.blockCount());
+    // 两批重叠：既有新块，也有第一批的块被重新积分。
+    EXPECT_GT(volume.blockCount(), full.dirtyBlocks);
+    EXPECT_LT(dirty.size(), volume.blockCount());
+
+    TsdfMesh scratch;
+    const TsdfMeshStats scratchStats = scratch.update(volume);
+    EXPECT_EQ(incremental.vertices, scratchStats.vertices);
+    EXPECT_EQ(incremental.faces, scratchStats.faces);
+    mesh.writePly(dir_ / "incremental.ply");
+    scratch.writePly(dir_ / "scratch.ply");
+    const std::string bytes = readFile(dir_ / "incremental.ply");
+    EXPECT_EQ(bytes, readFile(dir_ / "scratch.ply"));
+    EXPECT_EQ(parseMesh(bytes).faces.size(), incremental.faces * 3);
+}
+
+// 从球心向球面（不与体素网格对齐）投射射线：提取的网格是闭合、定向一致的亏格 0 曲面，法向朝向传感器（球内）。
+TEST_F(TsdfMeshTest, Sphere_ClosedOrientedSurface) {
+    const double radius = 0.5;
+    const CCVector3d center(0.013, 0.027, -0.011);
+    std::vector<CCVector3> points;
+    const std::size_t count = 60000;
+    for (std::size_t i = 0; i < count; ++i) {
+        // Fibonacci 球面采样，点距约 0.007 m，小于体素边长的一半。
+        const double z = 1.0 - (2.0 * static_cast<double>(i) + 1.0) / static_cast<double>(count);
+        const double r = std::sqrt(1.0 - z * z);
+        const double phi = 2.399963229728653 * static_cast<double>(i);
+        points.emplace_back(static_cast<float>(center.x + radius * r * std::cos(phi)), static_cast<float>(center.y + radius * r * std::sin(phi)),
+                            static_cast<float>(center.z + radius * z));
+    }
+    const std::vector<std::uint32_t> originIds(points.size(), 0);
+    TsdfVolume volume(0.02, 0.06, 64.0);
+    volume.integrate(points.data(), originIds.data(), points.size(), &center);
+    TsdfMesh tsdfMesh;
+    tsdfMesh.update(volume);
+    tsdfMesh.writePly(dir_ / "sphere.ply");
+    const Mesh mesh = parseMesh(readFile(dir_ / "sphere.ply"));
+    const std::size_t vertices = mesh.vertices.size() / 3;
+    ASSERT_GT(mesh.faces.size(), 0u);
+
+    // 每条有向边恰好出现一次且其反向边也出现一次：无边界、无非流形边、相邻三角形定向一致。
+    std::map<std::pair<std::int32_t, std::int32_t>, int> edges;
+    std::vector<std::uint8_t> used(vertices, 0);
+    for (std::size_t f = 0; f < mesh.faces.size(); f += 3) {
+        for (int k = 0; k < 3; ++k) {
+            const std::int32_t a = mesh.faces[f + static_cast<std::size_t>(k)];
+            const std::int32_t b = mesh.faces[f + static_cast<std::size_t>((k + 1) % 3)];
+            ASSERT_GE(a, 0);
+            ASSERT_LT(static_cast<std::size_t>(a), vertices);
+            ASSERT_NE(a, b);
+            ++edges[{a, b}];
+            used[static_cast<std::size_t>(a)] = 1;
+        }
+    }
+    for (const auto& [edge, uses] : edges) {
+        ASSERT_EQ(uses, 1) << edge.first << "->" << edge.second;
+        const auto reverse = edges.find({edge.second, edge.first});
+        ASSERT_NE(reverse, edges.end()) << "boundary edge " << edge.first << "->" << edge.second;
+    }
+    for (std::size_t v = 0; v < vertices; ++v) {
+        ASSERT_TRUE(used[v]) << "unreferenced vertex " << v;
+    }
+    // 欧拉示性数 V - E + F = 2。
+    const std::size_t faces = mesh.faces.size() / 3;
+    EXPECT_EQ(static_cast<long long>(vertices) - static_cast<long long>(edges.size() / 2) + static_cast<long long>(faces), 2);
+
+    // 顶点落在球面附近；有向体积为负（法向朝内），大小接近球体积。
+    double volumeSum = 0.0;
+    for (std::size_t v = 0; v < vertices; ++v) {
+        const double d = std::sqrt(std::pow(mesh.vertices[v * 3] - center.x, 2) + std::pow(mesh.vertices[v * 3 + 1] - center.y, 2) +
+                                   std::pow(mesh.vertices[v * 3 + 2] - center.z, 2));
+        ASSERT_NEAR(d, radius, 0.01) << v;
+    }
+    for (std::size_t f = 0; f < mesh.faces.size(); f += 3) {
+        const float* a = &mesh.vertices[static_cast<std::size_t>(mesh.faces[f]) * 3];
+        const float* b = &mesh.vertices[static_cast<std::size_t>(mesh.faces[f + 1]) * 3];
+        const float* c = &mesh.vertices[static_cast<std::size_t>(mesh.faces[f + 2]) * 3];
+        volumeSum += (static_cast<double>(a[0]) * (static_cast<double>(b[1]) * c[2] - static_cast<double>(b[2]) * c[1]) -
+                      static_cast<double>(a[1]) * (static_cast<double>(b[0]) * c[2] - static_cast<double>(b[2]) * c[0]) +
+                      static_cast<double>(a[2]) * (static_cast<double>(b[0]) * c[1] - static_cast<double>(b[1]) * c[0])) /
+                     6.0;
+    }
+    const double sphereVolume = 4.0 / 3.0 * 3.141592653589793 * radius * radius * radius;
+    EXPECT_NEAR(-volumeSum, sphereVolume, 0.02 * sphereVolume);
+}
+
+}  // namespace
+}  // namespace tsdf
@@ -0,0 +1,159 @@
+#include "tsdf_volume.h"
+
+#include "synthetic_cloud.h"
+
+#include <gtest/gtest.h>
+
+#include <tbb/global_control.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace tsdf {
+namespace {
+
+constexpr double VOXEL = 0.02;
+constexpr double TRUNCATION = 0.08;
+
+// z = 0 平面上 [-extent, extent]^2 内步长 step 的网格点。
+std::vector<CCVector3> planePoints(double extent, double step) {
+    std::vector<CCVector3> points;
+    const int n = static_cast<int>(std::lround(extent / step));
+    for (int j = -n; j <= n; ++j) {
+        for (int i = -n; i <= n; ++i) {
+            points.emplace_back(static_cast<float>(i * step), static_cast<float>(j * step), 0.0f);
+        }
+    }
+    return points;
+}
+
+// 体素中心 (vx, vy, vz)，未分配或未观测时返回 nullptr。
+const TsdfVoxel* voxelAt(const TsdfVolume& volume, std::int32_t vx, std::int32_t vy, std::int32_t vz) {
+    const auto floorDiv = [](std::int32_t v) { return v >= 0 ? v / TSDF_BLOCK_SIDE : -((-v + TSDF_BLOCK_SIDE - 1) / TSDF_BLOCK_SIDE); };
+    const TsdfBlock* block = volume.find(floorDiv(vx), floorDiv(vy), floorDiv(vz));
+    if (!block) {
+        return nullptr;
+    }
+    const TsdfVoxel& voxel =
+        block->voxels[TsdfBlock::voxelIndex(vx - block->coord[0] * TSDF_BLOCK_SIDE, vy - block->coord[1] * TSDF_BLOCK_SIDE, vz - block->coord[2] * TSDF_BLOCK_SIDE)];
+    return voxel.weight > 0.0f ? &voxel : nullptr;
+}
+
+// 传感器正上方观测平面：平面附近体素的 SDF 在传感器一侧为正、背面为负，大小接近体素中心到平面的距离。
+TEST(TsdfVolume, PlaneFromSingleOrigin_SdfMatchesDistance) {
+    const std::vector<CCVector3> points = planePoints(1.0, 0.01);
+    const std::vector<std::uint32_t> originIds(points.size(), 0);
+    const CCVector3d origin(0.0, 0.0, 2.0);
+    TsdfVolume volume(VOXEL, TRUNCATION, 64.0);
+    const TsdfIntegrateStats stats = volume.integrate(points.data(), originIds.data(), points.size(), &origin);
+    EXPECT_EQ(stats.points, points.size());
+    EXPECT_EQ(stats.newBlocks, volume.blockCount());
+    EXPECT_EQ(stats.touchedBlocks, volume.blockCount());
+
+    // 正下方 ±0.3 m 内射线与法向夹角不超过约 12°，投影距离与真实距离之差小于 1/4 体素。
+    const int lateral = static_cast<int>(0.3 / VOXEL);
+    const int depth = static_cast<int>(TRUNCATION / VOXEL) - 1;
+    std::size_t checked = 0;
+    for (int vz = -depth; vz < depth; ++vz) {
+        const double distance = (vz + 0.5) * VOXEL;
+        for (int vy = -lateral; vy < lateral; ++vy) {
+            for (int vx = -lateral; vx < lateral; ++vx) {
+                const TsdfVoxel* voxel = voxelAt(volume, vx, vy, vz);
+                ASSERT_NE(voxel, nullptr) << vx << ' ' << vy << ' ' << vz;
+                EXPECT_EQ(voxel->sdf > 0.0f, distance > 0.0) << vx << ' ' << vy << ' ' << vz;
+                EXPECT_NEAR(voxel->sdf * TRUNCATION, distance, 0.25 * VOXEL) << vx << ' ' << vy << ' ' << vz;
+                EXPECT_LE(voxel->weight, 64.0f);
+                ++checked;
+            }
+        }
+    }
+    EXPECT_GT(checked, 0u);
+    // 截断段之外（平面上方 2 倍截断距离）不更新。
+    EXPECT_EQ(voxelAt(volume, 0, 0, static_cast<int>(2 * TRUNCATION / VOXEL)), nullptr);
+}
+
+// 两个已知原点分两批观测同一平面：符号只取决于体素在平面哪一侧，批次号逐批递增。
+TEST(TsdfVolume, PlaneFromTwoOrigins_SignBySide) {
+    const std::vector<CCVector3> points = planePoints(0.6, 0.01);
+    const CCVector3d origins[2] = {CCVector3d(0.0, 0.0, 2.0), CCVector3d(0.5, -0.3, 3.0)};
+    std::vector<std::uint32_t> originIds(points.size());
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        originIds[i] = static_cast<std::uint32_t>(i % 2);
+    }
+    TsdfVolume volume(VOXEL, TRUNCATION, 4.0);
+    const std::size_t half = points.size() / 2;
+    volume.integrate(points.data(), originIds.data(), half, origins);
+    volume.integrate(points.data() + half, originIds.data() + half, points.size() - half, origins);
+    EXPECT_EQ(volume.epoch(), 2u);
+
+    const int lateral = static_cast<int>(0.4 / VOXEL);
+    for (int vz = -3; vz < 3; ++vz) {
+        for (int vy = -lateral; vy < lateral; ++vy) {
+            for (int vx = -lateral; vx < lateral; ++vx) {
+                const TsdfVoxel* voxel = voxelAt(volume, vx, vy, vz);
+                ASSERT_NE(voxel, nullptr);
+                EXPECT_EQ(voxel->sdf > 0.0f, vz >= 0) << vx << ' ' << vy << ' ' << vz;
+                EXPECT_LE(voxel->weight, 4.0f);
+            }
+        }
+    }
+}
+
+// 合成场景点云（含离群点）按 8 个原点分两批积分：单线程与默认线程数的块顺序与体素逐字节相同。
+TEST(TsdfVolume, SingleVsManyThreads_Identical) {
+    const std::vector<CCVector3> points = generateSyntheticCloud(200000);
+    std::vector<CCVector3d> origins;
+    for (int k = 0; k < 8; ++k) {
+        origins.emplace_back(std::cos(k * 0.785) * 3.0, std::sin(k * 0.785) * 3.0, 1.5);
+    }
+    std::vector<std::uint32_t> originIds(points.size());
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        originIds[i] = static_cast<std::uint32_t>((i * 2654435761u) % origins.size());
+    }
+    const auto run = [&](TsdfVolume& volume) {
+        const std::size_t half = points.size() / 2;
+        volume.integrate(points.data(), originIds.data(), half, origins.data());
+        return volume.integrate(points.data() + half, originIds.data() + half, points.size() - half, origins.data());
+    };
+
+    TsdfVolume serial(0.05, 0.15, 32.0);
+    TsdfIntegrateStats serialStats;
+    {
+        const tbb::global_control threads(tbb::global_control::max_allowed_parallelism, 1);
+        serialStats = run(serial);
+    }
+    TsdfVolume parallel(0.05, 0.15, 32.0);
+    const TsdfIntegrateStats parallelStats = run(parallel);
+
+    EXPECT_EQ(parallelStats.pairs, serialStats.pairs);
+    EXPECT_EQ(parallelStats.touchedBlocks, serialStats.touchedBlocks);
+    EXPECT_EQ(parallelStats.newBlocks, serialStats.newBlocks);
+    ASSERT_EQ(parallel.blockCount(), serial.blockCount());
+    ASSERT_GT(serial.blockCount(), 0u);
+    for (std::size_t b = 0; b < serial.blockCount(); ++b) {
+        const TsdfBlock& a = serial.block(b);
+        const TsdfBlock& c = parallel.block(b);
+        ASSERT_EQ(std::memcmp(a.coord, c.coord, sizeof(a.coord)), 0) << b;
+        ASSERT_EQ(a.stamp, c.stamp) << b;
+        ASSERT_EQ(std::memcmp(a.voxels, c.voxels, sizeof(a.voxels)), 0) << b;
+    }
+}
+
+// 块坐标越界在并行收集射线时抛出，异常传出 integrate，已有块不变。
+TEST(TsdfVolume, BlockOutOfRange_ThrowsFromParallelLoop) {
+    std::vector<CCVector3> points = planePoints(1.0, 0.005);
+    points[points.size() / 2] = CCVector3(2.0e5f, 0.0f, 0.0f);
+    const std::vector<std::uint32_t> originIds(points.size(), 0);
+    const CCVector3d origin(0.0, 0.0, 2.0);
+    TsdfVolume volume(0.01, 0.03, 64.0);
+    volume.integrate(points.data(), originIds.data(), 1, &origin);
+    const std::size_t before = volume.blockCount();
+    EXPECT_THROW(volume.integrate(points.data(), originIds.data(), points.size(), &origin), std::runtime_error);
+    EXPECT_EQ(volume.blockCount(), before);
+}
+
+}  // namespace
+}  // namespace tsdf
@@ -0,0 +1,134 @@
+#include "voxel_downsample.h"
+
+#include "synthetic_cloud.h"
+
+#include <gtest/gtest.h>
+
+#include <PointCloud.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <tuple>
+#include <vector>
+
+namespace tsdf {
+namespace {
+
+CCCoreLib::PointCloud makeCloud(const std::vector<CCVector3>& points) {
+    CCCoreLib::PointCloud cloud;
+    cloud.reserve(static_cast<unsigned>(points.size()));
+    for (const CCVector3& p : points) {
+        cloud.addPoint(p);
+    }
+    return cloud;
+}
+
+bool finite(const CCVector3& p) {
+    return std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z);
+}
+
+// 参考实现：有限点按 floor((p - min) / voxel) 分组，每组取下标最小的点，组内均值按下标升序累加。
+struct Reference {
+    std::vector<std::uint32_t> kept;
+    std::map<std::uint32_t, CCVector3> centroids;
+};
+
+Reference referenceMerge(const std::vector<CCVector3>& points, double voxel) {
+    float lo[3] = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+    for (const CCVector3& p : points) {
+        if (finite(p)) {
+            lo[0] = std::min(lo[0], p.x);
+            lo[1] = std::min(lo[1], p.y);
+            lo[2] = std::min(lo[2], p.z);
+        }
+    }
+    std::map<std::tuple<std::int64_t, std::int64_t, std::int64_t>, std::vector<std::uint32_t>> groups;
+    for (std::uint32_t i = 0; i < points.size(); ++i) {
+        const CCVector3& p = points[i];
+        if (!finite(p)) {
+            continue;
+        }
+        const auto cell = [&](int k) { return static_cast<std::int64_t>((static_cast<double>(p.u[k]) - lo[k]) * (1.0 / voxel)); };
+        groups[{cell(0), cell(1), cell(2)}].push_back(i);
+    }
+    Reference ref;
+    for (const auto& [key, members] : groups) {
+        double sum[3] = {0.0, 0.0, 0.0};
+        for (const std::uint32_t i : members) {
+            sum[0] += points[i].x;
+            sum[1] += points[i].y;
+            sum[2] += points[i].z;
+        }
+        const double n = static_cast<double>(members.size());
+        ref.kept.push_back(members.front());
+        ref.centroids[members.front()] = members.size() == 1 ? points[members.front()]
+                                                             : CCVector3(static_cast<float>(sum[0] / n), static_cast<float>(sum[1] / n),
+                                                                         static_cast<float>(sum[2] / n));
+    }
+    std::sort(ref.kept.begin(), ref.kept.end());
+    return ref;
+}
+
+// 夹杂 NaN / Inf 坐标的点：不影响有限点的分组与包围盒，自身不会被保留。
+std::vector<CCVector3> cloudWithNonFinite() {
+    std::vector<CCVector3> points = generateSyntheticCloud(30000);
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float inf = std::numeric_limits<float>::infinity();
+    for (std::size_t i = 0; i < points.size(); i += 53) {
+        switch (i % 3) {
+            case 0: points[i].x = nan; break;
+            case 1: points[i].y = inf; break;
+            default: points[i].z = -inf; break;
+        }
+    }
+    points.front().y = nan;  // 首点即最小下标，若被当作代表点会立即暴露
+    return points;
+}
+
+TEST(VoxelDownsample, NonFinitePoints_DroppedFirstMode) {
+    const std::vector<CCVector3> points = cloudWithNonFinite();
+    CCCoreLib::PointCloud cloud = makeCloud(points);
+    std::vector<std::uint32_t> all(points.size());
+    std::iota(all.begin(), all.end(), std::uint32_t(0));
+    DownsampleStats stats;
+    const std::vector<std::uint32_t> kept = mergeVoxels(cloud, all, 0.2, false, &stats);
+    const Reference ref = referenceMerge(points, 0.2);
+    EXPECT_EQ(kept, ref.kept);
+    EXPECT_EQ(stats.input, points.size());
+    EXPECT_EQ(stats.output, ref.kept.size());
+    EXPECT_LT(kept.size(), points.size() / 2);
+}
+
+TEST(VoxelDownsample, NonFinitePoints_DroppedCentroidMode) {
+    const std::vector<CCVector3> points = cloudWithNonFinite();
+    CCCoreLib::PointCloud cloud = makeCloud(points);
+    std::vector<std::uint32_t> all(points.size());
+    std::iota(all.begin(), all.end(), std::uint32_t(0));
+    const std::vector<std::uint32_t> kept = mergeVoxels(cloud, all, 0.2, true);
+    const Reference ref = referenceMerge(points, 0.2);
+    ASSERT_EQ(kept, ref.kept);
+    for (const std::uint32_t i : kept) {
+        const CCVector3& p = *cloud.getPoint(i);
+        const CCVector3& expected = ref.centroids.at(i);
+        ASSERT_TRUE(finite(p)) << i;
+        EXPECT_NEAR(p.x, expected.x, 1e-4f) << i;
+        EXPECT_NEAR(p.y, expected.y, 1e-4f) << i;
+        EXPECT_NEAR(p.z, expected.z, 1e-4f) << i;
+    }
+}
+
+TEST(VoxelDownsample, AllNonFinite_ReturnsEmpty) {
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    CCCoreLib::PointCloud cloud = makeCloud({CCVector3(nan, 0.0f, 0.0f), CCVector3(0.0f, std::numeric_limits<float>::infinity(), 0.0f)});
+    DownsampleStats stats;
+    EXPECT_TRUE(mergeVoxels(cloud, {0, 1}, 0.1, true, &stats).empty());
+    EXPECT_EQ(stats.input, 2u);
+    EXPECT_EQ(stats.output, 0u);
+}
+
+}  // namespace
+}  // namespace tsdf
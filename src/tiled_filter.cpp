@@ -0,0 +1,589 @@
+#include "tiled_filter.h"
+
+#include "cloud_io.h"
+#include "noise_filter.h"
+#include "stage_pipeline.h"
+#include "telemetry.h"
+
+#include <CCGeom.h>
+#include <PointCloud.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 整图滤波时每点的大致内存：坐标 12B + 八叉树索引/编码 16B + 引用云 4B + 滤波临时量。
+constexpr double FILTER_BYTES_PER_POINT = 48.0;
+constexpr std::size_t SCAN_CHUNK = 1 << 20;
+constexpr std::size_t DECODE_GRAIN = 1 << 16;
+constexpr std::size_t MERGE_BATCH = 1 << 16;
+// 自动选择分块时统计直方图的每轴最大格数。
+constexpr int HISTOGRAM_BINS = 1024;
+
+// 分块输入源：PCD DATA binary 走映射按块解码，其余格式（含 PLY）退化为整块载入内存。
+class TileSource {
+public:
+    explicit TileSource(const fs::path& input) {
+        try {
+            view_ = std::make_unique<tsdf::PcdBinaryView>(input);
+        } catch (const std::exception&) {
+            cloud_ = std::make_unique<CCCoreLib::PointCloud>(tsdf::loadCloud(input));
+        }
+    }
+
+    std::size_t size() const { return view_ ? view_->size() : cloud_->size(); }
+
+    // fn(first, points, count)：按原始点号顺序依次给出每块点。
+    template <typename Fn>
+    void forEachChunk(Fn&& fn) const {
+        if (!view_) {
+            if (cloud_->size() > 0) {
+                fn(std::size_t(0), cloud_->getPoint(0), static_cast<std::size_t>(cloud_->size()));
+            }
+            return;
+        }
+        std::vector<CCVector3> buffer(std::min(SCAN_CHUNK, view_->size()));
+        for (std::size_t first = 0; first < view_->size(); first += SCAN_CHUNK) {
+            const std::size_t count = std::min(SCAN_CHUNK, view_->size() - first);
+            tbb::parallel_for(tbb::blocked_range<std::size_t>(0, count, DECODE_GRAIN), [&](const tbb::blocked_range<std::size_t>& r) {
+                view_->decode(first + r.begin(), r.size(), buffer.data() + r.begin());
+            });
+            fn(first, static_cast<const CCVector3*>(buffer.data()), count);
+        }
+    }
+
+private:
+    std::unique_ptr<tsdf::PcdBinaryView> view_;
+    std::unique_ptr<CCCoreLib::PointCloud> cloud_;
+};
+
+struct Bounds {
+    double minX = std::numeric_limits<double>::max();
+    double minY = std::numeric_limits<double>::max();
+    double maxX = std::numeric_limits<double>::lowest();
+    double maxY = std::numeric_limits<double>::lowest();
+
+    double extent() const { return std::max(maxX - minX, maxY - minY); }
+};
+
+struct TileGrid {
+    double minX = 0.0;
+    double minY = 0.0;
+    double size = 1.0;
+    int nx = 1;
+    int ny = 1;
+
+    static int cell(double v, double origin, double size, int n) {
+        const double c = std::floor((v - origin) / size);
+        return static_cast<int>(std::clamp(c, 0.0, static_cast<double>(n - 1)));
+    }
+
+    std::size_t coreTile(const CCVector3& p) const {
+        return static_cast<std::size_t>(cell(p.y, minY, size, ny)) * static_cast<std::size_t>(nx)
+             + static_cast<std::size_t>(cell(p.x, minX, size, nx));
+    }
+};
+
+TileGrid makeGrid(const Bounds& bounds, double size) {
+    TileGrid grid;
+    grid.minX = bounds.minX;
+    grid.minY = bounds.minY;
+    grid.size = size;
+    grid.nx = std::max(1, static_cast<int>(std::ceil((bounds.maxX - bounds.minX) / size)));
+    grid.ny = std::max(1, static_cast<int>(std::ceil((bounds.maxY - bounds.minY) / size)));
+    return grid;
+}
+
+// 用 XY 直方图的二维前缀和估计每块（含重叠边）的点数，从大到小尝试分块边长，
+// 取第一个使最大分块不超过内存上限的边长；residentTiles 块同时驻留时按块均分上限。
+double chooseTileSize(const TileSource& source, const Bounds& bounds, const tsdf::FilterConfig& cfg, double halo, int residentTiles) {
+    const double capPoints = cfg.max_memory_mb * 1024.0 * 1024.0 / FILTER_BYTES_PER_POINT / residentTiles;
+    const double extent = std::max(bounds.extent(), halo);
+    if (static_cast<double>(source.size()) <= capPoints) {
+        return extent * 1.001 + halo;
+    }
+
+    const double bin = std::max(extent / HISTOGRAM_BINS, halo);
+    const int bx = static_cast<int>(std::floor((bounds.maxX - bounds.minX) / bin)) + 1;
+    const int by = static_cast<int>(std::floor((bounds.maxY - bounds.minY) / bin)) + 1;
+    std::vector<std::uint64_t> prefix(static_cast<std::size_t>(bx + 1) * static_cast<std::size_t>(by + 1), 0);
+    auto at = [&](int x, int y) -> std::uint64_t& {
+        return prefix[static_cast<std::size_t>(y) * static_cast<std::size_t>(bx + 1) + static_cast<std::size_t>(x)];
+    };
+    source.forEachChunk([&](std::size_t, const CCVector3* pts, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            ++at(TileGrid::cell(pts[i].x, bounds.minX, bin, bx) + 1, TileGrid::cell(pts[i].y, bounds.minY, bin, by) + 1);
+        }
+    });
+    for (int y = 1; y <= by; ++y) {
+        for (int x = 1; x <= bx; ++x) {
+            at(x, y) += at(x - 1, y) + at(x, y - 1) - at(x - 1, y - 1);
+        }
+    }
+
+    for (double k = 2.0;; k = std::ceil(k * 1.15)) {
+        const double size = extent / k;
+        if (size <= 2.0 * halo || size < 2.0 * bin) {
+            throw std::runtime_error("Filter.max_memory_mb 过小，分块边长已接近重叠边宽度仍无法满足");
+        }
+        const TileGrid grid = makeGrid(bounds, size);
+        std::uint64_t worst = 0;
+        for (int ty = 0; ty < grid.ny; ++ty) {
+            for (int tx = 0; tx < grid.nx; ++tx) {
+                // 直方图格与分块边界不对齐，按覆盖到的整格计数，偏保守。
+                const int x0 = TileGrid::cell(grid.minX + tx * size - halo, bounds.minX, bin, bx);
+                const int x1 = TileGrid::cell(grid.minX + (tx + 1) * size + halo, bounds.minX, bin, bx) + 1;
+                const int y0 = TileGrid::cell(grid.minY + ty * size - halo, bounds.minY, bin, by);
+                const int y1 = TileGrid::cell(grid.minY + (ty + 1) * size + halo, bounds.minY, bin, by) + 1;
+                worst = std::max(worst, at(x1, y1) - at(x0, y1) - at(x1, y0) + at(x0, y0));
+            }
+        }
+        if (static_cast<double>(worst) <= capPoints) {
+            return size;
+        }
+    }
+}
+
+// 分块落盘：每块一个文件，内存里只保留有限的写缓冲。构造时删除目录里同名的旧文件，避免追加到上次中断留下的残块。
+class TileSpill {
+public:
+    TileSpill(fs::path dir, std::size_t tiles, std::size_t flushRecords)
+        : dir_(std::move(dir)), buffers_(tiles), counts_(tiles, 0), flushRecords_(flushRecords) {
+        fs::create_directories(dir_);
+        for (std::size_t tile = 0; tile < tiles; ++tile) {
+            std::error_code ec;
+            fs::remove(tsdf::TilePartitioner::tilePath(dir_, tile), ec);
+        }
+    }
+
+    void push(std::size_t tile, const tsdf::TileRecord& record) {
+        std::vector<tsdf::TileRecord>& buffer = buffers_[tile];
+        buffer.push_back(record);
+        ++counts_[tile];
+        if (buffer.size() >= flushRecords_) {
+            flush(tile);
+        }
+    }
+
+    void flushAll() {
+        for (std::size_t tile = 0; tile < buffers_.size(); ++tile) {
+            flush(tile);
+        }
+    }
+
+    const std::vector<std::size_t>& counts() const { return counts_; }
+
+private:
+    void flush(std::size_t tile) {
+        std::vector<tsdf::TileRecord>& buffer = buffers_[tile];
+        if (buffer.empty()) {
+            return;
+        }
+        const fs::path path = tsdf::TilePartitioner::tilePath(dir_, tile);
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size() * sizeof(tsdf::TileRecord)));
+        if (!out) {
+            throw std::runtime_error("写分块文件失败: " + path.string());
+        }
+        buffer.clear();
+        buffer.shrink_to_fit();
+    }
+
+    fs::path dir_;
+    std::vector<std::vector<tsdf::TileRecord>> buffers_;
+    std::vector<std::size_t> counts_;
+    std::size_t flushRecords_;
+};
+
+// 单个分块在各步之间传递的数据：落盘记录 → 点云 → 核心区保留点（块内下标，按原始点号排序）。
+struct TileWork {
+    std::size_t tile = 0;
+    std::vector<tsdf::TileRecord> records;
+    std::unique_ptr<CCCoreLib::PointCloud> cloud;
+    std::vector<std::uint32_t> kept;
+    double octreeMs = 0.0;
+    double filterMs = 0.0;
+
+    // 只有重叠边、没有核心点的分块无需滤波。
+    bool active() const {
+        return std::any_of(records.begin(), records.end(), [](const tsdf::TileRecord& r) { return r.core != 0; });
+    }
+};
+
+void buildTileCloud(TileWork& work) {
+    if (!work.active()) {
+        return;
+    }
+    work.cloud = std::make_unique<CCCoreLib::PointCloud>();
+    if (!work.cloud->resize(static_cast<unsigned>(work.records.size()))) {
+        throw std::runtime_error("点云预分配失败");
+    }
+    for (std::size_t i = 0; i < work.records.size(); ++i) {
+        *work.cloud->point(static_cast<unsigned>(i)) = work.records[i].point;
+    }
+    work.cloud->invalidateBoundingBox();
+}
+
+void filterTile(TileWork& work, const tsdf::FilterConfig& cfg) {
+    if (!work.cloud) {
+        return;
+    }
+    const std::unique_ptr<CCCoreLib::ReferenceCloud> filtered = tsdf::runFilter(*work.cloud, cfg, &work.octreeMs, &work.filterMs);
+    const std::vector<tsdf::TileRecord>& records = work.records;
+    work.kept.reserve(filtered->size());
+    for (unsigned i = 0; i < filtered->size(); ++i) {
+        const unsigned local = filtered->getPointGlobalIndex(i);
+        if (records[local].core) {
+            work.kept.push_back(local);
+        }
+    }
+    std::sort(work.kept.begin(), work.kept.end(), [&](std::uint32_t a, std::uint32_t b) { return records[a].index < records[b].index; });
+    work.cloud.reset();
+}
+
+// 汇总一块的结果，保留点的原始点号追加到 keptIds（为空则不收集），须按分块顺序调用。
+void collectTile(const TileWork& work, tsdf::TiledFilterStats& stats, std::vector<std::uint64_t>* keptIds) {
+    if (!work.active()) {
+        return;
+    }
+    ++stats.tiles;
+    stats.maxTilePoints = std::max(stats.maxTilePoints, work.records.size());
+    stats.octreeMs += work.octreeMs;
+    stats.filterMs += work.filterMs;
+    stats.keptPoints += work.kept.size();
+    if (keptIds) {
+        for (const std::uint32_t local : work.kept) {
+            keptIds->push_back(work.records[local].index);
+        }
+    }
+}
+
+// 在 parent 下新建本次运行独有的分块目录，同一输入的并发作业互不干扰。
+fs::path makeSpillDir(const fs::path& parent, const std::string& stem) {
+    std::string pattern = ((parent.empty() ? fs::path(".") : parent) / (".livomesh_tiles_" + stem + ".XXXXXX")).string();
+    if (!mkdtemp(pattern.data())) {
+        throw std::runtime_error("无法创建分块临时目录: " + pattern + ": " + std::strerror(errno));
+    }
+    return fs::path(pattern);
+}
+
+// 作用域结束时删除目录（含异常展开）。
+class RemoveOnExit {
+public:
+    explicit RemoveOnExit(fs::path dir) : dir_(std::move(dir)) {}
+    ~RemoveOnExit() {
+        std::error_code ec;
+        fs::remove_all(dir_, ec);
+    }
+
+    RemoveOnExit(const RemoveOnExit&) = delete;
+    RemoveOnExit& operator=(const RemoveOnExit&) = delete;
+
+private:
+    fs::path dir_;
+};
+
+}  // namespace
+
+namespace tsdf {
+
+struct TilePartitioner::Impl {
+    explicit Impl(const fs::path& input) : source(input) {}
+
+    TileSource source;
+    TileGrid grid;
+    double halo = 0.0;
+    double maxMemoryMb = 0.0;
+};
+
+TilePartitioner::TilePartitioner(const fs::path& input, const FilterConfig& cfg, int residentTiles) : impl_(std::make_unique<Impl>(input)) {
+    Bounds bounds;
+    impl_->source.forEachChunk([&](std::size_t, const CCVector3* pts, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            bounds.minX = std::min(bounds.minX, static_cast<double>(pts[i].x));
+            bounds.minY = std::min(bounds.minY, static_cast<double>(pts[i].y));
+            bounds.maxX = std::max(bounds.maxX, static_cast<double>(pts[i].x));
+            bounds.maxY = std::max(bounds.maxY, static_cast<double>(pts[i].y));
+        }
+    });
+    impl_->maxMemoryMb = cfg.max_memory_mb;
+    if (impl_->source.size() == 0) {
+        return;
+    }
+    // 重叠边略大于 radius，避免边界上的浮点舍入漏掉恰好在球面上的邻点。
+    impl_->halo = cfg.radius * 1.001;
+    const double size = cfg.tile_size > 0.0 ? cfg.tile_size : chooseTileSize(impl_->source, bounds, cfg, impl_->halo, residentTiles);
+    impl_->grid = makeGrid(bounds, size);
+}
+
+TilePartitioner::~TilePartitioner() = default;
+
+std::size_t TilePartitioner::inputPoints() const {
+    return impl_->source.size();
+}
+
+double TilePartitioner::tileSize() const {
+    return inputPoints() > 0 ? impl_->grid.size : 0.0;
+}
+
+std::size_t TilePartitioner::tileCount() const {
+    return inputPoints() > 0 ? static_cast<std::size_t>(impl_->grid.nx) * static_cast<std::size_t>(impl_->grid.ny) : 0;
+}
+
+std::string TilePartitioner::describe() const {
+    const TileGrid& grid = impl_->grid;
+    std::ostringstream out;
+    out.precision(17);
+    out << "points " << inputPoints() << " origin " << grid.minX << ' ' << grid.minY << " size " << tileSize() << " grid " << grid.nx << ' ' << grid.ny
+        << " halo " << impl_->halo;
+    return out.str();
+}
+
+fs::path TilePartitioner::tilePath(const fs::path& dir, std::size_t tile) {
+    return dir / ("tile_" + std::to_string(tile) + ".bin");
+}
+
+std::vector<std::size_t> TilePartitioner::spill(const fs::path& dir, const std::function<bool(std::size_t)>& skip) const {
+    const std::size_t tileCount = this->tileCount();
+    if (tileCount == 0) {
+        return {};
+    }
+    const TileGrid& grid = impl_->grid;
+    const double halo = impl_->halo;
+    // 写缓冲总量控制在内存上限的一半以内（未设上限时取 16M 条记录）。
+    const double bufferRecords = impl_->maxMemoryMb > 0.0 ? impl_->maxMemoryMb * 512.0 * 1024.0 / sizeof(TileRecord) : double(1 << 24);
+    const std::size_t flushRecords = std::clamp<std::size_t>(static_cast<std::size_t>(bufferRecords / static_cast<double>(tileCount)), 1024, 1 << 16);
+    std::vector<std::uint8_t> skipped(tileCount, 0);
+    if (skip) {
+        for (std::size_t tile = 0; tile < tileCount; ++tile) {
+            skipped[tile] = skip(tile) ? 1 : 0;
+        }
+    }
+    TileSpill spill(dir, tileCount, flushRecords);
+
+    impl_->source.forEachChunk([&](std::size_t first, const CCVector3* pts, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            const CCVector3& p = pts[i];
+            const std::size_t core = grid.coreTile(p);
+            const int tx0 = TileGrid::cell(p.x - halo, grid.minX, grid.size, grid.nx);
+            const int tx1 = TileGrid::cell(p.x + halo, grid.minX, grid.size, grid.nx);
+            const int ty0 = TileGrid::cell(p.y - halo, grid.minY, grid.size, grid.ny);
+            const int ty1 = TileGrid::cell(p.y + halo, grid.minY, grid.size, grid.ny);
+            for (int ty = ty0; ty <= ty1; ++ty) {
+                for (int tx = tx0; tx <= tx1; ++tx) {
+                    const std::size_t tile = static_cast<std::size_t>(ty) * static_cast<std::size_t>(grid.nx) + static_cast<std::size_t>(tx);
+                    if (!skipped[tile]) {
+                        spill.push(tile, TileRecord{first + i, p, tile == core ? 1u : 0u});
+                    }
+                }
+            }
+        }
+    });
+    spill.flushAll();
+    return spill.counts();
+}
+
+std::vector<TileRecord> readTileRecords(const fs::path& file) {
+    std::vector<TileRecord> records;
+    std::error_code ec;
+    const std::uintmax_t bytes = fs::file_size(file, ec);
+    if (ec) {
+        return records;
+    }
+    if (bytes % sizeof(TileRecord) != 0) {
+        throw std::runtime_error("分块文件长度不是记录大小的整数倍: " + file.string());
+    }
+    records.resize(static_cast<std::size_t>(bytes / sizeof(TileRecord)));
+    std::ifstream in(file, std::ios::binary);
+    in.read(reinterpret_cast<char*>(records.data()), static_cast<std::streamsize>(bytes));
+    if (!in) {
+        throw std::runtime_error("读取分块文件失败: " + file.string());
+    }
+    return records;
+}
+
+std::vector<std::uint64_t> filterTileRecords(std::vector<TileRecord> records, const FilterConfig& cfg, double* octreeMs, double* filterMs) {
+    TileWork work;
+    work.records = std::move(records);
+    buildTileCloud(work);
+    filterTile(work, cfg);
+    if (octreeMs) {
+        *octreeMs = work.octreeMs;
+    }
+    if (filterMs) {
+        *filterMs = work.filterMs;
+    }
+    std::vector<std::uint64_t> kept(work.kept.size());
+    for (std::size_t i = 0; i < kept.size(); ++i) {
+        kept[i] = work.records[work.kept[i]].index;
+    }
+    return kept;
+}
+
+void writeSelectedPoints(const fs::path& input, const fs::path& output, const std::vector<std::uint64_t>& kept, bool keepFields) {
+    std::unique_ptr<PcdBinaryView> view;
+    try {
+        view = std::make_unique<PcdBinaryView>(input);
+    } catch (const std::exception&) {
+    }
+    if (keepFields) {
+        PcdRecords records;
+        if (!view) {
+            records = loadCloudRecords(input);
+        }
+        const PcdHeader& header = view ? view->header() : records.header();
+        const char* base = view ? view->record(0) : records.data();
+        const std::size_t step = header.pointStep;
+        CloudStreamWriter writer(output, header.fields);
+        std::vector<char> batch(MERGE_BATCH * step);
+        for (std::size_t first = 0; first < kept.size(); first += MERGE_BATCH) {
+            const std::size_t n = std::min(MERGE_BATCH, kept.size() - first);
+            for (std::size_t i = 0; i < n; ++i) {
+                std::memcpy(batch.data() + i * step, base + kept[first + i] * step, step);
+            }
+            writer.appendRecords(batch.data(), n);
+        }
+        writer.close();
+        return;
+    }
+
+    std::unique_ptr<CCCoreLib::PointCloud> cloud;
+    if (!view) {
+        cloud = std::make_unique<CCCoreLib::PointCloud>(loadCloud(input));
+    }
+    CloudStreamWriter writer(output);
+    std::vector<CCVector3> batch(MERGE_BATCH);
+    for (std::size_t first = 0; first < kept.size(); first += MERGE_BATCH) {
+        const std::size_t n = std::min(MERGE_BATCH, kept.size() - first);
+        for (std::size_t i = 0; i < n; ++i) {
+            if (view) {
+                view->decode(kept[first + i], 1, &batch[i]);
+            } else {
+                batch[i] = *cloud->getPoint(static_cast<unsigned>(kept[first + i]));
+            }
+        }
+        writer.append(batch.data(), n);
+    }
+    writer.close();
+}
+
+bool tiledFilterEnabled(const FilterConfig& cfg) {
+    return cfg.tile_size > 0.0 || cfg.max_memory_mb > 0.0;
+}
+
+TiledFilterStats runTiledFilter(const fs::path& input,
+                                const fs::path& output,
+                                const FilterConfig& cfg,
+                                const PipelineConfig& pipeline,
+                                bool keepFields) {
+    TiledFilterStats stats;
+    const auto spillStart = std::chrono::steady_clock::now();
+    ScopedStage spillStage("tile_spill");
+    const TilePartitioner partitioner(input, cfg, pipeline.enable ? pipeline.max_inflight : 1);
+    stats.inputPoints = partitioner.inputPoints();
+
+    if (stats.inputPoints == 0) {
+        if (!output.empty()) {
+            writeSelectedPoints(input, output, {}, keepFields);
+        }
+        return stats;
+    }
+
+    stats.tileSize = partitioner.tileSize();
+    const std::size_t tileCount = partitioner.tileCount();
+    const fs::path spillDir = makeSpillDir(output.empty() ? fs::temp_directory_path() : output.parent_path(), input.stem().string());
+    const RemoveOnExit cleanup(spillDir);
+    const std::vector<std::size_t> counts = partitioner.spill(spillDir);
+    stats.spillMs = elapsedMs(spillStart);
+    spillStage.setPoints(stats.inputPoints);
+    spillStage.finish();
+
+    // 读一块并随即删除其文件。
+    auto take = [&](std::size_t tile) {
+        const fs::path path = TilePartitioner::tilePath(spillDir, tile);
+        std::vector<TileRecord> records = readTileRecords(path);
+        std::error_code ec;
+        fs::remove(path, ec);
+        return records;
+    };
+
+    std::vector<std::size_t> tiles;
+    for (std::size_t tile = 0; tile < tileCount; ++tile) {
+        if (counts[tile] > 0) {
+            tiles.push_back(tile);
+        }
+    }
+    std::vector<std::uint64_t> keptIds;
+    std::vector<std::uint64_t>* collect = output.empty() ? nullptr : &keptIds;
+    if (pipeline.enable) {
+        // 读盘、组装、滤波、汇总四级重叠执行，汇总级按分块顺序消费，结果与串行一致。
+        StagePipeline<TileWork> stages("tiles", static_cast<std::size_t>(pipeline.max_inflight));
+        stages.source("read", pipeline.readers, tiles.size(), [&](std::size_t seq, TileWork& work) {
+            const TraceSpan span("tile_read");
+            work.tile = tiles[seq];
+            work.records = take(work.tile);
+        });
+        stages.stage("decode", pipeline.decoders, [](TileWork& work) {
+            const TraceSpan span("tile_decode");
+            buildTileCloud(work);
+        });
+        stages.stage("filter", pipeline.filters, [&](TileWork& work) {
+            const TraceSpan span("tile_filter");
+            filterTile(work, cfg);
+        });
+        stages.sink("write", [&](TileWork& work) {
+            const TraceSpan span("tile_write");
+            collectTile(work, stats, collect);
+        });
+        stats.pipeline = stages.run();
+    } else {
+        for (const std::size_t tile : tiles) {
+            TileWork work;
+            work.tile = tile;
+            work.records = take(tile);
+            if (!work.active()) {
+                continue;
+            }
+            ScopedStage tileStage("tile");
+            tileStage.setPoints(work.records.size());
+            buildTileCloud(work);
+            filterTile(work, cfg);
+            collectTile(work, stats, collect);
+        }
+    }
+
+    if (!output.empty()) {
+        // 各块保留点互不相交、块内已按原始点号排序，整体排序后按原始次序取记录写出，与整图滤波的输出一致。
+        const auto mergeStart = std::chrono::steady_clock::now();
+        ScopedStage mergeStage("tile_merge");
+        tbb::parallel_sort(keptIds.begin(), keptIds.end());
+        writeSelectedPoints(input, output, keptIds, keepFields);
+        stats.mergeMs = elapsedMs(mergeStart);
+        mergeStage.setPoints(keptIds.size());
+        mergeStage.addBytesWritten(fs::file_size(output));
+    }
+    return stats;
+}
+
+}  // namespace tsdf
@@ -0,0 +1,394 @@
+#include "tsdf_mesh.h"
+
+#include "mapped_file.h"
+#include "telemetry.h"
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr int SIDE = tsdf::TSDF_BLOCK_SIDE;
+// 本块 8^3 体素外扩 +x/+y/+z 各一层，覆盖以本块体素为原点的全部立方体角点。
+constexpr int PAD_SIDE = SIDE + 1;
+constexpr int SLOT_BITS = 11;
+constexpr std::uint64_t SLOT_MASK = (std::uint64_t(1) << SLOT_BITS) - 1;
+constexpr std::size_t BLOCK_GRAIN = 8;
+constexpr std::size_t VERTEX_BYTES = 3 * sizeof(float);
+constexpr std::size_t FACE_BYTES = 1 + 3 * sizeof(std::int32_t);
+
+// 立方体角点编号 c = x | y << 1 | z << 2；12 条边按 (低端角点, 轴) 编号。
+constexpr int EDGE_CORNER[12] = {0, 2, 4, 6, 0, 1, 4, 5, 0, 1, 2, 3};
+constexpr int EDGE_AXIS[12] = {0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2};
+// 六个面的角点，从立方体外侧看按逆时针排列。
+constexpr int FACE_CORNERS[6][4] = {{0, 4, 6, 2}, {1, 3, 7, 5}, {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 2, 3, 1}, {4, 5, 7, 6}};
+
+int edgeBetween(int a, int b) {
+    const int lo = std::min(a, b);
+    switch (a ^ b) {
+    case 1:
+        return lo >> 1;
+    case 2:
+        return 4 + ((lo & 1) | ((lo >> 2) << 1));
+    default:
+        return 8 + (lo & 3);
+    }
+}
+
+// 每种角点符号组合的三角形（最多 10 个），三角形法向朝向正值（传感器）一侧。
+struct McCase {
+    std::uint8_t count = 0;
+    std::uint8_t edges[30] = {};
+};
+
+// 按面逐一连接等值线段生成查找表：面上逆时针走到“正→负”穿越边时，连到下一条“负→正”穿越边，
+// 即歧义面上总把负角点隔开。该规则只取决于面上四个角点，相邻立方体对公共面的连法一致，网格无裂缝。
+// 每条穿越边恰好是一个面上线段的起点、另一个面上线段的终点，首尾相接得到闭合多边形后扇形三角化。
+std::array<McCase, 256> buildCaseTable() {
+    std::array<McCase, 256> table;
+    for (int mask = 0; mask < 256; ++mask) {
+        const auto inside = [mask](int corner) { return ((mask >> corner) & 1) != 0; };
+        int next[12];
+        std::fill(std::begin(next), std::end(next), -1);
+        for (const auto& face : FACE_CORNERS) {
+            for (int i = 0; i < 4; ++i) {
+                const int a = face[i];
+                const int b = face[(i + 1) % 4];
+                if (inside(a) || !inside(b)) {
+                    continue;
+                }
+                for (int j = i + 1; j < i + 4; ++j) {
+                    const int c = face[j % 4];
+                    const int d = face[(j + 1) % 4];
+                    if (inside(c) && !inside(d)) {
+                        next[edgeBetween(a, b)] = edgeBetween(c, d);
+                        break;
+                    }
+                }
+            }
+        }
+
+        McCase& entry = table[static_cast<std::size_t>(mask)];
+        bool visited[12] = {};
+        for (int start = 0; start < 12; ++start) {
+            if (next[start] < 0 || visited[start]) {
+                continue;
+            }
+            int loop[12];
+            int length = 0;
+            for (int e = start; !visited[e]; e = next[e]) {
+                visited[e] = true;
+                loop[length++] = e;
+            }
+            for (int k = 1; k + 1 < length; ++k) {
+                entry.edges[entry.count * 3 + 0] = static_cast<std::uint8_t>(loop[0]);
+                entry.edges[entry.count * 3 + 1] = static_cast<std::uint8_t>(loop[k]);
+                entry.edges[entry.count * 3 + 2] = static_cast<std::uint8_t>(loop[k + 1]);
+                ++entry.count;
+            }
+        }
+    }
+    return table;
+}
+
+const std::array<McCase, 256>& caseTable() {
+    static const std::array<McCase, 256> table = buildCaseTable();
+    return table;
+}
+
+int padIndex(int x, int y, int z) {
+    return (z * PAD_SIDE + y) * PAD_SIDE + x;
+}
+
+// 体素中心之间的格点边上的零点。属主块与引用它的块用同一组整数坐标与同一组 sdf 计算，结果逐位一致。
+void edgePoint(const std::int32_t voxel[3], int axis, float s0, float s1, double voxelSize, float out[3]) {
+    const double t = static_cast<double>(s0) / (static_cast<double>(s0) - static_cast<double>(s1));
+    for (int a = 0; a < 3; ++a) {
+        const double v = voxel[a] + 0.5 + (a == axis ? t : 0.0);
+        out[a] = static_cast<float>(v * voxelSize);
+    }
+}
+
+// 本块及 +x/+y/+z 方向 7 个邻块中外扩一层的 sdf；observed 为 0 表示未观测或邻块不存在。
+struct PaddedBlock {
+    float sdf[PAD_SIDE * PAD_SIDE * PAD_SIDE];
+    std::uint8_t observed[PAD_SIDE * PAD_SIDE * PAD_SIDE];
+    std::int64_t owners[8];  // 邻块 (dx | dy << 1 | dz << 2) 的块下标，-1 表示不存在
+};
+
+void gatherPadded(const tsdf::TsdfVolume& volume, const tsdf::TsdfBlock& block, float minWeight, PaddedBlock* pad) {
+    const tsdf::TsdfBlock* neighbours[8];
+    for (int n = 0; n < 8; ++n) {
+        pad->owners[n] = volume.findIndex(block.coord[0] + (n & 1), block.coord[1] + ((n >> 1) & 1), block.coord[2] + ((n >> 2) & 1));
+        neighbours[n] = pad->owners[n] < 0 ? nullptr : &volume.block(static_cast<std::size_t>(pad->owners[n]));
+    }
+    for (int z = 0; z < PAD_SIDE; ++z) {
+        for (int y = 0; y < PAD_SIDE; ++y) {
+            for (int x = 0; x < PAD_SIDE; ++x) {
+                const int n = (x / SIDE) | ((y / SIDE) << 1) | ((z / SIDE) << 2);
+                const int p = padIndex(x, y, z);
+                if (!neighbours[n]) {
+                    pad->sdf[p] = 1.0f;
+                    pad->observed[p] = 0;
+                    continue;
+                }
+                const tsdf::TsdfVoxel& voxel = neighbours[n]->voxels[tsdf::TsdfBlock::voxelIndex(x % SIDE, y % SIDE, z % SIDE)];
+                pad->sdf[p] = voxel.sdf;
+                pad->observed[p] = voxel.weight >= minWeight ? 1 : 0;
+            }
+        }
+    }
+}
+
+struct BlockOutput {
+    std::vector<std::uint16_t>* slots;
+    std::vector<float>* positions;
+    std::vector<std::uint64_t>* corners;
+};
+
+void meshBlock(const tsdf::TsdfVolume& volume, std::size_t index, float minWeight, const BlockOutput& out) {
+    const tsdf::TsdfBlock& block = volume.block(index);
+    PaddedBlock pad;
+    gatherPadded(volume, block, minWeight, &pad);
+    const std::int32_t base[3] = {block.coord[0] * SIDE, block.coord[1] * SIDE, block.coord[2] * SIDE};
+    const double voxelSize = volume.voxelSize();
+    out.slots->clear();
+    out.positions->clear();
+    out.corners->clear();
+
+    // 1. 本块拥有的顶点：低端点在本块、两端都已观测且符号相反的格点边；按槽位顺序生成，天然有序。
+    for (int z = 0; z < SIDE; ++z) {
+        for (int y = 0; y < SIDE; ++y) {
+            for (int x = 0; x < SIDE; ++x) {
+                const int p = padIndex(x, y, z);
+                if (!pad.observed[p]) {
+                    continue;
+                }
+                const std::int32_t voxel[3] = {base[0] + x, base[1] + y, base[2] + z};
+                const int q[3] = {padIndex(x + 1, y, z), padIndex(x, y + 1, z), padIndex(x, y, z + 1)};
+                for (int axis = 0; axis < 3; ++axis) {
+                    if (!pad.observed[q[axis]] || (pad.sdf[p] < 0.0f) == (pad.sdf[q[axis]] < 0.0f)) {
+                        continue;
+                    }
+                    float point[3];
+                    edgePoint(voxel, axis, pad.sdf[p], pad.sdf[q[axis]], voxelSize, point);
+                    out.slots->push_back(static_cast<std::uint16_t>(tsdf::TsdfBlock::voxelIndex(x, y, z) * 3 + axis));
+                    out.positions->insert(out.positions->end(), point, point + 3);
+                }
+            }
+        }
+    }
+
+    // 2. 以本块体素为原点、8 个角点都已观测的立方体；顶点按 (属主块, 槽位) 引用。
+    const std::array<McCase, 256>& table = caseTable();
+    for (int z = 0; z < SIDE; ++z) {
+        for (int y = 0; y < SIDE; ++y) {
+            for (int x = 0; x < SIDE; ++x) {
+                int mask = 0;
+                bool complete = true;
+                float values[8];
+                for (int c = 0; c < 8 && complete; ++c) {
+                    const int p = padIndex(x + (c & 1), y + ((c >> 1) & 1), z + ((c >> 2) & 1));
+                    complete = pad.observed[p] != 0;
+                    values[c] = pad.sdf[p];
+                    mask |= values[c] < 0.0f ? 1 << c : 0;
+                }
+                const McCase& entry = table[static_cast<std::size_t>(mask)];
+                if (!complete || entry.count == 0) {
+                    continue;
+                }
+                std::uint64_t keys[12];
+                float points[12][3];
+                for (int e = 0; e < 12; ++e) {
+                    const int lo = EDGE_CORNER[e];
+                    const int px = x + (lo & 1);
+                    const int py = y + ((lo >> 1) & 1);
+                    const int pz = z + ((lo >> 2) & 1);
+                    if ((values[lo] < 0.0f) == (values[lo | (1 << EDGE_AXIS[e])] < 0.0f)) {
+                        continue;
+                    }
+                    const std::int64_t owner = pad.owners[(px / SIDE) | ((py / SIDE) << 1) | ((pz / SIDE) << 2)];
+                    const int slot = tsdf::TsdfBlock::voxelIndex(px % SIDE, py % SIDE, pz % SIDE) * 3 + EDGE_AXIS[e];
+                    keys[e] = (static_cast<std::uint64_t>(owner) << SLOT_BITS) | static_cast<std::uint64_t>(slot);
+                    const std::int32_t voxel[3] = {base[0] + px, base[1] + py, base[2] + pz};
+                    edgePoint(voxel, EDGE_AXIS[e], values[lo], values[lo | (1 << EDGE_AXIS[e])], voxelSize, points[e]);
+                }
+                for (int t = 0; t < entry.count; ++t) {
+                    const int a = entry.edges[t * 3 + 0];
+                    const int b = entry.edges[t * 3 + 1];
+                    const int c = entry.edges[t * 3 + 2];
+                    // 零点恰好落在体素中心时相邻边的顶点重合，跳过退化三角形。
+                    if (std::memcmp(points[a], points[b], sizeof(points[a])) == 0 || std::memcmp(points[b], points[c], sizeof(points[b])) == 0 ||
+                        std::memcmp(points[a], points[c], sizeof(points[a])) == 0) {
+                        continue;
+                    }
+                    out.corners->insert(out.corners->end(), {keys[a], keys[b], keys[c]});
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+namespace tsdf {
+
+TsdfMesh::TsdfMesh(double minWeight) : minWeight_(static_cast<float>(minWeight)) {
+    if (!(minWeight > 0.0)) {
+        throw std::runtime_error("TSDF 网格提取的 min_weight 须大于 0");
+    }
+}
+
+TsdfMeshStats TsdfMesh::update(const TsdfVolume& volume) {
+    const auto start = std::chrono::steady_clock::now();
+    TsdfMeshStats stats;
+    const std::size_t count = volume.blockCount();
+    if (count > (std::numeric_limits<std::uint64_t>::max() >> SLOT_BITS)) {
+        throw std::runtime_error("TSDF 块数过多");
+    }
+    blocks_.resize(count);
+
+    // 脏块的立方体与顶点会变，-x/-y/-z 方向的邻块也有立方体角点或格点边落在脏块内。
+    std::vector<std::uint8_t> remesh(count, 0);
+    for (std::size_t b = 0; b < count; ++b) {
+        const TsdfBlock& block = volume.block(b);
+        if (block.stamp <= lastEpoch_) {
+            continue;
+        }
+        ++stats.dirtyBlocks;
+        for (int n = 0; n < 8; ++n) {
+            const std::int64_t index =
+                volume.findIndex(block.coord[0] - (n & 1), block.coord[1] - ((n >> 1) & 1), block.coord[2] - ((n >> 2) & 1));
+            if (index >= 0) {
+                remesh[static_cast<std::size_t>(index)] = 1;
+            }
+        }
+    }
+    std::vector<std::size_t> pending;
+    for (std::size_t b = 0; b < count; ++b) {
+        if (remesh[b]) {
+            pending.push_back(b);
+        }
+    }
+    stats.remeshedBlocks = pending.size();
+
+    // 每个块只写自己的输出，跨块顶点只记引用，无需加锁。
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, pending.size(), BLOCK_GRAIN), [&](const tbb::blocked_range<std::size_t>& range) {
+        const TraceSpan span("mesh_blocks");
+        for (std::size_t i = range.begin(); i != range.end(); ++i) {
+            BlockMesh& mesh = blocks_[pending[i]];
+            meshBlock(volume, pending[i], minWeight_, {&mesh.slots, &mesh.positions, &mesh.corners});
+        }
+    });
+
+    lastEpoch_ = volume.epoch();
+    stats.vertices = vertexCount();
+    stats.faces = faceCount();
+    stats.meshMs = elapsedMs(start);
+    return stats;
+}
+
+std::size_t TsdfMesh::vertexCount() const {
+    std::size_t total = 0;
+    for (const BlockMesh& mesh : blocks_) {
+        total += mesh.slots.size();
+    }
+    return total;
+}
+
+std::size_t TsdfMesh::faceCount() const {
+    std::size_t total = 0;
+    for (const BlockMesh& mesh : blocks_) {
+        total += mesh.corners.size() / 3;
+    }
+    return total;
+}
+
+void TsdfMesh::writePly(const fs::path& output) const {
+    // 每块顶点、三角形在输出中的起始序号。
+    std::vector<std::size_t> vertexStart(blocks_.size() + 1, 0);
+    std::vector<std::size_t> faceStart(blocks_.size() + 1, 0);
+    for (std::size_t b = 0; b < blocks_.size(); ++b) {
+        vertexStart[b + 1] = vertexStart[b] + blocks_[b].slots.size();
+        faceStart[b + 1] = faceStart[b] + blocks_[b].corners.size() / 3;
+    }
+    const std::size_t vertices = vertexStart.back();
+    const std::size_t faces = faceStart.back();
+    if (vertices > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max())) {
+        throw std::runtime_error("网格顶点数超出 PLY int 索引范围");
+    }
+
+    const std::string header = "ply\nformat binary_little_endian 1.0\nelement vertex " + std::to_string(vertices) +
+                               "\nproperty float x\nproperty float y\nproperty float z\nelement face " + std::to_string(faces) +
+                               "\nproperty list uchar int vertex_indices\nend_header\n";
+
+    const auto globalIndex = [&](std::uint64_t key) {
+        const BlockMesh& owner = blocks_[static_cast<std::size_t>(key >> SLOT_BITS)];
+        const auto slot = static_cast<std::uint16_t>(key & SLOT_MASK);
+        const auto it = std::lower_bound(owner.slots.begin(), owner.slots.end(), slot);
+        if (it == owner.slots.end() || *it != slot) {
+            throw std::runtime_error("网格顶点引用失效，属主块未提取");
+        }
+        return static_cast<std::int32_t>(vertexStart[key >> SLOT_BITS] + static_cast<std::size_t>(it - owner.slots.begin()));
+    };
+    const auto fillBlock = [&](std::size_t b, char* vertexDst, char* faceDst) {
+        const BlockMesh& mesh = blocks_[b];
+        if (vertexDst) {
+            std::memcpy(vertexDst, mesh.positions.data(), mesh.positions.size() * sizeof(float));
+        }
+        for (std::size_t k = 0; k < mesh.corners.size(); k += 3) {
+            const std::int32_t indices[3] = {globalIndex(mesh.corners[k]), globalIndex(mesh.corners[k + 1]), globalIndex(mesh.corners[k + 2])};
+            faceDst[0] = 3;
+            std::memcpy(faceDst + 1, indices, sizeof(indices));
+            faceDst += FACE_BYTES;
+        }
+    };
+
+    const std::size_t faceOffset = header.size() + vertices * VERTEX_BYTES;
+    MappedOutputFile file(output, faceOffset + faces * FACE_BYTES);
+    if (file.valid()) {
+        std::memcpy(file.data(), header.data(), header.size());
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, blocks_.size(), BLOCK_GRAIN), [&](const tbb::blocked_range<std::size_t>& range) {
+            const TraceSpan span("write_mesh");
+            for (std::size_t b = range.begin(); b != range.end(); ++b) {
+                fillBlock(b, file.data() + header.size() + vertexStart[b] * VERTEX_BYTES, file.data() + faceOffset + faceStart[b] * FACE_BYTES);
+            }
+        });
+        file.close();
+        return;
+    }
+    file.close();
+
+    // 无法映射时逐块生成后按顶点段、三角形段顺序流式写出。
+    std::ofstream out(output, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("无法写出网格: " + output.string());
+    }
+    out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    for (const BlockMesh& mesh : blocks_) {
+        out.write(reinterpret_cast<const char*>(mesh.positions.data()), static_cast<std::streamsize>(mesh.positions.size() * sizeof(float)));
+    }
+    std::vector<char> buffer;
+    for (std::size_t b = 0; b < blocks_.size(); ++b) {
+        buffer.resize((faceStart[b + 1] - faceStart[b]) * FACE_BYTES);
+        fillBlock(b, nullptr, buffer.data());
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    }
+    out.close();
+    if (!out) {
+        throw std::runtime_error("写出网格失败: " + output.string());
+    }
+}
+
+}  // namespace tsdf
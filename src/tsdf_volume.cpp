@@ -0,0 +1,282 @@
+#include "tsdf_volume.h"
+
+#include "telemetry.h"
+
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// 收集 (块, 点) 对时每个任务处理的点数。
+constexpr std::size_t RAY_GRAIN = 1 << 14;
+// integrateDataset 每批收集的点数，限制 (块, 点) 对数组的峰值内存。
+constexpr std::size_t DATASET_BATCH = 1 << 22;
+// 块坐标每轴 21 位，偏置后打包为 64 位键。
+constexpr std::int64_t BLOCK_BIAS = std::int64_t(1) << 20;
+
+struct BlockPair {
+    std::uint64_t block;
+    std::uint32_t point;
+
+    bool operator<(const BlockPair& other) const { return block != other.block ? block < other.block : point < other.point; }
+};
+
+std::int32_t floorDiv(std::int32_t v, std::int32_t d) {
+    return v >= 0 ? v / d : -((-v + d - 1) / d);
+}
+
+std::uint64_t packBlock(std::int32_t bx, std::int32_t by, std::int32_t bz) {
+    if (std::abs(bx) >= BLOCK_BIAS || std::abs(by) >= BLOCK_BIAS || std::abs(bz) >= BLOCK_BIAS) {
+        throw std::runtime_error("TSDF 块坐标超出范围，请检查位姿或增大 voxel_size");
+    }
+    return (static_cast<std::uint64_t>(bx + BLOCK_BIAS) << 42) | (static_cast<std::uint64_t>(by + BLOCK_BIAS) << 21) |
+           static_cast<std::uint64_t>(bz + BLOCK_BIAS);
+}
+
+void unpackBlock(std::uint64_t key, std::int32_t coord[3]) {
+    constexpr std::uint64_t mask = (std::uint64_t(1) << 21) - 1;
+    coord[0] = static_cast<std::int32_t>(static_cast<std::int64_t>((key >> 42) & mask) - BLOCK_BIAS);
+    coord[1] = static_cast<std::int32_t>(static_cast<std::int64_t>((key >> 21) & mask) - BLOCK_BIAS);
+    coord[2] = static_cast<std::int32_t>(static_cast<std::int64_t>(key & mask) - BLOCK_BIAS);
+}
+
+// 传感器原点到测点的射线，截断段为 t ∈ [t0, t1]（t 为沿射线的距离）。
+struct Ray {
+    double origin[3];
+    double dir[3];
+    double depth = 0.0;
+    double t0 = 0.0;
+    double t1 = 0.0;
+};
+
+bool makeRay(const CCVector3& point, const CCVector3d& origin, double truncation, Ray* ray) {
+    const double d[3] = {point.x - origin.x, point.y - origin.y, point.z - origin.z};
+    const double depth = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+    if (!(depth > 1e-6)) {
+        return false;
+    }
+    for (int a = 0; a < 3; ++a) {
+        ray->origin[a] = origin[static_cast<unsigned>(a)];
+        ray->dir[a] = d[a] / depth;
+    }
+    ray->depth = depth;
+    ray->t0 = std::max(0.0, depth - truncation);
+    ray->t1 = depth + truncation;
+    return true;
+}
+
+// Amanatides-Woo 3D DDA：对截断段经过的每个体素恰好调用一次 fn(vx, vy, vz)。
+template <typename Fn>
+void traverseRay(const Ray& ray, double voxelSize, Fn&& fn) {
+    std::int32_t v[3];
+    std::int32_t step[3];
+    double tMax[3];
+    double tDelta[3];
+    for (int a = 0; a < 3; ++a) {
+        const double p = ray.origin[a] + ray.dir[a] * ray.t0;
+        v[a] = static_cast<std::int32_t>(std::floor(p / voxelSize));
+        if (ray.dir[a] > 0.0) {
+            step[a] = 1;
+            tDelta[a] = voxelSize / ray.dir[a];
+            tMax[a] = ray.t0 + ((v[a] + 1) * voxelSize - p) / ray.dir[a];
+        } else if (ray.dir[a] < 0.0) {
+            step[a] = -1;
+            tDelta[a] = -voxelSize / ray.dir[a];
+            tMax[a] = ray.t0 + (v[a] * voxelSize - p) / ray.dir[a];
+        } else {
+            step[a] = 0;
+            tDelta[a] = std::numeric_limits<double>::infinity();
+            tMax[a] = std::numeric_limits<double>::infinity();
+        }
+    }
+    // 段长对应的步数上界，防止浮点误差导致死循环。
+    const int maxSteps = 3 * (static_cast<int>(std::ceil((ray.t1 - ray.t0) / voxelSize)) + 2);
+    for (int i = 0; i < maxSteps; ++i) {
+        fn(v[0], v[1], v[2]);
+        const int a = tMax[0] < tMax[1] ? (tMax[0] < tMax[2] ? 0 : 2) : (tMax[1] < tMax[2] ? 1 : 2);
+        if (tMax[a] > ray.t1) {
+            break;
+        }
+        v[a] += step[a];
+        tMax[a] += tDelta[a];
+    }
+}
+
+}  // namespace
+
+namespace tsdf {
+
+void TsdfIntegrateStats::merge(const TsdfIntegrateStats& other) {
+    points += other.points;
+    pairs += other.pairs;
+    touchedBlocks += other.touchedBlocks;
+    newBlocks += other.newBlocks;
+    pairMs += other.pairMs;
+    integrateMs += other.integrateMs;
+}
+
+TsdfVolume::TsdfVolume(double voxelSize, double truncation, double maxWeight)
+    : voxelSize_(voxelSize), truncation_(truncation), maxWeight_(static_cast<float>(maxWeight)) {
+    if (!(voxelSize > 0.0) || !(truncation > 0.0) || !(maxWeight >= 1.0)) {
+        throw std::runtime_error("TSDF 参数无效：voxel_size / truncation 须大于 0，max_weight 须不小于 1");
+    }
+}
+
+const TsdfBlock* TsdfVolume::find(std::int32_t bx, std::int32_t by, std::int32_t bz) const {
+    const std::int64_t index = findIndex(bx, by, bz);
+    return index < 0 ? nullptr : &blocks_[static_cast<std::size_t>(index)];
+}
+
+std::int64_t TsdfVolume::findIndex(std::int32_t bx, std::int32_t by, std::int32_t bz) const {
+    const auto it = lookup_.find(packBlock(bx, by, bz));
+    return it == lookup_.end() ? -1 : static_cast<std::int64_t>(it->second);
+}
+
+TsdfIntegrateStats TsdfVolume::integrate(const CCVector3* points, const std::uint32_t* originIds, std::size_t count, const CCVector3d* origins) {
+    TsdfIntegrateStats stats;
+    stats.points = count;
+    ++epoch_;
+    if (count == 0) {
+        return stats;
+    }
+    if (count > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error("TSDF 单批点数过多");
+    }
+
+    // 1. 并行遍历每条射线的截断段，记录其经过的块；射线离开凸的块后不会再回来，相邻去重即可。
+    const auto pairStart = std::chrono::steady_clock::now();
+    tbb::enumerable_thread_specific<std::vector<BlockPair>> local;
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, count, RAY_GRAIN), [&](const tbb::blocked_range<std::size_t>& range) {
+        const TraceSpan span("tsdf_rays");
+        std::vector<BlockPair>& out = local.local();
+        for (std::size_t i = range.begin(); i != range.end(); ++i) {
+            Ray ray;
+            if (!makeRay(points[i], origins[originIds[i]], truncation_, &ray)) {
+                continue;
+            }
+            std::uint64_t last = ~std::uint64_t(0);
+            traverseRay(ray, voxelSize_, [&](std::int32_t vx, std::int32_t vy, std::int32_t vz) {
+                const std::uint64_t key = packBlock(floorDiv(vx, TSDF_BLOCK_SIDE), floorDiv(vy, TSDF_BLOCK_SIDE), floorDiv(vz, TSDF_BLOCK_SIDE));
+                if (key != last) {
+                    out.push_back({key, static_cast<std::uint32_t>(i)});
+                    last = key;
+                }
+            });
+        }
+    });
+    std::size_t total = 0;
+    for (const std::vector<BlockPair>& part : local) {
+        total += part.size();
+    }
+    std::vector<BlockPair> pairs;
+    pairs.reserve(total);
+    for (std::vector<BlockPair>& part : local) {
+        pairs.insert(pairs.end(), part.begin(), part.end());
+        std::vector<BlockPair>().swap(part);
+    }
+    tbb::parallel_sort(pairs.begin(), pairs.end());
+    stats.pairs = pairs.size();
+
+    // 2. 切出每个块的连续区间，新块串行插入哈希（块数远少于点数）。
+    std::vector<std::size_t> runStart;
+    std::vector<std::uint32_t> runBlock;
+    for (std::size_t k = 0; k < pairs.size(); ++k) {
+        if (k > 0 && pairs[k].block == pairs[k - 1].block) {
+            continue;
+        }
+        runStart.push_back(k);
+        const auto [it, inserted] = lookup_.try_emplace(pairs[k].block, static_cast<std::uint32_t>(blocks_.size()));
+        if (inserted) {
+            blocks_.emplace_back();
+            unpackBlock(pairs[k].block, blocks_.back().coord);
+            ++stats.newBlocks;
+        }
+        runBlock.push_back(it->second);
+    }
+    runStart.push_back(pairs.size());
+    stats.touchedBlocks = runBlock.size();
+    stats.pairMs = elapsedMs(pairStart);
+
+    // 3. 按块并行积分：每个块只由一个任务写入，块内按点号顺序更新。
+    const auto integrateStart = std::chrono::steady_clock::now();
+    const double invTruncation = 1.0 / truncation_;
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, runBlock.size(), 16), [&](const tbb::blocked_range<std::size_t>& range) {
+        const TraceSpan span("tsdf_blocks");
+        for (std::size_t r = range.begin(); r != range.end(); ++r) {
+            TsdfBlock& block = blocks_[runBlock[r]];
+            block.stamp = epoch_;
+            const std::int32_t base[3] = {block.coord[0] * TSDF_BLOCK_SIDE, block.coord[1] * TSDF_BLOCK_SIDE, block.coord[2] * TSDF_BLOCK_SIDE};
+            for (std::size_t k = runStart[r]; k < runStart[r + 1]; ++k) {
+                Ray ray;
+                const std::uint32_t i = pairs[k].point;
+                if (!makeRay(points[i], origins[originIds[i]], truncation_, &ray)) {
+                    continue;
+                }
+                traverseRay(ray, voxelSize_, [&](std::int32_t vx, std::int32_t vy, std::int32_t vz) {
+                    const std::int32_t lx = vx - base[0];
+                    const std::int32_t ly = vy - base[1];
+                    const std::int32_t lz = vz - base[2];
+                    if (lx < 0 || ly < 0 || lz < 0 || lx >= TSDF_BLOCK_SIDE || ly >= TSDF_BLOCK_SIDE || lz >= TSDF_BLOCK_SIDE) {
+                        return;
+                    }
+                    // 投影距离：测点深度减去体素中心在射线方向上的投影长度。
+                    const double c[3] = {(vx + 0.5) * voxelSize_ - ray.origin[0], (vy + 0.5) * voxelSize_ - ray.origin[1],
+                                         (vz + 0.5) * voxelSize_ - ray.origin[2]};
+                    const double sdf = ray.depth - (c[0] * ray.dir[0] + c[1] * ray.dir[1] + c[2] * ray.dir[2]);
+                    if (sdf < -truncation_) {
+                        return;
+                    }
+                    const float value = static_cast<float>(std::min(1.0, sdf * invTruncation));
+                    TsdfVoxel& voxel = block.voxels[TsdfBlock::voxelIndex(lx, ly, lz)];
+                    voxel.sdf = (voxel.sdf * voxel.weight + value) / (voxel.weight + 1.0f);
+                    voxel.weight = std::min(voxel.weight + 1.0f, maxWeight_);
+                });
+            }
+        }
+    });
+    stats.integrateMs = elapsedMs(integrateStart);
+    return stats;
+}
+
+TsdfIntegrateStats integrateDataset(TsdfVolume& volume, const LidarDataset& dataset, const CCCoreLib::ReferenceCloud& kept) {
+    std::vector<CCVector3d> origins(dataset.frames.size());
+    for (std::size_t f = 0; f < dataset.frames.size(); ++f) {
+        const FramePose& pose = dataset.frames[f].pose;
+        origins[f] = CCVector3d(pose.translation[0], pose.translation[1], pose.translation[2]);
+    }
+
+    const std::uint32_t firstEpoch = volume.epoch() + 1;
+    TsdfIntegrateStats stats;
+    const std::size_t count = kept.size();
+    std::vector<CCVector3> points(std::min(count, DATASET_BATCH));
+    std::vector<std::uint32_t> frameIds(points.size());
+    for (std::size_t first = 0; first < count; first += DATASET_BATCH) {
+        const std::size_t n = std::min(DATASET_BATCH, count - first);
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, n, RAY_GRAIN), [&](const tbb::blocked_range<std::size_t>& range) {
+            for (std::size_t i = range.begin(); i != range.end(); ++i) {
+                const unsigned index = kept.getPointGlobalIndex(static_cast<unsigned>(first + i));
+                points[i] = *dataset.cloud->getPoint(index);
+                frameIds[i] = static_cast<std::uint32_t>(dataset.frameOf(index));
+            }
+        });
+        stats.merge(volume.integrate(points.data(), frameIds.data(), n, origins.data()));
+    }
+
+    // 多批之间同一块会被重复计数，这里按 stamp 重新统计本次更新过的块。
+    stats.touchedBlocks = 0;
+    for (std::size_t b = 0; b < volume.blockCount(); ++b) {
+        stats.touchedBlocks += volume.block(b).stamp >= firstEpoch ? 1 : 0;
+    }
+    return stats;
+}
+
+}  // namespace tsdf
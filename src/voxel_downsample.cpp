@@ -0,0 +1,241 @@
+#include "voxel_downsample.h"
+
+#include "radix_sort.h"
+#include "telemetry.h"
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+
+constexpr std::size_t GRAIN = 1 << 16;
+constexpr unsigned AXIS_BITS = 21;
+constexpr double AXIS_CELLS = static_cast<double>(std::uint64_t(1) << AXIS_BITS);
+// 非有限坐标的点不参与分组，排序时用全 1 键排到末尾后截掉。
+constexpr std::uint64_t REJECTED = std::numeric_limits<std::uint64_t>::max();
+
+bool isFinite(const CCVector3& p) {
+    return std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z);
+}
+
+// 有限点的包围盒，rejected 为跳过的非有限点数。
+struct Bounds {
+    float min[3] = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+    float max[3] = {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+    std::size_t rejected = 0;
+
+    void add(const CCVector3& p) {
+        if (!isFinite(p)) {
+            ++rejected;
+            return;
+        }
+        for (int k = 0; k < 3; ++k) {
+            min[k] = std::min(min[k], p.u[k]);
+            max[k] = std::max(max[k], p.u[k]);
+        }
+    }
+
+    void merge(const Bounds& other) {
+        for (int k = 0; k < 3; ++k) {
+            min[k] = std::min(min[k], other.min[k]);
+            max[k] = std::max(max[k], other.max[k]);
+        }
+        rejected += other.rejected;
+    }
+};
+
+}  // namespace
+
+namespace tsdf {
+
+std::vector<std::uint32_t> mergeVoxels(CCCoreLib::PointCloud& cloud,
+                                       const std::vector<std::uint32_t>& indices,
+                                       double voxelSize,
+                                       bool centroid,
+                                       DownsampleStats* stats) {
+    if (!(voxelSize > 0.0)) {
+        throw std::runtime_error("体素边长必须大于 0");
+    }
+    DownsampleStats local;
+    DownsampleStats& out = stats ? *stats : local;
+    const std::size_t count = indices.size();
+    out.input = count;
+    if (count == 0) {
+        out.output = 0;
+        return {};
+    }
+    const CCVector3* points = cloud.getPoint(0);
+
+    // 1. 包围盒与体素键：每轴 21 位 (x << 42 | y << 21 | z)；NaN / Inf 转成整数是未定义行为，先剔除。
+    auto start = std::chrono::steady_clock::now();
+    const Bounds bounds = tbb::parallel_reduce(
+        tbb::blocked_range<std::size_t>(0, count, GRAIN),
+        Bounds{},
+        [&](const tbb::blocked_range<std::size_t>& range, Bounds acc) {
+            for (std::size_t i = range.begin(); i != range.end(); ++i) {
+                acc.add(points[indices[i]]);
+            }
+            return acc;
+        },
+        [](Bounds a, const Bounds& b) {
+            a.merge(b);
+            return a;
+        });
+    if (bounds.rejected == count) {
+        out.output = 0;
+        out.keyMs = elapsedMs(start);
+        return {};
+    }
+    const double inv = 1.0 / voxelSize;
+    for (int k = 0; k < 3; ++k) {
+        if ((static_cast<double>(bounds.max[k]) - bounds.min[k]) * inv >= AXIS_CELLS) {
+            throw std::runtime_error("点云包围盒相对体素边长过大，体素坐标超出 21 位");
+        }
+    }
+    std::vector<KeyIndex> cells(count);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, count, GRAIN), [&](const tbb::blocked_range<std::size_t>& range) {
+        for (std::size_t i = range.begin(); i != range.end(); ++i) {
+            const CCVector3& p = points[indices[i]];
+            if (!isFinite(p)) {
+                cells[i] = {REJECTED, indices[i]};
+                continue;
+            }
+            const auto cx = static_cast<std::uint64_t>((static_cast<double>(p.x) - bounds.min[0]) * inv);
+            const auto cy = static_cast<std::uint64_t>((static_cast<double>(p.y) - bounds.min[1]) * inv);
+            const auto cz = static_cast<std::uint64_t>((static_cast<double>(p.z) - bounds.min[2]) * inv);
+            cells[i] = {(cx << (2 * AXIS_BITS)) | (cy << AXIS_BITS) | cz, indices[i]};
+        }
+    });
+    out.keyMs = elapsedMs(start);
+
+    // 2. 稳定基数排序：输入按下标升序，同一体素内的首元素即原始下标最小的点。
+    start = std::chrono::steady_clock::now();
+    radixSortByKey(cells, bounds.rejected > 0 ? 64u : 3 * AXIS_BITS);
+    cells.resize(count - bounds.rejected);
+    out.sortMs = elapsedMs(start);
+
+    // 3. 每个体素归约到代表点，在原始下标空间打标记后按块压实，得到升序的代表点下标。
+    start = std::chrono::steady_clock::now();
+    std::vector<std::size_t> runStart;
+    for (std::size_t k = 0; k < cells.size(); ++k) {
+        if (k == 0 || cells[k].key != cells[k - 1].key) {
+            runStart.push_back(k);
+        }
+    }
+    runStart.push_back(cells.size());
+    const std::size_t runs = runStart.size() - 1;
+    const std::size_t universe = cloud.size();
+    std::vector<std::uint8_t> representative(universe, 0);
+    CCVector3* writable = cloud.point(0);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, runs, 1024), [&](const tbb::blocked_range<std::size_t>& range) {
+        for (std::size_t r = range.begin(); r != range.end(); ++r) {
+            const std::uint32_t first = cells[runStart[r]].index;
+            representative[first] = 1;
+            if (!centroid || runStart[r + 1] - runStart[r] == 1) {
+                continue;
+            }
+            double sum[3] = {0.0, 0.0, 0.0};
+            for (std::size_t k = runStart[r]; k < runStart[r + 1]; ++k) {
+                const CCVector3& p = writable[cells[k].index];
+                sum[0] += p.x;
+                sum[1] += p.y;
+                sum[2] += p.z;
+            }
+            const double n = static_cast<double>(runStart[r + 1] - runStart[r]);
+            writable[first] = CCVector3(static_cast<PointCoordinateType>(sum[0] / n),
+                                        static_cast<PointCoordinateType>(sum[1] / n),
+                                        static_cast<PointCoordinateType>(sum[2] / n));
+        }
+    });
+    std::vector<KeyIndex>().swap(cells);
+    if (centroid) {
+        cloud.invalidateBoundingBox();
+    }
+
+    const std::size_t chunks = (universe + GRAIN - 1) / GRAIN;
+    std::vector<std::size_t> chunkStart(chunks + 1, 0);
+    tbb::parallel_for(std::size_t(0), chunks, [&](std::size_t c) {
+        const std::size_t end = std::min(universe, (c + 1) * GRAIN);
+        chunkStart[c + 1] = static_cast<std::size_t>(std::count(representative.begin() + c * GRAIN, representative.begin() + end, std::uint8_t(1)));
+    });
+    std::partial_sum(chunkStart.begin(), chunkStart.end(), chunkStart.begin());
+    std::vector<std::uint32_t> kept(chunkStart.back());
+    tbb::parallel_for(std::size_t(0), chunks, [&](std::size_t c) {
+        std::size_t cursor = chunkStart[c];
+        const std::size_t end = std::min(universe, (c + 1) * GRAIN);
+        for (std::size_t i = c * GRAIN; i < end; ++i) {
+            if (representative[i]) {
+                kept[cursor++] = static_cast<std::uint32_t>(i);
+            }
+        }
+    });
+    out.reduceMs = elapsedMs(start);
+    out.output = kept.size();
+    return kept;
+}
+
+DownsampleStats downsampleDataset(LidarDataset& dataset, const DownsampleConfig& cfg) {
+    const auto start = std::chrono::steady_clock::now();
+    CCCoreLib::PointCloud& cloud = *dataset.cloud;
+    const std::size_t count = cloud.size();
+    std::vector<std::uint32_t> all(count);
+    std::iota(all.begin(), all.end(), std::uint32_t(0));
+    DownsampleStats stats;
+    const std::vector<std::uint32_t> kept = mergeVoxels(cloud, all, cfg.voxel_size, cfg.mode == DownsampleMode::kCentroid, &stats);
+    std::vector<std::uint32_t>().swap(all);
+
+    // 代表点按原始下标升序，各帧仍占连续区间；并行收集后原地缩小合并点云（调用方持有的引用保持有效）。
+    const auto compactStart = std::chrono::steady_clock::now();
+    if (!kept.empty()) {
+        std::vector<CCVector3> compact(kept.size());
+        const CCVector3* src = cloud.getPoint(0);
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, kept.size(), GRAIN), [&](const tbb::blocked_range<std::size_t>& range) {
+            for (std::size_t i = range.begin(); i != range.end(); ++i) {
+                compact[i] = src[kept[i]];
+            }
+        });
+        if (!cloud.resize(static_cast<unsigned>(kept.size()))) {
+            throw std::runtime_error("降采样点云缩容失败");
+        }
+        std::memcpy(static_cast<void*>(cloud.point(0)), compact.data(), compact.size() * sizeof(CCVector3));
+    }
+    cloud.invalidateBoundingBox();
+
+    for (LidarFrame& frame : dataset.frames) {
+        const auto first = std::lower_bound(kept.begin(), kept.end(), static_cast<std::uint32_t>(frame.pointOffset));
+        const auto last = std::lower_bound(first, kept.end(), static_cast<std::uint32_t>(frame.pointOffset + frame.pointCount));
+        frame.pointOffset = static_cast<std::size_t>(first - kept.begin());
+        frame.pointCount = static_cast<std::size_t>(last - first);
+    }
+
+    if (dataset.records.valid() && dataset.records.size() == count && cfg.mode == DownsampleMode::kFirst) {
+        PcdHeader header = dataset.records.header();
+        const std::size_t step = header.pointStep;
+        std::vector<char> buffer(kept.size() * step);
+        const char* records = dataset.records.data();
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, kept.size(), GRAIN), [&](const tbb::blocked_range<std::size_t>& range) {
+            for (std::size_t i = range.begin(); i != range.end(); ++i) {
+                std::memcpy(buffer.data() + i * step, records + static_cast<std::size_t>(kept[i]) * step, step);
+            }
+        });
+        header.pointCount = kept.size();
+        header.data = PcdDataFormat::kBinary;
+        dataset.records = PcdRecords(std::move(buffer), header);
+    } else {
+        dataset.records = PcdRecords();
+    }
+    stats.reduceMs += elapsedMs(compactStart);
+    stats.totalMs = elapsedMs(start);
+    return stats;
+}
+
+}  // namespace tsdf
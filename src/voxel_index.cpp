@@ -0,0 +1,435 @@
+#include "voxel_index.h"
+
+#include "morton.h"
+#include "radix_sort.h"
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+constexpr std::uint64_t EMPTY_KEY = ~std::uint64_t(0);
+constexpr std::size_t GRAIN = 1 << 16;
+
+std::uint64_t hashKey(std::uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return key;
+}
+
+constexpr unsigned DIGIT_BITS = 8;
+constexpr std::size_t BUCKETS = std::size_t(1) << DIGIT_BITS;
+// 区间不超过该点数时改用插入排序；超过 PARALLEL_RANGE 时并行统计直方图、并行递归各桶。
+constexpr std::size_t INSERTION_RANGE = 32;
+constexpr std::size_t PARALLEL_RANGE = 1 << 16;
+
+// 原地 MSD 基数排序（American flag sort）：每层按 keyAt(i) 的一个 8 位数字就地交换元素，再逐桶递归下一位。
+// 键按下标即时计算，不需要键数组与等长散射缓冲；结果不稳定，同键元素的相对次序任意。
+template <typename KeyFn, typename SwapFn>
+void sortInPlace(std::size_t begin, std::size_t end, int shift, const KeyFn& keyAt, const SwapFn& swapAt) {
+    if (shift < 0 || end - begin < 2) {
+        return;
+    }
+    if (end - begin <= INSERTION_RANGE) {
+        for (std::size_t i = begin + 1; i < end; ++i) {
+            const std::uint64_t key = keyAt(i);
+            for (std::size_t j = i; j > begin && keyAt(j - 1) > key; --j) {
+                swapAt(j - 1, j);
+            }
+        }
+        return;
+    }
+
+    const auto digitAt = [&](std::size_t i) { return static_cast<std::size_t>(keyAt(i) >> shift) & (BUCKETS - 1); };
+    using Histogram = std::array<std::size_t, BUCKETS>;
+    const auto countRange = [&](const tbb::blocked_range<std::size_t>& range, Histogram acc) {
+        for (std::size_t i = range.begin(); i != range.end(); ++i) {
+            ++acc[digitAt(i)];
+        }
+        return acc;
+    };
+    Histogram counts{};
+    if (end - begin >= PARALLEL_RANGE) {
+        counts = tbb::parallel_reduce(tbb::blocked_range<std::size_t>(begin, end, GRAIN), Histogram{}, countRange, [](Histogram a, const Histogram& b) {
+            for (std::size_t d = 0; d < BUCKETS; ++d) {
+                a[d] += b[d];
+            }
+            return a;
+        });
+    } else {
+        counts = countRange(tbb::blocked_range<std::size_t>(begin, end), Histogram{});
+    }
+
+    Histogram heads;
+    Histogram tails;
+    std::size_t offset = begin;
+    for (std::size_t d = 0; d < BUCKETS; ++d) {
+        heads[d] = offset;
+        offset += counts[d];
+        tails[d] = offset;
+    }
+    const Histogram starts = heads;
+    for (std::size_t d = 0; d < BUCKETS; ++d) {
+        while (heads[d] < tails[d]) {
+            const std::size_t digit = digitAt(heads[d]);
+            if (digit == d) {
+                ++heads[d];
+            } else {
+                swapAt(heads[d], heads[digit]++);
+            }
+        }
+    }
+
+    const auto sortBucket = [&](std::size_t d) { sortInPlace(starts[d], tails[d], shift - static_cast<int>(DIGIT_BITS), keyAt, swapAt); };
+    if (end - begin >= PARALLEL_RANGE) {
+        tbb::parallel_for(std::size_t(0), BUCKETS, sortBucket);
+    } else {
+        for (std::size_t d = 0; d < BUCKETS; ++d) {
+            sortBucket(d);
+        }
+    }
+}
+
+inline bool isFinite(float x, float y, float z) {
+    return std::isfinite(x) && std::isfinite(y) && std::isfinite(z);
+}
+
+// 有限点的包围盒与非有限点（NaN / Inf）计数；非有限点不进索引，同 ParallelOctree 与 CCCoreLib 八叉树。
+struct Bounds {
+    float min[3] = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+    float max[3] = {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+    std::size_t rejected = 0;
+
+    void add(float x, float y, float z) {
+        if (!isFinite(x, y, z)) {
+            ++rejected;
+            return;
+        }
+        const float p[3] = {x, y, z};
+        for (int k = 0; k < 3; ++k) {
+            min[k] = std::min(min[k], p[k]);
+            max[k] = std::max(max[k], p[k]);
+        }
+    }
+
+    void merge(const Bounds& other) {
+        for (int k = 0; k < 3; ++k) {
+            min[k] = std::min(min[k], other.min[k]);
+            max[k] = std::max(max[k], other.max[k]);
+        }
+    }
+};
+
+}  // namespace
+
+namespace tsdf {
+
+void VoxelIndex::build(const CCVector3* points, std::size_t count, double cellSize) {
+    if (!(cellSize > 0.0)) {
+        throw std::runtime_error("体素索引的体素边长必须大于 0");
+    }
+    if (count > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error("体素索引点数超过 32 位索引上限");
+    }
+    cellSize_ = cellSize;
+
+    const Bounds bounds = tbb::parallel_reduce(
+        tbb::blocked_range<std::size_t>(0, count, GRAIN),
+        Bounds{},
+        [points](const tbb::blocked_range<std::size_t>& range, Bounds acc) {
+            for (std::size_t i = range.begin(); i != range.end(); ++i) {
+                acc.add(points[i].x, points[i].y, points[i].z);
+            }
+            return acc;
+        },
+        [](Bounds a, const Bounds& b) {
+            a.merge(b);
+            a.rejected += b.rejected;
+            return a;
+        });
+    setOrigin(bounds.min, bounds.max, count - bounds.rejected);
+
+    // 非有限点取全 1 键排到末尾后截掉。
+    std::vector<KeyIndex> keyed(count);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, count, GRAIN), [&](const tbb::blocked_range<std::size_t>& range) {
+        for (std::size_t i = range.begin(); i != range.end(); ++i) {
+            const CCVector3& p = points[i];
+            keyed[i] = {isFinite(p.x, p.y, p.z) ? cellKey(p.x, p.y, p.z) : EMPTY_KEY, static_cast<std::uint32_t>(i)};
+        }
+    });
+    radixSortByKey(keyed, bounds.rejected > 0 ? 64u : 3 * MORTON_AXIS_BITS);
+    count -= bounds.rejected;
+    keyed.resize(count);
+
+    xs_.resize(count);
+    ys_.resize(count);
+    zs_.resize(count);
+    order_.resize(count);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, count, GRAIN), [&](const tbb::blocked_range<std::size_t>& range) {
+        for (std::size_t i = range.begin(); i != range.end(); ++i) {
+            const CCVector3& p = points[keyed[i].index];
+            xs_[i] = p.x;
+            ys_[i] = p.y;
+            zs_[i] = p.z;
+            order_[i] = keyed[i].index;
+        }
+    });
+    indexCells(count, [&](std::size_t i) { return keyed[i].key; });
+}
+
+void VoxelIndex::adopt(std::vector<float>&& xs, std::vector<float>&& ys, std::vector<float>&& zs, double cellSize, bool trackOrder) {
+    if (!(cellSize > 0.0)) {
+        throw std::runtime_error("体素索引的体素边长必须大于 0");
+    }
+    std::size_t count = xs.size();
+    if (ys.size() != count || zs.size() != count) {
+        throw std::runtime_error("体素索引的 SoA 坐标长度不一致");
+    }
+    if (count > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error("体素索引点数超过 32 位索引上限");
+    }
+    cellSize_ = cellSize;
+    xs_ = std::move(xs);
+    ys_ = std::move(ys);
+    zs_ = std::move(zs);
+    order_.clear();
+    if (trackOrder) {
+        order_.resize(count);
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, count, GRAIN), [&](const tbb::blocked_range<std::size_t>& range) {
+            for (std::size_t i = range.begin(); i != range.end(); ++i) {
+                order_[i] = static_cast<std::uint32_t>(i);
+            }
+        });
+    }
+
+    const Bounds bounds = tbb::parallel_reduce(
+        tbb::blocked_range<std::size_t>(0, count, GRAIN),
+        Bounds{},
+        [&](const tbb::blocked_range<std::size_t>& range, Bounds acc) {
+            for (std::size_t i = range.begin(); i != range.end(); ++i) {
+                acc.add(xs_[i], ys_[i], zs_[i]);
+            }
+            return acc;
+        },
+        [](Bounds a, const Bounds& b) {
+            a.merge(b);
+            a.rejected += b.rejected;
+            return a;
+        });
+    // 非有限点按原次序挪出，索引只含有限点，size() 随之变小。
+    if (bounds.rejected > 0) {
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            if (isFinite(xs_[i], ys_[i], zs_[i])) {
+                xs_[kept] = xs_[i];
+                ys_[kept] = ys_[i];
+                zs_[kept] = zs_[i];
+                if (trackOrder) {
+                    order_[kept] = static_cast<std::uint32_t>(i);
+                }
+                ++kept;
+            }
+        }
+        count = kept;
+        xs_.resize(count);
+        ys_.resize(count);
+        zs_.resize(count);
+        if (trackOrder) {
+            order_.resize(count);
+        }
+    }
+    setOrigin(bounds.min, bounds.max, count);
+
+    // 键只用到包围盒所需的位数，高位全零的趟不必走。
+    std::uint64_t maxCoord = 0;
+    for (int k = 0; k < 3; ++k) {
+        if (count > 0) {
+            maxCoord = std::max(maxCoord, static_cast<std::uint64_t>(std::floor((static_cast<double>(bounds.max[k]) - origin_[k]) / cellSize_)));
+        }
+    }
+    unsigned axisBits = 0;
+    while (axisBits < MORTON_AXIS_BITS && (maxCoord >> axisBits) != 0) {
+        ++axisBits;
+    }
+    const auto keyAt = [this](std::size_t i) { return cellKey(xs_[i], ys_[i], zs_[i]); };
+    const auto swapAt = [this, trackOrder](std::size_t a, std::size_t b) {
+        std::swap(xs_[a], xs_[b]);
+        std::swap(ys_[a], ys_[b]);
+        std::swap(zs_[a], zs_[b]);
+        if (trackOrder) {
+            std::swap(order_[a], order_[b]);
+        }
+    };
+    sortInPlace(0, count, static_cast<int>((3 * axisBits + DIGIT_BITS - 1) / DIGIT_BITS * DIGIT_BITS) - static_cast<int>(DIGIT_BITS), keyAt, swapAt);
+    indexCells(count, keyAt);
+}
+
+void VoxelIndex::setOrigin(const float min[3], const float max[3], std::size_t count) {
+    for (int k = 0; k < 3; ++k) {
+        origin_[k] = count > 0 ? min[k] : 0.0;
+        if (count > 0 && std::floor((static_cast<double>(max[k]) - origin_[k]) / cellSize_) > static_cast<double>(MORTON_AXIS_MAX)) {
+            throw std::runtime_error("点云包围盒相对 radius 过大，体素坐标超出 21 位 Morton 编码范围");
+        }
+    }
+}
+
+std::uint64_t VoxelIndex::cellKey(float x, float y, float z) const {
+    return mortonEncode(static_cast<std::uint64_t>(std::floor((static_cast<double>(x) - origin_[0]) / cellSize_)),
+                        static_cast<std::uint64_t>(std::floor((static_cast<double>(y) - origin_[1]) / cellSize_)),
+                        static_cast<std::uint64_t>(std::floor((static_cast<double>(z) - origin_[2]) / cellSize_)));
+}
+
+// 点已按键升序排列，keyAt(i) 给出第 i 个点的键：切出体素区间并建哈希表。
+template <typename KeyFn>
+void VoxelIndex::indexCells(std::size_t count, const KeyFn& keyAt) {
+    cellKeys_.clear();
+    cellStart_.clear();
+    std::uint64_t previous = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::uint64_t key = keyAt(i);
+        if (i == 0 || key != previous) {
+            cellKeys_.push_back(key);
+            cellStart_.push_back(static_cast<std::uint32_t>(i));
+            previous = key;
+        }
+    }
+    cellStart_.push_back(static_cast<std::uint32_t>(count));
+
+    std::size_t capacity = 16;
+    while (capacity < cellKeys_.size() * 2) {
+        capacity <<= 1;
+    }
+    hashMask_ = capacity - 1;
+    hashKeys_.assign(capacity, EMPTY_KEY);
+    hashCells_.assign(capacity, 0);
+    for (std::size_t c = 0; c < cellKeys_.size(); ++c) {
+        std::uint64_t slot = hashKey(cellKeys_[c]) & hashMask_;
+        while (hashKeys_[slot] != EMPTY_KEY) {
+            slot = (slot + 1) & hashMask_;
+        }
+        hashKeys_[slot] = cellKeys_[c];
+        hashCells_[slot] = static_cast<std::uint32_t>(c);
+    }
+}
+
+std::int64_t VoxelIndex::findCell(std::uint64_t key) const {
+    std::uint64_t slot = hashKey(key) & hashMask_;
+    while (hashKeys_[slot] != EMPTY_KEY) {
+        if (hashKeys_[slot] == key) {
+            return hashCells_[slot];
+        }
+        slot = (slot + 1) & hashMask_;
+    }
+    return -1;
+}
+
+std::size_t VoxelIndex::neighborCells(std::size_t index, Range out[27]) const {
+    const std::uint64_t key = cellKeys_[index];
+    const std::int64_t cx = static_cast<std::int64_t>(compactBits(key));
+    const std::int64_t cy = static_cast<std::int64_t>(compactBits(key >> 1));
+    const std::int64_t cz = static_cast<std::int64_t>(compactBits(key >> 2));
+    const std::int64_t axisMax = static_cast<std::int64_t>(MORTON_AXIS_MAX);
+
+    std::size_t found = 0;
+    for (std::int64_t dz = -1; dz <= 1; ++dz) {
+        const std::int64_t z = cz + dz;
+        if (z < 0 || z > axisMax) {
+            continue;
+        }
+        for (std::int64_t dy = -1; dy <= 1; ++dy) {
+            const std::int64_t y = cy + dy;
+            if (y < 0 || y > axisMax) {
+                continue;
+            }
+            for (std::int64_t dx = -1; dx <= 1; ++dx) {
+                const std::int64_t x = cx + dx;
+                if (x < 0 || x > axisMax) {
+                    continue;
+                }
+                const std::int64_t neighbor = findCell(mortonEncode(x, y, z));
+                if (neighbor >= 0) {
+                    out[found++] = cell(static_cast<std::size_t>(neighbor));
+                }
+            }
+        }
+    }
+    return found;
+}
+
+std::size_t VoxelIndex::shellCells(std::size_t index, int ring, std::vector<Range>& out) const {
+    const std::uint64_t key = cellKeys_[index];
+    const std::int64_t cx = static_cast<std::int64_t>(compactBits(key));
+    const std::int64_t cy = static_cast<std::int64_t>(compactBits(key >> 1));
+    const std::int64_t cz = static_cast<std::int64_t>(compactBits(key >> 2));
+    const std::int64_t axisMax = static_cast<std::int64_t>(MORTON_AXIS_MAX);
+    const std::int64_t r = ring;
+
+    const std::size_t before = out.size();
+    for (std::int64_t dz = -r; dz <= r; ++dz) {
+        const std::int64_t z = cz + dz;
+        if (z < 0 || z > axisMax) {
+            continue;
+        }
+        for (std::int64_t dy = -r; dy <= r; ++dy) {
+            const std::int64_t y = cy + dy;
+            if (y < 0 || y > axisMax) {
+                continue;
+            }
+            // 上下两面与前后两面整行，其余行只取两端。
+            const bool fullRow = dz == -r || dz == r || dy == -r || dy == r;
+            for (std::int64_t dx = -r; dx <= r; dx += fullRow ? 1 : 2 * r) {
+                const std::int64_t x = cx + dx;
+                if (x < 0 || x > axisMax) {
+                    continue;
+                }
+                const std::int64_t neighbor = findCell(mortonEncode(x, y, z));
+                if (neighbor >= 0) {
+                    out.push_back(cell(static_cast<std::size_t>(neighbor)));
+                }
+            }
+        }
+    }
+    return out.size() - before;
+}
+
+std::size_t VoxelIndex::gatherNeighborhood(std::size_t index,
+                                           std::vector<float>& xs,
+                                           std::vector<float>& ys,
+                                           std::vector<float>& zs,
+                                           std::vector<std::uint32_t>& sorted) const {
+    Range ranges[27];
+    const std::size_t cells = neighborCells(index, ranges);
+    std::size_t total = 0;
+    for (std::size_t r = 0; r < cells; ++r) {
+        total += ranges[r].end - ranges[r].begin;
+    }
+    if (xs.size() < total) {
+        xs.resize(total);
+        ys.resize(total);
+        zs.resize(total);
+        sorted.resize(total);
+    }
+    std::size_t filled = 0;
+    for (std::size_t r = 0; r < cells; ++r) {
+        const std::uint32_t n = ranges[r].end - ranges[r].begin;
+        std::copy_n(xs_.data() + ranges[r].begin, n, xs.data() + filled);
+        std::copy_n(ys_.data() + ranges[r].begin, n, ys.data() + filled);
+        std::copy_n(zs_.data() + ranges[r].begin, n, zs.data() + filled);
+        for (std::uint32_t k = 0; k < n; ++k) {
+            sorted[filled + k] = ranges[r].begin + k;
+        }
+        filled += n;
+    }
+    return filled;
+}
+
+}  // namespace tsdf
@@ -0,0 +1,198 @@
+#include "watch_mode.h"
+
+#include "cloud_io.h"
+#include "incremental_filter.h"
+#include "lidar_dataset.h"
+#include "telemetry.h"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+volatile std::sig_atomic_t g_stop = 0;
+
+void requestStop(int) {
+    g_stop = 1;
+}
+
+// 运行期间把 SIGINT / SIGTERM 改为请求退出，让输出正常收尾；析构时恢复原处理函数。
+class StopSignals {
+public:
+    StopSignals() {
+        g_stop = 0;
+        previousInt_ = std::signal(SIGINT, requestStop);
+        previousTerm_ = std::signal(SIGTERM, requestStop);
+    }
+    ~StopSignals() {
+        std::signal(SIGINT, previousInt_);
+        std::signal(SIGTERM, previousTerm_);
+    }
+
+    StopSignals(const StopSignals&) = delete;
+    StopSignals& operator=(const StopSignals&) = delete;
+
+private:
+    void (*previousInt_)(int) = SIG_DFL;
+    void (*previousTerm_)(int) = SIG_DFL;
+};
+
+struct SizeSample {
+    std::uintmax_t size = 0;
+    std::chrono::steady_clock::time_point since;  // 首次观察到该大小的时刻
+};
+
+// 位姿文件的增量读取：记住已解析的字节偏移，每次只解析新写出的完整行，最后一行未写完时留待下次。
+class PoseTail {
+public:
+    explicit PoseTail(fs::path path) : path_(std::move(path)) {}
+
+    const std::vector<tsdf::FramePose>& poll() {
+        std::ifstream in(path_, std::ios::binary);
+        if (!in) {
+            return poses_;
+        }
+        in.seekg(static_cast<std::streamoff>(offset_));
+        std::string chunk((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        const std::size_t end = chunk.rfind('\n');
+        if (end == std::string::npos) {
+            return poses_;
+        }
+        std::size_t begin = 0;
+        tsdf::FramePose pose;
+        while (begin <= end) {
+            const std::size_t newline = chunk.find('\n', begin);
+            if (tsdf::parsePoseLine(chunk.substr(begin, newline - begin), ++lineNo_, path_, &pose)) {
+                poses_.push_back(pose);
+            }
+            begin = newline + 1;
+        }
+        offset_ += end + 1;
+        return poses_;
+    }
+
+private:
+    fs::path path_;
+    std::uintmax_t offset_ = 0;
+    std::size_t lineNo_ = 0;
+    std::vector<tsdf::FramePose> poses_;
+};
+
+}  // namespace
+
+namespace tsdf {
+
+WatchStats runWatch(const AppConfig& cfg, const fs::path& output, const fs::path& revokeLog, std::ostream& log) {
+    const StopSignals signals;
+
+    const std::string extension = cloudExtension(cfg.base.pointcloud_format);
+    IncrementalFilter filter(cfg.filter);
+    PoseTail poses(cfg.base.depth_pose);
+    CloudStreamWriter writer(output);
+    std::ofstream revoked(revokeLog, std::ios::trunc);
+    if (!revoked) {
+        throw std::runtime_error("无法写出撤销日志: " + revokeLog.string());
+    }
+
+    WatchStats stats;
+    double frameMsSum = 0.0;
+    fs::path lastFrame;
+    std::unordered_map<std::string, SizeSample> lastSize;  // 待处理帧最近一次观察到的文件大小
+    std::vector<CCVector3> points;
+    auto lastActivity = std::chrono::steady_clock::now();
+    log << "在线模式: 监视 " << cfg.base.depth_path << "  位姿: " << cfg.base.depth_pose << "  输出: " << output << '\n';
+
+    while (!g_stop) {
+        const std::vector<FramePose>& available = poses.poll();
+        const std::vector<fs::path> files = fs::is_directory(cfg.base.depth_path) ? listFrameFiles(cfg.base.depth_path, extension)
+                                                                                  : std::vector<fs::path>();
+        if (files.size() < stats.frames || (stats.frames > 0 && files[stats.frames - 1] != lastFrame)) {
+            throw std::runtime_error("帧目录中出现排在已处理帧之前的新文件或已处理帧被删除: " + cfg.base.depth_path.string());
+        }
+
+        // 帧文件仍在写入时大小会变化：大小至少保持一个轮询间隔不变才算写完。先为全部待处理帧采样，再按帧序处理。
+        const std::size_t ready = std::min(files.size(), available.size());
+        const auto now = std::chrono::steady_clock::now();
+        std::size_t stable = stats.frames;
+        bool prefix = true;
+        for (std::size_t i = stats.frames; i < ready; ++i) {
+            std::error_code ec;
+            const std::uintmax_t size = fs::file_size(files[i], ec);
+            const auto it = lastSize.find(files[i].string());
+            if (ec || size == 0 || it == lastSize.end() || it->second.size != size) {
+                lastSize[files[i].string()] = {ec ? 0 : size, now};
+                prefix = false;
+            } else if (now - it->second.since < std::chrono::milliseconds(cfg.watch.poll_ms)) {
+                prefix = false;
+            } else if (prefix) {
+                stable = i + 1;
+            }
+        }
+
+        bool progressed = false;
+        for (std::size_t i = stats.frames; i < stable && !g_stop; ++i) {
+            const auto frameStart = std::chrono::steady_clock::now();
+            const TraceSpan span("watch_frame");
+            const std::size_t count = readCloudHeader(files[i]).pointCount;
+            points.resize(count);
+            const std::size_t loaded = count > 0 ? loadCloudPoints(files[i], points.data(), count) : 0;
+            points.resize(loaded);
+            transformPoints(available[i], points.data(), loaded);
+            const IncrementalFilter::Update update = filter.insert(points.data(), loaded);
+
+            writer.append(update.added.data(), update.added.size());
+            writer.flush();
+            for (const std::uint64_t row : update.revoked) {
+                revoked << row << '\n';
+            }
+            revoked.flush();
+            if (!revoked) {
+                throw std::runtime_error("写出撤销日志失败: " + revokeLog.string());
+            }
+
+            const double frameMs = elapsedMs(frameStart);
+            lastSize.erase(files[i].string());
+            lastFrame = files[i];
+            ++stats.frames;
+            stats.points += loaded;
+            stats.evaluated += update.evaluated;
+            stats.revoked += update.revoked.size();
+            frameMsSum += frameMs;
+            stats.maxFrameMs = std::max(stats.maxFrameMs, frameMs);
+            progressed = true;
+            log << "帧 " << i << " (" << files[i].filename().string() << "): " << loaded << " 点"
+                << "  复评: " << update.evaluated << " 点 / " << update.cells << " 体素"
+                << "  新增: " << update.added.size() << "  撤销: " << update.revoked.size()
+                << "  地图: " << filter.size() << " 点  保留: " << filter.keptCount()
+                << "  耗时: " << frameMs << " ms\n";
+        }
+
+        if (progressed) {
+            lastActivity = std::chrono::steady_clock::now();
+            continue;
+        }
+        if (cfg.watch.idle_exit_s > 0.0 && elapsedMs(lastActivity) >= cfg.watch.idle_exit_s * 1000.0) {
+            log << "在线模式: 空闲超过 " << cfg.watch.idle_exit_s << " s，退出。\n";
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(cfg.watch.poll_ms));
+    }
+
+    writer.close();
+    stats.kept = filter.keptCount();
+    stats.rows = filter.rows();
+    stats.meanFrameMs = stats.frames > 0 ? frameMsSum / static_cast<double>(stats.frames) : 0.0;
+    return stats;
+}
+
+}  // namespace tsdf